@@ -0,0 +1,552 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+// Packed asset archive (.vkpa).
+//
+// Layout:
+//   [ AssetArchiveHeader ]                 64 bytes
+//   [ AssetArchiveEntry * entryCount ]     64 bytes each, sorted by nameHash
+//   [ AssetArchiveRegion * regionCount ]   16 bytes each (texture mip levels)
+//   [ string table ]                       entry names, not null terminated
+//   [ payloads ]                           each aligned to ASSET_ARCHIVE_ALIGNMENT
+//
+// Payloads are stored exactly as the GPU consumes them (vertex/index data, block
+// compressed mip chains, SPIR-V words) so that the runtime can memcpy them from the
+// mapped file into staging memory without parsing or intermediate heap copies.
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <assert.h>
+
+const uint32_t ASSET_ARCHIVE_MAGIC     = 0x41504B56; // "VKPA"
+const uint32_t ASSET_ARCHIVE_VERSION   = 1;
+const uint64_t ASSET_ARCHIVE_ALIGNMENT = 64;
+
+
+enum AssetType : uint32_t
+{
+    ASSET_TYPE_RAW     = 0,
+    ASSET_TYPE_MESH    = 1,
+    ASSET_TYPE_TEXTURE = 2,
+    ASSET_TYPE_SPIRV   = 3
+};
+
+
+enum AssetFlags : uint32_t
+{
+    ASSET_FLAG_MESH_OPTIMIZED = 0x1 // Indices/vertices already reordered by MeshOptimizer.h
+};
+
+
+struct AssetArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t regionCount;
+    uint64_t tocOffset;
+    uint64_t regionTableOffset;
+    uint64_t stringTableOffset;
+    uint64_t stringTableSize;
+    uint64_t fileSize;
+    uint8_t  reserved[8];
+};
+static_assert(sizeof(AssetArchiveHeader) == 64, "AssetArchiveHeader must be 64 bytes.");
+
+
+// [ cfarvin::NOTE ] The meaning of info[] depends on the entry type:
+//   ASSET_TYPE_MESH    : vertexCount, vertexStride, indexCount, indexSize (2 or 4), indexOffset, vertexFormat
+//                        Optional format specific metadata follows the indices, see MeshMetadata().
+//   ASSET_TYPE_TEXTURE : VkFormat, width, height, mipLevels, arrayLayers, firstRegion
+//   ASSET_TYPE_SPIRV   : VkShaderStageFlagBits
+struct AssetArchiveEntry
+{
+    uint64_t nameHash;
+    uint64_t offset; // From the start of the file, ASSET_ARCHIVE_ALIGNMENT aligned
+    uint64_t size;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t type;
+    uint32_t flags;
+    uint32_t info[6];
+};
+static_assert(sizeof(AssetArchiveEntry) == 64, "AssetArchiveEntry must be 64 bytes.");
+
+
+// One subresource (texture mip level / layer) inside an entry payload. Offsets are
+// relative to the owning entry's payload and are ASSET_ARCHIVE_ALIGNMENT aligned, which
+// satisfies the bufferOffset rules of vkCmdCopyBufferToImage for every format.
+struct AssetArchiveRegion
+{
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(AssetArchiveRegion) == 16, "AssetArchiveRegion must be 16 bytes.");
+
+
+inline uint64_t
+HashAssetName(const char* name, size_t length)
+{
+    // FNV-1a, 64 bit
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t ii = 0; ii < length; ii++)
+    {
+        hash ^= static_cast<uint8_t>(name[ii]);
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+
+inline uint64_t
+HashAssetName(const std::string& name)
+{
+    return HashAssetName(name.data(), name.size());
+}
+
+
+inline uint64_t
+AlignArchiveOffset(uint64_t offset)
+{
+    return (offset + ASSET_ARCHIVE_ALIGNMENT - 1) & ~(ASSET_ARCHIVE_ALIGNMENT - 1);
+}
+
+
+// Read-only view of a memory mapped archive. Entries and payloads point directly into
+// the mapping and stay valid until Close().
+class AssetArchive
+{
+public:
+    AssetArchive() = default;
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    ~AssetArchive()
+    {
+        Close();
+    }
+
+
+    void
+    Open(const std::string& path)
+    {
+        Close();
+        file.Open(path);
+        mappedData = file.Data();
+        mappedSize = file.Size();
+
+        if (mappedSize < sizeof(AssetArchiveHeader))
+        {
+            Close();
+            throw std::runtime_error("[ ERROR ] Asset archive is truncated: " + path);
+        }
+
+        header = reinterpret_cast<const AssetArchiveHeader*>(mappedData);
+        if (header->magic != ASSET_ARCHIVE_MAGIC || header->version != ASSET_ARCHIVE_VERSION)
+        {
+            Close();
+            throw std::runtime_error("[ ERROR ] Not a supported asset archive: " + path);
+        }
+
+        // Validate every table and payload once, here, so that lookups never have to.
+        bool valid = header->fileSize == mappedSize;
+        valid = valid && RangeIsValid(header->tocOffset,
+                                      static_cast<uint64_t>(header->entryCount) * sizeof(AssetArchiveEntry));
+        valid = valid && RangeIsValid(header->regionTableOffset,
+                                      static_cast<uint64_t>(header->regionCount) * sizeof(AssetArchiveRegion));
+        valid = valid && RangeIsValid(header->stringTableOffset, header->stringTableSize);
+        valid = valid && (header->tocOffset % alignof(AssetArchiveEntry)) == 0;
+        valid = valid && (header->regionTableOffset % alignof(AssetArchiveRegion)) == 0;
+
+        if (valid)
+        {
+            entries = reinterpret_cast<const AssetArchiveEntry*>(mappedData + header->tocOffset);
+            regions = reinterpret_cast<const AssetArchiveRegion*>(mappedData + header->regionTableOffset);
+            for (uint32_t ii = 0; valid && ii < header->entryCount; ii++)
+            {
+                const AssetArchiveEntry& entry = entries[ii];
+                valid = RangeIsValid(entry.offset, entry.size) &&
+                    (entry.offset % ASSET_ARCHIVE_ALIGNMENT) == 0 &&
+                    static_cast<uint64_t>(entry.nameOffset) + entry.nameLength <= header->stringTableSize &&
+                    (ii == 0 || entries[ii - 1].nameHash < entry.nameHash);
+
+                if (valid && entry.type == ASSET_TYPE_TEXTURE)
+                {
+                    uint64_t regionCount = static_cast<uint64_t>(entry.info[3]) * entry.info[4];
+                    valid = static_cast<uint64_t>(entry.info[5]) + regionCount <= header->regionCount;
+                    for (uint64_t rr = 0; valid && rr < regionCount; rr++)
+                    {
+                        const AssetArchiveRegion& region = regions[entry.info[5] + rr];
+                        valid = region.offset <= entry.size && region.size <= entry.size - region.offset;
+                    }
+                }
+            }
+        }
+
+        if (!valid)
+        {
+            Close();
+            throw std::runtime_error("[ ERROR ] Asset archive is corrupt: " + path);
+        }
+    }
+
+
+    void
+    Close()
+    {
+        file.Close();
+        mappedData = nullptr;
+        mappedSize = 0;
+        header     = nullptr;
+        entries    = nullptr;
+        regions    = nullptr;
+    }
+
+
+    bool
+    IsOpen() const
+    {
+        return mappedData != nullptr;
+    }
+
+
+    uint32_t
+    EntryCount() const
+    {
+        return header ? header->entryCount : 0;
+    }
+
+
+    const AssetArchiveEntry&
+    Entry(uint32_t index) const
+    {
+        assert(index < EntryCount());
+        return entries[index];
+    }
+
+
+    // Returns nullptr if no entry with the given name exists.
+    const AssetArchiveEntry*
+    Find(const std::string& name) const
+    {
+        if (!header) return nullptr;
+
+        uint64_t hash = HashAssetName(name);
+        const AssetArchiveEntry* end = entries + header->entryCount;
+        const AssetArchiveEntry* found = std::lower_bound(entries, end, hash,
+                                                          [](const AssetArchiveEntry& entry, uint64_t value)
+                                                          {
+                                                              return entry.nameHash < value;
+                                                          });
+
+        if (found == end || found->nameHash != hash) return nullptr;
+        return found;
+    }
+
+
+    std::string
+    Name(const AssetArchiveEntry& entry) const
+    {
+        const char* strings = reinterpret_cast<const char*>(mappedData + header->stringTableOffset);
+        return std::string(strings + entry.nameOffset, entry.nameLength);
+    }
+
+
+    const uint8_t*
+    Payload(const AssetArchiveEntry& entry) const
+    {
+        return mappedData + entry.offset;
+    }
+
+
+    // Bytes stored after the index data of a mesh (e.g. a dequantization transform), or
+    // nullptr if there are none.
+    const uint8_t*
+    MeshMetadata(const AssetArchiveEntry& entry, size_t& size) const
+    {
+        assert(entry.type == ASSET_TYPE_MESH);
+        uint64_t indexBytes     = static_cast<uint64_t>(entry.info[2]) * entry.info[3];
+        uint64_t metadataOffset = AlignArchiveOffset(entry.info[4] + indexBytes);
+
+        size = 0;
+        if (metadataOffset >= entry.size) return nullptr;
+
+        size = static_cast<size_t>(entry.size - metadataOffset);
+        return Payload(entry) + metadataOffset;
+    }
+
+
+    // Texture subresources, ordered by mip level then array layer.
+    const AssetArchiveRegion*
+    Regions(const AssetArchiveEntry& entry) const
+    {
+        assert(entry.type == ASSET_TYPE_TEXTURE);
+        return regions + entry.info[5];
+    }
+
+
+    // Copies the payload straight from the mapping into (typically persistently mapped
+    // staging) memory.
+    void
+    CopyPayload(const AssetArchiveEntry& entry, void* destination) const
+    {
+        memcpy(destination, Payload(entry), static_cast<size_t>(entry.size));
+    }
+
+
+private:
+    bool
+    RangeIsValid(uint64_t offset, uint64_t size) const
+    {
+        return offset <= mappedSize && size <= mappedSize - offset;
+    }
+
+
+    MappedFile                file;
+    const uint8_t*            mappedData    = nullptr;
+    size_t                    mappedSize    = 0;
+    const AssetArchiveHeader* header        = nullptr;
+    const AssetArchiveEntry*  entries       = nullptr;
+    const AssetArchiveRegion* regions       = nullptr;
+};
+
+
+// Offline side of the format, used by AssetPacker. Payloads are gathered in memory and
+// laid out by Write().
+class AssetArchiveWriter
+{
+public:
+    void
+    AddRaw(const std::string& name, const void* data, size_t size)
+    {
+        PendingAsset& asset = AddAsset(name, ASSET_TYPE_RAW);
+        AppendBlob(asset, data, size);
+    }
+
+
+    void
+    AddSpirv(const std::string& name, uint32_t shaderStage, const std::vector<uint32_t>& words)
+    {
+        PendingAsset& asset = AddAsset(name, ASSET_TYPE_SPIRV);
+        asset.info[0] = shaderStage;
+        AppendBlob(asset, words.data(), words.size() * sizeof(uint32_t));
+    }
+
+
+    // Vertices first, then indices at an aligned offset within the same payload so both
+    // can be copied with a single memcpy and bound from one buffer. Metadata, if any,
+    // goes last.
+    void
+    AddMesh(const std::string& name,
+            const void*        vertexData,
+            uint32_t           vertexCount,
+            uint32_t           vertexStride,
+            uint32_t           vertexFormat,
+            const void*        indexData,
+            uint32_t           indexCount,
+            uint32_t           indexSize,
+            uint32_t           flags = 0,
+            const void*        metadata = nullptr,
+            size_t             metadataSize = 0)
+    {
+        if (indexSize != 2 && indexSize != 4)
+        {
+            throw std::runtime_error("[ ERROR ] Mesh index size must be 2 or 4 bytes: " + name);
+        }
+
+        PendingAsset& asset = AddAsset(name, ASSET_TYPE_MESH);
+        AppendBlob(asset, vertexData, static_cast<size_t>(vertexCount) * vertexStride);
+        size_t indexOffset = AppendBlob(asset, indexData, static_cast<size_t>(indexCount) * indexSize);
+        if (metadataSize)
+        {
+            AppendBlob(asset, metadata, metadataSize);
+        }
+
+        asset.info[0] = vertexCount;
+        asset.info[1] = vertexStride;
+        asset.info[2] = indexCount;
+        asset.info[3] = indexSize;
+        asset.info[4] = static_cast<uint32_t>(indexOffset);
+        asset.info[5] = vertexFormat;
+        asset.flags   = flags;
+    }
+
+
+    // subresources[level * arrayLayers + layer]
+    void
+    AddTexture(const std::string&                     name,
+               uint32_t                               vkFormat,
+               uint32_t                               width,
+               uint32_t                               height,
+               uint32_t                               mipLevels,
+               uint32_t                               arrayLayers,
+               const std::vector<std::vector<uint8_t>>& subresources)
+    {
+        if (subresources.size() != static_cast<size_t>(mipLevels) * arrayLayers)
+        {
+            throw std::runtime_error("[ ERROR ] Texture subresource count mismatch: " + name);
+        }
+
+        PendingAsset& asset = AddAsset(name, ASSET_TYPE_TEXTURE);
+        asset.info[0] = vkFormat;
+        asset.info[1] = width;
+        asset.info[2] = height;
+        asset.info[3] = mipLevels;
+        asset.info[4] = arrayLayers;
+        for (const auto& subresource : subresources)
+        {
+            AssetArchiveRegion region = {};
+            region.offset = AppendBlob(asset, subresource.data(), subresource.size());
+            region.size   = subresource.size();
+            asset.regions.push_back(region);
+        }
+    }
+
+
+    void
+    Write(const std::string& path)
+    {
+        std::sort(assets.begin(), assets.end(),
+                  [](const PendingAsset& lhs, const PendingAsset& rhs)
+                  {
+                      return lhs.hash < rhs.hash;
+                  });
+
+        for (size_t ii = 1; ii < assets.size(); ii++)
+        {
+            if (assets[ii].hash == assets[ii - 1].hash)
+            {
+                throw std::runtime_error("[ ERROR ] Asset name collision: " + assets[ii - 1].name +
+                                         " / " + assets[ii].name);
+            }
+        }
+
+        std::vector<AssetArchiveEntry>  toc(assets.size());
+        std::vector<AssetArchiveRegion> regionTable;
+        std::string                     strings;
+
+        AssetArchiveHeader header = {};
+        header.magic             = ASSET_ARCHIVE_MAGIC;
+        header.version           = ASSET_ARCHIVE_VERSION;
+        header.entryCount        = static_cast<uint32_t>(assets.size());
+        header.tocOffset         = sizeof(AssetArchiveHeader);
+        header.regionTableOffset = header.tocOffset + toc.size() * sizeof(AssetArchiveEntry);
+
+        for (size_t ii = 0; ii < assets.size(); ii++)
+        {
+            const PendingAsset& asset = assets[ii];
+            AssetArchiveEntry&  entry = toc[ii];
+            entry.nameHash   = asset.hash;
+            entry.size       = asset.payload.size();
+            entry.nameOffset = static_cast<uint32_t>(strings.size());
+            entry.nameLength = static_cast<uint32_t>(asset.name.size());
+            entry.type       = asset.type;
+            entry.flags      = asset.flags;
+            memcpy(entry.info, asset.info, sizeof(entry.info));
+
+            if (asset.type == ASSET_TYPE_TEXTURE)
+            {
+                entry.info[5] = static_cast<uint32_t>(regionTable.size());
+                regionTable.insert(regionTable.end(), asset.regions.begin(), asset.regions.end());
+            }
+            strings += asset.name;
+        }
+
+        header.regionCount       = static_cast<uint32_t>(regionTable.size());
+        header.stringTableOffset = header.regionTableOffset + regionTable.size() * sizeof(AssetArchiveRegion);
+        header.stringTableSize   = strings.size();
+
+        uint64_t cursor = header.stringTableOffset + header.stringTableSize;
+        for (size_t ii = 0; ii < assets.size(); ii++)
+        {
+            toc[ii].offset = AlignArchiveOffset(cursor);
+            cursor         = toc[ii].offset + toc[ii].size;
+        }
+        header.fileSize = cursor;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create asset archive: " + path);
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(toc.data()),
+                   static_cast<std::streamsize>(toc.size() * sizeof(AssetArchiveEntry)));
+        file.write(reinterpret_cast<const char*>(regionTable.data()),
+                   static_cast<std::streamsize>(regionTable.size() * sizeof(AssetArchiveRegion)));
+        file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+        uint64_t written = header.stringTableOffset + header.stringTableSize;
+        const char padding[ASSET_ARCHIVE_ALIGNMENT] = {};
+        for (size_t ii = 0; ii < assets.size(); ii++)
+        {
+            file.write(padding, static_cast<std::streamsize>(toc[ii].offset - written));
+            file.write(reinterpret_cast<const char*>(assets[ii].payload.data()),
+                       static_cast<std::streamsize>(assets[ii].payload.size()));
+            written = toc[ii].offset + toc[ii].size;
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to write asset archive: " + path);
+        }
+    }
+
+
+    size_t
+    AssetCount() const
+    {
+        return assets.size();
+    }
+
+
+private:
+    struct PendingAsset
+    {
+        std::string                     name;
+        uint64_t                        hash;
+        uint32_t                        type;
+        uint32_t                        flags;
+        uint32_t                        info[6];
+        std::vector<uint8_t>            payload;
+        std::vector<AssetArchiveRegion> regions;
+    };
+
+
+    PendingAsset&
+    AddAsset(const std::string& name, AssetType type)
+    {
+        PendingAsset asset = {};
+        asset.name = name;
+        asset.hash = HashAssetName(name);
+        asset.type = type;
+        assets.push_back(asset);
+        return assets.back();
+    }
+
+
+    // Returns the aligned offset of the blob within the asset payload.
+    size_t
+    AppendBlob(PendingAsset& asset, const void* data, size_t size)
+    {
+        size_t offset = static_cast<size_t>(AlignArchiveOffset(asset.payload.size()));
+        asset.payload.resize(offset + size);
+        if (size)
+        {
+            memcpy(asset.payload.data() + offset, data, size);
+        }
+        return offset;
+    }
+
+    std::vector<PendingAsset> assets;
+};
+
+#endif // ASSET_ARCHIVE_H
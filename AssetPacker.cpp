@@ -0,0 +1,200 @@
+// Offline packer for the .vkpa asset archive format (see AssetArchive.h).
+//
+// Usage:
+//   AssetPacker <output.vkpa> <kind>:<name>=<path> [<kind>:<name>=<path> ...]
+//
+// Kinds:
+//   raw    Copied verbatim.
+//   spirv  SPIR-V module. The shader stage is taken from the file name
+//          (e.g. triangle.vert.spv, cull.comp.spv).
+//   ktx2   KTX2 texture without supercompression. Its mip chain is stored as GPU ready
+//          regions, so the runtime can copy levels straight into staging memory.
+//   mesh   Wavefront .obj or binary glTF .glb, imported in parallel (see MeshImporter.h),
+//          reordered for vertex cache, overdraw and vertex fetch (see MeshOptimizer.h) and
+//          stored as MeshVertex vertices with 32-bit triangle list indices.
+//   qmesh  Same as mesh, but stored as 16 byte QuantizedMeshVertex vertices with the
+//          MeshDequantization transform as metadata (see MeshQuantizer.h).
+
+#include <vulkan/vulkan.h>
+
+#include "AssetArchive.h"
+#include "Ktx2Loader.h"
+#include "MeshImporter.h"
+#include "MeshOptimizer.h"
+#include "MeshQuantizer.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+
+std::vector<uint8_t>
+ReadBinaryFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to open input file: " + path);
+    }
+
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return bytes;
+}
+
+
+uint32_t
+ShaderStageFromPath(const std::string& path)
+{
+    struct StageSuffix { const char* suffix; VkShaderStageFlagBits stage; };
+    const StageSuffix suffixes[] =
+    {
+        { ".vert", VK_SHADER_STAGE_VERTEX_BIT },
+        { ".tesc", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT },
+        { ".tese", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT },
+        { ".geom", VK_SHADER_STAGE_GEOMETRY_BIT },
+        { ".frag", VK_SHADER_STAGE_FRAGMENT_BIT },
+        { ".comp", VK_SHADER_STAGE_COMPUTE_BIT }
+    };
+
+    for (const auto& entry : suffixes)
+    {
+        if (path.find(entry.suffix) != std::string::npos)
+        {
+            return static_cast<uint32_t>(entry.stage);
+        }
+    }
+
+    throw std::runtime_error("[ ERROR ] Unable to determine the shader stage of: " + path);
+}
+
+
+void
+PackInput(AssetArchiveWriter& writer, JobSystem& jobs, const std::string& argument)
+{
+    size_t kindEnd = argument.find(':');
+    size_t nameEnd = argument.find('=', kindEnd == std::string::npos ? 0 : kindEnd);
+    if (kindEnd == std::string::npos || nameEnd == std::string::npos || nameEnd == kindEnd + 1)
+    {
+        throw std::runtime_error("[ ERROR ] Expected <kind>:<name>=<path>, got: " + argument);
+    }
+
+    std::string kind = argument.substr(0, kindEnd);
+    std::string name = argument.substr(kindEnd + 1, nameEnd - kindEnd - 1);
+    std::string path = argument.substr(nameEnd + 1);
+
+    if (kind == "raw")
+    {
+        std::vector<uint8_t> bytes = ReadBinaryFile(path);
+        writer.AddRaw(name, bytes.data(), bytes.size());
+    }
+    else if (kind == "spirv")
+    {
+        std::vector<uint8_t> bytes = ReadBinaryFile(path);
+        if (bytes.size() % sizeof(uint32_t) || bytes.size() < 5 * sizeof(uint32_t))
+        {
+            throw std::runtime_error("[ ERROR ] Not a SPIR-V module: " + path);
+        }
+
+        std::vector<uint32_t> words(bytes.size() / sizeof(uint32_t));
+        memcpy(words.data(), bytes.data(), bytes.size());
+        if (words[0] != 0x07230203)
+        {
+            throw std::runtime_error("[ ERROR ] Not a SPIR-V module: " + path);
+        }
+        writer.AddSpirv(name, ShaderStageFromPath(path), words);
+    }
+    else if (kind == "ktx2")
+    {
+        std::vector<uint8_t> bytes   = ReadBinaryFile(path);
+        Ktx2Texture          texture = ParseKtx2(bytes.data(), bytes.size());
+        if (texture.depth != 1 || texture.faceCount != 1)
+        {
+            throw std::runtime_error("[ ERROR ] Only 2D textures can be packed: " + path);
+        }
+
+        // KTX2 stores the layers of a level contiguously, which is also the archive order.
+        std::vector<std::vector<uint8_t>> subresources;
+        for (uint32_t level = 0; level < texture.levelCount; level++)
+        {
+            const uint8_t* levelData  = texture.LevelData(level);
+            size_t         layerBytes = static_cast<size_t>(texture.levels[level].byteLength / texture.layerCount);
+            for (uint32_t layer = 0; layer < texture.layerCount; layer++)
+            {
+                subresources.emplace_back(levelData + layer * layerBytes, levelData + (layer + 1) * layerBytes);
+            }
+        }
+
+        writer.AddTexture(name, static_cast<uint32_t>(texture.format), texture.width, texture.height,
+                          texture.levelCount, texture.layerCount, subresources);
+    }
+    else if (kind == "mesh" || kind == "qmesh")
+    {
+        ImportedMesh mesh = ImportMesh(path, jobs);
+        OptimizeMesh(mesh).Print(name);
+
+        if (kind == "mesh")
+        {
+            writer.AddMesh(name,
+                           mesh.vertices.data(), static_cast<uint32_t>(mesh.vertices.size()),
+                           static_cast<uint32_t>(sizeof(MeshVertex)), MESH_VERTEX_FORMAT_FLOAT32,
+                           mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()),
+                           static_cast<uint32_t>(sizeof(uint32_t)), ASSET_FLAG_MESH_OPTIMIZED);
+        }
+        else
+        {
+            QuantizedMesh quantized = QuantizeMesh(mesh);
+            quantized.report.Print(name);
+            writer.AddMesh(name,
+                           quantized.vertices.data(), static_cast<uint32_t>(quantized.vertices.size()),
+                           static_cast<uint32_t>(sizeof(QuantizedMeshVertex)), MESH_VERTEX_FORMAT_QUANTIZED,
+                           quantized.indices.data(), static_cast<uint32_t>(quantized.indices.size()),
+                           static_cast<uint32_t>(sizeof(uint32_t)), ASSET_FLAG_MESH_OPTIMIZED,
+                           &quantized.dequantization, sizeof(quantized.dequantization));
+        }
+    }
+    else
+    {
+        throw std::runtime_error("[ ERROR ] Unknown asset kind: " + kind);
+    }
+
+    std::cout << "[ INFO ] Packed " << kind << " [ " << name << " ] from " << path << std::endl;
+}
+
+
+int
+main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: AssetPacker <output.vkpa> <kind>:<name>=<path> ..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        AssetArchiveWriter writer;
+        JobSystem          jobs;
+        for (int ii = 2; ii < argc; ii++)
+        {
+            PackInput(writer, jobs, argv[ii]);
+        }
+        writer.Write(argv[1]);
+
+        // Round trip through the runtime reader so a bad archive never leaves the packer.
+        AssetArchive archive;
+        archive.Open(argv[1]);
+        std::cout << "[ INFO ] Wrote " << archive.EntryCount() << " assets to " << argv[1] << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
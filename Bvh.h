@@ -0,0 +1,752 @@
+#ifndef BVH_H
+#define BVH_H
+
+// Bounding volume hierarchy over axis aligned boxes, for scene queries that a linear scan
+// cannot afford: frustum culling, ray casts and picking.
+//
+// Build: binned SAH (BVH_BIN_COUNT bins per axis). Large nodes bin their primitives in
+// parallel, and once the top of the tree has produced enough independent subtrees those
+// are built in parallel as well.
+//
+// Layout: one flat array of 32 byte nodes. Siblings are stored next to each other and
+// every child comes after its parent, so a reverse walk over the array visits children
+// before parents (used by Refit()). Each subtree's primitives are contiguous in
+// PrimitiveOrder().
+//
+// Moving objects: UpdatePrimitive() refits from the object's leaf towards the root and
+// stops as soon as a node's bounds no longer change. Refitting keeps the topology, so
+// quality drops as objects drift; rebuild once queries get noticeably slower.
+//
+// Ray casts take a callback for the exact primitive test; RaycastTriangles() provides
+// one for triangle meshes on top of glm::intersectRayTriangle, and ScreenPointRay()
+// turns a cursor position into the ray used for picking.
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtx/intersect.hpp>
+
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+const uint32_t BVH_BIN_COUNT             = 16;
+const uint32_t BVH_MAX_LEAF_SIZE         = 4;
+const uint32_t BVH_PARALLEL_BINNING_SIZE = 64 * 1024; // Nodes at least this large bin in parallel
+const uint32_t BVH_INVALID               = 0xFFFFFFFF;
+
+
+struct BvhBounds
+{
+    glm::vec3 minimum;
+    glm::vec3 maximum;
+
+
+    static BvhBounds
+    Empty()
+    {
+        BvhBounds bounds;
+        bounds.minimum = glm::vec3(std::numeric_limits<float>::max());
+        bounds.maximum = glm::vec3(-std::numeric_limits<float>::max());
+        return bounds;
+    }
+
+
+    void
+    Grow(const BvhBounds& other)
+    {
+        minimum = glm::min(minimum, other.minimum);
+        maximum = glm::max(maximum, other.maximum);
+    }
+
+
+    void
+    Grow(const glm::vec3& point)
+    {
+        minimum = glm::min(minimum, point);
+        maximum = glm::max(maximum, point);
+    }
+
+
+    float
+    HalfArea() const
+    {
+        glm::vec3 size = glm::max(maximum - minimum, glm::vec3(0.0f));
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+};
+
+
+// Interior nodes: count == 0 and the children are offset and offset + 1.
+// Leaves: count primitives starting at PrimitiveOrder()[offset].
+struct BvhNode
+{
+    glm::vec3 minimum;
+    uint32_t  offset;
+    glm::vec3 maximum;
+    uint32_t  count;
+};
+static_assert(sizeof(BvhNode) == 32, "BvhNode should stay 32 bytes.");
+
+
+struct RayHit
+{
+    uint32_t  primitive   = BVH_INVALID;
+    float     distance    = 0.0f;
+    glm::vec2 barycentric = glm::vec2(0.0f); // Triangle hits only
+};
+
+
+class Bvh
+{
+public:
+    void
+    Build(JobSystem& jobs, const std::vector<BvhBounds>& primitiveBounds)
+    {
+        bounds = primitiveBounds;
+        nodes.clear();
+        order.resize(bounds.size());
+        centroids.resize(bounds.size());
+        for (size_t ii = 0; ii < bounds.size(); ii++)
+        {
+            order[ii]     = static_cast<uint32_t>(ii);
+            centroids[ii] = (bounds[ii].minimum + bounds[ii].maximum) * 0.5f;
+        }
+
+        if (!bounds.empty())
+        {
+            // Split the top serially until there are enough subtrees to keep every
+            // thread busy, then build those independently and splice them in.
+            subtreeSize = std::max<uint32_t>(static_cast<uint32_t>(bounds.size() / (jobs.ThreadCount() * 4)), 1024);
+            deferred.clear();
+            nodes.push_back(BvhNode());
+            BuildNode(jobs, nodes, 0, 0, static_cast<uint32_t>(bounds.size()), true);
+
+            std::vector<std::vector<BvhNode>> subtrees(deferred.size());
+            jobs.ParallelFor(deferred.size(), 1, [&](size_t begin, size_t end)
+            {
+                for (size_t ii = begin; ii < end; ii++)
+                {
+                    subtrees[ii].push_back(BvhNode());
+                    BuildNode(jobs, subtrees[ii], 0, deferred[ii].begin, deferred[ii].end, false);
+                }
+            });
+
+            for (size_t ii = 0; ii < deferred.size(); ii++)
+            {
+                Splice(deferred[ii].node, subtrees[ii]);
+            }
+            deferred.clear();
+        }
+
+        parents.assign(nodes.size(), BVH_INVALID);
+        primitiveLeaf.assign(bounds.size(), BVH_INVALID);
+        for (uint32_t node = 0; node < nodes.size(); node++)
+        {
+            const BvhNode& entry = nodes[node];
+            if (entry.count == 0)
+            {
+                parents[entry.offset]     = node;
+                parents[entry.offset + 1] = node;
+                continue;
+            }
+
+            for (uint32_t ii = 0; ii < entry.count; ii++)
+            {
+                primitiveLeaf[order[entry.offset + ii]] = node;
+            }
+        }
+    }
+
+
+    // Moves one primitive and refits its ancestors.
+    void
+    UpdatePrimitive(uint32_t primitive, const BvhBounds& primitiveBounds)
+    {
+        bounds[primitive] = primitiveBounds;
+
+        uint32_t node = primitiveLeaf[primitive];
+        while (node != BVH_INVALID)
+        {
+            BvhBounds refitted = NodeContentBounds(nodes[node]);
+            if (refitted.minimum == nodes[node].minimum && refitted.maximum == nodes[node].maximum) break;
+
+            nodes[node].minimum = refitted.minimum;
+            nodes[node].maximum = refitted.maximum;
+            node = parents[node];
+        }
+    }
+
+
+    // Refits every node, cheaper than many UpdatePrimitive() calls when most objects move.
+    void
+    Refit(const std::vector<BvhBounds>& primitiveBounds)
+    {
+        bounds = primitiveBounds;
+        for (size_t node = nodes.size(); node-- > 0;)
+        {
+            BvhBounds refitted = NodeContentBounds(nodes[node]);
+            nodes[node].minimum = refitted.minimum;
+            nodes[node].maximum = refitted.maximum;
+        }
+    }
+
+
+    // Appends every primitive whose box intersects the frustum to visible.
+    void
+    CullFrustum(const CullingFrustum& frustum, std::vector<uint32_t>& visible) const
+    {
+        if (nodes.empty()) return;
+
+        // Planes the node is already fully inside of are not tested again below it.
+        struct Entry
+        {
+            uint32_t node;
+            uint32_t planeMask;
+        };
+
+        std::vector<Entry> stack;
+        stack.reserve(64);
+        stack.push_back({ 0, 0x3F });
+        while (!stack.empty())
+        {
+            Entry entry = stack.back();
+            stack.pop_back();
+            const BvhNode& node = nodes[entry.node];
+
+            if (!BoxInFrustum(frustum, node.minimum, node.maximum, entry.planeMask)) continue;
+
+            if (node.count > 0)
+            {
+                for (uint32_t ii = 0; ii < node.count; ii++)
+                {
+                    uint32_t primitive = order[node.offset + ii];
+                    uint32_t planeMask = entry.planeMask;
+                    if (planeMask == 0 || BoxInFrustum(frustum, bounds[primitive].minimum, bounds[primitive].maximum,
+                                                       planeMask))
+                    {
+                        visible.push_back(primitive);
+                    }
+                }
+                continue;
+            }
+
+            stack.push_back({ node.offset + 1, entry.planeMask });
+            stack.push_back({ node.offset, entry.planeMask });
+        }
+    }
+
+
+    // Closest hit along origin + t * direction for t in [0, maxDistance]. intersect(primitive,
+    // distance) performs the exact test: it returns true and lowers distance when the
+    // primitive is hit closer than distance. Without a precise test, IntersectBounds() can
+    // be used to pick by box.
+    template<typename IntersectFunction>
+    RayHit
+    Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, IntersectFunction intersect) const
+    {
+        RayHit hit;
+        hit.distance = maxDistance;
+        if (nodes.empty()) return hit;
+
+        glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+        std::vector<uint32_t> stack;
+        stack.reserve(64);
+        if (RayBoxDistance(origin, inverseDirection, nodes[0].minimum, nodes[0].maximum) <= hit.distance)
+        {
+            stack.push_back(0);
+        }
+
+        while (!stack.empty())
+        {
+            const BvhNode& node = nodes[stack.back()];
+            stack.pop_back();
+            if (node.count > 0)
+            {
+                for (uint32_t ii = 0; ii < node.count; ii++)
+                {
+                    uint32_t primitive = order[node.offset + ii];
+                    float    distance  = hit.distance;
+                    if (intersect(primitive, distance) && distance <= hit.distance)
+                    {
+                        hit.primitive = primitive;
+                        hit.distance  = distance;
+                    }
+                }
+                continue;
+            }
+
+            // Push the farther child first so the nearer one is visited next.
+            uint32_t near  = node.offset;
+            uint32_t far   = node.offset + 1;
+            float    tNear = RayBoxDistance(origin, inverseDirection, nodes[near].minimum, nodes[near].maximum);
+            float    tFar  = RayBoxDistance(origin, inverseDirection, nodes[far].minimum, nodes[far].maximum);
+            if (tFar < tNear)
+            {
+                std::swap(near, far);
+                std::swap(tNear, tFar);
+            }
+
+            if (tFar <= hit.distance) stack.push_back(far);
+            if (tNear <= hit.distance) stack.push_back(near);
+        }
+        return hit;
+    }
+
+
+    // Box test usable as a Raycast() callback for picking by bounds.
+    bool
+    IntersectBounds(const glm::vec3& origin, const glm::vec3& direction, uint32_t primitive, float& distance) const
+    {
+        glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        float     boxDistance = RayBoxDistance(origin, inverseDirection, bounds[primitive].minimum,
+                                               bounds[primitive].maximum);
+        if (boxDistance > distance) return false;
+
+        distance = boxDistance;
+        return true;
+    }
+
+
+    const std::vector<BvhNode>&
+    Nodes() const
+    {
+        return nodes;
+    }
+
+
+    const std::vector<uint32_t>&
+    PrimitiveOrder() const
+    {
+        return order;
+    }
+
+
+private:
+    struct DeferredSubtree
+    {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+
+    struct Bin
+    {
+        BvhBounds bounds;
+        uint32_t  count;
+    };
+
+
+    // Tests the planes in planeMask and clears the ones the box is fully inside of.
+    static bool
+    BoxInFrustum(const CullingFrustum& frustum, const glm::vec3& minimum, const glm::vec3& maximum, uint32_t& planeMask)
+    {
+        glm::vec3 center = (minimum + maximum) * 0.5f;
+        glm::vec3 extent = (maximum - minimum) * 0.5f;
+        for (uint32_t plane = 0; plane < 6; plane++)
+        {
+            if ((planeMask & (1u << plane)) == 0) continue;
+
+            float distance = frustum.normalX[plane] * center.x + frustum.normalY[plane] * center.y +
+                             frustum.normalZ[plane] * center.z + frustum.distance[plane];
+            float reach    = frustum.absNormalX[plane] * extent.x + frustum.absNormalY[plane] * extent.y +
+                             frustum.absNormalZ[plane] * extent.z;
+            if (distance < -reach) return false;
+            if (distance >= reach) planeMask &= ~(1u << plane);
+        }
+        return true;
+    }
+
+
+    // Entry distance of the ray into the box, or +infinity when it misses. An axis the ray
+    // is parallel to has an infinite inverse, and an origin on the box's plane would turn
+    // its slab into 0 * inf = NaN, so such axes only test the origin against the slab.
+    static float
+    RayBoxDistance(const glm::vec3& origin, const glm::vec3& inverseDirection,
+                   const glm::vec3& minimum, const glm::vec3& maximum)
+    {
+        float enter = 0.0f;
+        float exit  = std::numeric_limits<float>::infinity();
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (std::isinf(inverseDirection[axis]))
+            {
+                bool outside = origin[axis] < minimum[axis] || origin[axis] > maximum[axis];
+                if (outside) return std::numeric_limits<float>::infinity();
+                continue;
+            }
+
+            float t0 = (minimum[axis] - origin[axis]) * inverseDirection[axis];
+            float t1 = (maximum[axis] - origin[axis]) * inverseDirection[axis];
+            enter = std::max(enter, std::min(t0, t1));
+            exit  = std::min(exit, std::max(t0, t1));
+        }
+        return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+    }
+
+
+    BvhBounds
+    NodeContentBounds(const BvhNode& node) const
+    {
+        BvhBounds result = BvhBounds::Empty();
+        if (node.count == 0)
+        {
+            const BvhNode& left  = nodes[node.offset];
+            const BvhNode& right = nodes[node.offset + 1];
+            result.minimum = glm::min(left.minimum, right.minimum);
+            result.maximum = glm::max(left.maximum, right.maximum);
+            return result;
+        }
+
+        for (uint32_t ii = 0; ii < node.count; ii++)
+        {
+            result.Grow(bounds[order[node.offset + ii]]);
+        }
+        return result;
+    }
+
+
+    // Fills target[nodeIndex] for primitives order[begin, end). When deferLarge is set,
+    // subtrees of at most subtreeSize primitives are queued instead of built.
+    void
+    BuildNode(JobSystem& jobs, std::vector<BvhNode>& target, uint32_t nodeIndex, uint32_t begin, uint32_t end,
+              bool deferLarge)
+    {
+        const uint32_t count = end - begin;
+
+        BvhBounds nodeBounds     = BvhBounds::Empty();
+        BvhBounds centroidBounds = BvhBounds::Empty();
+        Bin       bins[3][BVH_BIN_COUNT];
+        bool      binned         = false;
+
+        if (count >= BVH_PARALLEL_BINNING_SIZE)
+        {
+            ComputeBoundsParallel(jobs, begin, end, nodeBounds, centroidBounds);
+        }
+        else
+        {
+            for (uint32_t ii = begin; ii < end; ii++)
+            {
+                nodeBounds.Grow(bounds[order[ii]]);
+                centroidBounds.Grow(centroids[order[ii]]);
+            }
+        }
+
+        target[nodeIndex].minimum = nodeBounds.minimum;
+        target[nodeIndex].maximum = nodeBounds.maximum;
+        target[nodeIndex].offset  = begin;
+        target[nodeIndex].count   = count;
+
+        if (deferLarge && count <= subtreeSize)
+        {
+            DeferredSubtree subtree = { nodeIndex, begin, end };
+            deferred.push_back(subtree);
+            return;
+        }
+        if (count <= BVH_MAX_LEAF_SIZE) return;
+
+        glm::vec3 centroidExtent = centroidBounds.maximum - centroidBounds.minimum;
+        uint32_t  bestAxis       = 0;
+        uint32_t  bestSplit      = 0;
+        float     bestCost       = std::numeric_limits<float>::max();
+
+        if (std::max(centroidExtent.x, std::max(centroidExtent.y, centroidExtent.z)) > 0.0f)
+        {
+            if (count >= BVH_PARALLEL_BINNING_SIZE)
+            {
+                FillBinsParallel(jobs, begin, end, centroidBounds, bins);
+            }
+            else
+            {
+                FillBins(begin, end, centroidBounds, bins);
+            }
+            binned = true;
+
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                if (centroidExtent[axis] <= 0.0f) continue;
+
+                // Sweep from the right to get suffix costs, then evaluate every plane.
+                float     rightCost[BVH_BIN_COUNT] = {};
+                BvhBounds rightBounds              = BvhBounds::Empty();
+                uint32_t  rightCount               = 0;
+                for (uint32_t bin = BVH_BIN_COUNT - 1; bin > 0; bin--)
+                {
+                    rightBounds.Grow(bins[axis][bin].bounds);
+                    rightCount     += bins[axis][bin].count;
+                    rightCost[bin]  = rightCount ? rightBounds.HalfArea() * static_cast<float>(rightCount) : 0.0f;
+                }
+
+                BvhBounds leftBounds = BvhBounds::Empty();
+                uint32_t  leftCount  = 0;
+                for (uint32_t split = 1; split < BVH_BIN_COUNT; split++)
+                {
+                    leftBounds.Grow(bins[axis][split - 1].bounds);
+                    leftCount += bins[axis][split - 1].count;
+                    if (leftCount == 0 || leftCount == count) continue;
+
+                    float cost = leftBounds.HalfArea() * static_cast<float>(leftCount) + rightCost[split];
+                    if (cost < bestCost)
+                    {
+                        bestCost  = cost;
+                        bestAxis  = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+        }
+
+        uint32_t middle = begin + count / 2;
+        if (binned && bestSplit != 0)
+        {
+            // Leaf cost is count intersections; a split costs one extra traversal step.
+            float leafCost = nodeBounds.HalfArea() * static_cast<float>(count);
+            if (bestCost + nodeBounds.HalfArea() >= leafCost && count <= 4 * BVH_MAX_LEAF_SIZE) return;
+
+            float minimum = centroidBounds.minimum[bestAxis];
+            float scale   = static_cast<float>(BVH_BIN_COUNT) / centroidExtent[bestAxis];
+            middle = static_cast<uint32_t>(std::partition(order.begin() + begin, order.begin() + end, [&](uint32_t primitive)
+            {
+                return BinIndex(centroids[primitive][bestAxis], minimum, scale) < bestSplit;
+            }) - order.begin());
+        }
+        // else: coincident centroids, split the range in half.
+
+        uint32_t children = static_cast<uint32_t>(target.size());
+        target.push_back(BvhNode());
+        target.push_back(BvhNode());
+        target[nodeIndex].offset = children;
+        target[nodeIndex].count  = 0;
+
+        BuildNode(jobs, target, children, begin, middle, deferLarge);
+        BuildNode(jobs, target, children + 1, middle, end, deferLarge);
+    }
+
+
+    static uint32_t
+    BinIndex(float centroid, float minimum, float scale)
+    {
+        uint32_t bin = static_cast<uint32_t>(std::max((centroid - minimum) * scale, 0.0f));
+        return std::min(bin, BVH_BIN_COUNT - 1);
+    }
+
+
+    void
+    FillBins(uint32_t begin, uint32_t end, const BvhBounds& centroidBounds, Bin bins[3][BVH_BIN_COUNT]) const
+    {
+        glm::vec3 extent = centroidBounds.maximum - centroidBounds.minimum;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            for (uint32_t bin = 0; bin < BVH_BIN_COUNT; bin++)
+            {
+                bins[axis][bin].bounds = BvhBounds::Empty();
+                bins[axis][bin].count  = 0;
+            }
+        }
+
+        for (uint32_t ii = begin; ii < end; ii++)
+        {
+            uint32_t primitive = order[ii];
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                if (extent[axis] <= 0.0f) continue;
+
+                float scale = static_cast<float>(BVH_BIN_COUNT) / extent[axis];
+                Bin&  bin   = bins[axis][BinIndex(centroids[primitive][axis], centroidBounds.minimum[axis], scale)];
+                bin.bounds.Grow(bounds[primitive]);
+                bin.count++;
+            }
+        }
+    }
+
+
+    void
+    FillBinsParallel(JobSystem& jobs, uint32_t begin, uint32_t end, const BvhBounds& centroidBounds,
+                     Bin bins[3][BVH_BIN_COUNT]) const
+    {
+        FillBins(begin, begin, centroidBounds, bins);
+
+        std::mutex mergeMutex;
+        size_t     ranges = jobs.RangeCount(end - begin, BVH_PARALLEL_BINNING_SIZE / 4);
+        jobs.ParallelFor(ranges, 1, [&](size_t rangeBegin, size_t rangeEnd)
+        {
+            for (size_t range = rangeBegin; range < rangeEnd; range++)
+            {
+                Bin partial[3][BVH_BIN_COUNT];
+                FillBins(static_cast<uint32_t>(begin + (end - begin) * range / ranges),
+                         static_cast<uint32_t>(begin + (end - begin) * (range + 1) / ranges), centroidBounds, partial);
+
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    for (uint32_t bin = 0; bin < BVH_BIN_COUNT; bin++)
+                    {
+                        bins[axis][bin].bounds.Grow(partial[axis][bin].bounds);
+                        bins[axis][bin].count += partial[axis][bin].count;
+                    }
+                }
+            }
+        });
+    }
+
+
+    void
+    ComputeBoundsParallel(JobSystem& jobs, uint32_t begin, uint32_t end, BvhBounds& nodeBounds,
+                          BvhBounds& centroidBounds) const
+    {
+        std::mutex mergeMutex;
+        size_t     ranges = jobs.RangeCount(end - begin, BVH_PARALLEL_BINNING_SIZE / 4);
+        jobs.ParallelFor(ranges, 1, [&](size_t rangeBegin, size_t rangeEnd)
+        {
+            for (size_t range = rangeBegin; range < rangeEnd; range++)
+            {
+                BvhBounds partialBounds   = BvhBounds::Empty();
+                BvhBounds partialCentroid = BvhBounds::Empty();
+                size_t    first           = begin + (end - begin) * range / ranges;
+                size_t    last            = begin + (end - begin) * (range + 1) / ranges;
+                for (size_t ii = first; ii < last; ii++)
+                {
+                    partialBounds.Grow(bounds[order[ii]]);
+                    partialCentroid.Grow(centroids[order[ii]]);
+                }
+
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                nodeBounds.Grow(partialBounds);
+                centroidBounds.Grow(partialCentroid);
+            }
+        });
+    }
+
+
+    // Replaces the placeholder at node with the subtree's root and appends the rest.
+    void
+    Splice(uint32_t node, const std::vector<BvhNode>& subtree)
+    {
+        uint32_t base = static_cast<uint32_t>(nodes.size());
+        for (size_t ii = 0; ii < subtree.size(); ii++)
+        {
+            BvhNode entry = subtree[ii];
+            if (entry.count == 0) entry.offset = base + entry.offset - 1;
+
+            if (ii == 0) nodes[node] = entry;
+            else nodes.push_back(entry);
+        }
+    }
+
+    std::vector<BvhNode>         nodes;
+    std::vector<BvhBounds>       bounds;
+    std::vector<glm::vec3>       centroids;
+    std::vector<uint32_t>        order;
+    std::vector<uint32_t>        parents;
+    std::vector<uint32_t>        primitiveLeaf;
+    std::vector<DeferredSubtree> deferred;
+    uint32_t                     subtreeSize = 0;
+};
+
+
+// Triangle list positions for RaycastTriangles(); stride is in bytes, so MeshVertex
+// arrays can be used in place.
+struct BvhTriangleMesh
+{
+    const uint8_t*  positions;
+    size_t          stride;
+    const uint32_t* indices;
+    size_t          triangleCount;
+
+
+    glm::vec3
+    Position(uint32_t corner) const
+    {
+        const float* position = reinterpret_cast<const float*>(positions + indices[corner] * stride);
+        return glm::vec3(position[0], position[1], position[2]);
+    }
+};
+
+
+inline Bvh
+BuildTriangleBvh(JobSystem& jobs, const BvhTriangleMesh& mesh)
+{
+    std::vector<BvhBounds> triangleBounds(mesh.triangleCount);
+    jobs.ParallelFor(mesh.triangleCount, 4096, [&](size_t begin, size_t end)
+    {
+        for (size_t triangle = begin; triangle < end; triangle++)
+        {
+            BvhBounds& box = triangleBounds[triangle];
+            box = BvhBounds::Empty();
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                box.Grow(mesh.Position(static_cast<uint32_t>(triangle * 3 + corner)));
+            }
+        }
+    });
+
+    Bvh bvh;
+    bvh.Build(jobs, triangleBounds);
+    return bvh;
+}
+
+
+// Closest triangle hit; primitive is the triangle index. Both faces are hit.
+inline RayHit
+RaycastTriangles(const Bvh&             bvh,
+                 const BvhTriangleMesh& mesh,
+                 const glm::vec3&       origin,
+                 const glm::vec3&       direction,
+                 float                  maxDistance = std::numeric_limits<float>::max())
+{
+    glm::vec2 closestBarycentric(0.0f);
+    RayHit    hit = bvh.Raycast(origin, direction, maxDistance, [&](uint32_t triangle, float& distance)
+    {
+        glm::vec2 barycentric;
+        float     triangleDistance = 0.0f;
+        if (!glm::intersectRayTriangle(origin, direction, mesh.Position(triangle * 3), mesh.Position(triangle * 3 + 1),
+                                       mesh.Position(triangle * 3 + 2), barycentric, triangleDistance) ||
+            triangleDistance < 0.0f || triangleDistance > distance)
+        {
+            return false;
+        }
+
+        distance           = triangleDistance;
+        closestBarycentric = barycentric;
+        return true;
+    });
+
+    hit.barycentric = closestBarycentric;
+    return hit;
+}
+
+
+// World space picking ray through a cursor position in pixels (origin top left).
+// projection is the one used for rendering, including any Vulkan Y flip, with a zero to
+// one depth range. direction is normalized; origin lies on the near plane.
+inline void
+ScreenPointRay(float            cursorX,
+               float            cursorY,
+               float            viewportWidth,
+               float            viewportHeight,
+               const glm::mat4& view,
+               const glm::mat4& projection,
+               glm::vec3&       origin,
+               glm::vec3&       direction)
+{
+    glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+    glm::vec2 ndc(2.0f * cursorX / viewportWidth - 1.0f, 2.0f * cursorY / viewportHeight - 1.0f);
+
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, 0.0f, 1.0f);
+    glm::vec4 farPoint  = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+    origin    = glm::vec3(nearPoint) / nearPoint.w;
+    direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
+#endif // BVH_H
@@ -0,0 +1,507 @@
+#ifndef CLUSTER_CULLING_H
+#define CLUSTER_CULLING_H
+
+// GPU meshlet culling. A compute pre-pass tests every meshlet of a mesh against the view
+// frustum, its normal cone and the previous depth pyramid, and writes one
+// VkDrawIndexedIndirectCommand per surviving meshlet. Draw() then consumes them with a
+// single vkCmdDrawIndexedIndirectCountKHR, so vertex work follows visible geometry only.
+//
+// Without VK_KHR_draw_indirect_count every meshlet keeps its slot and culled ones are
+// written with instanceCount 0, which costs a little command processor time per meshlet
+// but needs no readback either.
+//
+// The model matrix passed to Cull() must be a rotation, translation and uniform scale;
+// meshlet spheres and cones are transformed on the GPU.
+
+#include <vulkan/vulkan.h>
+
+#include <glm/mat4x4.hpp>
+
+#include "GpuCulling.h"
+#include "Meshlets.h"
+#include "ShaderCompiler.h"
+#include "VulkanUtilities.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+
+// std430 mirror of Meshlet in CLUSTER_CULLING_GLSL.
+struct GpuMeshlet
+{
+    glm::vec4 sphere;
+    glm::vec4 coneApex;
+    glm::vec4 coneAxis;
+    uint32_t  firstIndex;
+    uint32_t  indexCount;
+    uint32_t  padding[2];
+};
+static_assert(sizeof(GpuMeshlet) == 64, "GpuMeshlet must match its std430 layout.");
+
+
+// Draw buffer layout: a 16 byte header holding the draw count, then the commands.
+const VkDeviceSize CLUSTER_CULLING_COMMANDS_OFFSET = 16;
+
+
+const char* const CLUSTER_CULLING_GLSL = R"GLSL(
+layout(local_size_x = 64) in;
+
+layout(set = 0, binding = 0) uniform CullingViewBlock
+{
+    CullingView cullingView;
+};
+
+struct Meshlet
+{
+    vec4 sphere;
+    vec4 coneApex;
+    vec4 coneAxis;
+    uint firstIndex;
+    uint indexCount;
+    uint padding0;
+    uint padding1;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Meshlets
+{
+    Meshlet meshlets[];
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 2) buffer Draws
+{
+    uint        drawCount;
+    uint        headerPadding[3];
+    DrawCommand draws[];
+};
+
+layout(set = 0, binding = 3) uniform sampler2D depthPyramid;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4  model;
+    uint  meshletCount;
+    float scale;
+    uint  firstInstance;
+} pc;
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= pc.meshletCount)
+    {
+        return;
+    }
+
+    Meshlet meshlet = meshlets[id];
+    vec3    center  = (pc.model * vec4(meshlet.sphere.xyz, 1.0)).xyz;
+    float   radius  = meshlet.sphere.w * pc.scale;
+
+    bool visible = SphereInFrustum(cullingView, center, radius);
+    if (visible && meshlet.coneApex.w < 1.0)
+    {
+        vec3 apex = (pc.model * vec4(meshlet.coneApex.xyz, 1.0)).xyz;
+        vec3 axis = normalize(mat3(pc.model) * meshlet.coneAxis.xyz);
+        visible   = !ConeBackfacing(cullingView, apex, axis, meshlet.coneApex.w);
+    }
+    if (visible)
+    {
+        visible = !SphereOccluded(cullingView, depthPyramid, center, radius);
+    }
+
+#ifdef COMPACT_DRAWS
+    if (visible)
+    {
+        uint slot = atomicAdd(drawCount, 1);
+        draws[slot] = DrawCommand(meshlet.indexCount, 1, meshlet.firstIndex, 0, pc.firstInstance);
+    }
+#else
+    draws[id] = DrawCommand(meshlet.indexCount, visible ? 1 : 0, meshlet.firstIndex, 0, pc.firstInstance);
+#endif
+}
+)GLSL";
+
+
+class ClusterCuller
+{
+public:
+    // drawIndirectCount: VK_KHR_draw_indirect_count was enabled on the device.
+    // multiDrawIndirect: the multiDrawIndirect feature was enabled (fallback path only).
+    void
+    Create(VkPhysicalDevice gpu,
+           VkDevice         logicalDevice,
+           uint32_t         framesInFlight,
+           bool             drawIndirectCount,
+           bool             multiDrawIndirect)
+    {
+        physicalDevice      = gpu;
+        device              = logicalDevice;
+        multiDrawSupported  = multiDrawIndirect;
+        if (drawIndirectCount)
+        {
+            drawIndexedIndirectCount = LoadDeviceFunction<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                device, "vkCmdDrawIndexedIndirectCountKHR");
+        }
+
+        VkDescriptorSetLayoutBinding bindings[4] = {};
+        const VkDescriptorType types[4] =
+        {
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+        };
+        for (uint32_t ii = 0; ii < 4; ii++)
+        {
+            bindings[ii].binding         = ii;
+            bindings[ii].descriptorType  = types[ii];
+            bindings[ii].descriptorCount = 1;
+            bindings[ii].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 4;
+        layoutInfo.pBindings    = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create cluster culling descriptor set layout.");
+        }
+
+        VkPushConstantRange pushRange = {};
+        pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushRange.size       = sizeof(glm::mat4) + 4 * sizeof(uint32_t);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = 1;
+        pipelineLayoutInfo.pSetLayouts            = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create cluster culling pipeline layout.");
+        }
+
+        ShaderDefines defines;
+        if (drawIndexedIndirectCount) defines.push_back({ "COMPACT_DRAWS", "1" });
+        pipeline = CreateComputePipeline(device, pipelineLayout,
+                                         std::string("#version 450\n") + GPU_CULLING_GLSL + CLUSTER_CULLING_GLSL,
+                                         "ClusterCulling.comp", defines);
+
+        VkDescriptorPoolSize poolSizes[3] = {};
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSizes[0].descriptorCount = framesInFlight;
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = 2 * framesInFlight;
+        poolSizes[2].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[2].descriptorCount = framesInFlight;
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = framesInFlight;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes    = poolSizes;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create cluster culling descriptor pool.");
+        }
+
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod       = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create cluster culling sampler.");
+        }
+
+        frames.resize(framesInFlight);
+        for (auto& frame : frames)
+        {
+            CreateBuffer(physicalDevice, device, sizeof(GpuCullingView), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         frame.viewBuffer, frame.viewMemory);
+            if (vkMapMemory(device, frame.viewMemory, 0, sizeof(GpuCullingView), 0, &frame.viewMapped) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to map cluster culling view buffer.");
+            }
+
+            VkDescriptorSetAllocateInfo allocateInfo = {};
+            allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocateInfo.descriptorPool     = descriptorPool;
+            allocateInfo.descriptorSetCount = 1;
+            allocateInfo.pSetLayouts        = &setLayout;
+            if (vkAllocateDescriptorSets(device, &allocateInfo, &frame.descriptorSet) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to allocate cluster culling descriptor set.");
+            }
+        }
+    }
+
+
+    void
+    Destroy()
+    {
+        for (auto& frame : frames)
+        {
+            if (frame.drawBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, frame.drawBuffer, nullptr);
+            if (frame.drawMemory != VK_NULL_HANDLE) vkFreeMemory(device, frame.drawMemory, nullptr);
+            vkDestroyBuffer(device, frame.viewBuffer, nullptr);
+            vkFreeMemory(device, frame.viewMemory, nullptr);
+        }
+        frames.clear();
+
+        ReleaseStaging();
+        if (meshletBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, meshletBuffer, nullptr);
+        if (meshletMemory != VK_NULL_HANDLE) vkFreeMemory(device, meshletMemory, nullptr);
+        if (indexBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, indexBuffer, nullptr);
+        if (indexMemory != VK_NULL_HANDLE) vkFreeMemory(device, indexMemory, nullptr);
+        if (dummyPyramidView != VK_NULL_HANDLE) vkDestroyImageView(device, dummyPyramidView, nullptr);
+        if (dummyPyramid != VK_NULL_HANDLE) vkDestroyImage(device, dummyPyramid, nullptr);
+        if (dummyPyramidMemory != VK_NULL_HANDLE) vkFreeMemory(device, dummyPyramidMemory, nullptr);
+        if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline, nullptr);
+        if (sampler != VK_NULL_HANDLE) vkDestroySampler(device, sampler, nullptr);
+        if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        meshletBuffer      = VK_NULL_HANDLE;
+        meshletMemory      = VK_NULL_HANDLE;
+        indexBuffer        = VK_NULL_HANDLE;
+        indexMemory        = VK_NULL_HANDLE;
+        dummyPyramidView   = VK_NULL_HANDLE;
+        dummyPyramid       = VK_NULL_HANDLE;
+        dummyPyramidMemory = VK_NULL_HANDLE;
+        pipeline           = VK_NULL_HANDLE;
+        sampler            = VK_NULL_HANDLE;
+        descriptorPool     = VK_NULL_HANDLE;
+        pipelineLayout     = VK_NULL_HANDLE;
+        setLayout          = VK_NULL_HANDLE;
+    }
+
+
+    // Records the upload of the meshlet table and the meshlet ordered index buffer. Call
+    // ReleaseStaging() once the command buffer has completed.
+    void
+    Upload(VkCommandBuffer commandBuffer, const MeshletMesh& mesh)
+    {
+        if (meshletBuffer != VK_NULL_HANDLE || mesh.meshlets.empty())
+        {
+            throw std::runtime_error("[ ERROR ] ClusterCuller::Upload() expects one non-empty mesh.");
+        }
+
+        meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+        std::vector<GpuMeshlet> gpuMeshlets(meshletCount);
+        for (uint32_t ii = 0; ii < meshletCount; ii++)
+        {
+            gpuMeshlets[ii].sphere     = mesh.bounds[ii].sphere;
+            gpuMeshlets[ii].coneApex   = mesh.bounds[ii].coneApex;
+            gpuMeshlets[ii].coneAxis   = mesh.bounds[ii].coneAxis;
+            gpuMeshlets[ii].firstIndex = mesh.meshlets[ii].triangleOffset * 3;
+            gpuMeshlets[ii].indexCount = mesh.meshlets[ii].triangleCount * 3;
+        }
+
+        staging.resize(2);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, gpuMeshlets.data(),
+                           gpuMeshlets.size() * sizeof(GpuMeshlet), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           meshletBuffer, meshletMemory, staging[0]);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, mesh.indices.data(),
+                           mesh.indices.size() * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                           indexBuffer, indexMemory, staging[1]);
+        BufferBarrier(commandBuffer, meshletBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        BufferBarrier(commandBuffer, indexBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_INDEX_READ_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+
+        // Per frame draw buffers: header + one command slot per meshlet.
+        VkDeviceSize drawBufferSize = CLUSTER_CULLING_COMMANDS_OFFSET +
+            static_cast<VkDeviceSize>(meshletCount) * sizeof(VkDrawIndexedIndirectCommand);
+        for (auto& frame : frames)
+        {
+            CreateBuffer(physicalDevice, device, drawBufferSize,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.drawBuffer, frame.drawMemory);
+        }
+
+        RecordDummyDepthPyramid(physicalDevice, device, commandBuffer, dummyPyramid, dummyPyramidMemory,
+                                dummyPyramidView);
+    }
+
+
+    void
+    ReleaseStaging()
+    {
+        for (auto& buffer : staging)
+        {
+            buffer.Destroy(device);
+        }
+        staging.clear();
+    }
+
+
+    // Records the culling dispatch for frameIndex. The fence of frameIndex must have been
+    // waited on. depthPyramid is a VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL view of the
+    // previous frame's pyramid, or VK_NULL_HANDLE (view.pyramid.w must then be 0).
+    void
+    Cull(VkCommandBuffer       commandBuffer,
+         uint32_t              frameIndex,
+         const GpuCullingView& view,
+         const glm::mat4&      model,
+         float                 modelScale,
+         uint32_t              firstInstance,
+         VkImageView           depthPyramid)
+    {
+        Frame& frame = frames[frameIndex];
+        memcpy(frame.viewMapped, &view, sizeof(view));
+
+        VkImageView pyramidView = depthPyramid != VK_NULL_HANDLE ? depthPyramid : dummyPyramidView;
+        if (pyramidView != frame.boundPyramid)
+        {
+            WriteDescriptors(frame, pyramidView);
+        }
+
+        vkCmdFillBuffer(commandBuffer, frame.drawBuffer, 0, CLUSTER_CULLING_COMMANDS_OFFSET, 0);
+        BufferBarrier(commandBuffer, frame.drawBuffer,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        struct PushConstants
+        {
+            glm::mat4 model;
+            uint32_t  meshletCount;
+            float     scale;
+            uint32_t  firstInstance;
+            uint32_t  padding;
+        } pushConstants = { model, meshletCount, modelScale, firstInstance, 0 };
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                                0, 1, &frame.descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(pushConstants), &pushConstants);
+        vkCmdDispatch(commandBuffer, (meshletCount + 63) / 64, 1, 1);
+
+        BufferBarrier(commandBuffer, frame.drawBuffer,
+                      VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    }
+
+
+    // Inside a render pass with the graphics pipeline and vertex buffer bound.
+    void
+    Draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) const
+    {
+        const Frame& frame  = frames[frameIndex];
+        const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+        if (drawIndexedIndirectCount)
+        {
+            drawIndexedIndirectCount(commandBuffer, frame.drawBuffer, CLUSTER_CULLING_COMMANDS_OFFSET,
+                                     frame.drawBuffer, 0, meshletCount, stride);
+        }
+        else if (multiDrawSupported)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer, CLUSTER_CULLING_COMMANDS_OFFSET,
+                                     meshletCount, stride);
+        }
+        else
+        {
+            for (uint32_t ii = 0; ii < meshletCount; ii++)
+            {
+                vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer,
+                                         CLUSTER_CULLING_COMMANDS_OFFSET + ii * stride, 1, stride);
+            }
+        }
+    }
+
+
+    uint32_t
+    MeshletCount() const
+    {
+        return meshletCount;
+    }
+
+
+private:
+    struct Frame
+    {
+        VkBuffer        viewBuffer    = VK_NULL_HANDLE;
+        VkDeviceMemory  viewMemory    = VK_NULL_HANDLE;
+        void*           viewMapped    = nullptr;
+        VkBuffer        drawBuffer    = VK_NULL_HANDLE;
+        VkDeviceMemory  drawMemory    = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkImageView     boundPyramid  = VK_NULL_HANDLE;
+    };
+
+
+    void
+    WriteDescriptors(Frame& frame, VkImageView pyramidView)
+    {
+        VkDescriptorBufferInfo viewInfo    = { frame.viewBuffer, 0, sizeof(GpuCullingView) };
+        VkDescriptorBufferInfo meshletInfo = { meshletBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo drawInfo    = { frame.drawBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorImageInfo  pyramidInfo = { sampler, pyramidView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+        VkWriteDescriptorSet writes[4] = {};
+        for (uint32_t ii = 0; ii < 4; ii++)
+        {
+            writes[ii].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[ii].dstSet          = frame.descriptorSet;
+            writes[ii].dstBinding      = ii;
+            writes[ii].descriptorCount = 1;
+        }
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[0].pBufferInfo    = &viewInfo;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[1].pBufferInfo    = &meshletInfo;
+        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[2].pBufferInfo    = &drawInfo;
+        writes[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[3].pImageInfo     = &pyramidInfo;
+        vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+
+        frame.boundPyramid = pyramidView;
+    }
+
+    VkPhysicalDevice                    physicalDevice           = VK_NULL_HANDLE;
+    VkDevice                            device                   = VK_NULL_HANDLE;
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+    bool                                multiDrawSupported       = false;
+    VkDescriptorSetLayout               setLayout                = VK_NULL_HANDLE;
+    VkPipelineLayout                    pipelineLayout           = VK_NULL_HANDLE;
+    VkPipeline                          pipeline                 = VK_NULL_HANDLE;
+    VkDescriptorPool                    descriptorPool           = VK_NULL_HANDLE;
+    VkSampler                           sampler                  = VK_NULL_HANDLE;
+    VkBuffer                            meshletBuffer            = VK_NULL_HANDLE;
+    VkDeviceMemory                      meshletMemory            = VK_NULL_HANDLE;
+    VkBuffer                            indexBuffer              = VK_NULL_HANDLE;
+    VkDeviceMemory                      indexMemory              = VK_NULL_HANDLE;
+    VkImage                             dummyPyramid             = VK_NULL_HANDLE;
+    VkDeviceMemory                      dummyPyramidMemory       = VK_NULL_HANDLE;
+    VkImageView                         dummyPyramidView         = VK_NULL_HANDLE;
+    uint32_t                            meshletCount             = 0;
+    std::vector<Frame>                  frames;
+    std::vector<StagingBuffer>          staging;
+};
+
+#endif // CLUSTER_CULLING_H
@@ -0,0 +1,440 @@
+#ifndef DEPTH_PYRAMID_H
+#define DEPTH_PYRAMID_H
+
+// Hierarchical Z pyramid for the occlusion tests in GPU_CULLING_GLSL.
+//
+// Level 0 is the depth buffer's size rounded down to powers of two, so every level is
+// exactly half of the previous one and a texel of any level covers a fixed rectangle of
+// the screen. Each texel holds the farthest depth of its footprint (max reduction, 1.0 =
+// far plane); a level 0 texel reads the 1 to 3 depth texels per axis under it.
+//
+// The pyramid is built by one dispatch of MipGenerator's DOWNSAMPLE_GLSL with a max
+// reduction.
+//
+// Built from the current frame's depth, the pyramid drives two phase occlusion culling
+// (GpuScene::Cull()):
+//   1. Early phase: instances that were visible last frame are culled against the
+//      frustum only and drawn. Their depth is a good occluder set for this frame.
+//   2. Build() the pyramid from that depth.
+//   3. Late phase: every instance is tested against the new pyramid; the visible ones
+//      not drawn in the early phase are drawn, and visibility is recorded for the next
+//      frame.
+// Nothing is culled by last frame's depth, so disoccluded objects appear in the frame
+// they become visible instead of one frame late.
+
+#include <vulkan/vulkan.h>
+
+#include "MipGenerator.h"
+#include "ShaderCompiler.h"
+#include "VulkanUtilities.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+
+const uint32_t DEPTH_PYRAMID_MAX_LEVELS    = 13;
+const uint32_t DEPTH_PYRAMID_MAX_DIMENSION = 4096; // Of level 0
+
+
+// Follows DOWNSAMPLE_GLSL, compiled with DOWNSAMPLE_MAX.
+const char* const DEPTH_PYRAMID_GLSL = R"GLSL(
+layout(set = 0, binding = 0) uniform sampler2D depthBuffer;
+layout(set = 0, binding = 1, r32f) uniform coherent image2D pyramidLevels[13];
+
+layout(push_constant) uniform PushConstants
+{
+    ivec2 depthSize;
+    ivec2 size;
+    uint  levelCount;
+    uint  workgroupCount;
+} pc;
+
+ivec2 LevelSize(uint level)
+{
+    return max(pc.size >> int(level), ivec2(1));
+}
+
+// Unlike MipGenerator, level 0 is written here too.
+void Store(uint level, ivec2 texel, float value)
+{
+    if (level >= pc.levelCount || any(greaterThanEqual(texel, LevelSize(level))))
+    {
+        return;
+    }
+
+    vec4 texelValue = vec4(value);
+    switch (level)
+    {
+        case 0:  imageStore(pyramidLevels[0], texel, texelValue);  break;
+        case 1:  imageStore(pyramidLevels[1], texel, texelValue);  break;
+        case 2:  imageStore(pyramidLevels[2], texel, texelValue);  break;
+        case 3:  imageStore(pyramidLevels[3], texel, texelValue);  break;
+        case 4:  imageStore(pyramidLevels[4], texel, texelValue);  break;
+        case 5:  imageStore(pyramidLevels[5], texel, texelValue);  break;
+        case 6:  imageStore(pyramidLevels[6], texel, texelValue);  break;
+        case 7:  imageStore(pyramidLevels[7], texel, texelValue);  break;
+        case 8:  imageStore(pyramidLevels[8], texel, texelValue);  break;
+        case 9:  imageStore(pyramidLevels[9], texel, texelValue);  break;
+        case 10: imageStore(pyramidLevels[10], texel, texelValue); break;
+        case 11: imageStore(pyramidLevels[11], texel, texelValue); break;
+        case 12: imageStore(pyramidLevels[12], texel, texelValue); break;
+    }
+}
+
+// Farthest depth under a level 0 texel. Level 0 is at most 2x smaller than the depth
+// buffer per axis, so the footprint spans 1 to 3 depth texels per axis.
+float DepthFootprint(ivec2 texel)
+{
+    ivec2 first    = texel * pc.depthSize / pc.size;
+    ivec2 last     = min(((texel + 1) * pc.depthSize + pc.size - 1) / pc.size, pc.depthSize) - 1;
+    float farthest = 0.0;
+    for (int yy = 0; yy < 3; yy++)
+    {
+        for (int xx = 0; xx < 3; xx++)
+        {
+            farthest = max(farthest, texelFetch(depthBuffer, min(first + ivec2(xx, yy), last), 0).r);
+        }
+    }
+    return farthest;
+}
+
+// Level 0 is computed from the depth buffer and stored on the way. Clamped reads only
+// repeat edge texels, which a max reduction ignores.
+float Load(uint level, ivec2 texel)
+{
+    ivec2 clamped = min(texel, LevelSize(level) - 1);
+    if (level == 0)
+    {
+        float value = DepthFootprint(clamped);
+        Store(0, texel, value);
+        return value;
+    }
+    return imageLoad(pyramidLevels[6], clamped).r;
+}
+
+void main()
+{
+    Downsample(pc.levelCount > 7, pc.workgroupCount);
+}
+)GLSL";
+
+
+class DepthPyramid
+{
+public:
+    void
+    Create(VkPhysicalDevice gpu, VkDevice logicalDevice)
+    {
+        physicalDevice = gpu;
+        device         = logicalDevice;
+
+        VkDescriptorSetLayoutBinding bindings[3] = {};
+        bindings[0].binding         = 0;
+        bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].binding         = 1;
+        bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount = DEPTH_PYRAMID_MAX_LEVELS;
+        bindings[1].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[2].binding         = 2;
+        bindings[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 3;
+        layoutInfo.pBindings    = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create depth pyramid descriptor set layout.");
+        }
+
+        VkPushConstantRange pushRange = {};
+        pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushRange.size       = 6 * sizeof(uint32_t);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = 1;
+        pipelineLayoutInfo.pSetLayouts            = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create depth pyramid pipeline layout.");
+        }
+
+        pipeline = CreateComputePipeline(device, pipelineLayout,
+                                         std::string("#version 450\n") + DOWNSAMPLE_GLSL + DEPTH_PYRAMID_GLSL,
+                                         "DepthPyramid.comp",
+                                         { { "DOWNSAMPLE_TYPE", "float" }, { "DOWNSAMPLE_MAX", "1" } });
+
+        VkDescriptorPoolSize poolSizes[3] = {};
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = 1;
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[1].descriptorCount = DEPTH_PYRAMID_MAX_LEVELS;
+        poolSizes[2].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[2].descriptorCount = 1;
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = 1;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes    = poolSizes;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create depth pyramid descriptor pool.");
+        }
+
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool     = descriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts        = &setLayout;
+        if (vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to allocate depth pyramid descriptor set.");
+        }
+
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &depthSampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create depth pyramid sampler.");
+        }
+
+        CreateBuffer(physicalDevice, device, sizeof(uint32_t),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, counterBuffer, counterMemory);
+    }
+
+
+    void
+    Destroy()
+    {
+        DestroyImage();
+        if (counterBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, counterBuffer, nullptr);
+        if (counterMemory != VK_NULL_HANDLE) vkFreeMemory(device, counterMemory, nullptr);
+        if (depthSampler != VK_NULL_HANDLE) vkDestroySampler(device, depthSampler, nullptr);
+        if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        counterBuffer  = VK_NULL_HANDLE;
+        counterMemory  = VK_NULL_HANDLE;
+        depthSampler   = VK_NULL_HANDLE;
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet  = VK_NULL_HANDLE;
+        pipeline       = VK_NULL_HANDLE;
+        pipelineLayout = VK_NULL_HANDLE;
+        setLayout      = VK_NULL_HANDLE;
+    }
+
+
+    // (Re)creates the pyramid for a depth buffer; call again when the swapchain is
+    // recreated, with the device idle. depthView is a depth aspect view of the depth buffer.
+    // The recorded clear to the far plane leaves the pyramid valid to sample, in
+    // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, before the first Build().
+    void
+    Resize(VkCommandBuffer commandBuffer, VkImageView depthView, uint32_t depthWidth, uint32_t depthHeight)
+    {
+        DestroyImage();
+
+        width      = PreviousPowerOfTwo(depthWidth);
+        height     = PreviousPowerOfTwo(depthHeight);
+        levelCount = 1;
+        while ((std::max(width, height) >> levelCount) > 0) levelCount++;
+        if (width > DEPTH_PYRAMID_MAX_DIMENSION || height > DEPTH_PYRAMID_MAX_DIMENSION)
+        {
+            throw std::runtime_error("[ ERROR ] Depth buffer too large for the depth pyramid.");
+        }
+
+        depthSize[0] = depthWidth;
+        depthSize[1] = depthHeight;
+
+        CreateImage2D(physicalDevice, device, VK_FORMAT_R32_SFLOAT, width, height, levelCount,
+                      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                      image, imageMemory);
+        view = CreateImageView2D(device, image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount);
+
+        // Every array element must be valid, so unused slots alias the last real level;
+        // the shader never writes to them.
+        VkDescriptorImageInfo levelInfos[DEPTH_PYRAMID_MAX_LEVELS] = {};
+        for (uint32_t level = 0; level < levelCount; level++)
+        {
+            levelViews[level]              = CreateImageView2D(device, image, VK_FORMAT_R32_SFLOAT,
+                                                               VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+            levelInfos[level].imageView    = levelViews[level];
+            levelInfos[level].imageLayout  = VK_IMAGE_LAYOUT_GENERAL;
+        }
+        for (uint32_t slot = levelCount; slot < DEPTH_PYRAMID_MAX_LEVELS; slot++)
+        {
+            levelInfos[slot] = levelInfos[levelCount - 1];
+        }
+
+        VkDescriptorImageInfo  depthInfo   = { depthSampler, depthView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        VkDescriptorBufferInfo counterInfo = { counterBuffer, 0, sizeof(uint32_t) };
+
+        VkWriteDescriptorSet writes[3] = {};
+        for (auto& write : writes)
+        {
+            write.sType  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptorSet;
+        }
+        writes[0].dstBinding      = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo      = &depthInfo;
+        writes[1].dstBinding      = 1;
+        writes[1].descriptorCount = DEPTH_PYRAMID_MAX_LEVELS;
+        writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo      = levelInfos;
+        writes[2].dstBinding      = 2;
+        writes[2].descriptorCount = 1;
+        writes[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[2].pBufferInfo     = &counterInfo;
+        vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount,
+                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkClearColorValue       farPlane = { { 1.0f, 1.0f, 1.0f, 1.0f } };
+        VkImageSubresourceRange range    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+        vkCmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &farPlane, 1, &range);
+
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+
+    // Rebuilds every level from the depth buffer, which must be in
+    // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL with its writes made visible to the compute
+    // stage (e.g. the early render pass's final layout and external dependency). The
+    // pyramid is ready for culling dispatches recorded afterwards.
+    void
+    Build(VkCommandBuffer commandBuffer)
+    {
+        vkCmdFillBuffer(commandBuffer, counterBuffer, 0, sizeof(uint32_t), 0);
+
+        VkMemoryBarrier counterBarrier = {};
+        counterBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        counterBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        counterBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &counterBarrier, 0, nullptr, 0, nullptr);
+
+        // Waits for culling passes still sampling the previous contents.
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+                     VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        uint32_t groupsX = (width + 63) / 64;
+        uint32_t groupsY = (height + 63) / 64;
+        uint32_t pushConstants[6] = { depthSize[0], depthSize[1], width, height, levelCount, groupsX * groupsY };
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                                0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(pushConstants), pushConstants);
+        vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount,
+                     VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+
+    // All levels, in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL outside Build(); pass to
+    // GpuScene::Cull() or ClusterCuller::Cull().
+    VkImageView
+    View() const
+    {
+        return view;
+    }
+
+
+    // For MakeGpuCullingView().
+    uint32_t
+    Width() const
+    {
+        return width;
+    }
+
+
+    uint32_t
+    Height() const
+    {
+        return height;
+    }
+
+
+    uint32_t
+    LevelCount() const
+    {
+        return levelCount;
+    }
+
+
+private:
+    static uint32_t
+    PreviousPowerOfTwo(uint32_t value)
+    {
+        uint32_t result = 1;
+        while (result * 2 <= value) result *= 2;
+        return result;
+    }
+
+
+    void
+    DestroyImage()
+    {
+        for (VkImageView& levelView : levelViews)
+        {
+            if (levelView != VK_NULL_HANDLE) vkDestroyImageView(device, levelView, nullptr);
+            levelView = VK_NULL_HANDLE;
+        }
+        if (view != VK_NULL_HANDLE) vkDestroyImageView(device, view, nullptr);
+        if (image != VK_NULL_HANDLE) vkDestroyImage(device, image, nullptr);
+        if (imageMemory != VK_NULL_HANDLE) vkFreeMemory(device, imageMemory, nullptr);
+        view        = VK_NULL_HANDLE;
+        image       = VK_NULL_HANDLE;
+        imageMemory = VK_NULL_HANDLE;
+    }
+
+    VkPhysicalDevice      physicalDevice                       = VK_NULL_HANDLE;
+    VkDevice              device                               = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout                            = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout                       = VK_NULL_HANDLE;
+    VkPipeline            pipeline                             = VK_NULL_HANDLE;
+    VkDescriptorPool      descriptorPool                       = VK_NULL_HANDLE;
+    VkDescriptorSet       descriptorSet                        = VK_NULL_HANDLE;
+    VkSampler             depthSampler                         = VK_NULL_HANDLE;
+    VkBuffer              counterBuffer                        = VK_NULL_HANDLE;
+    VkDeviceMemory        counterMemory                        = VK_NULL_HANDLE;
+    VkImage               image                                = VK_NULL_HANDLE;
+    VkDeviceMemory        imageMemory                          = VK_NULL_HANDLE;
+    VkImageView           view                                 = VK_NULL_HANDLE;
+    VkImageView           levelViews[DEPTH_PYRAMID_MAX_LEVELS] = {};
+    uint32_t              depthSize[2]                         = {};
+    uint32_t              width                                = 0;
+    uint32_t              height                               = 0;
+    uint32_t              levelCount                           = 0;
+};
+
+#endif // DEPTH_PYRAMID_H
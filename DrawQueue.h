@@ -0,0 +1,420 @@
+#ifndef DRAW_QUEUE_H
+#define DRAW_QUEUE_H
+
+// Sorted draw submission with automatic instancing.
+//
+// Draws are submitted as packets carrying a 64 bit sort key and one uint32 of per
+// instance data (typically an index into a transform buffer). Keys are laid out so that
+// sorting them groups draws by state change cost:
+//
+//   63..60  pass       (4 bits)
+//   59..48  pipeline   (12 bits)
+//   47..32  material   (16 bits)
+//   31..16  mesh       (16 bits)
+//   15..0   depth      (16 bits, quantized view distance)
+//
+// After Sort() consecutive packets with the same pass, pipeline, material and mesh become
+// one instanced vkCmdDrawIndexed. Their instance data is written contiguously to
+// SortedInstanceData() in the order the merged draws consume it: the caller uploads that
+// array and the vertex shader reads instanceData[gl_InstanceIndex]. Pipeline, descriptor
+// set and vertex/index buffer binds are skipped while they are already current, and
+// DrawQueueStatistics counts what was saved.
+
+#include <vulkan/vulkan.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+const uint32_t DRAW_KEY_PASS_BITS     = 4;
+const uint32_t DRAW_KEY_PIPELINE_BITS = 12;
+const uint32_t DRAW_KEY_MATERIAL_BITS = 16;
+const uint32_t DRAW_KEY_MESH_BITS     = 16;
+const uint32_t DRAW_KEY_DEPTH_BITS    = 16;
+
+const uint32_t DRAW_KEY_MESH_SHIFT     = DRAW_KEY_DEPTH_BITS;
+const uint32_t DRAW_KEY_MATERIAL_SHIFT = DRAW_KEY_MESH_SHIFT + DRAW_KEY_MESH_BITS;
+const uint32_t DRAW_KEY_PIPELINE_SHIFT = DRAW_KEY_MATERIAL_SHIFT + DRAW_KEY_MATERIAL_BITS;
+const uint32_t DRAW_KEY_PASS_SHIFT     = DRAW_KEY_PIPELINE_SHIFT + DRAW_KEY_PIPELINE_BITS;
+static_assert(DRAW_KEY_PASS_SHIFT + DRAW_KEY_PASS_BITS == 64, "Draw key fields must fill 64 bits.");
+
+// Everything above the depth field: packets equal under this mask can share one draw.
+const uint64_t DRAW_KEY_BATCH_MASK = ~((1ull << DRAW_KEY_DEPTH_BITS) - 1);
+
+
+// Maps a view distance onto the 16 bit depth field. Opaque passes sort front to back to
+// help early Z; pass backToFront for blended passes.
+inline uint32_t
+QuantizeDrawDepth(float viewDistance, float farPlane, bool backToFront = false)
+{
+    float    normalized = std::min(std::max(viewDistance / farPlane, 0.0f), 1.0f);
+    uint32_t depth      = static_cast<uint32_t>(normalized * static_cast<float>((1u << DRAW_KEY_DEPTH_BITS) - 1));
+    return backToFront ? ((1u << DRAW_KEY_DEPTH_BITS) - 1) - depth : depth;
+}
+
+
+// Every field is masked to its width, so an out of range value cannot spill into the
+// fields above it. DrawQueue::Submit() rejects such values instead.
+inline uint64_t
+MakeDrawKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth)
+{
+    return (static_cast<uint64_t>(pass     & ((1u << DRAW_KEY_PASS_BITS) - 1))     << DRAW_KEY_PASS_SHIFT)     |
+           (static_cast<uint64_t>(pipeline & ((1u << DRAW_KEY_PIPELINE_BITS) - 1)) << DRAW_KEY_PIPELINE_SHIFT) |
+           (static_cast<uint64_t>(material & ((1u << DRAW_KEY_MATERIAL_BITS) - 1)) << DRAW_KEY_MATERIAL_SHIFT) |
+           (static_cast<uint64_t>(mesh     & ((1u << DRAW_KEY_MESH_BITS) - 1))     << DRAW_KEY_MESH_SHIFT)     |
+           static_cast<uint64_t>(depth     & ((1u << DRAW_KEY_DEPTH_BITS) - 1));
+}
+
+
+struct DrawQueueStatistics
+{
+    uint32_t packets              = 0;
+    uint32_t drawCalls            = 0;
+    uint32_t pipelineBinds        = 0;
+    uint32_t pipelineBindsSaved   = 0;
+    uint32_t descriptorBinds      = 0;
+    uint32_t descriptorBindsSaved = 0;
+    uint32_t geometryBinds        = 0; // Vertex + index buffer pairs
+    uint32_t geometryBindsSaved   = 0;
+
+
+    void
+    Print() const
+    {
+        std::cout << "[ INFO ] Draw queue: " << packets << " packets -> " << drawCalls << " draws, binds saved "
+                  << "(pipeline " << pipelineBindsSaved << "/" << pipelineBinds + pipelineBindsSaved
+                  << ", descriptor " << descriptorBindsSaved << "/" << descriptorBinds + descriptorBindsSaved
+                  << ", geometry " << geometryBindsSaved << "/" << geometryBinds + geometryBindsSaved << ")\n";
+    }
+};
+
+
+// Least significant digit radix sort of keys, 8 bits per pass. Passes whose digit is the
+// same for every key are skipped, so keys that only use a few fields sort in a few passes.
+// order receives the indices of keys in ascending key order; the sort is stable.
+inline void
+RadixSortKeys(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order, std::vector<uint32_t>& scratch)
+{
+    const size_t count = keys.size();
+    order.resize(count);
+    scratch.resize(count);
+    for (size_t ii = 0; ii < count; ii++) order[ii] = static_cast<uint32_t>(ii);
+
+    // All histograms in one read of the keys.
+    uint32_t histograms[8][256] = {};
+    for (uint64_t key : keys)
+    {
+        for (uint32_t digit = 0; digit < 8; digit++)
+        {
+            histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    for (uint32_t digit = 0; digit < 8; digit++)
+    {
+        uint32_t* histogram = histograms[digit];
+        if (count == 0 || histogram[(keys[0] >> (digit * 8)) & 0xFF] == count) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t bucket = 0; bucket < 256; bucket++)
+        {
+            uint32_t bucketCount = histogram[bucket];
+            histogram[bucket]    = offset;
+            offset              += bucketCount;
+        }
+
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            uint32_t index = order[ii];
+            scratch[histogram[(keys[index] >> (digit * 8)) & 0xFF]++] = index;
+        }
+        order.swap(scratch);
+    }
+}
+
+
+class DrawQueue
+{
+public:
+    uint32_t
+    AddPipeline(VkPipeline pipeline, VkPipelineLayout layout)
+    {
+        if (pipelines.size() >= (1u << DRAW_KEY_PIPELINE_BITS))
+        {
+            throw std::runtime_error("[ ERROR ] Draw queue pipeline limit reached.");
+        }
+
+        Pipeline entry = { pipeline, layout };
+        pipelines.push_back(entry);
+        return static_cast<uint32_t>(pipelines.size() - 1);
+    }
+
+
+    // The material's descriptor set is bound at setIndex of the drawing pipeline's layout.
+    uint32_t
+    AddMaterial(VkDescriptorSet descriptorSet, uint32_t setIndex)
+    {
+        if (materials.size() >= (1u << DRAW_KEY_MATERIAL_BITS))
+        {
+            throw std::runtime_error("[ ERROR ] Draw queue material limit reached.");
+        }
+
+        Material entry = { descriptorSet, setIndex };
+        materials.push_back(entry);
+        return static_cast<uint32_t>(materials.size() - 1);
+    }
+
+
+    uint32_t
+    AddMesh(VkBuffer     vertexBuffer,
+            VkDeviceSize vertexOffset,
+            VkBuffer     indexBuffer,
+            VkDeviceSize indexOffset,
+            VkIndexType  indexType,
+            uint32_t     indexCount,
+            uint32_t     firstIndex = 0,
+            int32_t      baseVertex = 0)
+    {
+        if (meshes.size() >= (1u << DRAW_KEY_MESH_BITS))
+        {
+            throw std::runtime_error("[ ERROR ] Draw queue mesh limit reached.");
+        }
+
+        Mesh entry = { vertexBuffer, vertexOffset, indexBuffer, indexOffset, indexType, indexCount, firstIndex, baseVertex };
+        meshes.push_back(entry);
+        return static_cast<uint32_t>(meshes.size() - 1);
+    }
+
+
+    void
+    Submit(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth, uint32_t instanceData)
+    {
+        if (pass >= (1u << DRAW_KEY_PASS_BITS) || depth >= (1u << DRAW_KEY_DEPTH_BITS))
+        {
+            throw std::runtime_error("[ ERROR ] Draw queue pass or depth out of range.");
+        }
+        if (pipeline >= pipelines.size() || material >= materials.size() || mesh >= meshes.size())
+        {
+            throw std::runtime_error("[ ERROR ] Draw queue packet references an unregistered pipeline, material or mesh.");
+        }
+        keys.push_back(MakeDrawKey(pass, pipeline, material, mesh, depth));
+        packetInstanceData.push_back(instanceData);
+    }
+
+
+    // Sorts the frame's packets and fills SortedInstanceData().
+    void
+    Sort()
+    {
+        RadixSortKeys(keys, order, scratch);
+
+        sortedInstanceData.resize(order.size());
+        for (size_t ii = 0; ii < order.size(); ii++)
+        {
+            sortedInstanceData[ii] = packetInstanceData[order[ii]];
+        }
+        sorted = true;
+    }
+
+
+    const std::vector<uint32_t>&
+    SortedInstanceData() const
+    {
+        return sortedInstanceData;
+    }
+
+
+    // Records every packet of pass into commandBuffer, which must be inside the pass's
+    // render pass. Bind state is tracked across calls until Clear().
+    void
+    Record(VkCommandBuffer commandBuffer, uint32_t pass)
+    {
+        if (!sorted)
+        {
+            throw std::runtime_error("[ ERROR ] DrawQueue::Record() called before Sort().");
+        }
+
+        // A new command buffer starts without any bound state.
+        if (commandBuffer != boundCommandBuffer)
+        {
+            boundCommandBuffer = commandBuffer;
+            boundPipeline      = UNBOUND;
+            boundMaterial      = UNBOUND;
+            boundMesh          = UNBOUND;
+            boundLayout        = VK_NULL_HANDLE;
+        }
+
+        size_t begin = 0;
+        while (begin < order.size() && PassOf(keys[order[begin]]) < pass) begin++;
+
+        while (begin < order.size() && PassOf(keys[order[begin]]) == pass)
+        {
+            uint64_t batchKey = keys[order[begin]] & DRAW_KEY_BATCH_MASK;
+            size_t   end      = begin + 1;
+            while (end < order.size() && (keys[order[end]] & DRAW_KEY_BATCH_MASK) == batchKey) end++;
+
+            uint32_t pipeline = static_cast<uint32_t>(batchKey >> DRAW_KEY_PIPELINE_SHIFT) &
+                                ((1u << DRAW_KEY_PIPELINE_BITS) - 1);
+            uint32_t material = static_cast<uint32_t>(batchKey >> DRAW_KEY_MATERIAL_SHIFT) &
+                                ((1u << DRAW_KEY_MATERIAL_BITS) - 1);
+            uint32_t mesh     = static_cast<uint32_t>(batchKey >> DRAW_KEY_MESH_SHIFT) &
+                                ((1u << DRAW_KEY_MESH_BITS) - 1);
+
+            BindPipeline(commandBuffer, pipeline);
+            BindMaterial(commandBuffer, material);
+            BindMesh(commandBuffer, mesh);
+
+            const Mesh& entry = meshes[mesh];
+            vkCmdDrawIndexed(commandBuffer, entry.indexCount, static_cast<uint32_t>(end - begin),
+                             entry.firstIndex, entry.baseVertex, static_cast<uint32_t>(begin));
+            statistics.drawCalls++;
+
+            begin = end;
+        }
+    }
+
+
+    // Resets the packets and statistics for the next frame; registered pipelines,
+    // materials and meshes are kept.
+    void
+    Clear()
+    {
+        keys.clear();
+        packetInstanceData.clear();
+        sortedInstanceData.clear();
+        order.clear();
+        sorted             = false;
+        boundCommandBuffer = VK_NULL_HANDLE;
+        statistics         = DrawQueueStatistics();
+    }
+
+
+    // Counters for the packets recorded since the last Clear().
+    DrawQueueStatistics
+    Statistics() const
+    {
+        DrawQueueStatistics result = statistics;
+        result.packets = static_cast<uint32_t>(keys.size());
+        return result;
+    }
+
+
+private:
+    static const uint32_t UNBOUND = 0xFFFFFFFF;
+
+
+    struct Pipeline
+    {
+        VkPipeline       pipeline;
+        VkPipelineLayout layout;
+    };
+
+
+    struct Material
+    {
+        VkDescriptorSet descriptorSet;
+        uint32_t        setIndex;
+    };
+
+
+    struct Mesh
+    {
+        VkBuffer     vertexBuffer;
+        VkDeviceSize vertexOffset;
+        VkBuffer     indexBuffer;
+        VkDeviceSize indexOffset;
+        VkIndexType  indexType;
+        uint32_t     indexCount;
+        uint32_t     firstIndex;
+        int32_t      baseVertex;
+    };
+
+
+    static uint32_t
+    PassOf(uint64_t key)
+    {
+        return static_cast<uint32_t>(key >> DRAW_KEY_PASS_SHIFT);
+    }
+
+
+    void
+    BindPipeline(VkCommandBuffer commandBuffer, uint32_t pipeline)
+    {
+        if (pipeline == boundPipeline)
+        {
+            statistics.pipelineBindsSaved++;
+            return;
+        }
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[pipeline].pipeline);
+        statistics.pipelineBinds++;
+        boundPipeline = pipeline;
+
+        // Sets stay bound across pipelines sharing a layout; otherwise they are disturbed.
+        if (pipelines[pipeline].layout != boundLayout)
+        {
+            boundLayout   = pipelines[pipeline].layout;
+            boundMaterial = UNBOUND;
+        }
+    }
+
+
+    void
+    BindMaterial(VkCommandBuffer commandBuffer, uint32_t material)
+    {
+        if (material == boundMaterial)
+        {
+            statistics.descriptorBindsSaved++;
+            return;
+        }
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, boundLayout,
+                                materials[material].setIndex, 1, &materials[material].descriptorSet, 0, nullptr);
+        statistics.descriptorBinds++;
+        boundMaterial = material;
+    }
+
+
+    void
+    BindMesh(VkCommandBuffer commandBuffer, uint32_t mesh)
+    {
+        const Mesh& entry = meshes[mesh];
+        if (boundMesh != UNBOUND &&
+            meshes[boundMesh].vertexBuffer == entry.vertexBuffer &&
+            meshes[boundMesh].vertexOffset == entry.vertexOffset &&
+            meshes[boundMesh].indexBuffer  == entry.indexBuffer &&
+            meshes[boundMesh].indexOffset  == entry.indexOffset &&
+            meshes[boundMesh].indexType    == entry.indexType)
+        {
+            statistics.geometryBindsSaved++;
+            boundMesh = mesh;
+            return;
+        }
+
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &entry.vertexBuffer, &entry.vertexOffset);
+        vkCmdBindIndexBuffer(commandBuffer, entry.indexBuffer, entry.indexOffset, entry.indexType);
+        statistics.geometryBinds++;
+        boundMesh = mesh;
+    }
+
+    std::vector<Pipeline>  pipelines;
+    std::vector<Material>  materials;
+    std::vector<Mesh>      meshes;
+    std::vector<uint64_t>  keys;
+    std::vector<uint32_t>  packetInstanceData;
+    std::vector<uint32_t>  sortedInstanceData;
+    std::vector<uint32_t>  order;
+    std::vector<uint32_t>  scratch;
+    bool                   sorted             = false;
+    VkCommandBuffer        boundCommandBuffer = VK_NULL_HANDLE;
+    VkPipelineLayout       boundLayout        = VK_NULL_HANDLE;
+    uint32_t               boundPipeline      = UNBOUND;
+    uint32_t               boundMaterial      = UNBOUND;
+    uint32_t               boundMesh          = UNBOUND;
+    DrawQueueStatistics    statistics;
+};
+
+#endif // DRAW_QUEUE_H
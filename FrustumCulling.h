@@ -0,0 +1,328 @@
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+// CPU frustum culling of bounding spheres and AABBs stored as structure of arrays.
+//
+// The kernel is picked from GLM_ARCH (glm/simd/platform.h), so it follows the same
+// GLM_FORCE_* switches as the rest of glm:
+//
+//   GLM_ARCH_AVX2_BIT  8 objects per iteration, 256 bit FMA where the compiler targets it
+//   GLM_ARCH_SSE2_BIT  4 objects per iteration, glm/simd helpers
+//   otherwise          scalar
+//
+// Without GLM_FORCE_INTRINSICS (or a GLM_FORCE_<isa> define) glm reports plain x86 and
+// the scalar kernel is used; MSVC only defines __AVX2__ under /arch:AVX2, so define
+// GLM_FORCE_AVX2 to select the 8 wide kernel on such builds. AVX2 does not imply FMA:
+// GCC and Clang need -mfma (or -march) and otherwise get a separate multiply and add.
+//
+// CullFrustum() splits the objects across a JobSystem. Results are one byte per object
+// (1 = potentially visible), which keeps the parallel ranges free of shared writes.
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include <glm/simd/geometric.h>
+#endif
+
+#include "GpuCulling.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+const uint32_t FRUSTUM_CULLING_LANES = 8;
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+const uint32_t FRUSTUM_CULLING_LANES = 4;
+#else
+const uint32_t FRUSTUM_CULLING_LANES = 1;
+#endif
+
+
+// Six inward facing planes, one array per component so every plane term broadcasts
+// from a single float.
+struct CullingFrustum
+{
+    float normalX[6];
+    float normalY[6];
+    float normalZ[6];
+    float distance[6];
+    float absNormalX[6];
+    float absNormalY[6];
+    float absNormalZ[6];
+};
+
+
+inline CullingFrustum
+MakeCullingFrustum(const glm::mat4& viewProjection)
+{
+    glm::vec4 planes[6];
+    ExtractFrustumPlanes(viewProjection, planes);
+
+    CullingFrustum frustum = {};
+    for (int ii = 0; ii < 6; ii++)
+    {
+        frustum.normalX[ii]    = planes[ii].x;
+        frustum.normalY[ii]    = planes[ii].y;
+        frustum.normalZ[ii]    = planes[ii].z;
+        frustum.distance[ii]   = planes[ii].w;
+        frustum.absNormalX[ii] = std::fabs(planes[ii].x);
+        frustum.absNormalY[ii] = std::fabs(planes[ii].y);
+        frustum.absNormalZ[ii] = std::fabs(planes[ii].z);
+    }
+    return frustum;
+}
+
+
+// Spheres use center + radius; AABBs use center + half extents. Both kinds can be stored
+// in the same container, the kernel decides which fields it reads.
+struct CullingBounds
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+
+    size_t
+    Count() const
+    {
+        return centerX.size();
+    }
+
+
+    void
+    Reserve(size_t count)
+    {
+        centerX.reserve(count);
+        centerY.reserve(count);
+        centerZ.reserve(count);
+        radius.reserve(count);
+        extentX.reserve(count);
+        extentY.reserve(count);
+        extentZ.reserve(count);
+    }
+
+
+    void
+    AddSphere(const glm::vec3& center, float sphereRadius)
+    {
+        Add(center, sphereRadius, glm::vec3(sphereRadius));
+    }
+
+
+    // The AABB's bounding sphere is stored as well, so either kernel can be used.
+    void
+    AddAabb(const glm::vec3& minimum, const glm::vec3& maximum)
+    {
+        glm::vec3 halfExtent = (maximum - minimum) * 0.5f;
+        Add(minimum + halfExtent, glm::length(halfExtent), halfExtent);
+    }
+
+
+private:
+    void
+    Add(const glm::vec3& center, float sphereRadius, const glm::vec3& halfExtent)
+    {
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        radius.push_back(sphereRadius);
+        extentX.push_back(halfExtent.x);
+        extentY.push_back(halfExtent.y);
+        extentZ.push_back(halfExtent.z);
+    }
+};
+
+
+enum CullingVolume
+{
+    CULLING_VOLUME_SPHERE,
+    CULLING_VOLUME_AABB
+};
+
+
+// Reference kernel; also handles the tails of the SIMD kernels.
+inline uint32_t
+CullFrustumScalar(const CullingFrustum& frustum,
+                  const CullingBounds&  bounds,
+                  CullingVolume         volume,
+                  size_t                begin,
+                  size_t                end,
+                  uint8_t*              visible)
+{
+    uint32_t visibleCount = 0;
+    for (size_t ii = begin; ii < end; ii++)
+    {
+        bool inside = true;
+        for (int plane = 0; plane < 6 && inside; plane++)
+        {
+            float distance = frustum.normalX[plane] * bounds.centerX[ii] +
+                             frustum.normalY[plane] * bounds.centerY[ii] +
+                             frustum.normalZ[plane] * bounds.centerZ[ii] + frustum.distance[plane];
+            float reach    = volume == CULLING_VOLUME_SPHERE ? bounds.radius[ii] :
+                             frustum.absNormalX[plane] * bounds.extentX[ii] +
+                             frustum.absNormalY[plane] * bounds.extentY[ii] +
+                             frustum.absNormalZ[plane] * bounds.extentZ[ii];
+            inside = distance >= -reach;
+        }
+
+        visible[ii]   = inside ? 1 : 0;
+        visibleCount += inside ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+
+// a * b + c; MSVC accepts FMA intrinsics in any AVX2 build.
+inline __m256
+CullingMultiplyAdd(__m256 a, __m256 b, __m256 c)
+{
+#if defined(__FMA__) || defined(_MSC_VER)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+
+inline uint32_t
+CullFrustumSimd(const CullingFrustum& frustum,
+                const CullingBounds&  bounds,
+                CullingVolume         volume,
+                size_t                begin,
+                size_t                end,
+                uint8_t*              visible)
+{
+    uint32_t visibleCount = 0;
+    size_t   ii           = begin;
+    for (; ii + 8 <= end; ii += 8)
+    {
+        __m256 centerX = _mm256_loadu_ps(&bounds.centerX[ii]);
+        __m256 centerY = _mm256_loadu_ps(&bounds.centerY[ii]);
+        __m256 centerZ = _mm256_loadu_ps(&bounds.centerZ[ii]);
+        __m256 radius  = _mm256_loadu_ps(&bounds.radius[ii]);
+        __m256 extentX = _mm256_loadu_ps(&bounds.extentX[ii]);
+        __m256 extentY = _mm256_loadu_ps(&bounds.extentY[ii]);
+        __m256 extentZ = _mm256_loadu_ps(&bounds.extentZ[ii]);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int plane = 0; plane < 6; plane++)
+        {
+            __m256 distance = CullingMultiplyAdd(_mm256_set1_ps(frustum.normalX[plane]), centerX,
+                              CullingMultiplyAdd(_mm256_set1_ps(frustum.normalY[plane]), centerY,
+                              CullingMultiplyAdd(_mm256_set1_ps(frustum.normalZ[plane]), centerZ,
+                                                 _mm256_set1_ps(frustum.distance[plane]))));
+            __m256 reach    = volume == CULLING_VOLUME_SPHERE ? radius :
+                              CullingMultiplyAdd(_mm256_set1_ps(frustum.absNormalX[plane]), extentX,
+                              CullingMultiplyAdd(_mm256_set1_ps(frustum.absNormalY[plane]), extentY,
+                                                 _mm256_mul_ps(_mm256_set1_ps(frustum.absNormalZ[plane]), extentZ)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+        for (uint32_t lane = 0; lane < 8; lane++)
+        {
+            visible[ii + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+        visibleCount += static_cast<uint32_t>(_mm_popcnt_u32(mask));
+    }
+
+    return visibleCount + CullFrustumScalar(frustum, bounds, volume, ii, end, visible);
+}
+
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+inline uint32_t
+CullFrustumSimd(const CullingFrustum& frustum,
+                const CullingBounds&  bounds,
+                CullingVolume         volume,
+                size_t                begin,
+                size_t                end,
+                uint8_t*              visible)
+{
+    static const uint8_t laneCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    uint32_t visibleCount = 0;
+    size_t   ii           = begin;
+    for (; ii + 4 <= end; ii += 4)
+    {
+        glm_vec4 centerX = _mm_loadu_ps(&bounds.centerX[ii]);
+        glm_vec4 centerY = _mm_loadu_ps(&bounds.centerY[ii]);
+        glm_vec4 centerZ = _mm_loadu_ps(&bounds.centerZ[ii]);
+        glm_vec4 radius  = _mm_loadu_ps(&bounds.radius[ii]);
+        glm_vec4 extentX = _mm_loadu_ps(&bounds.extentX[ii]);
+        glm_vec4 extentY = _mm_loadu_ps(&bounds.extentY[ii]);
+        glm_vec4 extentZ = _mm_loadu_ps(&bounds.extentZ[ii]);
+
+        glm_vec4 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int plane = 0; plane < 6; plane++)
+        {
+            glm_vec4 distance = glm_vec4_fma(_mm_set1_ps(frustum.normalX[plane]), centerX,
+                                glm_vec4_fma(_mm_set1_ps(frustum.normalY[plane]), centerY,
+                                glm_vec4_fma(_mm_set1_ps(frustum.normalZ[plane]), centerZ,
+                                             _mm_set1_ps(frustum.distance[plane]))));
+            glm_vec4 reach    = volume == CULLING_VOLUME_SPHERE ? radius :
+                                glm_vec4_fma(_mm_set1_ps(frustum.absNormalX[plane]), extentX,
+                                glm_vec4_fma(_mm_set1_ps(frustum.absNormalY[plane]), extentY,
+                                             glm_vec4_mul(_mm_set1_ps(frustum.absNormalZ[plane]), extentZ)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(glm_vec4_add(distance, reach), _mm_setzero_ps()));
+        }
+
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+        for (uint32_t lane = 0; lane < 4; lane++)
+        {
+            visible[ii + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+        }
+        visibleCount += laneCounts[mask];
+    }
+
+    return visibleCount + CullFrustumScalar(frustum, bounds, volume, ii, end, visible);
+}
+
+#else
+
+inline uint32_t
+CullFrustumSimd(const CullingFrustum& frustum,
+                const CullingBounds&  bounds,
+                CullingVolume         volume,
+                size_t                begin,
+                size_t                end,
+                uint8_t*              visible)
+{
+    return CullFrustumScalar(frustum, bounds, volume, begin, end, visible);
+}
+
+#endif
+
+
+// Culls every object in bounds, resizing visible to Count(). Returns the visible count.
+inline uint32_t
+CullFrustum(JobSystem&            jobs,
+            const CullingFrustum& frustum,
+            const CullingBounds&  bounds,
+            CullingVolume         volume,
+            std::vector<uint8_t>& visible)
+{
+    const size_t grainSize = 16 * 1024;
+
+    visible.resize(bounds.Count());
+    std::atomic<uint32_t> visibleCount(0);
+    jobs.ParallelFor(bounds.Count(), grainSize, [&](size_t begin, size_t end)
+    {
+        visibleCount += CullFrustumSimd(frustum, bounds, volume, begin, end, visible.data());
+    });
+    return visibleCount;
+}
+
+#endif // FRUSTUM_CULLING_H
@@ -0,0 +1,377 @@
+// Throughput benchmark for the CPU frustum culling kernels (see FrustumCulling.h).
+//
+// Usage:
+//   FrustumCullingBenchmark [objectCount] [iterations]
+//
+// Culls objectCount (default 1M) random spheres and AABBs with the scalar kernel, the
+// SIMD kernel on one thread and the SIMD kernel across the job system, checks that all
+// three agree and prints the best time and throughput of each.
+//
+// The AABBs are then put in a BVH (Bvh.h): its build, refit and hierarchical culling are
+// timed the same way and checked against the scalar kernel, and rays cast from the
+// camera against the boxes are checked against a linear scan.
+//
+// Finally the AABBs are parented in a three level scene graph (TransformHierarchy.h). Full
+// updates after every root turns and partial ones after a few groups move are timed, and
+// the world space boxes they produce are culled on the job system.
+//
+// glm only reports SIMD support under GLM_FORCE_INTRINSICS; with MSVC, which does not
+// define __AVX2__ without /arch:AVX2, add /DGLM_FORCE_AVX2 to build the 8 wide kernel.
+
+#ifndef GLM_FORCE_PURE
+#define GLM_FORCE_INTRINSICS
+#endif
+
+#include "Bvh.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+
+const char*
+KernelName()
+{
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+    return "AVX2";
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+
+// Best of iterations, in milliseconds.
+double
+TimeBest(uint32_t iterations, const std::function<void()>& function)
+{
+    double best = 1e30;
+    for (uint32_t ii = 0; ii < iterations; ii++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        function();
+        auto stop  = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+
+void
+Report(const std::string& name, double milliseconds, size_t objectCount, uint32_t visibleCount)
+{
+    std::cout << "\t" << name << ": " << milliseconds << " ms, "
+              << static_cast<double>(objectCount) / (milliseconds * 1000.0) << " M objects/s, "
+              << visibleCount << " visible" << std::endl;
+}
+
+
+// Builds, refits and culls a BVH over the boxes, then casts rays from the frustum's apex
+// (the origin). Boxes touching a plane can round either way, since Bvh recomputes their
+// centers from the corners, so a few disagreements with the scalar kernel are allowed.
+void
+TimeBvh(JobSystem&                    jobs,
+        uint32_t                      iterations,
+        const CullingFrustum&         frustum,
+        const CullingBounds&          boxes,
+        const std::vector<BvhBounds>& boxBounds)
+{
+    const uint32_t rayCount    = 10000;
+    const uint32_t checkedRays = 32;
+    const float    rayDistance = 2000.0f;
+    size_t         objectCount = boxBounds.size();
+
+    // A build takes far longer than the kernels, so it is timed at most three times.
+    Bvh    bvh;
+    double buildTime = TimeBest(std::min(iterations, 3u), [&]()
+    {
+        bvh.Build(jobs, boxBounds);
+    });
+    double refitTime = TimeBest(iterations, [&]()
+    {
+        bvh.Refit(boxBounds);
+    });
+
+    std::vector<uint32_t> visible;
+    double cullTime = TimeBest(iterations, [&]()
+    {
+        visible.clear();
+        bvh.CullFrustum(frustum, visible);
+    });
+
+    std::vector<uint8_t> reference(objectCount);
+    std::vector<uint8_t> bvhVisible(objectCount, 0);
+    CullFrustumScalar(frustum, boxes, CULLING_VOLUME_AABB, 0, objectCount, reference.data());
+    for (uint32_t primitive : visible)
+    {
+        bvhVisible[primitive] = 1;
+    }
+    size_t mismatches = 0;
+    for (size_t ii = 0; ii < objectCount; ii++)
+    {
+        mismatches += bvhVisible[ii] != reference[ii] ? 1 : 0;
+    }
+    if (mismatches > objectCount / 10000)
+    {
+        throw std::runtime_error("[ ERROR ] BVH culling disagrees with the scalar kernel for " +
+                                 std::to_string(mismatches) + " AABBs.");
+    }
+
+    // Random directions, led by the six axes, whose rays are parallel to two slabs of every box.
+    std::mt19937                          random(4321);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<glm::vec3>                directions(rayCount);
+    for (uint32_t ii = 0; ii < rayCount; ii++)
+    {
+        glm::vec3 axis(0.0f);
+        axis[ii % 3] = ii % 6 < 3 ? 1.0f : -1.0f;
+        directions[ii] = ii < 6 ? axis : glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + 1e-4f);
+    }
+
+    glm::vec3           origin(0.0f);
+    std::vector<RayHit> hits(rayCount);
+    double rayTime = TimeBest(iterations, [&]()
+    {
+        for (uint32_t ii = 0; ii < rayCount; ii++)
+        {
+            const glm::vec3& direction = directions[ii];
+            hits[ii] = bvh.Raycast(origin, direction, rayDistance, [&](uint32_t primitive, float& distance)
+            {
+                return bvh.IntersectBounds(origin, direction, primitive, distance);
+            });
+        }
+    });
+
+    for (uint32_t ii = 0; ii < checkedRays; ii++)
+    {
+        float closest = rayDistance;
+        for (uint32_t primitive = 0; primitive < objectCount; primitive++)
+        {
+            bvh.IntersectBounds(origin, directions[ii], primitive, closest);
+        }
+        float found = hits[ii].primitive != BVH_INVALID ? hits[ii].distance : rayDistance;
+        if (found != closest)
+        {
+            throw std::runtime_error("[ ERROR ] BVH ray cast " + std::to_string(ii) + " disagrees with a linear scan.");
+        }
+    }
+
+    std::cout << "[ INFO ] BVH over the AABBs, " << bvh.Nodes().size() << " nodes" << std::endl;
+    std::cout << "\tbuild          : " << buildTime << " ms" << std::endl;
+    std::cout << "\trefit          : " << refitTime << " ms" << std::endl;
+    Report("cull           ", cullTime, objectCount, static_cast<uint32_t>(visible.size()));
+    std::cout << "\traycast        : " << rayTime << " ms, "
+              << static_cast<double>(rayCount) / (rayTime * 1000.0) << " M rays/s" << std::endl;
+}
+
+
+// One root per 4096 boxes and one group per 64, both at the origin, with every box a unit
+// cube scaled and moved into place. Update() must recompute exactly the moved nodes and
+// their descendants, and the first update must put every box back where it was.
+void
+TimeHierarchy(JobSystem&                    jobs,
+              uint32_t                      iterations,
+              const CullingFrustum&         frustum,
+              const std::vector<BvhBounds>& boxBounds)
+{
+    const uint32_t groupSize  = 64;
+    const uint32_t rootSize   = 4096;
+    const uint32_t movedEvery = 100; // Groups moved by a partial update
+
+    TransformHierarchy    hierarchy;
+    std::vector<uint32_t> roots;
+    std::vector<uint32_t> groups;
+    std::vector<uint32_t> leaves(boxBounds.size());
+    for (size_t ii = 0; ii < boxBounds.size(); ii++)
+    {
+        if (ii % rootSize == 0)
+        {
+            roots.push_back(hierarchy.Add(TRANSFORM_NO_PARENT, glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                          glm::vec3(1.0f)));
+        }
+        if (ii % groupSize == 0)
+        {
+            groups.push_back(hierarchy.Add(roots.back(), glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                           glm::vec3(1.0f)));
+        }
+
+        glm::vec3 center = (boxBounds[ii].minimum + boxBounds[ii].maximum) * 0.5f;
+        glm::vec3 extent = (boxBounds[ii].maximum - boxBounds[ii].minimum) * 0.5f;
+        leaves[ii] = hierarchy.Add(groups.back(), center, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), extent);
+    }
+
+    if (hierarchy.Update(jobs) != hierarchy.Count())
+    {
+        throw std::runtime_error("[ ERROR ] The first transform update skipped nodes.");
+    }
+    for (size_t ii = 0; ii < boxBounds.size(); ii++)
+    {
+        glm::vec3 center = (boxBounds[ii].minimum + boxBounds[ii].maximum) * 0.5f;
+        if (glm::length(glm::vec3(hierarchy.World(leaves[ii])[3]) - center) > 1e-3f)
+        {
+            throw std::runtime_error("[ ERROR ] Transform hierarchy misplaced box " + std::to_string(ii) + ".");
+        }
+    }
+
+    uint32_t turn      = 0;
+    uint32_t fullCount = 0;
+    double   fullTime  = TimeBest(iterations, [&]()
+    {
+        glm::quat rotation = glm::angleAxis(0.01f * static_cast<float>(++turn), glm::vec3(0.0f, 1.0f, 0.0f));
+        for (uint32_t root : roots)
+        {
+            hierarchy.SetRotation(root, rotation);
+        }
+        fullCount = hierarchy.Update(jobs);
+    });
+
+    uint32_t step         = 0;
+    uint32_t partialCount = 0;
+    double   partialTime  = TimeBest(iterations, [&]()
+    {
+        step++;
+        for (size_t group = step % movedEvery; group < groups.size(); group += movedEvery)
+        {
+            hierarchy.SetPosition(groups[group], glm::vec3(0.0f, 0.001f * static_cast<float>(step), 0.0f));
+        }
+        partialCount = hierarchy.Update(jobs);
+    });
+
+    size_t expectedPartial = 0;
+    for (size_t group = step % movedEvery; group < groups.size(); group += movedEvery)
+    {
+        expectedPartial += 1 + std::min<size_t>(groupSize, boxBounds.size() - group * groupSize);
+    }
+    if (fullCount != hierarchy.Count() || partialCount != expectedPartial)
+    {
+        throw std::runtime_error("[ ERROR ] Transform updates recomputed the wrong nodes.");
+    }
+
+    // World space AABBs of the turned unit cubes.
+    CullingBounds worldBounds;
+    worldBounds.Reserve(boxBounds.size());
+    for (uint32_t leaf : leaves)
+    {
+        const glm::mat4& world  = hierarchy.World(leaf);
+        glm::vec3        center = glm::vec3(world[3]);
+        glm::vec3        extent = glm::abs(glm::vec3(world[0])) + glm::abs(glm::vec3(world[1])) +
+                                  glm::abs(glm::vec3(world[2]));
+        worldBounds.AddAabb(center - extent, center + extent);
+    }
+
+    std::vector<uint8_t> visible;
+    uint32_t             visibleCount = 0;
+    double cullTime = TimeBest(iterations, [&]()
+    {
+        visibleCount = CullFrustum(jobs, frustum, worldBounds, CULLING_VOLUME_AABB, visible);
+    });
+
+    std::cout << "[ INFO ] Transform hierarchy, " << hierarchy.Count() << " nodes" << std::endl;
+    std::cout << "\tfull update    : " << fullTime << " ms, " << fullCount << " nodes" << std::endl;
+    std::cout << "\tpartial update : " << partialTime << " ms, " << partialCount << " nodes" << std::endl;
+    Report("cull, turned   ", cullTime, boxBounds.size(), visibleCount);
+}
+
+
+int
+main(int argc, char** argv)
+{
+    try
+    {
+        size_t   objectCount = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 1000000;
+        uint32_t iterations  = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 20;
+        if (objectCount == 0 || iterations == 0)
+        {
+            throw std::runtime_error("[ ERROR ] Object count and iterations must be positive.");
+        }
+
+        // A 1km cube of objects seen from its center; about one in seven survives.
+        std::mt19937                          random(1234);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+        CullingBounds          spheres;
+        CullingBounds          boxes;
+        std::vector<BvhBounds> boxBounds(objectCount);
+        spheres.Reserve(objectCount);
+        boxes.Reserve(objectCount);
+        for (size_t ii = 0; ii < objectCount; ii++)
+        {
+            glm::vec3 center(position(random), position(random), position(random));
+            glm::vec3 extent(size(random), size(random), size(random));
+            spheres.AddSphere(center, extent.x);
+            boxes.AddAabb(center - extent, center + extent);
+            boxBounds[ii].minimum = center - extent;
+            boxBounds[ii].maximum = center + extent;
+        }
+
+        glm::mat4 view       = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.2f, 0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+        CullingFrustum frustum = MakeCullingFrustum(projection * view);
+
+        JobSystem jobs;
+        std::cout << "[ INFO ] Frustum culling " << objectCount << " objects, " << KernelName() << " kernel, "
+                  << jobs.ThreadCount() << " threads, best of " << iterations << std::endl;
+
+        const CullingBounds* volumes[2] = { &spheres, &boxes };
+        const char*          names[2]   = { "spheres", "AABBs" };
+        for (int kind = 0; kind < 2; kind++)
+        {
+            const CullingBounds& bounds = *volumes[kind];
+            CullingVolume        volume = kind == 0 ? CULLING_VOLUME_SPHERE : CULLING_VOLUME_AABB;
+
+            std::vector<uint8_t> reference(objectCount);
+            std::vector<uint8_t> single(objectCount);
+            std::vector<uint8_t> parallel;
+            uint32_t referenceCount = 0;
+            uint32_t singleCount    = 0;
+            uint32_t parallelCount  = 0;
+
+            double scalarTime = TimeBest(iterations, [&]()
+            {
+                referenceCount = CullFrustumScalar(frustum, bounds, volume, 0, objectCount, reference.data());
+            });
+            double singleTime = TimeBest(iterations, [&]()
+            {
+                singleCount = CullFrustumSimd(frustum, bounds, volume, 0, objectCount, single.data());
+            });
+            double parallelTime = TimeBest(iterations, [&]()
+            {
+                parallelCount = CullFrustum(jobs, frustum, bounds, volume, parallel);
+            });
+
+            if (single != reference || parallel != reference)
+            {
+                throw std::runtime_error(std::string("[ ERROR ] SIMD culling disagrees with the scalar kernel for ") +
+                                         names[kind] + ".");
+            }
+
+            std::cout << "[ INFO ] " << names[kind] << std::endl;
+            Report("scalar         ", scalarTime, objectCount, referenceCount);
+            Report("simd, 1 thread ", singleTime, objectCount, singleCount);
+            Report("simd, parallel ", parallelTime, objectCount, parallelCount);
+        }
+
+        TimeBvh(jobs, iterations, frustum, boxes, boxBounds);
+        TimeHierarchy(jobs, iterations, frustum, boxBounds);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
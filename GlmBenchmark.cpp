@@ -0,0 +1,257 @@
+// Micro-benchmarks for the vendored glm kernels in this build configuration.
+//
+// Usage:
+//   GlmBenchmark [passes] [samples] [results.csv]
+//
+// Times mat4 * mat4, mat4 * vec4, inverse, transpose, vec4 normalize, quaternion slerp,
+// unorm/half packing and perlin/simplex noise on one thread, for both packed_highp (glm's
+// default) and aligned_highp operands. Each sample runs passes sweeps over 1024 inputs; the
+// best of samples is reported as ns/op and millions of ops per second on one core.
+//
+// Whether glm uses its SIMD paths is a compile time choice, so the comparison takes two
+// builds: this file (GLM_FORCE_INTRINSICS) and GlmBenchmarkPure.cpp (GLM_FORCE_PURE).
+// Give both the same results.csv to collect their rows side by side.
+//
+// With MSVC, which does not define __AVX2__ without /arch:AVX2, add /DGLM_FORCE_AVX2 to
+// measure the AVX2 paths.
+
+#ifndef GLM_FORCE_PURE
+#define GLM_FORCE_INTRINSICS
+#endif
+#define GLM_FORCE_ALIGNED_GENTYPES // aligned_highp in the pure build too, where supported
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/noise.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+const size_t GLM_BENCHMARK_ELEMENTS = 1024; // Power of two, operands stay in L1/L2
+
+
+struct KernelResult
+{
+    std::string kernel;
+    std::string qualifier;
+    double      nsPerOp = 0.0;
+};
+
+
+const char*
+SimdPath()
+{
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+    return "AVX2";
+#elif GLM_ARCH & GLM_ARCH_AVX_BIT
+    return "AVX";
+#elif GLM_ARCH & GLM_ARCH_SSE42_BIT
+    return "SSE4.2";
+#elif GLM_ARCH & GLM_ARCH_SSE41_BIT
+    return "SSE4.1";
+#elif GLM_ARCH & GLM_ARCH_SSE2_BIT
+    return "SSE2";
+#elif GLM_ARCH & GLM_ARCH_NEON_BIT
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+
+const char*
+BuildName()
+{
+#ifdef GLM_FORCE_PURE
+    return "GLM_FORCE_PURE";
+#else
+    return "GLM_FORCE_INTRINSICS";
+#endif
+}
+
+
+// Keeps the compiler from dropping or merging the stores of repeated passes.
+inline void
+ClobberMemory()
+{
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+
+// Best of samples, in nanoseconds per call of function(ii).
+template<typename Function>
+double
+MeasureNsPerOp(uint32_t passes, uint32_t samples, const Function& function)
+{
+    typedef decltype(function(0)) Output;
+    std::vector<Output> outputs(GLM_BENCHMARK_ELEMENTS);
+
+    double best = 1e30;
+    for (uint32_t sample = 0; sample < samples; sample++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t pass = 0; pass < passes; pass++)
+        {
+            for (size_t ii = 0; ii < GLM_BENCHMARK_ELEMENTS; ii++)
+            {
+                outputs[ii] = function(ii);
+            }
+            ClobberMemory();
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    return best / (static_cast<double>(passes) * static_cast<double>(GLM_BENCHMARK_ELEMENTS));
+}
+
+
+template<glm::qualifier Q>
+void
+RunKernels(const char* qualifierName, uint32_t passes, uint32_t samples, std::vector<KernelResult>& results)
+{
+    typedef glm::mat<4, 4, float, Q> Mat4;
+    typedef glm::vec<4, float, Q>    Vec4;
+    typedef glm::qua<float, Q>       Quat;
+
+    // Same seed for both qualifiers, so they see identical operands.
+    std::mt19937                          random(1234);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    std::vector<Mat4> matrices(GLM_BENCHMARK_ELEMENTS);
+    std::vector<Vec4> vectors(GLM_BENCHMARK_ELEMENTS);
+    std::vector<Quat> rotations(GLM_BENCHMARK_ELEMENTS);
+    for (size_t ii = 0; ii < GLM_BENCHMARK_ELEMENTS; ii++)
+    {
+        glm::vec3 axis = glm::normalize(glm::vec3(value(random), value(random), value(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+        glm::quat rotation = glm::angleAxis(3.0f * value(random), axis);
+
+        // Translation * rotation * scale, always invertible.
+        glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(value(random), value(random), value(random)) * 10.0f) *
+                           glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), glm::vec3(scale(random)));
+
+        matrices[ii]  = Mat4(matrix);
+        vectors[ii]   = Vec4(value(random), value(random), value(random), 1.0f);
+        rotations[ii] = Quat(rotation);
+    }
+
+    const size_t mask = GLM_BENCHMARK_ELEMENTS - 1;
+    auto add = [&](const char* kernel, double nsPerOp)
+    {
+        KernelResult result;
+        result.kernel    = kernel;
+        result.qualifier = qualifierName;
+        result.nsPerOp   = nsPerOp;
+        results.push_back(result);
+    };
+
+    add("mat4 * mat4", MeasureNsPerOp(passes, samples, [&](size_t ii) { return matrices[ii] * matrices[(ii + 1) & mask]; }));
+    add("mat4 * vec4", MeasureNsPerOp(passes, samples, [&](size_t ii) { return matrices[ii] * vectors[ii]; }));
+    add("inverse",     MeasureNsPerOp(passes, samples, [&](size_t ii) { return glm::inverse(matrices[ii]); }));
+    add("transpose",   MeasureNsPerOp(passes, samples, [&](size_t ii) { return glm::transpose(matrices[ii]); }));
+    add("normalize",   MeasureNsPerOp(passes, samples, [&](size_t ii) { return glm::normalize(vectors[ii]); }));
+    add("slerp",       MeasureNsPerOp(passes, samples, [&](size_t ii)
+    {
+        return glm::slerp(rotations[ii], rotations[(ii + 1) & mask], static_cast<float>(ii & 255) / 255.0f);
+    }));
+    add("packUnorm",   MeasureNsPerOp(passes, samples, [&](size_t ii)
+    {
+        return glm::packUnorm<glm::uint8>(vectors[ii] * 0.5f + 0.5f);
+    }));
+    add("packHalf",    MeasureNsPerOp(passes, samples, [&](size_t ii) { return glm::packHalf(vectors[ii]); }));
+    add("perlin",      MeasureNsPerOp(passes, samples, [&](size_t ii) { return glm::perlin(vectors[ii] * 8.0f); }));
+    add("simplex",     MeasureNsPerOp(passes, samples, [&](size_t ii) { return glm::simplex(vectors[ii] * 8.0f); }));
+}
+
+
+void
+AppendCsv(const std::string& path, const std::vector<KernelResult>& results)
+{
+    bool writeHeader = false;
+    {
+        std::ifstream existing(path);
+        writeHeader = !existing || existing.peek() == std::ifstream::traits_type::eof();
+    }
+
+    std::ofstream file(path, std::ios::app);
+    if (!file)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to open " + path + " for writing.");
+    }
+
+    if (writeHeader)
+    {
+        file << "build,simd,kernel,qualifier,ns_per_op,mops_per_core\n";
+    }
+    for (const auto& result : results)
+    {
+        file << BuildName() << "," << SimdPath() << "," << result.kernel << "," << result.qualifier << ","
+             << result.nsPerOp << "," << 1000.0 / result.nsPerOp << "\n";
+    }
+}
+
+
+int
+main(int argc, char** argv)
+{
+    try
+    {
+        uint32_t passes  = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 200;
+        uint32_t samples = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 7;
+        if (passes == 0 || samples == 0)
+        {
+            throw std::runtime_error("[ ERROR ] Passes and samples must be positive.");
+        }
+
+        std::cout << "[ INFO ] " << GLM_VERSION_MESSAGE << ", " << BuildName() << ", " << SimdPath()
+                  << " paths, best of " << samples << " x " << passes << " passes" << std::endl;
+
+        std::vector<KernelResult> results;
+        RunKernels<glm::packed_highp>("packed_highp", passes, samples, results);
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+        RunKernels<glm::aligned_highp>("aligned_highp", passes, samples, results);
+#else
+        std::cout << "[ INFO ] aligned_highp is not available in this build." << std::endl;
+#endif
+
+        std::cout << std::fixed << std::setprecision(2);
+        for (const auto& result : results)
+        {
+            std::cout << "\t" << std::left << std::setw(12) << result.kernel << std::setw(14) << result.qualifier
+                      << std::right << std::setw(9) << result.nsPerOp << " ns/op"
+                      << std::setw(10) << 1000.0 / result.nsPerOp << " M ops/s per core" << std::endl;
+        }
+
+        if (argc > 3)
+        {
+            AppendCsv(argv[3], results);
+            std::cout << "[ INFO ] Appended results to " << argv[3] << std::endl;
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
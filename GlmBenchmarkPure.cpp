@@ -0,0 +1,5 @@
+// GlmBenchmark.cpp with glm's SIMD paths disabled, as the baseline for the intrinsics
+// build. build_vulkan.bat has no way to pass defines, hence this separate entry point.
+
+#define GLM_FORCE_PURE
+#include "GlmBenchmark.cpp"
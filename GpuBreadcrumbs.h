@@ -0,0 +1,317 @@
+#ifndef GPU_BREADCRUMBS_H
+#define GPU_BREADCRUMBS_H
+
+// GPU crash breadcrumbs: named markers around the passes of a queue's command buffers,
+// dumped when the device is lost to show which passes completed and which were running.
+//
+// Every Begin() hands out the next marker id of the queue and remembers its name in a ring
+// of GPU_BREADCRUMB_SLOTS entries; End() closes the innermost open marker. The markers
+// reach the GPU in one of two ways:
+//
+//   VK_NV_device_diagnostic_checkpoints  vkCmdSetCheckpointNV with the id (and a begin/end
+//                                        bit) as the checkpoint marker. Dump() prints the
+//                                        last checkpoint every pipeline stage reached, as
+//                                        reported by vkGetQueueCheckpointDataNV.
+//   otherwise                            vkCmdFillBuffer of the id into the marker's slot
+//                                        of a persistently mapped host visible buffer, one
+//                                        word when the marker begins and one when it ends.
+//                                        End() puts an ALL_COMMANDS -> TRANSFER barrier in
+//                                        front of its write, so an end value means the
+//                                        marker's work finished. Dump() reads the slots
+//                                        back and lists the last completed markers and
+//                                        every marker that began but did not end.
+//
+// Transfer commands and barriers are not allowed inside render pass instances, so with the
+// buffer markers Begin() and End() belong outside of them: one marker per pass, not per
+// draw. The end barrier serializes consecutive passes, which costs some GPU overlap; enable
+// breadcrumbs when hunting a device loss rather than in benchmarks.
+//
+// One object per queue; recording is single threaded like the command buffers it writes.
+// name must outlive the marker's last dump; string literals are the intended use.
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanUtilities.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+const uint32_t GPU_BREADCRUMB_SLOTS          = 1024; // Markers remembered per queue
+const uint32_t GPU_BREADCRUMB_DUMP_COMPLETED = 8;    // Completed markers listed by Dump()
+
+
+class GpuBreadcrumbs
+{
+public:
+    // checkpoints: VK_NV_device_diagnostic_checkpoints is enabled on logicalDevice.
+    void
+    Create(VkPhysicalDevice   gpu,
+           VkDevice           logicalDevice,
+           VkQueue            markedQueue,
+           const std::string& name,
+           bool               checkpoints)
+    {
+        device    = logicalDevice;
+        queue     = markedQueue;
+        queueName = name;
+        entries.assign(GPU_BREADCRUMB_SLOTS, Entry());
+        nextId    = 1;
+        openIds.clear();
+
+        if (checkpoints)
+        {
+            setCheckpoint     = LoadDeviceFunction<PFN_vkCmdSetCheckpointNV>(device, "vkCmdSetCheckpointNV");
+            getCheckpointData = LoadDeviceFunction<PFN_vkGetQueueCheckpointDataNV>(device, "vkGetQueueCheckpointDataNV");
+        }
+        if (setCheckpoint && getCheckpointData)
+        {
+            std::cout << "[ INFO ] GPU breadcrumbs on " << queueName << ": VK_NV_device_diagnostic_checkpoints." << std::endl;
+            return;
+        }
+        setCheckpoint     = nullptr;
+        getCheckpointData = nullptr;
+
+        // Begin and end word per slot. Coherent, so the host sees the last writes that made
+        // it out before the loss without an invalidate.
+        CreateBuffer(gpu, device, 2 * GPU_BREADCRUMB_SLOTS * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     markerBuffer, markerMemory);
+
+        void* mapped = nullptr;
+        if (vkMapMemory(device, markerMemory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to map GPU breadcrumb buffer.");
+        }
+        markers = static_cast<volatile uint32_t*>(mapped);
+        std::fill(markers, markers + 2 * GPU_BREADCRUMB_SLOTS, 0u);
+        std::cout << "[ INFO ] GPU breadcrumbs on " << queueName << ": marker buffer." << std::endl;
+    }
+
+
+    void
+    Destroy()
+    {
+        if (markerMemory != VK_NULL_HANDLE)
+        {
+            vkUnmapMemory(device, markerMemory);
+            vkFreeMemory(device, markerMemory, nullptr);
+        }
+        if (markerBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, markerBuffer, nullptr);
+        markerBuffer      = VK_NULL_HANDLE;
+        markerMemory      = VK_NULL_HANDLE;
+        markers           = nullptr;
+        setCheckpoint     = nullptr;
+        getCheckpointData = nullptr;
+        entries.clear();
+        openIds.clear();
+    }
+
+
+    void
+    Begin(VkCommandBuffer commandBuffer, const char* name)
+    {
+        if (entries.empty()) return;
+
+        uint32_t id    = nextId++;
+        Entry&   entry = entries[id % GPU_BREADCRUMB_SLOTS];
+        entry.id   = id;
+        entry.name = name;
+        openIds.push_back(id);
+
+        if (setCheckpoint)
+        {
+            setCheckpoint(commandBuffer, CheckpointMarker(id, false));
+        }
+        else
+        {
+            vkCmdFillBuffer(commandBuffer, markerBuffer, SlotOffset(id), sizeof(uint32_t), id);
+        }
+    }
+
+
+    void
+    End(VkCommandBuffer commandBuffer)
+    {
+        if (entries.empty()) return;
+        if (openIds.empty())
+        {
+            throw std::runtime_error("[ ERROR ] GpuBreadcrumbs::End() without a matching Begin().");
+        }
+
+        uint32_t id = openIds.back();
+        openIds.pop_back();
+
+        if (setCheckpoint)
+        {
+            setCheckpoint(commandBuffer, CheckpointMarker(id, true));
+            return;
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 0, nullptr);
+        vkCmdFillBuffer(commandBuffer, markerBuffer, SlotOffset(id) + sizeof(uint32_t), sizeof(uint32_t), id);
+    }
+
+
+    // Checks a queue submission or wait result; dumps the markers on VK_ERROR_DEVICE_LOST.
+    // Returns result so it can wrap the call.
+    VkResult
+    Check(VkResult result)
+    {
+        if (result == VK_ERROR_DEVICE_LOST) Dump(std::cerr);
+        return result;
+    }
+
+
+    void
+    Dump(std::ostream& stream) const
+    {
+        if (entries.empty()) return;
+
+        stream << "[ ERROR ] Device lost, GPU breadcrumbs of " << queueName << " (" << nextId - 1
+               << " markers recorded):\n";
+        if (getCheckpointData) DumpCheckpoints(stream);
+        else                   DumpMarkerBuffer(stream);
+        stream.flush();
+    }
+
+
+private:
+    struct Entry
+    {
+        uint32_t    id   = 0; // 0: slot never used
+        const char* name = nullptr;
+    };
+
+
+    static void*
+    CheckpointMarker(uint32_t id, bool end)
+    {
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(id) << 1 | (end ? 1u : 0u));
+    }
+
+
+    static VkDeviceSize
+    SlotOffset(uint32_t id)
+    {
+        return 2 * (id % GPU_BREADCRUMB_SLOTS) * sizeof(uint32_t);
+    }
+
+
+    const char*
+    NameOf(uint32_t id) const
+    {
+        const Entry& entry = entries[id % GPU_BREADCRUMB_SLOTS];
+        return entry.id == id && entry.name ? entry.name : "(overwritten)";
+    }
+
+
+    void
+    DumpCheckpoints(std::ostream& stream) const
+    {
+        uint32_t count = 0;
+        getCheckpointData(queue, &count, nullptr);
+        std::vector<VkCheckpointDataNV> checkpoints(count);
+        for (auto& checkpoint : checkpoints)
+        {
+            checkpoint       = {};
+            checkpoint.sType = VK_STRUCTURE_TYPE_CHECKPOINT_DATA_NV;
+        }
+        getCheckpointData(queue, &count, checkpoints.data());
+
+        if (count == 0)
+        {
+            stream << "[ ERROR ]     no checkpoint was reached.\n";
+        }
+        for (uint32_t ii = 0; ii < count; ii++)
+        {
+            uintptr_t marker = reinterpret_cast<uintptr_t>(checkpoints[ii].pCheckpointMarker);
+            uint32_t  id     = static_cast<uint32_t>(marker >> 1);
+            stream << "[ ERROR ]     stage 0x" << std::hex << checkpoints[ii].stage << std::dec << " last reached "
+                   << ((marker & 1) ? "end" : "begin") << " of #" << id << " " << NameOf(id) << "\n";
+        }
+    }
+
+
+    void
+    DumpMarkerBuffer(std::ostream& stream) const
+    {
+        std::vector<uint32_t> completed;
+        std::vector<uint32_t> inFlight;
+        uint32_t              firstPending = 0;
+        for (const Entry& entry : entries)
+        {
+            if (entry.id == 0) continue;
+
+            uint32_t slot  = entry.id % GPU_BREADCRUMB_SLOTS;
+            bool     begun = markers[2 * slot] == entry.id;
+            bool     ended = markers[2 * slot + 1] == entry.id;
+            if (ended)      completed.push_back(entry.id);
+            else if (begun) inFlight.push_back(entry.id);
+            else if (firstPending == 0 || entry.id < firstPending) firstPending = entry.id;
+        }
+        std::sort(completed.begin(), completed.end());
+        std::sort(inFlight.begin(), inFlight.end());
+
+        size_t firstShown = completed.size() > GPU_BREADCRUMB_DUMP_COMPLETED ? completed.size() - GPU_BREADCRUMB_DUMP_COMPLETED : 0;
+        for (size_t ii = firstShown; ii < completed.size(); ii++)
+        {
+            stream << "[ ERROR ]     completed #" << completed[ii] << " " << NameOf(completed[ii]) << "\n";
+        }
+        for (uint32_t id : inFlight)
+        {
+            stream << "[ ERROR ]     in flight #" << id << " " << NameOf(id) << "\n";
+        }
+        if (firstPending != 0)
+        {
+            stream << "[ ERROR ]     not started #" << firstPending << " " << NameOf(firstPending) << " and later\n";
+        }
+    }
+
+
+    VkDevice                       device            = VK_NULL_HANDLE;
+    VkQueue                        queue             = VK_NULL_HANDLE;
+    std::string                    queueName;
+    PFN_vkCmdSetCheckpointNV       setCheckpoint     = nullptr;
+    PFN_vkGetQueueCheckpointDataNV getCheckpointData = nullptr;
+    VkBuffer                       markerBuffer      = VK_NULL_HANDLE;
+    VkDeviceMemory                 markerMemory      = VK_NULL_HANDLE;
+    volatile uint32_t*             markers           = nullptr; // Begin, end word per slot
+    std::vector<Entry>             entries;
+    std::vector<uint32_t>          openIds;
+    uint32_t                       nextId            = 1;
+};
+
+
+// Marks the lifetime of the object, e.g. one pass:
+//   { GpuBreadcrumb breadcrumb(breadcrumbs, commandBuffer, "Shadows"); ... }
+class GpuBreadcrumb
+{
+public:
+    GpuBreadcrumb(GpuBreadcrumbs& queueBreadcrumbs, VkCommandBuffer markedCommandBuffer, const char* name)
+        : breadcrumbs(queueBreadcrumbs), commandBuffer(markedCommandBuffer)
+    {
+        breadcrumbs.Begin(commandBuffer, name);
+    }
+
+
+    ~GpuBreadcrumb()
+    {
+        breadcrumbs.End(commandBuffer);
+    }
+
+
+    GpuBreadcrumb(const GpuBreadcrumb&) = delete;
+    GpuBreadcrumb& operator=(const GpuBreadcrumb&) = delete;
+
+
+private:
+    GpuBreadcrumbs& breadcrumbs;
+    VkCommandBuffer commandBuffer;
+};
+
+#endif // GPU_BREADCRUMBS_H
@@ -0,0 +1,186 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+// Shared pieces of the compute culling passes (ClusterCulling.h and the GPU driven scene
+// path): the per view uniform block, its CPU side setup and GLSL helpers for frustum,
+// normal cone and Hi-Z occlusion tests against bounding spheres.
+//
+// Conventions: right handed view space looking down -Z, GLM_FORCE_DEPTH_ZERO_TO_ONE style
+// projection, and a depth pyramid whose texels hold the farthest depth of their footprint
+// (max reduction, 1.0 = far plane), as built by DepthPyramid.h.
+
+#include <vulkan/vulkan.h>
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+
+#include "VulkanUtilities.h"
+
+#include <cmath>
+#include <cstdint>
+
+
+// std140 mirror of CullingView in GPU_CULLING_GLSL.
+struct GpuCullingView
+{
+    glm::mat4 view;
+    glm::vec4 frustumPlanes[6];  // xyz = inward normal, w = distance, world space
+    glm::vec4 cameraPosition;    // xyz world space
+    glm::vec4 projection;        // P[0][0], P[1][1], P[2][2], P[3][2]
+    glm::vec4 pyramid;           // width, height, level count, 1 if occlusion culling is enabled
+    glm::vec4 nearPlane;         // x = near plane distance
+};
+static_assert(sizeof(GpuCullingView) == 224, "GpuCullingView must match its std140 layout.");
+
+
+// Gribb/Hartmann plane extraction for a zero-to-one depth range clip space.
+inline void
+ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+    planes[0] = row3 + row0; // Left
+    planes[1] = row3 - row0; // Right
+    planes[2] = row3 + row1; // Bottom
+    planes[3] = row3 - row1; // Top
+    planes[4] = row2;        // Near
+    planes[5] = row3 - row2; // Far
+
+    for (int ii = 0; ii < 6; ii++)
+    {
+        planes[ii] /= glm::length(glm::vec3(planes[ii]));
+    }
+}
+
+
+// pyramidLevels == 0 disables the occlusion test.
+inline GpuCullingView
+MakeGpuCullingView(const glm::mat4& view,
+                   const glm::mat4& projection,
+                   const glm::vec3& cameraPosition,
+                   float            nearPlane,
+                   uint32_t         pyramidWidth = 0,
+                   uint32_t         pyramidHeight = 0,
+                   uint32_t         pyramidLevels = 0)
+{
+    GpuCullingView cullingView = {};
+    cullingView.view = view;
+    ExtractFrustumPlanes(projection * view, cullingView.frustumPlanes);
+    cullingView.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+    cullingView.projection     = glm::vec4(projection[0][0], projection[1][1], projection[2][2], projection[3][2]);
+    cullingView.pyramid        = glm::vec4(static_cast<float>(pyramidWidth), static_cast<float>(pyramidHeight),
+                                           static_cast<float>(pyramidLevels), pyramidLevels ? 1.0f : 0.0f);
+    cullingView.nearPlane      = glm::vec4(nearPlane, 0.0f, 0.0f, 0.0f);
+    return cullingView;
+}
+
+
+// 1x1 R32_SFLOAT pyramid cleared to the far plane, bound by culling passes whenever no
+// real pyramid exists yet (the descriptor must still be valid). Ends in
+// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+inline void
+RecordDummyDepthPyramid(VkPhysicalDevice physicalDevice,
+                        VkDevice         device,
+                        VkCommandBuffer  commandBuffer,
+                        VkImage&         image,
+                        VkDeviceMemory&  memory,
+                        VkImageView&     view)
+{
+    CreateImage2D(physicalDevice, device, VK_FORMAT_R32_SFLOAT, 1, 1, 1,
+                  VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, image, memory);
+    view = CreateImageView2D(device, image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1);
+
+    ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1,
+                 VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkClearColorValue       farPlane = { { 1.0f, 1.0f, 1.0f, 1.0f } };
+    VkImageSubresourceRange range    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    vkCmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &farPlane, 1, &range);
+
+    ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+}
+
+
+// Included right after "#version 450" by every culling shader. The depth pyramid is passed
+// to SphereOccluded() and must be sampled with nearest filtering and clamp to edge.
+const char* const GPU_CULLING_GLSL = R"GLSL(
+struct CullingView
+{
+    mat4 view;
+    vec4 frustumPlanes[6];
+    vec4 cameraPosition;
+    vec4 projection;
+    vec4 pyramid;
+    vec4 nearPlane;
+};
+
+bool SphereInFrustum(CullingView cullingView, vec3 center, float radius)
+{
+    for (int ii = 0; ii < 6; ii++)
+    {
+        if (dot(cullingView.frustumPlanes[ii].xyz, center) + cullingView.frustumPlanes[ii].w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Cone of the cluster's triangle normals: apex, axis and cos(half angle + 90 degrees).
+// Every triangle is back facing when the camera is inside the inverted cone.
+bool ConeBackfacing(CullingView cullingView, vec3 apex, vec3 axis, float cutoff)
+{
+    return dot(normalize(apex - cullingView.cameraPosition.xyz), axis) >= cutoff;
+}
+
+// Extents of x/z for a circle (c, z) of radius r seen from the origin, z > r.
+vec2 ProjectSphereAxis(float c, float z, float r)
+{
+    float t = sqrt(c * c + z * z - r * r);
+    return vec2((c * t - r * z) / (z * t + r * c), (c * t + r * z) / (z * t - r * c));
+}
+
+// Returns true when the sphere is certainly hidden behind the depth pyramid.
+bool SphereOccluded(CullingView cullingView, sampler2D pyramid, vec3 center, float radius)
+{
+    if (cullingView.pyramid.w == 0.0)
+    {
+        return false;
+    }
+
+    vec3  viewCenter = (cullingView.view * vec4(center, 1.0)).xyz;
+    float distance   = -viewCenter.z;
+    if (distance - radius < cullingView.nearPlane.x)
+    {
+        return false; // Crosses the near plane, no conservative projection
+    }
+
+    vec2 rangeX = ProjectSphereAxis(viewCenter.x, distance, radius) * cullingView.projection.x;
+    vec2 rangeY = ProjectSphereAxis(viewCenter.y, distance, radius) * cullingView.projection.y;
+    vec4 ndc    = vec4(min(rangeX.x, rangeX.y), min(rangeY.x, rangeY.y), max(rangeX.x, rangeX.y), max(rangeY.x, rangeY.y));
+    vec4 uv     = clamp(ndc * 0.5 + 0.5, 0.0, 1.0);
+
+    // Pick the level where the rectangle covers at most 2x2 texels.
+    vec2  size  = (uv.zw - uv.xy) * cullingView.pyramid.xy;
+    float level = min(ceil(log2(max(max(size.x, size.y), 1.0))), cullingView.pyramid.z - 1.0);
+
+    float farthest = max(max(textureLod(pyramid, uv.xy, level).r, textureLod(pyramid, uv.zy, level).r),
+                         max(textureLod(pyramid, uv.xw, level).r, textureLod(pyramid, uv.zw, level).r));
+
+    // Depth of the sphere's closest point, same projection as the depth buffer.
+    float nearestZ     = -(distance - radius);
+    float nearestDepth = (cullingView.projection.z * nearestZ + cullingView.projection.w) / -nearestZ;
+    return nearestDepth > farthest;
+}
+)GLSL";
+
+#endif // GPU_CULLING_H
@@ -0,0 +1,361 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+// GPU timestamp profiler with named, nested scopes.
+//
+// Every frame in flight owns a query pool. BeginScope()/EndScope() write a timestamp pair
+// into the current frame's pool; BeginFrame() for a frame index first reads back the
+// results that pool collected framesInFlight frames ago. The caller has already waited on
+// that frame's fence, so the readback never stalls.
+//
+// Pools are reset from the host with VK_EXT_host_query_reset when it is enabled, otherwise
+// with vkCmdResetQueryPool at the start of the frame's command buffer. Ticks are converted
+// to milliseconds with VkPhysicalDeviceLimits::timestampPeriod.
+//
+// Statistics are kept per scope path ("Frame/Shadows/Cascade 0") over the last
+// GPU_PROFILER_HISTORY frames. Queues without timestamp support turn every call into a
+// no-op.
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanUtilities.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+const uint32_t GPU_PROFILER_MAX_SCOPES = 256; // Per frame
+const uint32_t GPU_PROFILER_HISTORY    = 128; // Frames of rolling statistics
+
+
+struct GpuScopeStatistics
+{
+    std::string path;
+    std::string name;
+    uint32_t    depth       = 0;
+    uint32_t    sampleCount = 0; // Up to GPU_PROFILER_HISTORY
+    double      minMs       = 0.0;
+    double      avgMs       = 0.0;
+    double      maxMs       = 0.0;
+    double      lastMs      = 0.0;
+};
+
+
+class GpuProfiler
+{
+public:
+    // Raw device timestamps of every scope as it is read back (see Tracing.h).
+    typedef std::function<void(const char* name, uint64_t begin, uint64_t end)> TimestampCallback;
+
+
+    // hostQueryReset: VK_EXT_host_query_reset is enabled with its hostQueryReset feature.
+    void
+    Create(VkPhysicalDevice gpu,
+           VkDevice         logicalDevice,
+           uint32_t         queueFamilyIndex,
+           uint32_t         framesInFlight,
+           bool             hostQueryReset)
+    {
+        device = logicalDevice;
+
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(gpu, &properties);
+        timestampPeriod = properties.limits.timestampPeriod;
+
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queueFamilyCount, queueFamilies.data());
+
+        uint32_t validBits = queueFamilyIndex < queueFamilyCount ? queueFamilies[queueFamilyIndex].timestampValidBits : 0;
+        if (validBits == 0)
+        {
+            std::cout << "[ INFO ] GPU profiler disabled: the queue does not support timestamps." << std::endl;
+            return;
+        }
+        timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        if (hostQueryReset)
+        {
+            resetQueryPool = LoadDeviceFunction<PFN_vkResetQueryPoolEXT>(device, "vkResetQueryPoolEXT");
+        }
+
+        frames.resize(framesInFlight);
+        for (auto& frame : frames)
+        {
+            VkQueryPoolCreateInfo poolInfo = {};
+            poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount = 2 * GPU_PROFILER_MAX_SCOPES;
+            if (vkCreateQueryPool(device, &poolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to create GPU profiler query pool.");
+            }
+
+            // Queries start out undefined; later resets happen after each readback.
+            if (resetQueryPool) resetQueryPool(device, frame.queryPool, 0, 2 * GPU_PROFILER_MAX_SCOPES);
+            else                frame.needsReset = true;
+        }
+    }
+
+
+    void
+    Destroy()
+    {
+        for (auto& frame : frames)
+        {
+            if (frame.queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, frame.queryPool, nullptr);
+        }
+        frames.clear();
+        openScopes.clear();
+    }
+
+
+    // First call in frameIndex's command buffer, outside a render pass, once the frame's
+    // fence has been waited on. Collects the results the frame recorded last time.
+    void
+    BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+    {
+        if (frames.empty()) return;
+        if (!openScopes.empty())
+        {
+            throw std::runtime_error("[ ERROR ] GPU profiler scope left open at the end of a frame.");
+        }
+
+        currentFrame = frameIndex;
+        Frame& frame = frames[frameIndex];
+        Collect(frame);
+
+        if (resetQueryPool)
+        {
+            resetQueryPool(device, frame.queryPool, 0, 2 * GPU_PROFILER_MAX_SCOPES);
+        }
+        else if (frame.needsReset || !frame.scopes.empty())
+        {
+            vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, 2 * GPU_PROFILER_MAX_SCOPES);
+        }
+        frame.needsReset = false;
+        frame.scopes.clear();
+    }
+
+
+    // name must outlive the frame's readback; string literals are the intended use.
+    void
+    BeginScope(VkCommandBuffer commandBuffer, const char* name)
+    {
+        if (frames.empty()) return;
+
+        Frame&   frame = frames[currentFrame];
+        uint32_t index = static_cast<uint32_t>(frame.scopes.size());
+        if (index == GPU_PROFILER_MAX_SCOPES)
+        {
+            openScopes.push_back(GPU_PROFILER_MAX_SCOPES); // Dropped, but still balanced
+            return;
+        }
+
+        Scope scope = {};
+        scope.name   = name;
+        scope.parent = openScopes.empty() ? GPU_PROFILER_MAX_SCOPES : openScopes.back();
+        frame.scopes.push_back(scope);
+        openScopes.push_back(index);
+
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, 2 * index);
+    }
+
+
+    void
+    EndScope(VkCommandBuffer commandBuffer)
+    {
+        if (frames.empty()) return;
+        if (openScopes.empty())
+        {
+            throw std::runtime_error("[ ERROR ] GpuProfiler::EndScope() without a matching BeginScope().");
+        }
+
+        uint32_t index = openScopes.back();
+        openScopes.pop_back();
+        if (index == GPU_PROFILER_MAX_SCOPES) return;
+
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames[currentFrame].queryPool,
+                            2 * index + 1);
+    }
+
+
+    void
+    SetTimestampCallback(const TimestampCallback& callback)
+    {
+        timestampCallback = callback;
+    }
+
+
+    // In order of first appearance, which is depth first for a stable frame structure.
+    const std::vector<GpuScopeStatistics>&
+    Statistics() const
+    {
+        return statistics;
+    }
+
+
+    // Same reporting channel as the validation layer messages.
+    void
+    Print() const
+    {
+        for (const auto& scope : statistics)
+        {
+            std::cout << "[ INFO ] GPU " << std::string(2 * scope.depth, ' ') << scope.name << ": avg "
+                      << scope.avgMs << " ms, min " << scope.minMs << " ms, max " << scope.maxMs << " ms ("
+                      << scope.sampleCount << " frames)" << std::endl;
+        }
+    }
+
+
+private:
+    struct Scope
+    {
+        const char* name;
+        uint32_t    parent; // GPU_PROFILER_MAX_SCOPES for top level scopes
+    };
+
+
+    struct Frame
+    {
+        VkQueryPool        queryPool  = VK_NULL_HANDLE;
+        bool               needsReset = false;
+        std::vector<Scope> scopes;
+    };
+
+
+    struct History
+    {
+        double   samples[GPU_PROFILER_HISTORY];
+        uint32_t next = 0;
+    };
+
+
+    void
+    Collect(const Frame& frame)
+    {
+        if (frame.scopes.empty()) return;
+
+        // Pairs of (timestamp, availability) for begin and end of every scope.
+        const uint32_t        queryCount = 2 * static_cast<uint32_t>(frame.scopes.size());
+        std::vector<uint64_t> results(2 * queryCount, 0);
+        VkResult result = vkGetQueryPoolResults(device, frame.queryPool, 0, queryCount,
+                                                results.size() * sizeof(uint64_t), results.data(),
+                                                2 * sizeof(uint64_t),
+                                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+        std::vector<uint32_t> statisticIndices(frame.scopes.size());
+        for (size_t ii = 0; ii < frame.scopes.size(); ii++)
+        {
+            const Scope& scope = frame.scopes[ii];
+            std::string  path  = scope.parent == GPU_PROFILER_MAX_SCOPES ?
+                                 std::string(scope.name) :
+                                 statistics[statisticIndices[scope.parent]].path + "/" + scope.name;
+            uint32_t depth = scope.parent == GPU_PROFILER_MAX_SCOPES ?
+                             0 : statistics[statisticIndices[scope.parent]].depth + 1;
+            statisticIndices[ii] = FindStatistics(path, scope.name, depth);
+
+            const uint64_t* begin = &results[4 * ii];
+            const uint64_t* end   = &results[4 * ii + 2];
+            if (begin[1] == 0 || end[1] == 0) continue; // Never executed, e.g. frame skipped
+
+            uint64_t ticks = (end[0] - begin[0]) & timestampMask;
+            AddSample(statisticIndices[ii], static_cast<double>(ticks) * timestampPeriod * 1e-6);
+            if (timestampCallback) timestampCallback(scope.name, begin[0], end[0]);
+        }
+    }
+
+
+    uint32_t
+    FindStatistics(const std::string& path, const char* name, uint32_t depth)
+    {
+        auto found = pathIndices.find(path);
+        if (found != pathIndices.end()) return found->second;
+
+        GpuScopeStatistics scope;
+        scope.path  = path;
+        scope.name  = name;
+        scope.depth = depth;
+        statistics.push_back(scope);
+        histories.push_back(History());
+
+        uint32_t index = static_cast<uint32_t>(statistics.size() - 1);
+        pathIndices[path] = index;
+        return index;
+    }
+
+
+    void
+    AddSample(uint32_t index, double milliseconds)
+    {
+        History&            history = histories[index];
+        GpuScopeStatistics& scope   = statistics[index];
+
+        history.samples[history.next] = milliseconds;
+        history.next                  = (history.next + 1) % GPU_PROFILER_HISTORY;
+        scope.sampleCount             = std::min(scope.sampleCount + 1, GPU_PROFILER_HISTORY);
+        scope.lastMs                  = milliseconds;
+
+        // The last sampleCount samples, newest first.
+        double sum  = 0.0;
+        scope.minMs = 1e30;
+        scope.maxMs = 0.0;
+        for (uint32_t ii = 0; ii < scope.sampleCount; ii++)
+        {
+            double sample = history.samples[(history.next + GPU_PROFILER_HISTORY - 1 - ii) % GPU_PROFILER_HISTORY];
+            sum += sample;
+            scope.minMs = std::min(scope.minMs, sample);
+            scope.maxMs = std::max(scope.maxMs, sample);
+        }
+        scope.avgMs = sum / scope.sampleCount;
+    }
+
+    VkDevice                                  device          = VK_NULL_HANDLE;
+    PFN_vkResetQueryPoolEXT                   resetQueryPool  = nullptr;
+    float                                     timestampPeriod = 1.0f;
+    uint64_t                                  timestampMask   = ~0ull;
+    uint32_t                                  currentFrame    = 0;
+    std::vector<Frame>                        frames;
+    std::vector<uint32_t>                     openScopes;
+    std::vector<GpuScopeStatistics>           statistics;
+    std::vector<History>                      histories;
+    std::unordered_map<std::string, uint32_t> pathIndices;
+    TimestampCallback                         timestampCallback;
+};
+
+
+// Profiles the lifetime of the object, e.g. one pass:
+//   { GpuProfilerScope scope(profiler, commandBuffer, "Shadows"); ... }
+class GpuProfilerScope
+{
+public:
+    GpuProfilerScope(GpuProfiler& gpuProfiler, VkCommandBuffer scopeCommandBuffer, const char* name)
+        : profiler(gpuProfiler), commandBuffer(scopeCommandBuffer)
+    {
+        profiler.BeginScope(commandBuffer, name);
+    }
+
+
+    ~GpuProfilerScope()
+    {
+        profiler.EndScope(commandBuffer);
+    }
+
+
+    GpuProfilerScope(const GpuProfilerScope&) = delete;
+    GpuProfilerScope& operator=(const GpuProfilerScope&) = delete;
+
+
+private:
+    GpuProfiler&    profiler;
+    VkCommandBuffer commandBuffer;
+};
+
+#endif // GPU_PROFILER_H
@@ -0,0 +1,812 @@
+#ifndef GPU_SCENE_H
+#define GPU_SCENE_H
+
+// GPU driven scene submission. Instances are uploaded once; every frame a compute pass
+// culls all of them against the frustum and the previous depth pyramid and compacts the
+// survivors into one indirect command range per material bucket. Recording the frame is
+// then one vkCmdDrawIndexedIndirectCountKHR per bucket, independent of the instance count.
+//
+// All meshes share one vertex and one index buffer owned by the caller; meshes are ranges
+// inside them. The instance buffer is visible to vertex shaders too: a draw's
+// firstInstance is the instance index, so gl_InstanceIndex selects the instance data
+// (GPU_SCENE_INSTANCE_GLSL). This requires the drawIndirectFirstInstance feature.
+//
+// Without VK_KHR_draw_indirect_count the command ranges are cleared every frame and
+// drawn whole; unused slots have indexCount 0.
+//
+// Meshes may carry a LOD chain (MeshSimplifier.h). The culling shader picks each visible
+// instance's LOD by projected error with the same hysteresis rule as SelectLod(), so LOD
+// selection needs no extra pass over the scene. The chosen LOD persists per instance
+// across frames; call SetLodSelection() to enable it.
+//
+// Cull() runs either as one pass against the previous frame's depth pyramid, or as the
+// early and late phases of two phase occlusion culling around DepthPyramid::Build() (see
+// DepthPyramid.h). Per instance visibility from the late phase persists to select the
+// next frame's early phase.
+
+#include <vulkan/vulkan.h>
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+
+#include "GpuCulling.h"
+#include "MeshSimplifier.h"
+#include "ShaderCompiler.h"
+#include "VulkanUtilities.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+
+enum GpuScenePhase
+{
+    GPU_SCENE_PHASE_SINGLE, // Frustum and previous frame's pyramid, visibility untouched
+    GPU_SCENE_PHASE_EARLY,  // Instances visible last frame, frustum only
+    GPU_SCENE_PHASE_LATE    // All instances against this frame's pyramid, except those drawn early
+};
+
+
+// std430 mirror of Instance in GPU_SCENE_INSTANCE_GLSL.
+struct GpuSceneInstance
+{
+    glm::mat4 model;
+    glm::vec4 sphere;   // World space bounding sphere
+    uint32_t  mesh;
+    uint32_t  material;
+    float     maxScale; // Largest axis scale of model, applied to LOD errors
+    uint32_t  padding;
+};
+static_assert(sizeof(GpuSceneInstance) == 96, "GpuSceneInstance must match its std430 layout.");
+
+
+// std430 mirrors of Mesh and Lod in GPU_SCENE_CULLING_GLSL.
+struct GpuSceneMesh
+{
+    uint32_t firstLod;
+    uint32_t lodCount;
+    int32_t  vertexOffset;
+    uint32_t padding;
+};
+
+
+struct GpuSceneLod
+{
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    float    error;
+    uint32_t padding;
+};
+
+
+const char* const GPU_SCENE_INSTANCE_GLSL = R"GLSL(
+struct Instance
+{
+    mat4 model;
+    vec4 sphere;
+    uint mesh;
+    uint material;
+    float maxScale;
+    uint padding;
+};
+)GLSL";
+
+
+const char* const GPU_SCENE_CULLING_GLSL = R"GLSL(
+layout(local_size_x = 64) in;
+
+layout(set = 0, binding = 0) uniform CullingViewBlock
+{
+    CullingView cullingView;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances
+{
+    Instance instances[];
+};
+
+struct Mesh
+{
+    uint firstLod;
+    uint lodCount;
+    int  vertexOffset;
+    uint padding;
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Meshes
+{
+    Mesh meshes[];
+};
+
+layout(std430, set = 0, binding = 3) readonly buffer Buckets
+{
+    uint bucketFirstCommand[];
+};
+
+layout(std430, set = 0, binding = 4) buffer Counts
+{
+    uint bucketDrawCount[];
+};
+
+struct DrawCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 5) writeonly buffer Draws
+{
+    DrawCommand draws[];
+};
+
+layout(set = 0, binding = 6) uniform sampler2D depthPyramid;
+
+struct Lod
+{
+    uint  indexCount;
+    uint  firstIndex;
+    float error;
+    uint  padding;
+};
+
+layout(std430, set = 0, binding = 7) readonly buffer Lods
+{
+    Lod lods[];
+};
+
+layout(std430, set = 0, binding = 8) buffer InstanceLods
+{
+    uint instanceLod[];
+};
+
+layout(std430, set = 0, binding = 9) buffer InstanceVisibility
+{
+    uint instanceVisible[];
+};
+
+const uint PHASE_SINGLE = 0;
+const uint PHASE_EARLY  = 1;
+const uint PHASE_LATE   = 2;
+
+layout(push_constant) uniform PushConstants
+{
+    uint  instanceCount;
+    float lodPixelScale; // |P[1][1]| * viewport height / 2, 0 disables LOD selection
+    float lodThreshold;  // Pixels
+    float lodHysteresis;
+    uint  phase;
+} pc;
+
+// Same rule as SelectLod() in MeshSimplifier.h.
+uint SelectLod(Mesh mesh, Instance instance, uint currentLod)
+{
+    if (pc.lodPixelScale <= 0.0)
+    {
+        return 0;
+    }
+
+    float distance      = max(length(instance.sphere.xyz - cullingView.cameraPosition.xyz) - instance.sphere.w,
+                              cullingView.nearPlane.x);
+    float pixelsPerUnit = instance.maxScale * pc.lodPixelScale / distance;
+    uint  lod           = min(currentLod, mesh.lodCount - 1);
+
+    while (lod > 0 && lods[mesh.firstLod + lod].error * pixelsPerUnit > pc.lodThreshold)
+    {
+        lod--;
+    }
+    while (lod + 1 < mesh.lodCount &&
+           lods[mesh.firstLod + lod + 1].error * pixelsPerUnit <= pc.lodThreshold * pc.lodHysteresis)
+    {
+        lod++;
+    }
+    return lod;
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= pc.instanceCount)
+    {
+        return;
+    }
+
+    Instance instance = instances[id];
+    bool     visible  = SphereInFrustum(cullingView, instance.sphere.xyz, instance.sphere.w);
+    if (pc.phase == PHASE_EARLY)
+    {
+        visible = visible && instanceVisible[id] != 0;
+    }
+    else if (visible)
+    {
+        visible = !SphereOccluded(cullingView, depthPyramid, instance.sphere.xyz, instance.sphere.w);
+    }
+
+    if (pc.phase == PHASE_LATE)
+    {
+        // Visible last frame and in the frustum means already drawn by the early phase.
+        bool drawnEarly = instanceVisible[id] != 0;
+        instanceVisible[id] = visible ? 1 : 0;
+        visible = visible && !drawnEarly;
+    }
+
+    if (!visible)
+    {
+        return;
+    }
+
+    Mesh mesh = meshes[instance.mesh];
+    uint lod  = SelectLod(mesh, instance, instanceLod[id]);
+    Lod  range = lods[mesh.firstLod + lod];
+    instanceLod[id] = lod;
+
+    uint slot = atomicAdd(bucketDrawCount[instance.material], 1);
+    draws[bucketFirstCommand[instance.material] + slot] =
+        DrawCommand(range.indexCount, 1, range.firstIndex, mesh.vertexOffset, id);
+}
+)GLSL";
+
+
+class GpuScene
+{
+public:
+    void
+    Create(VkPhysicalDevice gpu,
+           VkDevice         logicalDevice,
+           uint32_t         framesInFlight,
+           bool             drawIndirectCount,
+           bool             multiDrawIndirect)
+    {
+        physicalDevice     = gpu;
+        device             = logicalDevice;
+        frameCount         = framesInFlight;
+        multiDrawSupported = multiDrawIndirect;
+        if (drawIndirectCount)
+        {
+            drawIndexedIndirectCount = LoadDeviceFunction<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                device, "vkCmdDrawIndexedIndirectCountKHR");
+        }
+
+        const VkDescriptorType types[GPU_SCENE_BINDINGS] =
+        {
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+        };
+
+        VkDescriptorSetLayoutBinding bindings[GPU_SCENE_BINDINGS] = {};
+        for (uint32_t ii = 0; ii < GPU_SCENE_BINDINGS; ii++)
+        {
+            bindings[ii].binding         = ii;
+            bindings[ii].descriptorType  = types[ii];
+            bindings[ii].descriptorCount = 1;
+            bindings[ii].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = GPU_SCENE_BINDINGS;
+        layoutInfo.pBindings    = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create GPU scene descriptor set layout.");
+        }
+
+        VkPushConstantRange pushRange = {};
+        pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushRange.size       = sizeof(PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = 1;
+        pipelineLayoutInfo.pSetLayouts            = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create GPU scene pipeline layout.");
+        }
+
+        pipeline = CreateComputePipeline(device, pipelineLayout,
+                                         std::string("#version 450\n") + GPU_CULLING_GLSL +
+                                         GPU_SCENE_INSTANCE_GLSL + GPU_SCENE_CULLING_GLSL,
+                                         "GpuSceneCulling.comp");
+
+        VkDescriptorPoolSize poolSizes[3] = {};
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSizes[0].descriptorCount = framesInFlight;
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = 8 * framesInFlight;
+        poolSizes[2].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[2].descriptorCount = framesInFlight;
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = framesInFlight;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes    = poolSizes;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create GPU scene descriptor pool.");
+        }
+
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod       = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create GPU scene sampler.");
+        }
+    }
+
+
+    void
+    Destroy()
+    {
+        for (auto& frame : frames)
+        {
+            vkDestroyBuffer(device, frame.viewBuffer, nullptr);
+            vkFreeMemory(device, frame.viewMemory, nullptr);
+            vkDestroyBuffer(device, frame.countBuffer, nullptr);
+            vkFreeMemory(device, frame.countMemory, nullptr);
+            vkDestroyBuffer(device, frame.drawBuffer, nullptr);
+            vkFreeMemory(device, frame.drawMemory, nullptr);
+        }
+        frames.clear();
+
+        ReleaseStaging();
+        DestroyBuffer(instanceBuffer, instanceMemory);
+        DestroyBuffer(meshBuffer, meshMemory);
+        DestroyBuffer(bucketBuffer, bucketMemory);
+        DestroyBuffer(lodBuffer, lodMemory);
+        DestroyBuffer(instanceLodBuffer, instanceLodMemory);
+        DestroyBuffer(visibilityBuffer, visibilityMemory);
+        if (dummyPyramidView != VK_NULL_HANDLE) vkDestroyImageView(device, dummyPyramidView, nullptr);
+        if (dummyPyramid != VK_NULL_HANDLE) vkDestroyImage(device, dummyPyramid, nullptr);
+        if (dummyPyramidMemory != VK_NULL_HANDLE) vkFreeMemory(device, dummyPyramidMemory, nullptr);
+        if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline, nullptr);
+        if (sampler != VK_NULL_HANDLE) vkDestroySampler(device, sampler, nullptr);
+        if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        dummyPyramidView   = VK_NULL_HANDLE;
+        dummyPyramid       = VK_NULL_HANDLE;
+        dummyPyramidMemory = VK_NULL_HANDLE;
+        pipeline           = VK_NULL_HANDLE;
+        sampler            = VK_NULL_HANDLE;
+        descriptorPool     = VK_NULL_HANDLE;
+        pipelineLayout     = VK_NULL_HANDLE;
+        setLayout          = VK_NULL_HANDLE;
+    }
+
+
+    // localSphere: object space bounding sphere (xyz = center, w = radius).
+    uint32_t
+    AddMesh(uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset, const glm::vec4& localSphere)
+    {
+        MeshLod lod = { 0, indexCount, 0.0f };
+        return AddMesh(&lod, 1, firstIndex, vertexOffset, localSphere);
+    }
+
+
+    // LOD chain whose indices were placed at firstIndex of the shared index buffer
+    // (MeshLodChain::indices); lods[0] must be the full detail mesh.
+    uint32_t
+    AddMesh(const MeshLod* lods, uint32_t lodCount, uint32_t firstIndex, int32_t vertexOffset,
+            const glm::vec4& localSphere)
+    {
+        GpuSceneMesh mesh = { static_cast<uint32_t>(meshLods.size()), lodCount, vertexOffset, 0 };
+        for (uint32_t ii = 0; ii < lodCount; ii++)
+        {
+            GpuSceneLod lod = { lods[ii].indexCount, firstIndex + lods[ii].firstIndex, lods[ii].error, 0 };
+            meshLods.push_back(lod);
+        }
+
+        meshes.push_back(mesh);
+        meshSpheres.push_back(localSphere);
+        return static_cast<uint32_t>(meshes.size() - 1);
+    }
+
+
+    // Enables LOD selection: the coarsest LOD whose error projects to at most
+    // thresholdPixels is drawn; see SelectLod() for the hysteresis.
+    void
+    SetLodSelection(float viewportHeight, float thresholdPixels = 1.0f, float hysteresis = 0.75f)
+    {
+        lodViewportHeight = viewportHeight;
+        lodThreshold      = thresholdPixels;
+        lodHysteresis     = hysteresis;
+    }
+
+
+    // material is the bucket index passed to DrawBucket().
+    uint32_t
+    AddInstance(const glm::mat4& model, uint32_t mesh, uint32_t material)
+    {
+        if (mesh >= meshes.size())
+        {
+            throw std::runtime_error("[ ERROR ] GPU scene instance references an unknown mesh.");
+        }
+
+        const glm::vec4& local    = meshSpheres[mesh];
+        float            maxScale = std::max(glm::length(glm::vec3(model[0])),
+                                             std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+        GpuSceneInstance instance = {};
+        instance.model    = model;
+        instance.sphere   = glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(local), 1.0f)), local.w * maxScale);
+        instance.mesh     = mesh;
+        instance.material = material;
+        instance.maxScale = maxScale;
+        instances.push_back(instance);
+
+        bucketCount = std::max(bucketCount, material + 1);
+        return static_cast<uint32_t>(instances.size() - 1);
+    }
+
+
+    // Records the one time upload of meshes and instances. Call ReleaseStaging() once the
+    // command buffer has completed.
+    void
+    Upload(VkCommandBuffer commandBuffer)
+    {
+        if (instances.empty() || instanceBuffer != VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("[ ERROR ] GpuScene::Upload() expects instances and is called once.");
+        }
+
+        // Each bucket gets as many command slots as it has instances.
+        bucketCapacity.assign(bucketCount, 0);
+        for (const auto& instance : instances) bucketCapacity[instance.material]++;
+
+        bucketFirstCommand.assign(bucketCount, 0);
+        for (uint32_t bucket = 1; bucket < bucketCount; bucket++)
+        {
+            bucketFirstCommand[bucket] = bucketFirstCommand[bucket - 1] + bucketCapacity[bucket - 1];
+        }
+
+        staging.resize(4);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, instances.data(),
+                           instances.size() * sizeof(GpuSceneInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           instanceBuffer, instanceMemory, staging[0]);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, meshes.data(),
+                           meshes.size() * sizeof(GpuSceneMesh), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           meshBuffer, meshMemory, staging[1]);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, bucketFirstCommand.data(),
+                           bucketFirstCommand.size() * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           bucketBuffer, bucketMemory, staging[2]);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, meshLods.data(),
+                           meshLods.size() * sizeof(GpuSceneLod), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           lodBuffer, lodMemory, staging[3]);
+
+        // Every instance starts at full detail.
+        CreateBuffer(physicalDevice, device, instances.size() * sizeof(uint32_t),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceLodBuffer, instanceLodMemory);
+        vkCmdFillBuffer(commandBuffer, instanceLodBuffer, 0, VK_WHOLE_SIZE, 0);
+
+        // Nothing counts as visible before the first late phase, which then draws everything
+        // in the frustum.
+        CreateBuffer(physicalDevice, device, instances.size() * sizeof(uint32_t),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, visibilityBuffer, visibilityMemory);
+        vkCmdFillBuffer(commandBuffer, visibilityBuffer, 0, VK_WHOLE_SIZE, 0);
+
+        VkMemoryBarrier uploadBarrier = {};
+        uploadBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        uploadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        uploadBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                             0, 1, &uploadBarrier, 0, nullptr, 0, nullptr);
+
+        frames.resize(frameCount);
+        for (auto& frame : frames)
+        {
+            CreateBuffer(physicalDevice, device, sizeof(GpuCullingView), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         frame.viewBuffer, frame.viewMemory);
+            if (vkMapMemory(device, frame.viewMemory, 0, sizeof(GpuCullingView), 0, &frame.viewMapped) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to map GPU scene view buffer.");
+            }
+
+            CreateBuffer(physicalDevice, device, bucketCount * sizeof(uint32_t),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.countBuffer, frame.countMemory);
+            CreateBuffer(physicalDevice, device, instances.size() * sizeof(VkDrawIndexedIndirectCommand),
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.drawBuffer, frame.drawMemory);
+
+            VkDescriptorSetAllocateInfo allocateInfo = {};
+            allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocateInfo.descriptorPool     = descriptorPool;
+            allocateInfo.descriptorSetCount = 1;
+            allocateInfo.pSetLayouts        = &setLayout;
+            if (vkAllocateDescriptorSets(device, &allocateInfo, &frame.descriptorSet) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to allocate GPU scene descriptor set.");
+            }
+        }
+
+        RecordDummyDepthPyramid(physicalDevice, device, commandBuffer, dummyPyramid, dummyPyramidMemory,
+                                dummyPyramidView);
+    }
+
+
+    void
+    ReleaseStaging()
+    {
+        for (auto& buffer : staging)
+        {
+            buffer.Destroy(device);
+        }
+        staging.clear();
+    }
+
+
+    // Records a culling pass. The fence of frameIndex must have been waited on. depthPyramid
+    // as for ClusterCuller::Cull().
+    //
+    // For two phase culling record, in order: Cull(GPU_SCENE_PHASE_EARLY), the bucket draws,
+    // DepthPyramid::Build(), Cull(GPU_SCENE_PHASE_LATE) and the bucket draws again, loading
+    // the early depth. Both phases take the same depthPyramid (DepthPyramid::View()) so the
+    // descriptor set is not rewritten between them; the late phase reuses the early
+    // phase's view.
+    void
+    Cull(VkCommandBuffer       commandBuffer,
+         uint32_t              frameIndex,
+         const GpuCullingView& view,
+         VkImageView           depthPyramid,
+         GpuScenePhase         phase = GPU_SCENE_PHASE_SINGLE)
+    {
+        Frame& frame = frames[frameIndex];
+        if (phase != GPU_SCENE_PHASE_LATE)
+        {
+            memcpy(frame.viewMapped, &view, sizeof(view));
+        }
+
+        VkImageView pyramidView = depthPyramid != VK_NULL_HANDLE ? depthPyramid : dummyPyramidView;
+        if (pyramidView != frame.boundPyramid)
+        {
+            WriteDescriptors(frame, pyramidView);
+        }
+
+        if (phase == GPU_SCENE_PHASE_LATE)
+        {
+            // The early phase's draws still read the command buffers about to be cleared.
+            VkMemoryBarrier reuseBarrier = {};
+            reuseBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            reuseBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            reuseBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &reuseBarrier, 0, nullptr, 0, nullptr);
+        }
+
+        vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, VK_WHOLE_SIZE, 0);
+        if (!drawIndexedIndirectCount)
+        {
+            vkCmdFillBuffer(commandBuffer, frame.drawBuffer, 0, VK_WHOLE_SIZE, 0);
+        }
+
+        // Also orders earlier passes' writes to the shared per instance LOD and visibility state.
+        VkMemoryBarrier clearBarrier = {};
+        clearBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+        PushConstants constants = {};
+        constants.instanceCount = static_cast<uint32_t>(instances.size());
+        constants.lodPixelScale = std::fabs(view.projection.y) * lodViewportHeight * 0.5f;
+        constants.lodThreshold  = lodThreshold;
+        constants.lodHysteresis = lodHysteresis;
+        constants.phase         = static_cast<uint32_t>(phase);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                                0, 1, &frame.descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(constants), &constants);
+        vkCmdDispatch(commandBuffer, (constants.instanceCount + 63) / 64, 1, 1);
+
+        VkMemoryBarrier cullBarrier = {};
+        cullBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                             0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+    }
+
+
+    // Inside a render pass with the bucket's pipeline, descriptor sets and the shared
+    // vertex and index buffers bound.
+    void
+    DrawBucket(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t bucket) const
+    {
+        if (bucket >= bucketCount || bucketCapacity[bucket] == 0) return;
+
+        const Frame&   frame  = frames[frameIndex];
+        const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+        VkDeviceSize   offset = static_cast<VkDeviceSize>(bucketFirstCommand[bucket]) * stride;
+
+        if (drawIndexedIndirectCount)
+        {
+            drawIndexedIndirectCount(commandBuffer, frame.drawBuffer, offset,
+                                     frame.countBuffer, bucket * sizeof(uint32_t), bucketCapacity[bucket], stride);
+        }
+        else if (multiDrawSupported)
+        {
+            vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer, offset, bucketCapacity[bucket], stride);
+        }
+        else
+        {
+            for (uint32_t ii = 0; ii < bucketCapacity[bucket]; ii++)
+            {
+                vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer, offset + ii * stride, 1, stride);
+            }
+        }
+    }
+
+
+    // Bind as a read only storage buffer to read GPU_SCENE_INSTANCE_GLSL instances in
+    // vertex shaders.
+    VkBuffer
+    InstanceBuffer() const
+    {
+        return instanceBuffer;
+    }
+
+
+    uint32_t
+    BucketCount() const
+    {
+        return bucketCount;
+    }
+
+
+    uint32_t
+    InstanceCount() const
+    {
+        return static_cast<uint32_t>(instances.size());
+    }
+
+
+private:
+    static const uint32_t GPU_SCENE_BINDINGS = 10;
+
+
+    struct PushConstants
+    {
+        uint32_t instanceCount;
+        float    lodPixelScale;
+        float    lodThreshold;
+        float    lodHysteresis;
+        uint32_t phase;
+    };
+
+
+    struct Frame
+    {
+        VkBuffer        viewBuffer    = VK_NULL_HANDLE;
+        VkDeviceMemory  viewMemory    = VK_NULL_HANDLE;
+        void*           viewMapped    = nullptr;
+        VkBuffer        countBuffer   = VK_NULL_HANDLE;
+        VkDeviceMemory  countMemory   = VK_NULL_HANDLE;
+        VkBuffer        drawBuffer    = VK_NULL_HANDLE;
+        VkDeviceMemory  drawMemory    = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkImageView     boundPyramid  = VK_NULL_HANDLE;
+    };
+
+
+    void
+    DestroyBuffer(VkBuffer& buffer, VkDeviceMemory& memory)
+    {
+        if (buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, buffer, nullptr);
+        if (memory != VK_NULL_HANDLE) vkFreeMemory(device, memory, nullptr);
+        buffer = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
+    }
+
+
+    void
+    WriteDescriptors(Frame& frame, VkImageView pyramidView)
+    {
+        VkDescriptorBufferInfo bufferInfos[GPU_SCENE_BINDINGS] =
+        {
+            { frame.viewBuffer,  0, sizeof(GpuCullingView) },
+            { instanceBuffer,    0, VK_WHOLE_SIZE },
+            { meshBuffer,        0, VK_WHOLE_SIZE },
+            { bucketBuffer,      0, VK_WHOLE_SIZE },
+            { frame.countBuffer, 0, VK_WHOLE_SIZE },
+            { frame.drawBuffer,  0, VK_WHOLE_SIZE },
+            {},
+            { lodBuffer,         0, VK_WHOLE_SIZE },
+            { instanceLodBuffer, 0, VK_WHOLE_SIZE },
+            { visibilityBuffer,  0, VK_WHOLE_SIZE }
+        };
+        VkDescriptorImageInfo pyramidInfo = { sampler, pyramidView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+        VkWriteDescriptorSet writes[GPU_SCENE_BINDINGS] = {};
+        for (uint32_t ii = 0; ii < GPU_SCENE_BINDINGS; ii++)
+        {
+            writes[ii].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[ii].dstSet          = frame.descriptorSet;
+            writes[ii].dstBinding      = ii;
+            writes[ii].descriptorCount = 1;
+            writes[ii].descriptorType  = ii == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[ii].pBufferInfo     = &bufferInfos[ii];
+        }
+        writes[6].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[6].pBufferInfo    = nullptr;
+        writes[6].pImageInfo     = &pyramidInfo;
+        vkUpdateDescriptorSets(device, GPU_SCENE_BINDINGS, writes, 0, nullptr);
+
+        frame.boundPyramid = pyramidView;
+    }
+
+    VkPhysicalDevice                     physicalDevice           = VK_NULL_HANDLE;
+    VkDevice                             device                   = VK_NULL_HANDLE;
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+    bool                                 multiDrawSupported       = false;
+    uint32_t                             frameCount               = 0;
+    VkDescriptorSetLayout                setLayout                = VK_NULL_HANDLE;
+    VkPipelineLayout                     pipelineLayout           = VK_NULL_HANDLE;
+    VkPipeline                           pipeline                 = VK_NULL_HANDLE;
+    VkDescriptorPool                     descriptorPool           = VK_NULL_HANDLE;
+    VkSampler                            sampler                  = VK_NULL_HANDLE;
+    VkBuffer                             instanceBuffer           = VK_NULL_HANDLE;
+    VkDeviceMemory                       instanceMemory           = VK_NULL_HANDLE;
+    VkBuffer                             meshBuffer               = VK_NULL_HANDLE;
+    VkDeviceMemory                       meshMemory               = VK_NULL_HANDLE;
+    VkBuffer                             bucketBuffer             = VK_NULL_HANDLE;
+    VkDeviceMemory                       bucketMemory             = VK_NULL_HANDLE;
+    VkBuffer                             lodBuffer                = VK_NULL_HANDLE;
+    VkDeviceMemory                       lodMemory                = VK_NULL_HANDLE;
+    VkBuffer                             instanceLodBuffer        = VK_NULL_HANDLE;
+    VkDeviceMemory                       instanceLodMemory        = VK_NULL_HANDLE;
+    VkBuffer                             visibilityBuffer         = VK_NULL_HANDLE;
+    VkDeviceMemory                       visibilityMemory         = VK_NULL_HANDLE;
+    VkImage                              dummyPyramid             = VK_NULL_HANDLE;
+    VkDeviceMemory                       dummyPyramidMemory       = VK_NULL_HANDLE;
+    VkImageView                          dummyPyramidView         = VK_NULL_HANDLE;
+    uint32_t                             bucketCount              = 0;
+    float                                lodViewportHeight        = 0.0f;
+    float                                lodThreshold             = 1.0f;
+    float                                lodHysteresis            = 0.75f;
+    std::vector<GpuSceneMesh>            meshes;
+    std::vector<GpuSceneLod>             meshLods;
+    std::vector<glm::vec4>               meshSpheres;
+    std::vector<GpuSceneInstance>        instances;
+    std::vector<uint32_t>                bucketCapacity;
+    std::vector<uint32_t>                bucketFirstCommand;
+    std::vector<Frame>                   frames;
+    std::vector<StagingBuffer>           staging;
+};
+
+#endif // GPU_SCENE_H
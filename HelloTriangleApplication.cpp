@@ -1,8 +1,20 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+// Before every other project header so that their Vulkan calls are tracked as well.
+#include "VulkanObjectTracker.h"
+
+#include "Ktx2Loader.h"
+#include "Metrics.h"
+#include "MetricsEndpoint.h"
+#include "PipelineTelemetry.h"
+#include "ValidationMessageRouter.h"
+#include "VulkanUtilities.h"
+
 #include <iostream>
+#include <algorithm>
 #include <stdexcept>
+#include <chrono>
 #include <functional>
 #include <cstdlib>
 #include <vector>
@@ -17,6 +29,32 @@ const std::vector<const char*> validationLayers =
     "VK_LAYER_KHRONOS_validation"
 };
 
+// Enabled whenever the device supports them; code built on top checks
+// IsDeviceExtensionEnabled() and falls back otherwise.
+const std::vector<const char*> optionalDeviceExtensions =
+{
+    VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME,
+    VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,
+    VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME,
+    VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,
+    VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME
+};
+
+// The optional device extensions above that depend on VK_KHR_get_physical_device_properties2.
+// The instance stays at Vulkan 1.0, so they are only enabled when it has that extension.
+const std::vector<const char*> properties2DeviceExtensions =
+{
+    VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME,
+    VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME,
+    VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME
+};
+
+// Frame statistics in the window title, and served in Prometheus text format on a Unix
+// socket next to the executable (see MetricsEndpoint.h).
+const bool        enableMetricsOverlay  = true;
+const bool        enableMetricsEndpoint = true;
+const char* const METRICS_SOCKET_PATH   = "hello_triangle_metrics.sock";
+
 #ifdef NDEBUG
 const bool enableValidationLayers = false;
 #else
@@ -120,15 +158,10 @@ private:
                   void*                                       pUserData)
     {
         if (pUserData && messageType) {} // Silence unused arguments warning
-        if (messageSeverity == VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
-        {
-            std::cout << "[ INFO ] Validation layer: " << pCallbackData->pMessage << std::endl;
-        }
-        else
-        {
-            std::cerr << "[ ERROR ] Validation layer: " << pCallbackData->pMessage << std::endl;
-        }
-        return VK_FALSE; // Determines if the calling Vulkan function should be aborted
+
+        // Deduplicated, rate limited and written by the router's logger thread. Always
+        // VK_FALSE, which determines if the calling Vulkan function should be aborted.
+        return ValidationMessageRouter::Instance().Route(messageSeverity, pCallbackData);
     }
 
 
@@ -211,9 +244,6 @@ private:
 
             // We're adding these optional extensions. The GLFW ones are always required.
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-
-            createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
-            createInfo.ppEnabledExtensionNames = extensions.data();
         }
         else
         {
@@ -222,6 +252,16 @@ private:
             createInfo.pNext = nullptr;
         }
 
+        // Needed by the device extensions in properties2DeviceExtensions.
+        properties2Enabled = InstanceExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        if (properties2Enabled)
+        {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
+
         if (vkCreateInstance(&createInfo, nullptr, &vulkanInstance) != VK_SUCCESS)
         {
             throw std::runtime_error("[ ERROR ] Failed to create a Vulkan instance.");
@@ -320,7 +360,33 @@ private:
         // Specify device features
         // [ cfarvin::TODO ] Come back to this when we want to do more than
         // the initial setup.
+        VkPhysicalDeviceFeatures supportedFeatures = {};
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+        // Enable every block compression family the device has so that textures can be
+        // uploaded pre-compressed.
         VkPhysicalDeviceFeatures deviceFeatures = {};
+        deviceFeatures.textureCompressionBC       = supportedFeatures.textureCompressionBC;
+        deviceFeatures.textureCompressionETC2     = supportedFeatures.textureCompressionETC2;
+        deviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+
+        // GPU driven culling writes many indirect draws that carry their own instance index.
+        deviceFeatures.multiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+        for (const char* extension : optionalDeviceExtensions)
+        {
+            bool needsProperties2 = std::any_of(properties2DeviceExtensions.begin(), properties2DeviceExtensions.end(),
+                                                [extension](const char* name) { return strcmp(name, extension) == 0; });
+            if (needsProperties2 && !properties2Enabled)
+            {
+                continue;
+            }
+            if (DeviceExtensionSupported(physicalDevice, extension))
+            {
+                enabledDeviceExtensions.push_back(extension);
+            }
+        }
 
         // Specify logical device properties
         VkDeviceCreateInfo createInfo = {};
@@ -328,7 +394,30 @@ private:
         createInfo.pQueueCreateInfos = &queueCreateInfo;
         createInfo.queueCreateInfoCount = 1;
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = 0;
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledDeviceExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledDeviceExtensions.data();
+
+        // Lets query pools be reset from the host with vkResetQueryPoolEXT. The feature is
+        // required of every device exposing the extension.
+        VkPhysicalDeviceHostQueryResetFeaturesEXT hostQueryResetFeatures = {};
+        hostQueryResetFeatures.sType          = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT;
+        hostQueryResetFeatures.hostQueryReset = VK_TRUE;
+        if (IsDeviceExtensionEnabled(VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME))
+        {
+            hostQueryResetFeatures.pNext = const_cast<void*>(createInfo.pNext);
+            createInfo.pNext             = &hostQueryResetFeatures;
+        }
+
+        // Driver statistics per pipeline for PipelineTelemetry; likewise required with the
+        // extension.
+        VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR executableFeatures = {};
+        executableFeatures.sType                  = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR;
+        executableFeatures.pipelineExecutableInfo = VK_TRUE;
+        if (IsDeviceExtensionEnabled(VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME))
+        {
+            executableFeatures.pNext = const_cast<void*>(createInfo.pNext);
+            createInfo.pNext         = &executableFeatures;
+        }
 
         if (enableValidationLayers)
         {
@@ -347,6 +436,32 @@ private:
         }
 
         vkGetDeviceQueue(device, GRAPHICAL_AND_PRESENT_QUEUE_FAMILY_INDEX, 0, &graphicsQueue);
+
+        if (VULKAN_OBJECT_TRACKER)
+        {
+            VulkanObjectTracker::Instance().Attach(vulkanInstance, physicalDevice, device);
+        }
+
+        PipelineTelemetry::Instance().Enable(device,
+                                             IsDeviceExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME),
+                                             IsDeviceExtensionEnabled(VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME));
+
+        // Format support never changes for a device; query it once here.
+        textureFormats.Query(physicalDevice, deviceFeatures);
+    }
+
+
+    bool
+    IsDeviceExtensionEnabled(const char* extensionName) const
+    {
+        for (const char* extension : enabledDeviceExtensions)
+        {
+            if (strcmp(extension, extensionName) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
     }
 
 
@@ -363,6 +478,11 @@ private:
     void
     InitVulkan()
     {
+        if (enableValidationLayers)
+        {
+            ValidationMessageRouter::Instance().Start();
+        }
+
         CreateVulkanInstance();
 
         if (enableValidationLayers)
@@ -373,15 +493,35 @@ private:
         CreateSurface();
         FindGraphicsCompatibleDevice();
         CreateLogicalDevice();
+
+        frameMetrics.Create();
+        frameMetrics.SetHeapSizes(physicalDevice);
+        if (enableMetricsEndpoint)
+        {
+            metricsEndpoint.Start(METRICS_SOCKET_PATH);
+        }
     }
 
 
     void
     MainLoop()
     {
+        auto frameStart  = std::chrono::steady_clock::now();
+        auto lastOverlay = frameStart;
         while(!glfwWindowShouldClose(window))
         {
             glfwPollEvents();
+
+            auto now = std::chrono::steady_clock::now();
+            frameMetrics.EndFrame(std::chrono::duration<double>(now - frameStart).count());
+            frameStart = now;
+
+            if (enableMetricsOverlay && now - lastOverlay >= std::chrono::milliseconds(250))
+            {
+                std::string title = "HelloTriangleApplication | " + frameMetrics.OverlayText();
+                glfwSetWindowTitle(window, title.c_str());
+                lastOverlay = now;
+            }
         }
     }
 
@@ -389,15 +529,26 @@ private:
     void
     Cleanup()
     {
+        metricsEndpoint.Stop();
+
         // Vulkan cleanup
         if (enableValidationLayers)
         {
             DestroyDebugUtilsMessengerEXT(vulkanInstance, debugMessenger, nullptr);
         }
 
+        PipelineTelemetry::Instance().PrintSummary();
+        PipelineTelemetry::Instance().WriteReport("pipeline_report.json");
+        PipelineTelemetry::Instance().Disable();
+        if (VULKAN_OBJECT_TRACKER)
+        {
+            VulkanObjectTracker::Instance().PrintSummary();
+            VulkanObjectTracker::Instance().Detach();
+        }
         vkDestroyDevice(device, nullptr);
         vkDestroySurfaceKHR(vulkanInstance, surface, nullptr);
         vkDestroyInstance(vulkanInstance, nullptr);
+        ValidationMessageRouter::Instance().Stop();
 
         // GLFW Cleanup
         glfwDestroyWindow(window);
@@ -413,6 +564,11 @@ private:
     uint32_t                 PRESENT_QUEUE_FMAILY_INDEX;
     VkQueue                  graphicsQueue;
     VkSurfaceKHR             surface;
+    TextureFormatSupport     textureFormats;
+    std::vector<const char*> enabledDeviceExtensions;
+    bool                     properties2Enabled = false;
+    FrameMetrics             frameMetrics;
+    MetricsEndpoint          metricsEndpoint;
 };
 
 
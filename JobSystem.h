@@ -0,0 +1,218 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+// Minimal fork/join job system: a fixed pool of worker threads that cooperatively run the
+// chunks of one ParallelFor() at a time. The calling thread works on its own batch too,
+// so a pool with zero workers simply runs everything inline.
+//
+// ParallelFor() called from inside a job runs serially on that thread instead of
+// deadlocking on the pool.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+
+class JobSystem
+{
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+
+    // workerCount == 0 uses one worker per hardware thread, minus the calling thread.
+    explicit JobSystem(uint32_t workerCount = 0)
+    {
+        if (workerCount == 0)
+        {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+
+        for (uint32_t ii = 0; ii < workerCount; ii++)
+        {
+            workers.emplace_back(&JobSystem::WorkerLoop, this);
+        }
+    }
+
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(batchMutex);
+            stopRequested = true;
+        }
+        batchReady.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+
+    // Threads that run jobs, including the caller of ParallelFor().
+    uint32_t
+    ThreadCount() const
+    {
+        return static_cast<uint32_t>(workers.size()) + 1;
+    }
+
+
+    // Calls function(begin, end) over [0, count) in chunks of at most grainSize and
+    // returns once every chunk has run.
+    void
+    ParallelFor(size_t count, size_t grainSize, const RangeFunction& function)
+    {
+        if (count == 0) return;
+        grainSize = std::max<size_t>(grainSize, 1);
+
+        if (workers.empty() || count <= grainSize || InsideJob())
+        {
+            function(0, count);
+            return;
+        }
+
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        {
+            std::lock_guard<std::mutex> lock(batchMutex);
+            batchFunction   = &function;
+            batchCount      = count;
+            batchGrain      = grainSize;
+            batchChunks     = (count + grainSize - 1) / grainSize;
+            nextChunk       = 0;
+            completedChunks = 0;
+            batchGeneration++;
+        }
+        batchReady.notify_all();
+
+        InsideJob() = true;
+        size_t finished = RunChunks(function, count, grainSize, batchChunks);
+        InsideJob() = false;
+
+        std::unique_lock<std::mutex> lock(batchMutex);
+        completedChunks += finished;
+        batchDone.wait(lock, [this]() { return completedChunks == batchChunks && activeWorkers == 0; });
+        batchFunction = nullptr;
+
+        // Exceptions thrown by a chunk on any thread resurface on the caller.
+        if (batchException)
+        {
+            std::exception_ptr exception = batchException;
+            batchException = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+
+    // Splits [0, count) evenly into one range per thread; useful when each range needs
+    // its own scratch state (e.g. per-thread output buffers indexed by the range).
+    size_t
+    RangeCount(size_t count, size_t minimumPerRange) const
+    {
+        minimumPerRange = std::max<size_t>(minimumPerRange, 1);
+        size_t ranges   = std::min<size_t>(ThreadCount() * 4, (count + minimumPerRange - 1) / minimumPerRange);
+        return std::max<size_t>(ranges, 1);
+    }
+
+
+private:
+    static bool&
+    InsideJob()
+    {
+        static thread_local bool insideJob = false;
+        return insideJob;
+    }
+
+
+    // Returns the number of chunks this thread ran.
+    size_t
+    RunChunks(const RangeFunction& function, size_t count, size_t grainSize, size_t chunkCount)
+    {
+        size_t finished = 0;
+        for (;;)
+        {
+            size_t chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount) break;
+
+            size_t begin = chunk * grainSize;
+            try
+            {
+                function(begin, std::min(begin + grainSize, count));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(batchMutex);
+                if (!batchException) batchException = std::current_exception();
+            }
+            finished++;
+        }
+        return finished;
+    }
+
+
+    void
+    WorkerLoop()
+    {
+        InsideJob() = true;
+        uint64_t seenGeneration = 0;
+        for (;;)
+        {
+            const RangeFunction* function   = nullptr;
+            size_t               count      = 0;
+            size_t               grainSize  = 0;
+            size_t               chunkCount = 0;
+            {
+                std::unique_lock<std::mutex> lock(batchMutex);
+                batchReady.wait(lock, [this, seenGeneration]()
+                                {
+                                    return stopRequested || (batchFunction && batchGeneration != seenGeneration);
+                                });
+                if (stopRequested) return;
+
+                // The batch cannot be torn down while this worker is registered in it.
+                seenGeneration = batchGeneration;
+                function       = batchFunction;
+                count          = batchCount;
+                grainSize      = batchGrain;
+                chunkCount     = batchChunks;
+                activeWorkers++;
+            }
+
+            size_t finished = RunChunks(*function, count, grainSize, chunkCount);
+
+            std::lock_guard<std::mutex> lock(batchMutex);
+            completedChunks += finished;
+            activeWorkers--;
+            if (completedChunks == batchChunks && activeWorkers == 0)
+            {
+                batchDone.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex               submitMutex;
+    std::mutex               batchMutex;
+    std::condition_variable  batchReady;
+    std::condition_variable  batchDone;
+    const RangeFunction*     batchFunction   = nullptr;
+    size_t                   batchCount      = 0;
+    size_t                   batchGrain      = 1;
+    size_t                   batchChunks     = 0;
+    std::atomic<size_t>      nextChunk{ 0 };
+    size_t                   completedChunks = 0;
+    uint32_t                 activeWorkers   = 0;
+    uint64_t                 batchGeneration = 0;
+    std::exception_ptr       batchException;
+    bool                     stopRequested   = false;
+};
+
+#endif // JOB_SYSTEM_H
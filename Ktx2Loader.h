@@ -0,0 +1,427 @@
+#ifndef KTX2_LOADER_H
+#define KTX2_LOADER_H
+
+// KTX2 container loading with block compressed format negotiation.
+//
+// TextureFormatSupport is filled once when the logical device is created and answers
+// every "can this device sample format X" question from its cache afterwards. Textures are
+// shipped in one KTX2 file per compression family (name.bc7.ktx2, name.astc.ktx2, ...);
+// the loader picks the best family the device supports and uploads the pre-compressed
+// mip chain as is. Supercompressed (Basis Universal / zstd) files are not supported.
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanUtilities.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+
+enum TextureCompressionFamily : uint32_t
+{
+    TEXTURE_COMPRESSION_BC   = 0,
+    TEXTURE_COMPRESSION_ASTC = 1,
+    TEXTURE_COMPRESSION_ETC2 = 2,
+    TEXTURE_COMPRESSION_NONE = 3,
+    TEXTURE_COMPRESSION_FAMILY_COUNT
+};
+
+
+// File name suffixes of each family, see ChooseKtx2Variant().
+const char* const TEXTURE_COMPRESSION_SUFFIXES[TEXTURE_COMPRESSION_FAMILY_COUNT] =
+{
+    ".bc7.ktx2",
+    ".astc.ktx2",
+    ".etc2.ktx2",
+    ".rgba8.ktx2"
+};
+
+
+class TextureFormatSupport
+{
+public:
+    // enabledFeatures must be the features the logical device was created with; compressed
+    // formats are only usable when their textureCompression* feature is enabled.
+    void
+    Query(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceFeatures& enabledFeatures)
+    {
+        const VkFormat candidates[] =
+        {
+            VK_FORMAT_BC1_RGB_UNORM_BLOCK,  VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+            VK_FORMAT_BC1_RGBA_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK,
+            VK_FORMAT_BC2_UNORM_BLOCK,      VK_FORMAT_BC2_SRGB_BLOCK,
+            VK_FORMAT_BC3_UNORM_BLOCK,      VK_FORMAT_BC3_SRGB_BLOCK,
+            VK_FORMAT_BC4_UNORM_BLOCK,      VK_FORMAT_BC4_SNORM_BLOCK,
+            VK_FORMAT_BC5_UNORM_BLOCK,      VK_FORMAT_BC5_SNORM_BLOCK,
+            VK_FORMAT_BC6H_UFLOAT_BLOCK,    VK_FORMAT_BC6H_SFLOAT_BLOCK,
+            VK_FORMAT_BC7_UNORM_BLOCK,      VK_FORMAT_BC7_SRGB_BLOCK,
+
+            VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,   VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,
+            VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK,
+            VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,
+            VK_FORMAT_EAC_R11_UNORM_BLOCK,       VK_FORMAT_EAC_R11G11_UNORM_BLOCK,
+
+            VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_4x4_SRGB_BLOCK,
+            VK_FORMAT_ASTC_6x6_UNORM_BLOCK, VK_FORMAT_ASTC_6x6_SRGB_BLOCK,
+            VK_FORMAT_ASTC_8x8_UNORM_BLOCK, VK_FORMAT_ASTC_8x8_SRGB_BLOCK,
+
+            VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB
+        };
+
+        const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+        supported.clear();
+        for (VkFormat format : candidates)
+        {
+            TextureCompressionFamily family = FamilyOf(format);
+            if (family == TEXTURE_COMPRESSION_BC && !enabledFeatures.textureCompressionBC) continue;
+            if (family == TEXTURE_COMPRESSION_ETC2 && !enabledFeatures.textureCompressionETC2) continue;
+            if (family == TEXTURE_COMPRESSION_ASTC && !enabledFeatures.textureCompressionASTC_LDR) continue;
+
+            VkFormatProperties properties = {};
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+            if ((properties.optimalTilingFeatures & required) == required)
+            {
+                supported.push_back(format);
+            }
+        }
+        std::sort(supported.begin(), supported.end());
+    }
+
+
+    bool
+    IsSupported(VkFormat format) const
+    {
+        return std::binary_search(supported.begin(), supported.end(), format);
+    }
+
+
+    // Families in order of preference: BC7 (desktop), ASTC 4x4, ETC2 and finally RGBA8.
+    // Only families whose flagship format is supported are listed.
+    std::vector<TextureCompressionFamily>
+    PreferredFamilies() const
+    {
+        std::vector<TextureCompressionFamily> families;
+        if (IsSupported(VK_FORMAT_BC7_UNORM_BLOCK))           families.push_back(TEXTURE_COMPRESSION_BC);
+        if (IsSupported(VK_FORMAT_ASTC_4x4_UNORM_BLOCK))      families.push_back(TEXTURE_COMPRESSION_ASTC);
+        if (IsSupported(VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK)) families.push_back(TEXTURE_COMPRESSION_ETC2);
+        families.push_back(TEXTURE_COMPRESSION_NONE);
+        return families;
+    }
+
+
+    static TextureCompressionFamily
+    FamilyOf(VkFormat format)
+    {
+        if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK)
+        {
+            return TEXTURE_COMPRESSION_BC;
+        }
+        if (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK)
+        {
+            return TEXTURE_COMPRESSION_ETC2;
+        }
+        if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+        {
+            return TEXTURE_COMPRESSION_ASTC;
+        }
+        return TEXTURE_COMPRESSION_NONE;
+    }
+
+
+private:
+    std::vector<VkFormat> supported;
+};
+
+
+struct Ktx2Level
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+
+// A parsed KTX2 file. Level data is not copied: LevelData() points into the buffer given
+// to ParseKtx2(), which may be a mapped file or archive payload.
+struct Ktx2Texture
+{
+    VkFormat               format;
+    uint32_t               width;
+    uint32_t               height;
+    uint32_t               depth;
+    uint32_t               layerCount;
+    uint32_t               faceCount;
+    uint32_t               levelCount;
+    std::vector<Ktx2Level> levels;
+    const uint8_t*         data;
+    size_t                 size;
+
+    const uint8_t*
+    LevelData(uint32_t level) const
+    {
+        return data + levels[level].byteOffset;
+    }
+};
+
+
+// Texel block of format: its footprint in texels and its size in bytes. Uncompressed
+// formats have 1x1 blocks. Returns false for formats the loader does not know.
+inline bool
+Ktx2FormatBlock(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockBytes)
+{
+    // ASTC UNORM/SRGB pairs, from VK_FORMAT_ASTC_4x4_UNORM_BLOCK on.
+    const uint32_t astcFootprints[14][2] =
+    {
+        { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+        { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+    };
+
+    blockWidth  = 1;
+    blockHeight = 1;
+    blockBytes  = 0;
+    if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+    {
+        const uint32_t* footprint = astcFootprints[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+        blockWidth  = footprint[0];
+        blockHeight = footprint[1];
+        blockBytes  = 16;
+        return true;
+    }
+    if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK)
+    {
+        bool eightBytes = format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK ||
+                          format == VK_FORMAT_BC4_UNORM_BLOCK || format == VK_FORMAT_BC4_SNORM_BLOCK ||
+                          (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK) ||
+                          format == VK_FORMAT_EAC_R11_UNORM_BLOCK || format == VK_FORMAT_EAC_R11_SNORM_BLOCK;
+        blockWidth  = 4;
+        blockHeight = 4;
+        blockBytes  = eightBytes ? 8 : 16;
+        return true;
+    }
+
+    if      (format >= VK_FORMAT_R8_UNORM && format <= VK_FORMAT_R8_SRGB)                       blockBytes = 1;
+    else if (format >= VK_FORMAT_R8G8_UNORM && format <= VK_FORMAT_R8G8_SRGB)                   blockBytes = 2;
+    else if (format >= VK_FORMAT_R8G8B8A8_UNORM && format <= VK_FORMAT_A2B10G10R10_SINT_PACK32) blockBytes = 4;
+    else if (format >= VK_FORMAT_R16_UNORM && format <= VK_FORMAT_R16_SFLOAT)                   blockBytes = 2;
+    else if (format >= VK_FORMAT_R16G16_UNORM && format <= VK_FORMAT_R16G16_SFLOAT)             blockBytes = 4;
+    else if (format >= VK_FORMAT_R16G16B16A16_UNORM && format <= VK_FORMAT_R16G16B16A16_SFLOAT) blockBytes = 8;
+    else if (format >= VK_FORMAT_R32_UINT && format <= VK_FORMAT_R32_SFLOAT)                    blockBytes = 4;
+    else if (format >= VK_FORMAT_R32G32_UINT && format <= VK_FORMAT_R32G32_SFLOAT)              blockBytes = 8;
+    else if (format >= VK_FORMAT_R32G32B32A32_UINT && format <= VK_FORMAT_R32G32B32A32_SFLOAT)  blockBytes = 16;
+    else if (format == VK_FORMAT_B10G11R11_UFLOAT_PACK32 || format == VK_FORMAT_E5B9G9R9_UFLOAT_PACK32) blockBytes = 4;
+    return blockBytes != 0;
+}
+
+
+inline Ktx2Texture
+ParseKtx2(const uint8_t* data, size_t size)
+{
+    const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const size_t  headerSize     = 80;
+
+    if (size < headerSize || memcmp(data, identifier, sizeof(identifier)) != 0)
+    {
+        throw std::runtime_error("[ ERROR ] Not a KTX2 file.");
+    }
+
+    uint32_t fields[9] = {};
+    memcpy(fields, data + sizeof(identifier), sizeof(fields));
+
+    Ktx2Texture texture = {};
+    texture.format     = static_cast<VkFormat>(fields[0]);
+    texture.width      = fields[2];
+    texture.height     = fields[3];
+    texture.depth      = std::max(fields[4], 1u);
+    texture.layerCount = std::max(fields[5], 1u);
+    texture.faceCount  = fields[6];
+    texture.levelCount = std::max(fields[7], 1u);
+    texture.data       = data;
+    texture.size       = size;
+
+    uint32_t supercompressionScheme = fields[8];
+    if (supercompressionScheme != 0 || texture.format == VK_FORMAT_UNDEFINED)
+    {
+        throw std::runtime_error("[ ERROR ] Supercompressed KTX2 files are not supported.");
+    }
+
+    // 1D textures (height 0) are not supported either; every upload path is 2D.
+    if (texture.width == 0 || texture.height == 0)
+    {
+        throw std::runtime_error("[ ERROR ] KTX2 texture has a zero width or height.");
+    }
+
+    uint32_t largest   = std::max(std::max(texture.width, texture.height), texture.depth);
+    uint32_t fullChain = 1;
+    while ((largest >> fullChain) > 0) fullChain++;
+    if (texture.levelCount > fullChain)
+    {
+        throw std::runtime_error("[ ERROR ] KTX2 texture has more levels than its size allows.");
+    }
+
+    uint32_t blockWidth  = 1;
+    uint32_t blockHeight = 1;
+    uint32_t blockBytes  = 0;
+    if (!Ktx2FormatBlock(texture.format, blockWidth, blockHeight, blockBytes))
+    {
+        throw std::runtime_error("[ ERROR ] KTX2 texture format is not supported.");
+    }
+
+    if (size < headerSize + static_cast<size_t>(texture.levelCount) * sizeof(Ktx2Level))
+    {
+        throw std::runtime_error("[ ERROR ] KTX2 level index is truncated.");
+    }
+
+    texture.levels.resize(texture.levelCount);
+    memcpy(texture.levels.data(), data + headerSize, texture.levels.size() * sizeof(Ktx2Level));
+    for (uint32_t ii = 0; ii < texture.levelCount; ii++)
+    {
+        const Ktx2Level& level = texture.levels[ii];
+        if (level.byteOffset > size || level.byteLength > size - level.byteOffset)
+        {
+            throw std::runtime_error("[ ERROR ] KTX2 level data is out of bounds.");
+        }
+
+        // Every layer, face and slice of the level, so copies of it stay inside its data.
+        uint64_t blocksX  = (std::max(texture.width >> ii, 1u) + blockWidth - 1) / blockWidth;
+        uint64_t blocksY  = (std::max(texture.height >> ii, 1u) + blockHeight - 1) / blockHeight;
+        uint64_t required = blocksX * blocksY * blockBytes * std::max(texture.depth >> ii, 1u) *
+                            texture.layerCount * std::max(texture.faceCount, 1u);
+        if (level.byteLength < required)
+        {
+            throw std::runtime_error("[ ERROR ] KTX2 level " + std::to_string(ii) + " is smaller than its format requires.");
+        }
+    }
+
+    return texture;
+}
+
+
+// Returns basePath + suffix of the most preferred family with an existing file, e.g.
+// "textures/brick" -> "textures/brick.bc7.ktx2".
+inline std::string
+ChooseKtx2Variant(const TextureFormatSupport& formatSupport, const std::string& basePath)
+{
+    for (TextureCompressionFamily family : formatSupport.PreferredFamilies())
+    {
+        std::string path = basePath + TEXTURE_COMPRESSION_SUFFIXES[family];
+        if (std::ifstream(path, std::ios::binary))
+        {
+            return path;
+        }
+    }
+
+    throw std::runtime_error("[ ERROR ] No KTX2 variant of " + basePath + " is usable on this device.");
+}
+
+
+struct Ktx2Image
+{
+    VkImage        image  = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView    view   = VK_NULL_HANDLE;
+    VkFormat       format = VK_FORMAT_UNDEFINED;
+    uint32_t       levels = 0;
+};
+
+
+// Bytes of staging memory UploadKtx2() needs for the texture.
+inline VkDeviceSize
+Ktx2StagingSize(const Ktx2Texture& texture)
+{
+    VkDeviceSize total = 0;
+    for (const auto& level : texture.levels)
+    {
+        total = ((total + 15) & ~VkDeviceSize(15)) + level.byteLength;
+    }
+    return total;
+}
+
+
+// Creates the image and records the upload of the whole mip chain into commandBuffer.
+// Level data is copied from the KTX2 buffer straight into the mapped staging memory at
+// stagingOffset; the staging buffer must stay alive until the commands have executed.
+inline Ktx2Image
+UploadKtx2(VkPhysicalDevice            physicalDevice,
+           VkDevice                    device,
+           const TextureFormatSupport& formatSupport,
+           const Ktx2Texture&          texture,
+           VkCommandBuffer             commandBuffer,
+           VkBuffer                    stagingBuffer,
+           void*                       stagingMapped,
+           VkDeviceSize                stagingOffset)
+{
+    if (texture.depth != 1 || texture.layerCount != 1 || texture.faceCount != 1)
+    {
+        throw std::runtime_error("[ ERROR ] Only 2D KTX2 textures are supported.");
+    }
+
+    if (!formatSupport.IsSupported(texture.format))
+    {
+        throw std::runtime_error("[ ERROR ] KTX2 texture format is not supported by the device.");
+    }
+
+    std::vector<VkBufferImageCopy> copies(texture.levelCount);
+    VkDeviceSize cursor = stagingOffset;
+    for (uint32_t level = 0; level < texture.levelCount; level++)
+    {
+        // 16 byte alignment satisfies the texel block size of every candidate format.
+        cursor = (cursor + 15) & ~VkDeviceSize(15);
+        memcpy(static_cast<uint8_t*>(stagingMapped) + cursor,
+               texture.LevelData(level),
+               static_cast<size_t>(texture.levels[level].byteLength));
+
+        VkBufferImageCopy& copy = copies[level];
+        copy = {};
+        copy.bufferOffset                = cursor;
+        copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copy.imageSubresource.mipLevel   = level;
+        copy.imageSubresource.layerCount = 1;
+        copy.imageExtent                 = { std::max(texture.width >> level, 1u),
+                                             std::max(texture.height >> level, 1u),
+                                             1 };
+        cursor += texture.levels[level].byteLength;
+    }
+
+    Ktx2Image result = {};
+    result.format = texture.format;
+    result.levels = texture.levelCount;
+    CreateImage2D(physicalDevice, device, texture.format, texture.width, texture.height, texture.levelCount,
+                  VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                  result.image, result.memory);
+    result.view = CreateImageView2D(device, result.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT,
+                                    0, texture.levelCount);
+
+    ImageBarrier(commandBuffer, result.image, VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.levelCount,
+                 VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, result.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(copies.size()), copies.data());
+
+    ImageBarrier(commandBuffer, result.image, VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.levelCount,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                 VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    return result;
+}
+
+
+inline void
+DestroyKtx2Image(VkDevice device, Ktx2Image& image)
+{
+    if (image.view != VK_NULL_HANDLE) vkDestroyImageView(device, image.view, nullptr);
+    if (image.image != VK_NULL_HANDLE) vkDestroyImage(device, image.image, nullptr);
+    if (image.memory != VK_NULL_HANDLE) vkFreeMemory(device, image.memory, nullptr);
+    image = Ktx2Image();
+}
+
+#endif // KTX2_LOADER_H
@@ -0,0 +1,148 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Read-only memory mapping of a whole file (MapViewOfFile / mmap). An empty file is a valid
+// empty mapping: Size() is 0 and Data() is nullptr, since neither API maps zero bytes.
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdexcept>
+#include <string>
+#include <cstdint>
+
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+
+    void
+    Open(const std::string& path)
+    {
+        Close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to open file: " + path);
+        }
+
+        LARGE_INTEGER fileSize = {};
+        if (!GetFileSizeEx(fileHandle, &fileSize))
+        {
+            Close();
+            throw std::runtime_error("[ ERROR ] Failed to query file size: " + path);
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+        if (size == 0)
+        {
+            CloseHandle(fileHandle);
+            fileHandle = INVALID_HANDLE_VALUE;
+            return;
+        }
+
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle)
+        {
+            data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        int fileDescriptor = open(path.c_str(), O_RDONLY);
+        if (fileDescriptor < 0)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to open file: " + path);
+        }
+
+        struct stat fileStat = {};
+        if (fstat(fileDescriptor, &fileStat) != 0)
+        {
+            close(fileDescriptor);
+            throw std::runtime_error("[ ERROR ] Failed to query file size: " + path);
+        }
+        size = static_cast<size_t>(fileStat.st_size);
+        if (size == 0)
+        {
+            close(fileDescriptor);
+            return;
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        close(fileDescriptor); // The mapping keeps its own reference to the file
+        if (mapping != MAP_FAILED)
+        {
+            // Mapped files are usually consumed front to back.
+            madvise(mapping, size, MADV_WILLNEED);
+            data = static_cast<const uint8_t*>(mapping);
+        }
+#endif
+        if (!data)
+        {
+            Close();
+            throw std::runtime_error("[ ERROR ] Failed to map file: " + path);
+        }
+    }
+
+
+    void
+    Close()
+    {
+#ifdef _WIN32
+        if (data) { UnmapViewOfFile(data); }
+        if (mappingHandle) { CloseHandle(mappingHandle); }
+        if (fileHandle != INVALID_HANDLE_VALUE) { CloseHandle(fileHandle); }
+        mappingHandle = nullptr;
+        fileHandle    = INVALID_HANDLE_VALUE;
+#else
+        if (data) { munmap(const_cast<uint8_t*>(data), size); }
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+
+    const uint8_t*
+    Data() const
+    {
+        return data;
+    }
+
+
+    size_t
+    Size() const
+    {
+        return size;
+    }
+
+
+private:
+#ifdef _WIN32
+    HANDLE         fileHandle    = INVALID_HANDLE_VALUE;
+    HANDLE         mappingHandle = nullptr;
+#endif
+    const uint8_t* data          = nullptr;
+    size_t         size          = 0;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,1053 @@
+#ifndef MESH_IMPORTER_H
+#define MESH_IMPORTER_H
+
+// Parallel mesh import for Wavefront OBJ and binary glTF (.glb).
+//
+// OBJ: the mapped file is split into line aligned chunks. A cheap counting pass gives each
+// chunk the global index of its first v/vt/vn (needed to resolve negative indices), then
+// every chunk is parsed concurrently with a SWAR float parser that consumes eight digits
+// per step. Face corners are deduplicated into vertices with a sharded hash map: corners
+// are partitioned by hash into shards and every shard is owned by exactly one job, so the
+// map needs no locks and the result does not depend on thread timing.
+//
+// glTF: the JSON chunk is parsed into a small DOM and accessors are read directly out of
+// the mapped BIN chunk; the only copy is the interleave into MeshVertex. Node transforms
+// are not applied, every triangle primitive of every mesh is merged as is.
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "JobSystem.h"
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+const uint32_t MESH_VERTEX_FORMAT_FLOAT32 = 0; // MeshVertex, see AssetArchiveEntry::info[5]
+const uint32_t MESH_IMPORT_NO_INDEX       = 0xFFFFFFFF;
+
+
+// Attributes missing from the source are zero.
+struct MeshVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+    glm::vec4 tangent; // w is the bitangent sign
+};
+static_assert(sizeof(MeshVertex) == 48, "MeshVertex must be tightly packed.");
+
+
+struct ImportedMesh
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t>   indices; // Triangle list
+};
+
+
+//
+// [ Number parsing ]
+//
+
+inline bool
+IsEightDigits(uint64_t chunk)
+{
+    return (((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+             (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
+}
+
+
+// Eight ASCII digits, first digit in the lowest byte, to their value.
+inline uint32_t
+ParseEightDigits(uint64_t chunk)
+{
+    const uint64_t mask = 0x000000FF000000FFull;
+    const uint64_t mul1 = 0x000F424000000064ull; // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ull; // 1 + (10000 << 32)
+
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+
+// Accumulates a run of digits into mantissa; digits past the 19th only move the exponent.
+inline void
+ParseDigitRun(const char*& cursor, const char* end, uint64_t& mantissa, int32_t& digits, int32_t& dropped,
+              int32_t& skipped)
+{
+    // Zeros ahead of the first significant digit do not count toward the 19 digit budget.
+    while (mantissa == 0 && cursor < end && *cursor == '0')
+    {
+        skipped++;
+        cursor++;
+    }
+
+    while (end - cursor >= 8 && digits <= 11)
+    {
+        uint64_t chunk = 0;
+        memcpy(&chunk, cursor, sizeof(chunk));
+        if (!IsEightDigits(chunk)) break;
+
+        mantissa = mantissa * 100000000ull + ParseEightDigits(chunk);
+        digits  += 8;
+        cursor  += 8;
+    }
+
+    while (cursor < end && *cursor >= '0' && *cursor <= '9')
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*cursor - '0');
+            digits++;
+        }
+        else
+        {
+            dropped++;
+        }
+        cursor++;
+    }
+}
+
+
+inline float
+ParseMeshFloat(const char*& cursor, const char* end)
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+
+    bool negative = false;
+    if (cursor < end && (*cursor == '-' || *cursor == '+'))
+    {
+        negative = *cursor == '-';
+        cursor++;
+    }
+
+    uint64_t mantissa = 0;
+    int32_t  digits   = 0;
+    int32_t  dropped  = 0;
+    int32_t  skipped  = 0;
+    int32_t  exponent = 0;
+
+    const char* start = cursor;
+    ParseDigitRun(cursor, end, mantissa, digits, dropped, skipped);
+    exponent += dropped;
+
+    if (cursor < end && *cursor == '.')
+    {
+        cursor++;
+        int32_t integerDigits = digits;
+        dropped = 0;
+        skipped = 0;
+        ParseDigitRun(cursor, end, mantissa, digits, dropped, skipped);
+        exponent -= digits - integerDigits + skipped;
+    }
+
+    if (cursor == start)
+    {
+        throw std::runtime_error("[ ERROR ] Expected a number in mesh file.");
+    }
+
+    if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+    {
+        cursor++;
+        bool negativeExponent = false;
+        if (cursor < end && (*cursor == '-' || *cursor == '+'))
+        {
+            negativeExponent = *cursor == '-';
+            cursor++;
+        }
+
+        int32_t value = 0;
+        while (cursor < end && *cursor >= '0' && *cursor <= '9')
+        {
+            value = std::min(value * 10 + (*cursor - '0'), 1000);
+            cursor++;
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+
+    static const double powersOfTen[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    double value = static_cast<double>(mantissa);
+    if (exponent >= 0 && exponent <= 22)       value *= powersOfTen[exponent];
+    else if (exponent < 0 && exponent >= -22)  value /= powersOfTen[-exponent];
+    else                                       value *= std::pow(10.0, exponent);
+
+    return static_cast<float>(negative ? -value : value);
+}
+
+
+inline int64_t
+ParseObjIndex(const char*& cursor, const char* end)
+{
+    bool negative = cursor < end && *cursor == '-';
+    if (negative) cursor++;
+
+    int64_t value = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9')
+    {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
+    }
+    return negative ? -value : value;
+}
+
+
+//
+// [ OBJ ]
+//
+
+struct ObjCorner
+{
+    uint32_t position;
+    uint32_t uv;
+    uint32_t normal;
+
+    bool
+    operator==(const ObjCorner& other) const
+    {
+        return position == other.position && uv == other.uv && normal == other.normal;
+    }
+};
+
+
+struct ObjCornerHash
+{
+    size_t
+    operator()(const ObjCorner& corner) const
+    {
+        uint64_t hash = corner.position * 0x9E3779B97F4A7C15ull;
+        hash ^= (corner.uv + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+        hash ^= (corner.normal + 0x165667B19E3779F9ull) * 0x94D049BB133111EBull;
+        hash ^= hash >> 31;
+        return static_cast<size_t>(hash);
+    }
+};
+
+
+struct ObjChunk
+{
+    const char*            begin;
+    const char*            end;
+    uint32_t               positionBase;
+    uint32_t               uvBase;
+    uint32_t               normalBase;
+    uint32_t               positionCount;
+    uint32_t               uvCount;
+    uint32_t               normalCount;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners; // Three per triangle
+};
+
+
+inline const char*
+NextObjLine(const char* cursor, const char* end)
+{
+    const void* newline = memchr(cursor, '\n', static_cast<size_t>(end - cursor));
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+
+inline void
+CountObjElements(ObjChunk& chunk)
+{
+    chunk.positionCount = chunk.uvCount = chunk.normalCount = 0;
+    for (const char* line = chunk.begin; line < chunk.end; line = NextObjLine(line, chunk.end))
+    {
+        while (line < chunk.end && (*line == ' ' || *line == '\t')) line++;
+        if (chunk.end - line < 2 || line[0] != 'v') continue;
+
+        if (line[1] == ' ' || line[1] == '\t') chunk.positionCount++;
+        else if (line[1] == 't')               chunk.uvCount++;
+        else if (line[1] == 'n')               chunk.normalCount++;
+    }
+}
+
+
+inline uint32_t
+ResolveObjIndex(int64_t index, uint32_t countSoFar)
+{
+    // 1 based, negative indices count back from the last element defined so far.
+    int64_t resolved = index > 0 ? index - 1 : static_cast<int64_t>(countSoFar) + index;
+    if (index == 0 || resolved < 0)
+    {
+        throw std::runtime_error("[ ERROR ] Invalid OBJ face index.");
+    }
+    return static_cast<uint32_t>(resolved);
+}
+
+
+inline void
+ParseObjChunk(ObjChunk& chunk)
+{
+    chunk.positions.reserve(chunk.positionCount);
+    chunk.uvs.reserve(chunk.uvCount);
+    chunk.normals.reserve(chunk.normalCount);
+
+    std::vector<ObjCorner> face;
+    const char* end = chunk.end;
+    for (const char* line = chunk.begin; line < end; line = NextObjLine(line, end))
+    {
+        const char* cursor = line;
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+        if (end - cursor < 2) continue;
+
+        if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            cursor += 1;
+            glm::vec3 position;
+            position.x = ParseMeshFloat(cursor, end);
+            position.y = ParseMeshFloat(cursor, end);
+            position.z = ParseMeshFloat(cursor, end);
+            chunk.positions.push_back(position);
+        }
+        else if (cursor[0] == 'v' && cursor[1] == 't')
+        {
+            cursor += 2;
+            glm::vec2 uv;
+            uv.x = ParseMeshFloat(cursor, end);
+            uv.y = 1.0f - ParseMeshFloat(cursor, end); // OBJ has its origin bottom left, Vulkan top left
+            chunk.uvs.push_back(uv);
+        }
+        else if (cursor[0] == 'v' && cursor[1] == 'n')
+        {
+            cursor += 2;
+            glm::vec3 normal;
+            normal.x = ParseMeshFloat(cursor, end);
+            normal.y = ParseMeshFloat(cursor, end);
+            normal.z = ParseMeshFloat(cursor, end);
+            chunk.normals.push_back(normal);
+        }
+        else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            cursor += 1;
+            face.clear();
+
+            uint32_t positionsSoFar = chunk.positionBase + static_cast<uint32_t>(chunk.positions.size());
+            uint32_t uvsSoFar       = chunk.uvBase + static_cast<uint32_t>(chunk.uvs.size());
+            uint32_t normalsSoFar   = chunk.normalBase + static_cast<uint32_t>(chunk.normals.size());
+            for (;;)
+            {
+                while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) cursor++;
+                if (cursor >= end || *cursor == '\n' || *cursor == '#') break;
+
+                ObjCorner corner = { MESH_IMPORT_NO_INDEX, MESH_IMPORT_NO_INDEX, MESH_IMPORT_NO_INDEX };
+                corner.position = ResolveObjIndex(ParseObjIndex(cursor, end), positionsSoFar);
+                if (cursor < end && *cursor == '/')
+                {
+                    cursor++;
+                    if (cursor < end && *cursor != '/')
+                    {
+                        corner.uv = ResolveObjIndex(ParseObjIndex(cursor, end), uvsSoFar);
+                    }
+                    if (cursor < end && *cursor == '/')
+                    {
+                        cursor++;
+                        corner.normal = ResolveObjIndex(ParseObjIndex(cursor, end), normalsSoFar);
+                    }
+                }
+                face.push_back(corner);
+            }
+
+            // Fan triangulation of convex polygons.
+            for (size_t ii = 2; ii < face.size(); ii++)
+            {
+                chunk.corners.push_back(face[0]);
+                chunk.corners.push_back(face[ii - 1]);
+                chunk.corners.push_back(face[ii]);
+            }
+        }
+    }
+}
+
+
+inline ImportedMesh
+ImportObj(const char* data, size_t size, JobSystem& jobs)
+{
+    const size_t minimumChunkBytes = 256 * 1024;
+    const char*  end               = data + size;
+
+    // Line aligned chunks.
+    std::vector<ObjChunk> chunks(jobs.RangeCount(size, minimumChunkBytes));
+    const char* cursor = data;
+    for (size_t ii = 0; ii < chunks.size(); ii++)
+    {
+        const char* chunkEnd = ii + 1 == chunks.size() ? end : data + size * (ii + 1) / chunks.size();
+        if (chunkEnd < cursor) chunkEnd = cursor;
+        if (chunkEnd > data && chunkEnd < end && chunkEnd[-1] != '\n') chunkEnd = NextObjLine(chunkEnd, end);
+
+        chunks[ii].begin = cursor;
+        chunks[ii].end   = chunkEnd;
+        cursor           = chunkEnd;
+    }
+
+    jobs.ParallelFor(chunks.size(), 1, [&chunks](size_t begin, size_t finish)
+    {
+        for (size_t ii = begin; ii < finish; ii++) CountObjElements(chunks[ii]);
+    });
+
+    uint32_t positionTotal = 0;
+    uint32_t uvTotal       = 0;
+    uint32_t normalTotal   = 0;
+    for (auto& chunk : chunks)
+    {
+        chunk.positionBase = positionTotal;
+        chunk.uvBase       = uvTotal;
+        chunk.normalBase   = normalTotal;
+        positionTotal     += chunk.positionCount;
+        uvTotal           += chunk.uvCount;
+        normalTotal       += chunk.normalCount;
+    }
+
+    jobs.ParallelFor(chunks.size(), 1, [&chunks](size_t begin, size_t finish)
+    {
+        for (size_t ii = begin; ii < finish; ii++) ParseObjChunk(chunks[ii]);
+    });
+
+    // Gather attributes and corners into flat arrays.
+    std::vector<glm::vec3> positions(positionTotal);
+    std::vector<glm::vec2> uvs(uvTotal);
+    std::vector<glm::vec3> normals(normalTotal);
+    std::vector<size_t>    cornerBase(chunks.size() + 1, 0);
+    for (size_t ii = 0; ii < chunks.size(); ii++)
+    {
+        cornerBase[ii + 1] = cornerBase[ii] + chunks[ii].corners.size();
+    }
+
+    std::vector<ObjCorner> corners(cornerBase.back());
+    jobs.ParallelFor(chunks.size(), 1, [&](size_t begin, size_t finish)
+    {
+        for (size_t ii = begin; ii < finish; ii++)
+        {
+            const ObjChunk& chunk = chunks[ii];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+            std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.uvBase);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+            std::copy(chunk.corners.begin(), chunk.corners.end(),
+                      corners.begin() + static_cast<std::ptrdiff_t>(cornerBase[ii]));
+        }
+    });
+    chunks.clear();
+
+    for (const auto& corner : corners)
+    {
+        if (corner.position >= positionTotal ||
+            (corner.uv != MESH_IMPORT_NO_INDEX && corner.uv >= uvTotal) ||
+            (corner.normal != MESH_IMPORT_NO_INDEX && corner.normal >= normalTotal))
+        {
+            throw std::runtime_error("[ ERROR ] OBJ face index out of range.");
+        }
+    }
+
+    // Sharded deduplication. Shard = top bits of the corner hash.
+    const uint32_t shardBits  = 6;
+    const uint32_t shardCount = 1u << shardBits;
+    const size_t   rangeCount = jobs.RangeCount(corners.size(), 64 * 1024);
+    const size_t   rangeSize  = (corners.size() + rangeCount - 1) / std::max<size_t>(rangeCount, 1);
+
+    std::vector<uint8_t>  cornerShard(corners.size());
+    std::vector<size_t>   rangeShardCounts(rangeCount * shardCount, 0);
+    jobs.ParallelFor(rangeCount, 1, [&](size_t begin, size_t finish)
+    {
+        ObjCornerHash hasher;
+        for (size_t range = begin; range < finish; range++)
+        {
+            size_t first = range * rangeSize;
+            size_t last  = std::min(first + rangeSize, corners.size());
+            for (size_t ii = first; ii < last; ii++)
+            {
+                uint8_t shard = static_cast<uint8_t>(static_cast<uint64_t>(hasher(corners[ii])) >> (64 - shardBits));
+                cornerShard[ii] = shard;
+                rangeShardCounts[range * shardCount + shard]++;
+            }
+        }
+    });
+
+    // Scatter corner ids into per shard lists, keeping the original order inside a shard.
+    std::vector<size_t> shardStart(shardCount + 1, 0);
+    std::vector<size_t> rangeShardOffsets(rangeCount * shardCount);
+    {
+        size_t running = 0;
+        for (uint32_t shard = 0; shard < shardCount; shard++)
+        {
+            shardStart[shard] = running;
+            for (size_t range = 0; range < rangeCount; range++)
+            {
+                rangeShardOffsets[range * shardCount + shard] = running;
+                running += rangeShardCounts[range * shardCount + shard];
+            }
+        }
+        shardStart[shardCount] = running;
+    }
+
+    std::vector<uint32_t> shardOrder(corners.size());
+    jobs.ParallelFor(rangeCount, 1, [&](size_t begin, size_t finish)
+    {
+        for (size_t range = begin; range < finish; range++)
+        {
+            size_t* offsets = &rangeShardOffsets[range * shardCount];
+            size_t  first   = range * rangeSize;
+            size_t  last    = std::min(first + rangeSize, corners.size());
+            for (size_t ii = first; ii < last; ii++)
+            {
+                shardOrder[offsets[cornerShard[ii]]++] = static_cast<uint32_t>(ii);
+            }
+        }
+    });
+
+    // One job per shard: no two jobs ever touch the same map.
+    std::vector<uint32_t>              cornerLocalIndex(corners.size());
+    std::vector<std::vector<uint32_t>> shardUniqueCorners(shardCount);
+    jobs.ParallelFor(shardCount, 1, [&](size_t begin, size_t finish)
+    {
+        for (size_t shard = begin; shard < finish; shard++)
+        {
+            std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> map;
+            map.reserve(shardStart[shard + 1] - shardStart[shard]);
+
+            std::vector<uint32_t>& unique = shardUniqueCorners[shard];
+            for (size_t ii = shardStart[shard]; ii < shardStart[shard + 1]; ii++)
+            {
+                uint32_t cornerIndex = shardOrder[ii];
+                auto     inserted    = map.insert(std::make_pair(corners[cornerIndex],
+                                                                 static_cast<uint32_t>(unique.size())));
+                if (inserted.second)
+                {
+                    unique.push_back(cornerIndex);
+                }
+                cornerLocalIndex[cornerIndex] = inserted.first->second;
+            }
+        }
+    });
+
+    std::vector<uint32_t> shardVertexBase(shardCount + 1, 0);
+    for (uint32_t shard = 0; shard < shardCount; shard++)
+    {
+        shardVertexBase[shard + 1] = shardVertexBase[shard] + static_cast<uint32_t>(shardUniqueCorners[shard].size());
+    }
+
+    ImportedMesh mesh;
+    mesh.vertices.resize(shardVertexBase[shardCount]);
+    mesh.indices.resize(corners.size());
+
+    jobs.ParallelFor(shardCount, 1, [&](size_t begin, size_t finish)
+    {
+        for (size_t shard = begin; shard < finish; shard++)
+        {
+            const std::vector<uint32_t>& unique = shardUniqueCorners[shard];
+            for (size_t ii = 0; ii < unique.size(); ii++)
+            {
+                const ObjCorner& corner = corners[unique[ii]];
+                MeshVertex       vertex = {};
+                vertex.position = positions[corner.position];
+                if (corner.uv != MESH_IMPORT_NO_INDEX)     vertex.uv     = uvs[corner.uv];
+                if (corner.normal != MESH_IMPORT_NO_INDEX) vertex.normal = normals[corner.normal];
+                mesh.vertices[shardVertexBase[shard] + ii] = vertex;
+            }
+        }
+    });
+
+    jobs.ParallelFor(corners.size(), 64 * 1024, [&](size_t begin, size_t finish)
+    {
+        for (size_t ii = begin; ii < finish; ii++)
+        {
+            mesh.indices[ii] = shardVertexBase[cornerShard[ii]] + cornerLocalIndex[ii];
+        }
+    });
+
+    return mesh;
+}
+
+
+//
+// [ glTF ]
+//
+
+struct GltfJson
+{
+    enum Type
+    {
+        JSON_NULL,
+        JSON_BOOL,
+        JSON_NUMBER,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT
+    };
+
+    Type                                         type    = JSON_NULL;
+    bool                                         boolean = false;
+    double                                       number  = 0.0;
+    std::string                                  string;
+    std::vector<GltfJson>                        array;
+    std::vector<std::pair<std::string, GltfJson>> members;
+
+
+    const GltfJson*
+    Find(const char* key) const
+    {
+        for (const auto& member : members)
+        {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+
+
+    uint32_t
+    Uint(const char* key, uint32_t fallback) const
+    {
+        const GltfJson* value = Find(key);
+        return value && value->type == JSON_NUMBER ? static_cast<uint32_t>(value->number) : fallback;
+    }
+
+
+    const GltfJson&
+    At(const char* key, size_t index) const
+    {
+        const GltfJson* value = Find(key);
+        if (!value || value->type != JSON_ARRAY || index >= value->array.size())
+        {
+            throw std::runtime_error(std::string("[ ERROR ] glTF reference out of range: ") + key);
+        }
+        return value->array[index];
+    }
+};
+
+
+inline void
+SkipJsonWhitespace(const char*& cursor, const char* end)
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) cursor++;
+}
+
+
+inline std::string
+ParseJsonString(const char*& cursor, const char* end)
+{
+    std::string result;
+    cursor++; // Opening quote
+    while (cursor < end && *cursor != '"')
+    {
+        if (*cursor == '\\' && cursor + 1 < end)
+        {
+            cursor++;
+            switch (*cursor)
+            {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'u': result += '?'; cursor += std::min<std::ptrdiff_t>(4, end - cursor - 1); break;
+                default:  result += *cursor; break;
+            }
+        }
+        else
+        {
+            result += *cursor;
+        }
+        cursor++;
+    }
+
+    if (cursor >= end)
+    {
+        throw std::runtime_error("[ ERROR ] Unterminated string in glTF JSON.");
+    }
+    cursor++; // Closing quote
+    return result;
+}
+
+
+inline GltfJson
+ParseGltfJson(const char*& cursor, const char* end, uint32_t depth = 0)
+{
+    if (depth > 64)
+    {
+        throw std::runtime_error("[ ERROR ] glTF JSON is nested too deeply.");
+    }
+
+    SkipJsonWhitespace(cursor, end);
+    if (cursor >= end)
+    {
+        throw std::runtime_error("[ ERROR ] Unexpected end of glTF JSON.");
+    }
+
+    GltfJson value;
+    if (*cursor == '{')
+    {
+        value.type = GltfJson::JSON_OBJECT;
+        cursor++;
+        SkipJsonWhitespace(cursor, end);
+        while (cursor < end && *cursor != '}')
+        {
+            if (*cursor != '"')
+            {
+                throw std::runtime_error("[ ERROR ] Expected a key in glTF JSON.");
+            }
+            std::string key = ParseJsonString(cursor, end);
+            SkipJsonWhitespace(cursor, end);
+            if (cursor >= end || *cursor != ':')
+            {
+                throw std::runtime_error("[ ERROR ] Expected ':' in glTF JSON.");
+            }
+            cursor++;
+            value.members.emplace_back(key, ParseGltfJson(cursor, end, depth + 1));
+            SkipJsonWhitespace(cursor, end);
+            if (cursor < end && *cursor == ',')
+            {
+                cursor++;
+                SkipJsonWhitespace(cursor, end);
+            }
+        }
+        cursor++;
+    }
+    else if (*cursor == '[')
+    {
+        value.type = GltfJson::JSON_ARRAY;
+        cursor++;
+        SkipJsonWhitespace(cursor, end);
+        while (cursor < end && *cursor != ']')
+        {
+            value.array.push_back(ParseGltfJson(cursor, end, depth + 1));
+            SkipJsonWhitespace(cursor, end);
+            if (cursor < end && *cursor == ',')
+            {
+                cursor++;
+                SkipJsonWhitespace(cursor, end);
+            }
+        }
+        cursor++;
+    }
+    else if (*cursor == '"')
+    {
+        value.type   = GltfJson::JSON_STRING;
+        value.string = ParseJsonString(cursor, end);
+    }
+    else if (end - cursor >= 4 && strncmp(cursor, "true", 4) == 0)
+    {
+        value.type    = GltfJson::JSON_BOOL;
+        value.boolean = true;
+        cursor += 4;
+    }
+    else if (end - cursor >= 5 && strncmp(cursor, "false", 5) == 0)
+    {
+        value.type = GltfJson::JSON_BOOL;
+        cursor += 5;
+    }
+    else if (end - cursor >= 4 && strncmp(cursor, "null", 4) == 0)
+    {
+        cursor += 4;
+    }
+    else
+    {
+        value.type   = GltfJson::JSON_NUMBER;
+        value.number = ParseMeshFloat(cursor, end);
+    }
+    return value;
+}
+
+
+// Strided, typed view of a glTF accessor inside the BIN chunk.
+struct GltfAccessorView
+{
+    const uint8_t* data          = nullptr;
+    size_t         stride        = 0;
+    uint32_t       count         = 0;
+    uint32_t       componentType = 0;
+    uint32_t       components    = 0;
+    bool           normalized    = false;
+
+
+    float
+    Component(size_t element, uint32_t component) const
+    {
+        const uint8_t* source = data + element * stride;
+        switch (componentType)
+        {
+            case 5126: // FLOAT
+            {
+                float value = 0.0f;
+                memcpy(&value, source + component * sizeof(float), sizeof(float));
+                return value;
+            }
+            case 5121: // UNSIGNED_BYTE
+            {
+                float value = static_cast<float>(source[component]);
+                return normalized ? value / 255.0f : value;
+            }
+            case 5123: // UNSIGNED_SHORT
+            {
+                uint16_t value = 0;
+                memcpy(&value, source + component * sizeof(uint16_t), sizeof(uint16_t));
+                return normalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+            }
+            default:
+                throw std::runtime_error("[ ERROR ] Unsupported glTF attribute component type.");
+        }
+    }
+
+
+    uint32_t
+    Index(size_t element) const
+    {
+        const uint8_t* source = data + element * stride;
+        switch (componentType)
+        {
+            case 5121: return source[0];
+            case 5123: { uint16_t value = 0; memcpy(&value, source, sizeof(value)); return value; }
+            case 5125: { uint32_t value = 0; memcpy(&value, source, sizeof(value)); return value; }
+            default:   throw std::runtime_error("[ ERROR ] Unsupported glTF index component type.");
+        }
+    }
+};
+
+
+// semantic names the accessor in errors. Its type ("SCALAR", "VEC2", ...) must be type and its
+// componentType one of componentTypes, otherwise the element size, and with it the bounds
+// check below, would not match what the caller reads.
+inline GltfAccessorView
+GltfAccessor(const GltfJson&                 document,
+             uint32_t                        accessorIndex,
+             const uint8_t*                  bin,
+             size_t                          binSize,
+             const char*                     semantic,
+             const char*                     type,
+             std::initializer_list<uint32_t> componentTypes)
+{
+    const GltfJson& accessor = document.At("accessors", accessorIndex);
+    const GltfJson* typeName = accessor.Find("type");
+
+    GltfAccessorView view;
+    view.count         = accessor.Uint("count", 0);
+    view.componentType = accessor.Uint("componentType", 0);
+    view.components    = 1;
+    const GltfJson* normalized = accessor.Find("normalized");
+    view.normalized    = normalized && normalized->boolean;
+    if (typeName && typeName->string == "VEC2") view.components = 2;
+    if (typeName && typeName->string == "VEC3") view.components = 3;
+    if (typeName && typeName->string == "VEC4") view.components = 4;
+
+    if (!typeName || typeName->string != type ||
+        std::find(componentTypes.begin(), componentTypes.end(), view.componentType) == componentTypes.end())
+    {
+        throw std::runtime_error(std::string("[ ERROR ] glTF ") + semantic + " accessor must be " + type +
+                                 " with a supported component type.");
+    }
+
+    size_t componentSize = view.componentType == 5121 ? 1 : (view.componentType == 5123 ? 2 : 4);
+    size_t elementSize   = componentSize * view.components;
+
+    uint32_t        bufferViewIndex = accessor.Uint("bufferView", MESH_IMPORT_NO_INDEX);
+    if (bufferViewIndex == MESH_IMPORT_NO_INDEX)
+    {
+        throw std::runtime_error("[ ERROR ] Sparse or empty glTF accessors are not supported.");
+    }
+    const GltfJson& bufferView = document.At("bufferViews", bufferViewIndex);
+    if (bufferView.Uint("buffer", 0) != 0)
+    {
+        throw std::runtime_error("[ ERROR ] Only the GLB BIN buffer is supported.");
+    }
+
+    size_t offset = static_cast<size_t>(bufferView.Uint("byteOffset", 0)) + accessor.Uint("byteOffset", 0);
+    view.stride   = bufferView.Uint("byteStride", static_cast<uint32_t>(elementSize));
+    view.data     = bin + offset;
+    if (view.stride < elementSize)
+    {
+        throw std::runtime_error(std::string("[ ERROR ] glTF ") + semantic + " accessor stride is smaller than its elements.");
+    }
+
+    size_t required = view.count ? view.stride * (view.count - 1) + elementSize : 0;
+    if (offset > binSize || required > binSize - offset)
+    {
+        throw std::runtime_error("[ ERROR ] glTF accessor is out of bounds.");
+    }
+    return view;
+}
+
+
+inline ImportedMesh
+ImportGlb(const uint8_t* data, size_t size, JobSystem& jobs)
+{
+    uint32_t header[3] = {};
+    if (size < 20) throw std::runtime_error("[ ERROR ] GLB file is truncated.");
+    memcpy(header, data, sizeof(header));
+    if (header[0] != 0x46546C67 || header[1] != 2) // "glTF", version 2
+    {
+        throw std::runtime_error("[ ERROR ] Not a glTF 2.0 binary file.");
+    }
+
+    // Chunks: JSON first, then an optional BIN.
+    const char*    json     = nullptr;
+    size_t         jsonSize = 0;
+    const uint8_t* bin      = nullptr;
+    size_t         binSize  = 0;
+    for (size_t offset = 12; offset + 8 <= size;)
+    {
+        uint32_t chunkHeader[2] = {};
+        memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+        size_t chunkSize = chunkHeader[0];
+        if (chunkSize > size - offset - 8) throw std::runtime_error("[ ERROR ] GLB chunk is out of bounds.");
+
+        if (chunkHeader[1] == 0x4E4F534A && !json) // "JSON"
+        {
+            json     = reinterpret_cast<const char*>(data + offset + 8);
+            jsonSize = chunkSize;
+        }
+        else if (chunkHeader[1] == 0x004E4942 && !bin) // "BIN\0"
+        {
+            bin     = data + offset + 8;
+            binSize = chunkSize;
+        }
+        offset += 8 + ((chunkSize + 3) & ~size_t(3));
+    }
+
+    if (!json) throw std::runtime_error("[ ERROR ] GLB file has no JSON chunk.");
+
+    const char* cursor   = json;
+    GltfJson    document = ParseGltfJson(cursor, json + jsonSize);
+
+    struct Primitive
+    {
+        GltfAccessorView position;
+        GltfAccessorView normal;
+        GltfAccessorView uv;
+        GltfAccessorView tangent;
+        GltfAccessorView indices;
+        bool             indexed;
+        uint32_t         firstVertex;
+        uint32_t         firstIndex;
+    };
+
+    std::vector<Primitive> primitives;
+    uint32_t vertexTotal = 0;
+    uint32_t indexTotal  = 0;
+
+    const GltfJson* meshes = document.Find("meshes");
+    for (size_t meshIndex = 0; meshes && meshIndex < meshes->array.size(); meshIndex++)
+    {
+        const GltfJson* meshPrimitives = meshes->array[meshIndex].Find("primitives");
+        for (size_t ii = 0; meshPrimitives && ii < meshPrimitives->array.size(); ii++)
+        {
+            const GltfJson& source = meshPrimitives->array[ii];
+            if (source.Uint("mode", 4) != 4) continue; // Triangle lists only
+
+            const GltfJson* attributes = source.Find("attributes");
+            if (!attributes || !attributes->Find("POSITION")) continue;
+
+            Primitive primitive = {};
+            // Component types: 5126 FLOAT, 5121 UNSIGNED_BYTE, 5123 UNSIGNED_SHORT, 5125 UNSIGNED_INT.
+            primitive.position = GltfAccessor(document, attributes->Uint("POSITION", 0), bin, binSize,
+                                              "POSITION", "VEC3", { 5126 });
+            if (attributes->Find("NORMAL"))
+                primitive.normal = GltfAccessor(document, attributes->Uint("NORMAL", 0), bin, binSize,
+                                                "NORMAL", "VEC3", { 5126 });
+            if (attributes->Find("TEXCOORD_0"))
+                primitive.uv = GltfAccessor(document, attributes->Uint("TEXCOORD_0", 0), bin, binSize,
+                                            "TEXCOORD_0", "VEC2", { 5126, 5121, 5123 });
+            if (attributes->Find("TANGENT"))
+                primitive.tangent = GltfAccessor(document, attributes->Uint("TANGENT", 0), bin, binSize,
+                                                 "TANGENT", "VEC4", { 5126 });
+
+            primitive.indexed = source.Find("indices") != nullptr;
+            if (primitive.indexed)
+            {
+                primitive.indices = GltfAccessor(document, source.Uint("indices", 0), bin, binSize,
+                                                 "indices", "SCALAR", { 5121, 5123, 5125 });
+            }
+
+            primitive.firstVertex = vertexTotal;
+            primitive.firstIndex  = indexTotal;
+            vertexTotal += primitive.position.count;
+            indexTotal  += primitive.indexed ? primitive.indices.count : primitive.position.count;
+            primitives.push_back(primitive);
+        }
+    }
+
+    ImportedMesh mesh;
+    mesh.vertices.resize(vertexTotal);
+    mesh.indices.resize(indexTotal);
+
+    for (const auto& primitive : primitives)
+    {
+        jobs.ParallelFor(primitive.position.count, 16 * 1024, [&](size_t begin, size_t finish)
+        {
+            for (size_t ii = begin; ii < finish; ii++)
+            {
+                MeshVertex& vertex = mesh.vertices[primitive.firstVertex + ii];
+                vertex = {};
+                for (uint32_t cc = 0; cc < 3; cc++)
+                {
+                    vertex.position[cc] = primitive.position.Component(ii, cc);
+                    if (primitive.normal.data) vertex.normal[cc] = primitive.normal.Component(ii, cc);
+                }
+                for (uint32_t cc = 0; primitive.uv.data && cc < 2; cc++)
+                {
+                    vertex.uv[cc] = primitive.uv.Component(ii, cc);
+                }
+                for (uint32_t cc = 0; primitive.tangent.data && cc < 4; cc++)
+                {
+                    vertex.tangent[cc] = primitive.tangent.Component(ii, cc);
+                }
+            }
+        });
+
+        uint32_t indexCount = primitive.indexed ? primitive.indices.count : primitive.position.count;
+        jobs.ParallelFor(indexCount, 64 * 1024, [&](size_t begin, size_t finish)
+        {
+            for (size_t ii = begin; ii < finish; ii++)
+            {
+                uint32_t index = primitive.indexed ? primitive.indices.Index(ii) : static_cast<uint32_t>(ii);
+                if (index >= primitive.position.count)
+                {
+                    throw std::runtime_error("[ ERROR ] glTF index out of range.");
+                }
+                mesh.indices[primitive.firstIndex + ii] = primitive.firstVertex + index;
+            }
+        });
+    }
+
+    return mesh;
+}
+
+
+// Picks the importer by file extension (.obj or .glb).
+inline ImportedMesh
+ImportMesh(const std::string& path, JobSystem& jobs)
+{
+    MappedFile file;
+    file.Open(path);
+
+    std::string extension = path.substr(path.find_last_of('.') == std::string::npos ? path.size()
+                                                                                    : path.find_last_of('.'));
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](char character) { return static_cast<char>(tolower(character)); });
+
+    if (extension == ".obj")
+    {
+        return ImportObj(reinterpret_cast<const char*>(file.Data()), file.Size(), jobs);
+    }
+    if (extension == ".glb")
+    {
+        return ImportGlb(file.Data(), file.Size(), jobs);
+    }
+    throw std::runtime_error("[ ERROR ] Unsupported mesh format: " + path);
+}
+
+#endif // MESH_IMPORTER_H
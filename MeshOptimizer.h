@@ -0,0 +1,385 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+// Index and vertex reordering for triangle lists, run by AssetPacker before meshes are
+// packed and usable at runtime on procedurally generated or streamed geometry:
+//
+//   1. Vertex cache  Tipsify (Sander, Nehab, Barczak 2007): fans around the most recently
+//                    emitted vertices so post-transform cache hits go up.
+//   2. Overdraw      Tipsify output is cut into clusters at cache flushes and wherever a
+//                    cluster's ACMR is already good enough, then clusters are sorted
+//                    outward facing first so early depth rejection kicks in sooner.
+//   3. Vertex fetch  Vertices are renumbered in order of first use, making vertex fetches
+//                    roughly sequential. Unreferenced vertices are dropped.
+//
+// ACMR = transformed vertices / triangles (lower is better, ~0.5 is the ideal for a grid).
+// ATVR = transformed vertices / referenced vertices (1.0 is ideal).
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+// FIFO size used for analysis and optimization. Real hardware varies; 16 is a reasonable
+// common denominator and the ordering is not very sensitive to it.
+const uint32_t MESH_OPTIMIZER_CACHE_SIZE = 16;
+
+
+struct VertexCacheStatistics
+{
+    uint32_t transformedVertices = 0;
+    float    acmr                = 0.0f;
+    float    atvr                = 0.0f;
+};
+
+
+struct MeshOptimizationReport
+{
+    struct Stage
+    {
+        const char*           name;
+        VertexCacheStatistics statistics;
+    };
+
+    std::vector<Stage> stages;
+    uint32_t           clusterCount = 0;
+
+
+    void
+    Print(const std::string& meshName) const
+    {
+        std::cout << "[ INFO ] Mesh optimization [ " << meshName << " ] " << clusterCount << " clusters" << std::endl;
+        for (const auto& stage : stages)
+        {
+            std::cout << "\t" << std::left << std::setw(14) << stage.name << std::right << std::fixed
+                      << std::setprecision(3)
+                      << "ACMR " << stage.statistics.acmr << "  ATVR " << stage.statistics.atvr << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+    }
+};
+
+
+// Simulates a FIFO post-transform cache of cacheSize entries.
+inline VertexCacheStatistics
+AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+                   size_t                       vertexCount,
+                   uint32_t                     cacheSize = MESH_OPTIMIZER_CACHE_SIZE)
+{
+    VertexCacheStatistics statistics;
+    if (indices.empty()) return statistics;
+
+    // A vertex is in the FIFO while fewer than cacheSize misses happened since it entered.
+    std::vector<uint32_t> insertedAt(vertexCount, 0);
+    std::vector<bool>     referenced(vertexCount, false);
+    uint32_t              misses          = 0;
+    uint32_t              referencedCount = 0;
+    for (uint32_t index : indices)
+    {
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            referencedCount++;
+        }
+
+        if (insertedAt[index] == 0 || misses - insertedAt[index] + 1 > cacheSize)
+        {
+            misses++;
+            insertedAt[index] = misses;
+        }
+    }
+
+    statistics.transformedVertices = misses;
+    statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    statistics.atvr = static_cast<float>(misses) / static_cast<float>(referencedCount);
+    return statistics;
+}
+
+
+// Returns the reordered index buffer. clusterStarts receives the first triangle of every
+// run that began after a dead end (a non local jump that flushes the cache).
+inline std::vector<uint32_t>
+OptimizeVertexCacheTipsify(const std::vector<uint32_t>& indices,
+                           size_t                       vertexCount,
+                           std::vector<uint32_t>*       clusterStarts = nullptr,
+                           uint32_t                     cacheSize = MESH_OPTIMIZER_CACHE_SIZE)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (clusterStarts) clusterStarts->clear();
+    if (triangleCount == 0) return std::vector<uint32_t>();
+
+    // Vertex -> triangle adjacency, CSR layout.
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) liveTriangles[index]++;
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t ii = 0; ii < vertexCount; ii++)
+    {
+        adjacencyOffsets[ii + 1] = adjacencyOffsets[ii] + liveTriangles[ii];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t ii = 0; ii < indices.size(); ii++)
+        {
+            adjacency[fill[indices[ii]]++] = static_cast<uint32_t>(ii / 3);
+        }
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool>     emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t timeStamp   = cacheSize + 1;
+    size_t   scanCursor  = 0;
+    int64_t  fanVertex   = indices[0];
+    bool     jumped      = true;
+    while (fanVertex >= 0)
+    {
+        uint32_t fan = static_cast<uint32_t>(fanVertex);
+        candidates.clear();
+
+        if (jumped && clusterStarts)
+        {
+            clusterStarts->push_back(static_cast<uint32_t>(result.size() / 3));
+        }
+
+        for (uint32_t ii = adjacencyOffsets[fan]; ii < adjacencyOffsets[fan + 1]; ii++)
+        {
+            uint32_t triangle = adjacency[ii];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = true;
+
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                uint32_t vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timeStamp - cacheTime[vertex] > cacheSize)
+                {
+                    cacheTime[vertex] = timeStamp++;
+                }
+            }
+        }
+
+        // Next fan: the candidate that will still be in cache after its remaining
+        // triangles are emitted, preferring the oldest such vertex.
+        fanVertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0) continue;
+
+            int64_t age      = static_cast<int64_t>(timeStamp - cacheTime[vertex]);
+            int64_t priority = age + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= cacheSize ? age : 0;
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanVertex    = vertex;
+            }
+        }
+
+        jumped = false;
+        if (fanVertex < 0)
+        {
+            // Dead end: back up through recently emitted vertices, then scan linearly.
+            while (!deadEnds.empty() && fanVertex < 0)
+            {
+                uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[vertex] > 0) fanVertex = vertex;
+            }
+
+            while (fanVertex < 0 && scanCursor < vertexCount)
+            {
+                if (liveTriangles[scanCursor] > 0)
+                {
+                    fanVertex = static_cast<int64_t>(scanCursor);
+                    jumped    = true;
+                }
+                scanCursor++;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+// Splits cache optimized triangles into clusters and sorts them outward facing first.
+// threshold > 1 trades a little ACMR for more, smaller clusters (1.05 = at most ~5%).
+// Returns the number of clusters.
+inline uint32_t
+OptimizeOverdraw(std::vector<uint32_t>&       indices,
+                 const MeshVertex*            vertices,
+                 const std::vector<uint32_t>& hardClusterStarts,
+                 float                        threshold = 1.05f,
+                 uint32_t                     cacheSize = MESH_OPTIMIZER_CACHE_SIZE)
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0) return 0;
+
+    uint32_t vertexCount = 0;
+    for (uint32_t index : indices) vertexCount = std::max(vertexCount, index + 1);
+    const float targetAcmr = AnalyzeVertexCache(indices, vertexCount, cacheSize).acmr * threshold;
+
+    // Soft boundaries: inside each hard cluster, cut as soon as the running cluster ACMR
+    // drops to the target; a cut costs at most one cache warm up.
+    std::vector<uint32_t> clusterStarts;
+    std::vector<uint32_t> insertedAt(vertexCount, 0);
+    uint32_t              misses = 0;
+    for (size_t hard = 0; hard < hardClusterStarts.size(); hard++)
+    {
+        uint32_t first = hardClusterStarts[hard];
+        uint32_t last  = hard + 1 < hardClusterStarts.size() ? hardClusterStarts[hard + 1] : triangleCount;
+
+        uint32_t clusterMisses = 0;
+        uint32_t clusterStart  = first;
+        clusterStarts.push_back(first);
+        misses += cacheSize + 1; // Flush
+        for (uint32_t triangle = first; triangle < last; triangle++)
+        {
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                uint32_t vertex = indices[triangle * 3 + corner];
+                if (insertedAt[vertex] == 0 || misses - insertedAt[vertex] + 1 > cacheSize)
+                {
+                    misses++;
+                    clusterMisses++;
+                    insertedAt[vertex] = misses;
+                }
+            }
+
+            uint32_t clusterTriangles = triangle + 1 - clusterStart;
+            if (triangle + 1 < last && clusterTriangles >= 8 &&
+                static_cast<float>(clusterMisses) <= targetAcmr * static_cast<float>(clusterTriangles))
+            {
+                clusterStart  = triangle + 1;
+                clusterMisses = 0;
+                clusterStarts.push_back(clusterStart);
+                misses += cacheSize + 1;
+            }
+        }
+    }
+
+    // Sort key: how far the cluster faces away from the mesh center.
+    glm::vec3 meshCenter(0.0f);
+    for (uint32_t index : indices) meshCenter += vertices[index].position;
+    meshCenter /= static_cast<float>(indices.size());
+
+    struct Cluster
+    {
+        uint32_t first;
+        uint32_t last;
+        float    sortKey;
+    };
+
+    std::vector<Cluster> clusters(clusterStarts.size());
+    for (size_t ii = 0; ii < clusterStarts.size(); ii++)
+    {
+        Cluster& cluster = clusters[ii];
+        cluster.first = clusterStarts[ii];
+        cluster.last  = ii + 1 < clusterStarts.size() ? clusterStarts[ii + 1] : triangleCount;
+
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float     area = 0.0f;
+        for (uint32_t triangle = cluster.first; triangle < cluster.last; triangle++)
+        {
+            const glm::vec3& p0 = vertices[indices[triangle * 3 + 0]].position;
+            const glm::vec3& p1 = vertices[indices[triangle * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[triangle * 3 + 2]].position;
+
+            glm::vec3 areaNormal   = glm::cross(p1 - p0, p2 - p0); // Length is twice the area
+            float     triangleArea = glm::length(areaNormal);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal   += areaNormal;
+            area     += triangleArea;
+        }
+
+        centroid        = area > 0.0f ? centroid / area : vertices[indices[cluster.first * 3]].position;
+        float length    = glm::length(normal);
+        cluster.sortKey = length > 0.0f ? glm::dot(centroid - meshCenter, normal / length) : 0.0f;
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(indices.size());
+    for (const auto& cluster : clusters)
+    {
+        sorted.insert(sorted.end(), indices.begin() + cluster.first * 3, indices.begin() + cluster.last * 3);
+    }
+    indices.swap(sorted);
+
+    return static_cast<uint32_t>(clusters.size());
+}
+
+
+// Renumbers vertices in first use order and compacts the vertex array in place.
+// Works on any interleaved layout. Returns the new vertex count.
+inline size_t
+OptimizeVertexFetch(std::vector<uint32_t>& indices, void* vertexData, size_t vertexCount, size_t vertexStride)
+{
+    const uint32_t unassigned = 0xFFFFFFFF;
+    std::vector<uint32_t> remap(vertexCount, unassigned);
+    uint32_t              nextVertex = 0;
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == unassigned) remap[index] = nextVertex++;
+        index = remap[index];
+    }
+
+    std::vector<uint8_t> reordered(static_cast<size_t>(nextVertex) * vertexStride);
+    const uint8_t*       source = static_cast<const uint8_t*>(vertexData);
+    for (size_t ii = 0; ii < vertexCount; ii++)
+    {
+        if (remap[ii] != unassigned)
+        {
+            memcpy(&reordered[remap[ii] * vertexStride], source + ii * vertexStride, vertexStride);
+        }
+    }
+    memcpy(vertexData, reordered.data(), reordered.size());
+
+    return nextVertex;
+}
+
+
+// Runs all three passes on an imported mesh.
+inline MeshOptimizationReport
+OptimizeMesh(ImportedMesh& mesh, float overdrawThreshold = 1.05f)
+{
+    MeshOptimizationReport report;
+    report.stages.push_back({ "input", AnalyzeVertexCache(mesh.indices, mesh.vertices.size()) });
+
+    std::vector<uint32_t> clusterStarts;
+    mesh.indices = OptimizeVertexCacheTipsify(mesh.indices, mesh.vertices.size(), &clusterStarts);
+    report.stages.push_back({ "vertex cache", AnalyzeVertexCache(mesh.indices, mesh.vertices.size()) });
+
+    report.clusterCount = OptimizeOverdraw(mesh.indices, mesh.vertices.data(), clusterStarts, overdrawThreshold);
+    report.stages.push_back({ "overdraw", AnalyzeVertexCache(mesh.indices, mesh.vertices.size()) });
+
+    size_t vertexCount = OptimizeVertexFetch(mesh.indices, mesh.vertices.data(), mesh.vertices.size(),
+                                             sizeof(MeshVertex));
+    mesh.vertices.resize(vertexCount);
+    report.stages.push_back({ "vertex fetch", AnalyzeVertexCache(mesh.indices, mesh.vertices.size()) });
+
+    return report;
+}
+
+#endif // MESH_OPTIMIZER_H
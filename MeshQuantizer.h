@@ -0,0 +1,245 @@
+#ifndef MESH_QUANTIZER_H
+#define MESH_QUANTIZER_H
+
+// Compresses MeshVertex (48 bytes) into QuantizedMeshVertex (16 bytes) with the
+// glm/gtc/packing.hpp helpers:
+//
+//   position  unorm16 x3 inside the mesh bounds, w = bitangent sign (0 or 1)
+//   normal    octahedral snorm8 x2
+//   tangent   octahedral snorm8 x2
+//   uv        unorm16 x2 inside the mesh UV bounds (so tiling UVs keep full precision)
+//
+// MeshDequantization maps the unorm values back to object space. It is laid out for a
+// push constant block or std140 uniform; QUANTIZED_VERTEX_GLSL has the matching decode.
+
+#include <vulkan/vulkan.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+const uint32_t MESH_VERTEX_FORMAT_QUANTIZED = 1; // QuantizedMeshVertex, MeshDequantization as metadata
+
+
+struct QuantizedMeshVertex
+{
+    uint16_t position[4];
+    uint16_t normal;
+    uint16_t tangent;
+    uint16_t uv[2];
+};
+static_assert(sizeof(QuantizedMeshVertex) == 16, "QuantizedMeshVertex must be 16 bytes.");
+
+
+// position = positionOffset.xyz + positionScale.xyz * quantized.xyz
+// uv       = uvOffsetScale.xy + uvOffsetScale.zw * quantized.uv
+struct MeshDequantization
+{
+    glm::vec4 positionOffset;
+    glm::vec4 positionScale;
+    glm::vec4 uvOffsetScale;
+};
+static_assert(sizeof(MeshDequantization) == 48, "MeshDequantization must match its std140 layout.");
+
+
+const char* const QUANTIZED_VERTEX_GLSL = R"GLSL(
+layout(location = 0) in vec4 inPosition; // R16G16B16A16_UNORM
+layout(location = 1) in vec2 inNormal;   // R8G8_SNORM, octahedral
+layout(location = 2) in vec2 inTangent;  // R8G8_SNORM, octahedral
+layout(location = 3) in vec2 inUv;       // R16G16_UNORM
+
+struct MeshDequantization
+{
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 uvOffsetScale;
+};
+
+vec3 DecodeOctahedral(vec2 e)
+{
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+}
+
+vec3 DequantizePosition(MeshDequantization d) { return d.positionOffset.xyz + d.positionScale.xyz * inPosition.xyz; }
+vec2 DequantizeUv(MeshDequantization d)       { return d.uvOffsetScale.xy + d.uvOffsetScale.zw * inUv; }
+float BitangentSign()                         { return inPosition.w > 0.5 ? 1.0 : -1.0; }
+)GLSL";
+
+
+inline std::array<VkVertexInputAttributeDescription, 4>
+QuantizedVertexAttributes(uint32_t binding)
+{
+    std::array<VkVertexInputAttributeDescription, 4> attributes = {};
+    attributes[0] = { 0, binding, VK_FORMAT_R16G16B16A16_UNORM, offsetof(QuantizedMeshVertex, position) };
+    attributes[1] = { 1, binding, VK_FORMAT_R8G8_SNORM,         offsetof(QuantizedMeshVertex, normal) };
+    attributes[2] = { 2, binding, VK_FORMAT_R8G8_SNORM,         offsetof(QuantizedMeshVertex, tangent) };
+    attributes[3] = { 3, binding, VK_FORMAT_R16G16_UNORM,       offsetof(QuantizedMeshVertex, uv) };
+    return attributes;
+}
+
+
+inline uint16_t
+EncodeOctahedral(glm::vec3 direction)
+{
+    float     length  = std::fabs(direction.x) + std::fabs(direction.y) + std::fabs(direction.z);
+    glm::vec2 encoded = length > 0.0f ? glm::vec2(direction.x, direction.y) / length : glm::vec2(0.0f);
+    if (direction.z < 0.0f)
+    {
+        encoded = glm::vec2((1.0f - std::fabs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+                            (1.0f - std::fabs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return glm::packSnorm2x8(encoded);
+}
+
+
+inline glm::vec3
+DecodeOctahedral(uint16_t packed)
+{
+    glm::vec2 encoded = glm::unpackSnorm2x8(packed);
+    glm::vec3 direction(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+    float     fold = std::max(-direction.z, 0.0f);
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.y += direction.y >= 0.0f ? -fold : fold;
+    return glm::normalize(direction);
+}
+
+
+struct MeshQuantizationReport
+{
+    size_t sourceBytes             = 0;
+    size_t quantizedBytes          = 0;
+    float  positionMaxError        = 0.0f; // Object space units
+    float  positionMaxErrorPercent = 0.0f; // Of the largest bounds extent
+    float  normalMaxErrorDegrees   = 0.0f;
+    float  tangentMaxErrorDegrees  = 0.0f;
+    float  uvMaxError              = 0.0f; // UV units, 1/4096 is one texel of a 4k texture
+
+
+    void
+    Print(const std::string& meshName) const
+    {
+        std::cout << "[ INFO ] Mesh quantization [ " << meshName << " ] " << sourceBytes << " -> "
+                  << quantizedBytes << " vertex bytes" << std::endl;
+        std::cout << std::setprecision(4)
+                  << "\tposition max error " << positionMaxError << " (" << positionMaxErrorPercent << "% of extent)\n"
+                  << "\tnormal max error   " << normalMaxErrorDegrees << " degrees\n"
+                  << "\ttangent max error  " << tangentMaxErrorDegrees << " degrees\n"
+                  << "\tuv max error       " << uvMaxError << std::endl;
+        std::cout << std::setprecision(6);
+    }
+};
+
+
+struct QuantizedMesh
+{
+    std::vector<QuantizedMeshVertex> vertices;
+    std::vector<uint32_t>            indices;
+    MeshDequantization               dequantization;
+    MeshQuantizationReport           report;
+};
+
+
+inline QuantizedMesh
+QuantizeMesh(const ImportedMesh& mesh)
+{
+    QuantizedMesh result;
+    result.indices = mesh.indices;
+    result.vertices.resize(mesh.vertices.size());
+    result.dequantization = {};
+    if (mesh.vertices.empty()) return result;
+
+    glm::vec3 positionMin = mesh.vertices[0].position;
+    glm::vec3 positionMax = positionMin;
+    glm::vec2 uvMin       = mesh.vertices[0].uv;
+    glm::vec2 uvMax       = uvMin;
+    for (const auto& vertex : mesh.vertices)
+    {
+        positionMin = glm::min(positionMin, vertex.position);
+        positionMax = glm::max(positionMax, vertex.position);
+        uvMin       = glm::min(uvMin, vertex.uv);
+        uvMax       = glm::max(uvMax, vertex.uv);
+    }
+
+    // Degenerate axes get a unit scale so the division below stays finite.
+    glm::vec3 positionScale = positionMax - positionMin;
+    glm::vec2 uvScale       = uvMax - uvMin;
+    for (int axis = 0; axis < 3; axis++) if (positionScale[axis] <= 0.0f) positionScale[axis] = 1.0f;
+    for (int axis = 0; axis < 2; axis++) if (uvScale[axis] <= 0.0f) uvScale[axis] = 1.0f;
+
+    MeshDequantization& dequantization = result.dequantization;
+    dequantization.positionOffset = glm::vec4(positionMin, 0.0f);
+    dequantization.positionScale  = glm::vec4(positionScale, 0.0f);
+    dequantization.uvOffsetScale  = glm::vec4(uvMin, uvScale);
+
+    MeshQuantizationReport& report = result.report;
+    report.sourceBytes    = mesh.vertices.size() * sizeof(MeshVertex);
+    report.quantizedBytes = result.vertices.size() * sizeof(QuantizedMeshVertex);
+
+    const float radiansToDegrees = 57.2957795f;
+    for (size_t ii = 0; ii < mesh.vertices.size(); ii++)
+    {
+        const MeshVertex&    source    = mesh.vertices[ii];
+        QuantizedMeshVertex& quantized = result.vertices[ii];
+
+        glm::vec4 position((source.position - positionMin) / positionScale, source.tangent.w < 0.0f ? 0.0f : 1.0f);
+        uint64_t  packedPosition = glm::packUnorm4x16(glm::clamp(position, 0.0f, 1.0f));
+        memcpy(quantized.position, &packedPosition, sizeof(quantized.position));
+
+        glm::vec2 uv = glm::clamp((source.uv - uvMin) / uvScale, 0.0f, 1.0f);
+        quantized.uv[0]   = glm::packUnorm1x16(uv.x);
+        quantized.uv[1]   = glm::packUnorm1x16(uv.y);
+        quantized.normal  = EncodeOctahedral(source.normal);
+        quantized.tangent = EncodeOctahedral(glm::vec3(source.tangent));
+
+        // Error report, measured on the values a shader would reconstruct.
+        glm::vec3 decodedPosition = glm::vec3(dequantization.positionOffset) +
+            glm::vec3(dequantization.positionScale) * glm::vec3(glm::unpackUnorm4x16(packedPosition));
+        glm::vec3 positionError = glm::abs(decodedPosition - source.position);
+        report.positionMaxError = std::max(report.positionMaxError,
+                                           std::max(positionError.x, std::max(positionError.y, positionError.z)));
+
+        glm::vec2 decodedUv = uvMin + uvScale * glm::vec2(glm::unpackUnorm1x16(quantized.uv[0]),
+                                                          glm::unpackUnorm1x16(quantized.uv[1]));
+        glm::vec2 uvError   = glm::abs(decodedUv - source.uv);
+        report.uvMaxError   = std::max(report.uvMaxError, std::max(uvError.x, uvError.y));
+
+        if (glm::length(source.normal) > 0.0f)
+        {
+            float cosine = glm::dot(glm::normalize(source.normal), DecodeOctahedral(quantized.normal));
+            report.normalMaxErrorDegrees = std::max(report.normalMaxErrorDegrees,
+                                                    std::acos(glm::clamp(cosine, -1.0f, 1.0f)) * radiansToDegrees);
+        }
+
+        glm::vec3 tangent(source.tangent);
+        if (glm::length(tangent) > 0.0f)
+        {
+            float cosine = glm::dot(glm::normalize(tangent), DecodeOctahedral(quantized.tangent));
+            report.tangentMaxErrorDegrees = std::max(report.tangentMaxErrorDegrees,
+                                                     std::acos(glm::clamp(cosine, -1.0f, 1.0f)) * radiansToDegrees);
+        }
+    }
+
+    float extent = std::max(positionMax.x - positionMin.x,
+                            std::max(positionMax.y - positionMin.y, positionMax.z - positionMin.z));
+    report.positionMaxErrorPercent = extent > 0.0f ? 100.0f * report.positionMaxError / extent : 0.0f;
+    return result;
+}
+
+#endif // MESH_QUANTIZER_H
@@ -0,0 +1,416 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+// Quadric error metric simplification (Garland, Heckbert 1997) and LOD chain generation.
+//
+// Simplification uses half edge collapses: a vertex is always merged into one of its
+// neighbours, so every LOD indexes the original vertex buffer and LODs only cost index
+// memory. Collapses run in passes; each pass sorts the candidate edges by cost and
+// greedily collapses those whose vertices were not touched yet in that pass.
+//
+//   - Quadrics are area weighted face planes plus heavily weighted planes through open
+//     border edges, so holes and sheet edges keep their outline.
+//   - Vertices sharing a position with another vertex (UV or normal seams) never move;
+//     moving one side of a seam would open a crack.
+//   - A collapse that would flip (or nearly flip) any remaining triangle is rejected.
+//
+// The reported error is the square root of the area normalized quadric error, roughly the
+// RMS distance from the original surface in object space units. LOD selection turns it
+// into a projected size in pixels (SelectLod(), GpuScene).
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include "MeshImporter.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// Border plane quadrics are scaled by this so open edges collapse only along themselves.
+const float MESH_SIMPLIFIER_BORDER_WEIGHT = 10.0f;
+
+
+struct MeshQuadric
+{
+    // Symmetric 4x4 matrix: a2 ab ac ad b2 bc bd c2 cd d2, plus the accumulated area.
+    double terms[10];
+    double weight;
+
+
+    static MeshQuadric
+    FromPlane(const glm::vec3& normal, float distance, double planeWeight)
+    {
+        double a = normal.x;
+        double b = normal.y;
+        double c = normal.z;
+        double d = distance;
+
+        MeshQuadric quadric;
+        quadric.terms[0] = a * a * planeWeight;
+        quadric.terms[1] = a * b * planeWeight;
+        quadric.terms[2] = a * c * planeWeight;
+        quadric.terms[3] = a * d * planeWeight;
+        quadric.terms[4] = b * b * planeWeight;
+        quadric.terms[5] = b * c * planeWeight;
+        quadric.terms[6] = b * d * planeWeight;
+        quadric.terms[7] = c * c * planeWeight;
+        quadric.terms[8] = c * d * planeWeight;
+        quadric.terms[9] = d * d * planeWeight;
+        quadric.weight   = planeWeight;
+        return quadric;
+    }
+
+
+    void
+    Add(const MeshQuadric& other)
+    {
+        for (int ii = 0; ii < 10; ii++) terms[ii] += other.terms[ii];
+        weight += other.weight;
+    }
+
+
+    // Weighted squared distance of point to the accumulated planes.
+    double
+    Evaluate(const glm::vec3& point) const
+    {
+        double x = point.x;
+        double y = point.y;
+        double z = point.z;
+        double error = terms[0] * x * x + 2.0 * terms[1] * x * y + 2.0 * terms[2] * x * z + 2.0 * terms[3] * x +
+                       terms[4] * y * y + 2.0 * terms[5] * y * z + 2.0 * terms[6] * y +
+                       terms[7] * z * z + 2.0 * terms[8] * z + terms[9];
+        return std::max(error, 0.0);
+    }
+};
+
+
+// Simplifies the triangle list towards targetIndexCount indices, stopping early when no
+// collapse below maxError (object space units) remains. Returns the new index list;
+// error receives the largest error of any collapse that was performed.
+inline std::vector<uint32_t>
+SimplifyMesh(const std::vector<uint32_t>& sourceIndices,
+             const MeshVertex*            vertices,
+             size_t                       vertexCount,
+             size_t                       targetIndexCount,
+             float                        maxError,
+             float*                       error = nullptr)
+{
+    std::vector<uint32_t> indices     = sourceIndices;
+    float                 resultError = 0.0f;
+
+    // Seams: any vertex whose position is shared with another vertex is locked.
+    std::vector<uint8_t> locked(vertexCount, 0);
+    {
+        struct PositionHash
+        {
+            size_t operator()(const glm::vec3& position) const
+            {
+                uint32_t bits[3];
+                memcpy(bits, &position, sizeof(bits));
+                return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+            }
+        };
+
+        std::unordered_map<glm::vec3, uint32_t, PositionHash> firstAtPosition;
+        firstAtPosition.reserve(vertexCount);
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            auto inserted = firstAtPosition.insert(std::make_pair(vertices[vertex].position, vertex));
+            if (!inserted.second)
+            {
+                locked[vertex]                 = 1;
+                locked[inserted.first->second] = 1;
+            }
+        }
+    }
+
+    std::vector<MeshQuadric> quadrics(vertexCount, MeshQuadric::FromPlane(glm::vec3(0.0f), 0.0f, 0.0));
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    edgeUses.reserve(indices.size());
+    auto edgeKey = [](uint32_t a, uint32_t b)
+    {
+        return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+    };
+
+    for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+    {
+        const glm::vec3& p0 = vertices[indices[triangle]].position;
+        const glm::vec3& p1 = vertices[indices[triangle + 1]].position;
+        const glm::vec3& p2 = vertices[indices[triangle + 2]].position;
+        glm::vec3        cross = glm::cross(p1 - p0, p2 - p0);
+        float            area  = glm::length(cross);
+        if (area <= 0.0f) continue;
+
+        glm::vec3   normal = cross / area;
+        MeshQuadric plane  = MeshQuadric::FromPlane(normal, -glm::dot(normal, p0), area * 0.5);
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            quadrics[indices[triangle + corner]].Add(plane);
+            edgeUses[edgeKey(indices[triangle + corner], indices[triangle + (corner + 1) % 3])]++;
+        }
+    }
+
+    // Border edges are used by exactly one triangle; add a plane through the edge,
+    // perpendicular to its triangle.
+    for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+    {
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t a = indices[triangle + corner];
+            uint32_t b = indices[triangle + (corner + 1) % 3];
+            if (edgeUses[edgeKey(a, b)] != 1) continue;
+
+            const glm::vec3& pa         = vertices[a].position;
+            const glm::vec3& pc         = vertices[indices[triangle + (corner + 2) % 3]].position;
+            glm::vec3        edge       = vertices[b].position - pa;
+            glm::vec3        faceNormal = glm::cross(edge, pc - pa);
+            float            length     = glm::length(edge);
+            glm::vec3        normal     = glm::cross(edge, faceNormal);
+            if (length <= 0.0f || glm::length(normal) <= 0.0f) continue;
+
+            normal = glm::normalize(normal);
+            MeshQuadric border = MeshQuadric::FromPlane(normal, -glm::dot(normal, pa),
+                                                        length * length * MESH_SIMPLIFIER_BORDER_WEIGHT);
+            border.weight = 0.0; // Constraint only, not surface area
+            quadrics[a].Add(border);
+            quadrics[b].Add(border);
+        }
+    }
+
+    auto collapseError = [&](uint32_t from, uint32_t to)
+    {
+        MeshQuadric combined = quadrics[from];
+        combined.Add(quadrics[to]);
+        return combined.weight > 0.0 ? std::sqrt(combined.Evaluate(vertices[to].position) / combined.weight) : 0.0;
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        float    error;
+    };
+
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t>  touched(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+
+    while (indices.size() > targetIndexCount)
+    {
+        // Vertex -> triangle adjacency for the flip test.
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : indices) adjacencyOffsets[index + 1]++;
+        for (size_t vertex = 0; vertex < vertexCount; vertex++) adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+        adjacency.resize(indices.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t corner = 0; corner < indices.size(); corner++)
+            {
+                adjacency[cursor[indices[corner]]++] = static_cast<uint32_t>(corner / 3);
+            }
+        }
+
+        // Cheapest direction of every edge. Interior edges appear once per winding, so
+        // only the a < b occurrence is used; border edges appear once either way.
+        collapses.clear();
+        for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+        {
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                uint32_t a = indices[triangle + corner];
+                uint32_t b = indices[triangle + (corner + 1) % 3];
+                if (a > b && edgeUses[edgeKey(a, b)] != 1) continue;
+
+                double errorAb = locked[a] ? -1.0 : collapseError(a, b);
+                double errorBa = locked[b] ? -1.0 : collapseError(b, a);
+                if (errorAb < 0.0 && errorBa < 0.0) continue;
+
+                Collapse collapse;
+                if (errorBa < 0.0 || (errorAb >= 0.0 && errorAb <= errorBa))
+                {
+                    collapse = { a, b, static_cast<float>(errorAb) };
+                }
+                else
+                {
+                    collapse = { b, a, static_cast<float>(errorBa) };
+                }
+                if (collapse.error <= maxError) collapses.push_back(collapse);
+            }
+        }
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right)
+        {
+            return left.error < right.error;
+        });
+
+        // Each collapse removes about two triangles; do not overshoot the target by much.
+        size_t trianglesToRemove = (indices.size() - targetIndexCount) / 3;
+        size_t collapseBudget    = std::max<size_t>(trianglesToRemove / 2, 1);
+
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++) remap[vertex] = vertex;
+        std::fill(touched.begin(), touched.end(), static_cast<uint8_t>(0));
+
+        size_t performed = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (performed >= collapseBudget) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            // Reject collapses that flip a surviving triangle around the moved vertex.
+            const glm::vec3& target  = vertices[collapse.to].position;
+            bool             flipped = false;
+            for (uint32_t ii = adjacencyOffsets[collapse.from]; ii < adjacencyOffsets[collapse.from + 1] && !flipped; ii++)
+            {
+                const uint32_t* triangle = &indices[adjacency[ii] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) continue;
+
+                glm::vec3 before[3];
+                glm::vec3 after[3];
+                for (uint32_t corner = 0; corner < 3; corner++)
+                {
+                    before[corner] = vertices[triangle[corner]].position;
+                    after[corner]  = triangle[corner] == collapse.from ? target : before[corner];
+                }
+                glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+                // Also rejects turns of more than ~75 degrees, which mostly create slivers.
+                flipped = glm::dot(normalBefore, normalAfter) <=
+                          0.25f * glm::length(normalBefore) * glm::length(normalAfter);
+            }
+            if (flipped) continue;
+
+            // Lock the whole one ring so the flip test above stays valid for this pass.
+            for (uint32_t ii = adjacencyOffsets[collapse.from]; ii < adjacencyOffsets[collapse.from + 1]; ii++)
+            {
+                for (uint32_t corner = 0; corner < 3; corner++) touched[indices[adjacency[ii] * 3 + corner]] = 1;
+            }
+            for (uint32_t ii = adjacencyOffsets[collapse.to]; ii < adjacencyOffsets[collapse.to + 1]; ii++)
+            {
+                for (uint32_t corner = 0; corner < 3; corner++) touched[indices[adjacency[ii] * 3 + corner]] = 1;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].Add(quadrics[collapse.from]);
+            resultError = std::max(resultError, collapse.error);
+            performed++;
+        }
+        if (performed == 0) break;
+
+        // Apply the pass and drop degenerate triangles.
+        size_t written = 0;
+        for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+        {
+            uint32_t a = remap[indices[triangle]];
+            uint32_t b = remap[indices[triangle + 1]];
+            uint32_t c = remap[indices[triangle + 2]];
+            if (a == b || b == c || a == c) continue;
+
+            indices[written++] = a;
+            indices[written++] = b;
+            indices[written++] = c;
+        }
+        indices.resize(written);
+
+        // Border classification changes as the mesh shrinks.
+        edgeUses.clear();
+        for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+        {
+            for (uint32_t corner = 0; corner < 3; corner++)
+            {
+                edgeUses[edgeKey(indices[triangle + corner], indices[triangle + (corner + 1) % 3])]++;
+            }
+        }
+    }
+
+    if (error) *error = resultError;
+    return indices;
+}
+
+
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float    error; // Object space, never smaller than the previous LOD's
+};
+
+
+// All LODs share one index buffer and the mesh's vertex buffer. lods[0] is the source.
+struct MeshLodChain
+{
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod>  lods;
+};
+
+
+// ratios: target triangle fraction of every LOD after the first, e.g. { 0.5, 0.25, 0.125 }.
+// LODs that fail to shrink at least 10% below the previous one are dropped; every LOD is
+// reordered for the vertex cache.
+inline MeshLodChain
+GenerateLods(const ImportedMesh& mesh, const std::vector<float>& ratios, float maxError = 1e30f)
+{
+    MeshLodChain chain;
+    chain.indices = mesh.indices;
+
+    MeshLod source = { 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f };
+    chain.lods.push_back(source);
+
+    for (float ratio : ratios)
+    {
+        size_t target = static_cast<size_t>(static_cast<double>(mesh.indices.size() / 3) * ratio) * 3;
+        float  error  = 0.0f;
+
+        // Always simplify the source, so quadrics measure against the original surface.
+        std::vector<uint32_t> simplified = SimplifyMesh(mesh.indices, mesh.vertices.data(), mesh.vertices.size(),
+                                                        target, maxError, &error);
+        if (simplified.empty() || simplified.size() * 10 > static_cast<size_t>(chain.lods.back().indexCount) * 9)
+        {
+            continue;
+        }
+
+        simplified = OptimizeVertexCacheTipsify(simplified, mesh.vertices.size());
+
+        MeshLod lod;
+        lod.firstIndex = static_cast<uint32_t>(chain.indices.size());
+        lod.indexCount = static_cast<uint32_t>(simplified.size());
+        lod.error      = std::max(error, chain.lods.back().error);
+        chain.lods.push_back(lod);
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+    }
+
+    return chain;
+}
+
+
+// Screen space LOD choice for CPU side paths; GpuScene runs the same rule in its culling
+// shader. pixelScale = |projection[1][1]| * viewportHeight / 2. A LOD is acceptable while
+// its projected error stays below thresholdPixels; moving to a coarser LOD additionally
+// requires its error to be below thresholdPixels * hysteresis, so objects near a switch
+// distance do not flicker between two LODs.
+inline uint32_t
+SelectLod(const MeshLod* lods,
+          uint32_t       lodCount,
+          uint32_t       currentLod,
+          float          distance,
+          float          objectScale,
+          float          pixelScale,
+          float          thresholdPixels,
+          float          hysteresis = 0.75f)
+{
+    float    pixelsPerUnit = objectScale * pixelScale / std::max(distance, 1e-4f);
+    uint32_t lod           = std::min(currentLod, lodCount - 1);
+
+    while (lod > 0 && lods[lod].error * pixelsPerUnit > thresholdPixels) lod--;
+    while (lod + 1 < lodCount && lods[lod + 1].error * pixelsPerUnit <= thresholdPixels * hysteresis) lod++;
+    return lod;
+}
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,222 @@
+#ifndef MESHLETS_H
+#define MESHLETS_H
+
+// Splits a triangle list into meshlets of at most MESHLET_MAX_VERTICES vertices and
+// MESHLET_MAX_TRIANGLES triangles, each with a bounding sphere and a normal cone for
+// GPU cluster culling (see ClusterCulling.h).
+//
+// Triangles are consumed greedily in index order, so the input should already be vertex
+// cache optimized (MeshOptimizer.h); Tipsify order keeps neighbouring triangles together
+// and produces compact, well filled meshlets.
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+
+#include "MeshImporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+
+const uint32_t MESHLET_MAX_VERTICES  = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+
+struct Meshlet
+{
+    uint32_t vertexOffset;   // Into MeshletMesh::meshletVertices
+    uint32_t triangleOffset; // In triangles, into MeshletMesh::indices and localTriangles
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+};
+
+
+// std430 friendly; w components carry the scalars.
+struct MeshletBounds
+{
+    glm::vec4 sphere;   // xyz = center, w = radius
+    glm::vec4 coneApex; // xyz = apex, w = cutoff (>= 1 means the cone is unusable)
+    glm::vec4 coneAxis; // xyz = normalized average facing direction
+};
+
+
+struct MeshletMesh
+{
+    std::vector<Meshlet>       meshlets;
+    std::vector<MeshletBounds> bounds;
+    std::vector<uint32_t>      meshletVertices; // Mesh vertex index per meshlet local vertex
+    std::vector<uint8_t>       localTriangles;  // Three meshlet local vertex indices per triangle
+    std::vector<uint32_t>      indices;         // Same triangles with mesh vertex indices, meshlet order
+};
+
+
+// Ritter's bounding sphere: not minimal, but within a few percent and linear time.
+inline glm::vec4
+ComputeBoundingSphere(const std::vector<glm::vec3>& points)
+{
+    if (points.empty()) return glm::vec4(0.0f);
+
+    glm::vec3 first    = points[0];
+    glm::vec3 farthest = first;
+    for (const auto& point : points)
+    {
+        if (glm::dot(point - first, point - first) > glm::dot(farthest - first, farthest - first)) farthest = point;
+    }
+
+    glm::vec3 opposite = farthest;
+    for (const auto& point : points)
+    {
+        if (glm::dot(point - farthest, point - farthest) > glm::dot(opposite - farthest, opposite - farthest))
+        {
+            opposite = point;
+        }
+    }
+
+    glm::vec3 center = (farthest + opposite) * 0.5f;
+    float     radius = glm::length(opposite - farthest) * 0.5f;
+    for (const auto& point : points)
+    {
+        float distance = glm::length(point - center);
+        if (distance > radius)
+        {
+            float grown = (radius + distance) * 0.5f;
+            center += (point - center) * ((grown - radius) / distance);
+            radius  = grown;
+        }
+    }
+
+    return glm::vec4(center, radius);
+}
+
+
+inline MeshletBounds
+ComputeMeshletBounds(const MeshletMesh& result, const Meshlet& meshlet, const MeshVertex* vertices)
+{
+    std::vector<glm::vec3> points(meshlet.vertexCount);
+    for (uint32_t ii = 0; ii < meshlet.vertexCount; ii++)
+    {
+        points[ii] = vertices[result.meshletVertices[meshlet.vertexOffset + ii]].position;
+    }
+
+    MeshletBounds bounds = {};
+    bounds.sphere = ComputeBoundingSphere(points);
+
+    // Normal cone: average of the unit triangle normals, widened to the farthest normal.
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> corners;
+    glm::vec3              normalSum(0.0f);
+    for (uint32_t triangle = 0; triangle < meshlet.triangleCount; triangle++)
+    {
+        const uint8_t* local = &result.localTriangles[(meshlet.triangleOffset + triangle) * 3];
+        glm::vec3      p0    = points[local[0]];
+        glm::vec3      p1    = points[local[1]];
+        glm::vec3      p2    = points[local[2]];
+        glm::vec3      cross = glm::cross(p1 - p0, p2 - p0);
+        float          area  = glm::length(cross);
+        if (area <= 0.0f) continue;
+
+        normals.push_back(cross / area);
+        corners.push_back(p0);
+        normalSum += cross / area;
+    }
+
+    bounds.coneApex = glm::vec4(glm::vec3(bounds.sphere), 2.0f);
+    bounds.coneAxis = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+
+    float axisLength = glm::length(normalSum);
+    if (normals.empty() || axisLength <= 0.0f) return bounds;
+
+    glm::vec3 axis       = normalSum / axisLength;
+    float     minimumDot = 1.0f;
+    for (const auto& normal : normals) minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+
+    // A cone wider than ~84 degrees rarely culls anything; leave it disabled.
+    if (minimumDot <= 0.1f) return bounds;
+
+    // Apex: move back along the axis until every triangle plane faces away from it.
+    glm::vec3 center  = glm::vec3(bounds.sphere);
+    float     maximum = 0.0f;
+    for (size_t ii = 0; ii < normals.size(); ii++)
+    {
+        float t = glm::dot(center - corners[ii], normals[ii]) / glm::dot(axis, normals[ii]);
+        maximum = std::max(maximum, t);
+    }
+
+    bounds.coneApex = glm::vec4(center - axis * maximum, std::sqrt(1.0f - minimumDot * minimumDot));
+    bounds.coneAxis = glm::vec4(axis, 0.0f);
+    return bounds;
+}
+
+
+inline MeshletMesh
+BuildMeshlets(const std::vector<uint32_t>& indices, const MeshVertex* vertices, size_t vertexCount)
+{
+    const uint8_t unassigned = 0xFF;
+
+    MeshletMesh          result;
+    std::vector<uint8_t> localIndex(vertexCount, unassigned);
+    Meshlet              current = {};
+
+    auto finish = [&]()
+    {
+        if (current.triangleCount == 0) return;
+        for (uint32_t ii = 0; ii < current.vertexCount; ii++)
+        {
+            localIndex[result.meshletVertices[current.vertexOffset + ii]] = unassigned;
+        }
+
+        result.meshlets.push_back(current);
+        current                = {};
+        current.vertexOffset   = static_cast<uint32_t>(result.meshletVertices.size());
+        current.triangleOffset = static_cast<uint32_t>(result.localTriangles.size() / 3);
+    };
+
+    for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+    {
+        const uint32_t* corners  = &indices[triangle];
+        uint32_t        newCount = 0;
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            bool repeated = (corner > 0 && corners[corner] == corners[0]) ||
+                            (corner > 1 && corners[corner] == corners[1]);
+            if (localIndex[corners[corner]] == unassigned && !repeated) newCount++;
+        }
+
+        if (current.vertexCount + newCount > MESHLET_MAX_VERTICES || current.triangleCount == MESHLET_MAX_TRIANGLES)
+        {
+            finish();
+        }
+
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t vertex = corners[corner];
+            if (localIndex[vertex] == unassigned)
+            {
+                localIndex[vertex] = static_cast<uint8_t>(current.vertexCount++);
+                result.meshletVertices.push_back(vertex);
+            }
+            result.localTriangles.push_back(localIndex[vertex]);
+            result.indices.push_back(vertex);
+        }
+        current.triangleCount++;
+    }
+    finish();
+
+    result.bounds.reserve(result.meshlets.size());
+    for (const auto& meshlet : result.meshlets)
+    {
+        result.bounds.push_back(ComputeMeshletBounds(result, meshlet, vertices));
+    }
+    return result;
+}
+
+
+inline MeshletMesh
+BuildMeshlets(const ImportedMesh& mesh)
+{
+    return BuildMeshlets(mesh.indices, mesh.vertices.data(), mesh.vertices.size());
+}
+
+#endif // MESHLETS_H
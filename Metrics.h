@@ -0,0 +1,508 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// Process-wide metrics registry: counters, gauges and histograms with Prometheus text
+// exposition (see MetricsEndpoint.h for serving it).
+//
+// Registration takes a lock and returns a reference that stays valid for the life of the
+// process; updates through that reference are relaxed atomics and can come from any
+// thread. Metrics sharing a name form one family and differ by their label string, e.g.
+// Gauge("vulkan_heap_size_bytes", "...", "heap=\"0\"").
+//
+// FrameMetrics registers the standard per frame set (frame time, draw calls, triangles,
+// pipeline binds, descriptor writes, upload bytes, memory heaps), tallies a frame with
+// plain adds on the render thread and publishes it in EndFrame(). OverlayText() gives a
+// one line summary for on-screen display.
+
+#include <vulkan/vulkan.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+
+enum MetricType
+{
+    METRIC_TYPE_COUNTER,
+    METRIC_TYPE_GAUGE,
+    METRIC_TYPE_HISTOGRAM
+};
+
+
+// Doubles in an atomic<uint64_t>; std::atomic<double> has no fetch_add before C++20.
+class AtomicDouble
+{
+public:
+    double
+    Load() const
+    {
+        uint64_t bits = value.load(std::memory_order_relaxed);
+        double   result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+
+    void
+    Store(double newValue)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &newValue, sizeof(bits));
+        value.store(bits, std::memory_order_relaxed);
+    }
+
+
+    void
+    Add(double delta)
+    {
+        uint64_t expected = value.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            double current;
+            std::memcpy(&current, &expected, sizeof(current));
+            double   sum = current + delta;
+            uint64_t desired;
+            std::memcpy(&desired, &sum, sizeof(desired));
+            if (value.compare_exchange_weak(expected, desired, std::memory_order_relaxed)) return;
+        }
+    }
+
+
+private:
+    std::atomic<uint64_t> value { 0 }; // Bit pattern of 0.0
+};
+
+
+class MetricCounter
+{
+public:
+    void
+    Add(uint64_t delta = 1)
+    {
+        value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+
+    uint64_t
+    Value() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+
+private:
+    std::atomic<uint64_t> value { 0 };
+};
+
+
+class MetricGauge
+{
+public:
+    void
+    Set(double newValue)
+    {
+        value.Store(newValue);
+    }
+
+
+    void
+    Add(double delta)
+    {
+        value.Add(delta);
+    }
+
+
+    double
+    Value() const
+    {
+        return value.Load();
+    }
+
+
+private:
+    AtomicDouble value;
+};
+
+
+// Cumulative buckets as Prometheus expects them; bounds are upper bounds in ascending
+// order, +Inf is implicit.
+class MetricHistogram
+{
+public:
+    explicit MetricHistogram(const std::vector<double>& upperBounds)
+        : bounds(upperBounds),
+          buckets(new std::atomic<uint64_t>[upperBounds.size() + 1])
+    {
+        for (size_t ii = 0; ii <= bounds.size(); ii++)
+        {
+            buckets[ii].store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    void
+    Observe(double value)
+    {
+        size_t bucket = static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.Add(value);
+    }
+
+
+    const std::vector<double>&
+    Bounds() const
+    {
+        return bounds;
+    }
+
+
+    // Observations in bucket index alone (not cumulative); index Bounds().size() is +Inf.
+    uint64_t
+    BucketCount(size_t index) const
+    {
+        return buckets[index].load(std::memory_order_relaxed);
+    }
+
+
+    uint64_t
+    Count() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+
+    double
+    Sum() const
+    {
+        return sum.Load();
+    }
+
+
+private:
+    std::vector<double>                      bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+    std::atomic<uint64_t>                    count { 0 };
+    AtomicDouble                             sum;
+};
+
+
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry&
+    Instance()
+    {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+
+    // Returns the existing metric when name and labels were registered before.
+    MetricCounter&
+    Counter(const std::string& name, const std::string& help, const std::string& labels = std::string())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Metric& metric = FindOrAdd(name, help, labels, METRIC_TYPE_COUNTER);
+        if (!metric.counter) metric.counter.reset(new MetricCounter());
+        return *metric.counter;
+    }
+
+
+    MetricGauge&
+    Gauge(const std::string& name, const std::string& help, const std::string& labels = std::string())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Metric& metric = FindOrAdd(name, help, labels, METRIC_TYPE_GAUGE);
+        if (!metric.gauge) metric.gauge.reset(new MetricGauge());
+        return *metric.gauge;
+    }
+
+
+    // upperBounds is only used on first registration.
+    MetricHistogram&
+    Histogram(const std::string&         name,
+              const std::string&         help,
+              const std::vector<double>& upperBounds,
+              const std::string&         labels = std::string())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Metric& metric = FindOrAdd(name, help, labels, METRIC_TYPE_HISTOGRAM);
+        if (!metric.histogram) metric.histogram.reset(new MetricHistogram(upperBounds));
+        return *metric.histogram;
+    }
+
+
+    // Prometheus text format 0.0.4. Each metric is read atomically, the set as a whole is
+    // not a snapshot.
+    std::string
+    PrometheusText() const
+    {
+        std::ostringstream text;
+        text.precision(12);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& family : families)
+        {
+            static const char* const typeNames[] = { "counter", "gauge", "histogram" };
+            text << "# HELP " << family.name << " " << family.help << "\n"
+                 << "# TYPE " << family.name << " " << typeNames[family.type] << "\n";
+
+            for (const auto& metric : family.metrics)
+            {
+                if (family.type == METRIC_TYPE_COUNTER)
+                {
+                    text << family.name << Labels(metric->labels, std::string()) << " " << metric->counter->Value() << "\n";
+                }
+                else if (family.type == METRIC_TYPE_GAUGE)
+                {
+                    text << family.name << Labels(metric->labels, std::string()) << " " << metric->gauge->Value() << "\n";
+                }
+                else
+                {
+                    const MetricHistogram& histogram  = *metric->histogram;
+                    uint64_t               cumulative = 0;
+                    for (size_t ii = 0; ii <= histogram.Bounds().size(); ii++)
+                    {
+                        std::ostringstream bound;
+                        if (ii < histogram.Bounds().size()) bound << histogram.Bounds()[ii];
+                        else                                bound << "+Inf";
+
+                        cumulative += histogram.BucketCount(ii);
+                        text << family.name << "_bucket" << Labels(metric->labels, "le=\"" + bound.str() + "\"")
+                             << " " << cumulative << "\n";
+                    }
+                    text << family.name << "_sum" << Labels(metric->labels, std::string()) << " " << histogram.Sum() << "\n"
+                         << family.name << "_count" << Labels(metric->labels, std::string()) << " " << histogram.Count() << "\n";
+                }
+            }
+        }
+        return text.str();
+    }
+
+
+private:
+    struct Metric
+    {
+        std::string                      labels;
+        std::unique_ptr<MetricCounter>   counter;
+        std::unique_ptr<MetricGauge>     gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    struct Family
+    {
+        std::string                          name;
+        std::string                          help;
+        MetricType                           type = METRIC_TYPE_COUNTER;
+        std::vector<std::unique_ptr<Metric>> metrics;
+    };
+
+
+    MetricsRegistry() = default;
+
+
+    Metric&
+    FindOrAdd(const std::string& name, const std::string& help, const std::string& labels, MetricType type)
+    {
+        Family* family = nullptr;
+        for (auto& candidate : families)
+        {
+            if (candidate.name == name) family = &candidate;
+        }
+
+        if (!family)
+        {
+            families.emplace_back();
+            family       = &families.back();
+            family->name = name;
+            family->help = help;
+            family->type = type;
+        }
+        else if (family->type != type)
+        {
+            throw std::runtime_error("[ ERROR ] Metric " + name + " registered with two different types.");
+        }
+
+        for (auto& metric : family->metrics)
+        {
+            if (metric->labels == labels) return *metric;
+        }
+        family->metrics.emplace_back(new Metric());
+        family->metrics.back()->labels = labels;
+        return *family->metrics.back();
+    }
+
+
+    static std::string
+    Labels(const std::string& labels, const std::string& extra)
+    {
+        if (labels.empty() && extra.empty()) return std::string();
+        if (labels.empty()) return "{" + extra + "}";
+        if (extra.empty())  return "{" + labels + "}";
+        return "{" + labels + "," + extra + "}";
+    }
+
+
+    mutable std::mutex  mutex;
+    std::vector<Family> families; // Stable addresses are only needed for the Metric objects
+};
+
+
+// The standard frame loop metrics. Add*() calls are plain adds meant for the render
+// thread; EndFrame() publishes the frame to the registry.
+class FrameMetrics
+{
+public:
+    void
+    Create(MetricsRegistry& registry = MetricsRegistry::Instance())
+    {
+        metrics = &registry;
+
+        // 1 ms .. 250 ms, in seconds as Prometheus convention has it.
+        std::vector<double> frameBounds = { 0.001, 0.002, 0.004, 0.008, 0.0125, 0.0167, 0.025, 0.0333,
+                                            0.05, 0.1, 0.25 };
+        frameTime   = &registry.Histogram("frame_time_seconds", "CPU time between frame starts.", frameBounds);
+        frames      = &registry.Counter("frames_total", "Frames completed.");
+        drawCalls   = &registry.Counter("draw_calls_total", "Draw commands recorded.");
+        triangles   = &registry.Counter("triangles_total", "Triangles submitted by draw commands.");
+        binds       = &registry.Counter("pipeline_binds_total", "vkCmdBindPipeline calls.");
+        writes      = &registry.Counter("descriptor_writes_total", "Descriptors written by vkUpdateDescriptorSets.");
+        uploads     = &registry.Counter("upload_bytes_total", "Bytes copied from staging to device memory.");
+        frameDraws  = &registry.Gauge("frame_draw_calls", "Draw commands recorded in the last frame.");
+        frameTris   = &registry.Gauge("frame_triangles", "Triangles submitted in the last frame.");
+    }
+
+
+    void AddDrawCalls(uint32_t count)        { current.drawCalls += count; }
+    void AddTriangles(uint64_t count)        { current.triangles += count; }
+    void AddPipelineBinds(uint32_t count)    { current.pipelineBinds += count; }
+    void AddDescriptorWrites(uint32_t count) { current.descriptorWrites += count; }
+    void AddUploadBytes(uint64_t bytes)      { current.uploadBytes += bytes; }
+
+
+    // Heap sizes never change; usage is only known to the caller (allocator totals or
+    // VK_EXT_memory_budget) and is published once it is first reported.
+    void
+    SetHeapSizes(VkPhysicalDevice physicalDevice)
+    {
+        VkPhysicalDeviceMemoryProperties properties = {};
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &properties);
+        for (uint32_t ii = 0; ii < properties.memoryHeapCount; ii++)
+        {
+            std::string labels = HeapLabels(ii, properties.memoryHeaps[ii].flags);
+            metrics->Gauge("vulkan_heap_size_bytes", "Size of the Vulkan memory heap.", labels)
+                .Set(static_cast<double>(properties.memoryHeaps[ii].size));
+            heapSizes.push_back(properties.memoryHeaps[ii].size);
+            heapFlags.push_back(properties.memoryHeaps[ii].flags);
+        }
+    }
+
+
+    void
+    SetHeapUsage(uint32_t heapIndex, uint64_t usedBytes)
+    {
+        if (heapIndex >= heapSizes.size()) return;
+        if (heapUsage.size() < heapSizes.size()) heapUsage.resize(heapSizes.size(), nullptr);
+        if (!heapUsage[heapIndex])
+        {
+            heapUsage[heapIndex] = &metrics->Gauge("vulkan_heap_used_bytes", "Bytes allocated from the Vulkan memory heap.",
+                                                   HeapLabels(heapIndex, heapFlags[heapIndex]));
+        }
+        heapUsage[heapIndex]->Set(static_cast<double>(usedBytes));
+    }
+
+
+    void
+    EndFrame(double frameSeconds)
+    {
+        frameTime->Observe(frameSeconds);
+        frames->Add();
+        drawCalls->Add(current.drawCalls);
+        triangles->Add(current.triangles);
+        binds->Add(current.pipelineBinds);
+        writes->Add(current.descriptorWrites);
+        uploads->Add(current.uploadBytes);
+        frameDraws->Set(static_cast<double>(current.drawCalls));
+        frameTris->Set(static_cast<double>(current.triangles));
+
+        // Exponential moving average so the overlay does not flicker.
+        averageSeconds = averageSeconds == 0.0 ? frameSeconds : averageSeconds * 0.95 + frameSeconds * 0.05;
+        last           = current;
+        current        = Tally();
+    }
+
+
+    // e.g. "16.67 ms (60.0 fps) | 120 draws | 1.25 M tris | 8 binds | 40 writes | 0.00 MB up"
+    std::string
+    OverlayText() const
+    {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2) << averageSeconds * 1000.0 << " ms ("
+             << std::setprecision(1) << (averageSeconds > 0.0 ? 1.0 / averageSeconds : 0.0) << " fps) | "
+             << last.drawCalls << " draws | "
+             << std::setprecision(2) << static_cast<double>(last.triangles) / 1e6 << " M tris | "
+             << last.pipelineBinds << " binds | " << last.descriptorWrites << " writes | "
+             << static_cast<double>(last.uploadBytes) / (1024.0 * 1024.0) << " MB up";
+
+        for (size_t ii = 0; ii < heapUsage.size(); ii++)
+        {
+            if (!heapUsage[ii]) continue;
+            text << " | heap " << ii << " " << heapUsage[ii]->Value() / (1024.0 * 1024.0) << "/"
+                 << static_cast<double>(heapSizes[ii]) / (1024.0 * 1024.0) << " MB";
+        }
+        return text.str();
+    }
+
+
+private:
+    struct Tally
+    {
+        uint32_t drawCalls        = 0;
+        uint64_t triangles        = 0;
+        uint32_t pipelineBinds    = 0;
+        uint32_t descriptorWrites = 0;
+        uint64_t uploadBytes      = 0;
+    };
+
+
+    static std::string
+    HeapLabels(uint32_t heapIndex, VkMemoryHeapFlags flags)
+    {
+        return "heap=\"" + std::to_string(heapIndex) + "\",device_local=\"" +
+               ((flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false") + "\"";
+    }
+
+
+    MetricsRegistry*                metrics        = nullptr;
+    MetricHistogram*                frameTime      = nullptr;
+    MetricCounter*                  frames         = nullptr;
+    MetricCounter*                  drawCalls      = nullptr;
+    MetricCounter*                  triangles      = nullptr;
+    MetricCounter*                  binds          = nullptr;
+    MetricCounter*                  writes         = nullptr;
+    MetricCounter*                  uploads        = nullptr;
+    MetricGauge*                    frameDraws     = nullptr;
+    MetricGauge*                    frameTris      = nullptr;
+    std::vector<MetricGauge*>       heapUsage;
+    std::vector<VkDeviceSize>       heapSizes;
+    std::vector<VkMemoryHeapFlags>  heapFlags;
+
+    Tally                           current;
+    Tally                           last;
+    double                          averageSeconds = 0.0;
+};
+
+#endif // METRICS_H
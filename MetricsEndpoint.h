@@ -0,0 +1,213 @@
+#ifndef METRICS_ENDPOINT_H
+#define METRICS_ENDPOINT_H
+
+// Serves MetricsRegistry::PrometheusText() on a local Unix domain socket.
+//
+// Every connection gets one HTTP/1.0 response with the current metrics and is closed, so
+// the socket can be scraped with
+//   curl --unix-socket hello_triangle_metrics.sock http://localhost/metrics
+// or bridged to TCP for Prometheus (e.g. socat TCP-LISTEN:9100,fork UNIX-CONNECT:<path>).
+// The request itself is read and ignored. A single background thread polls the listening
+// socket, so Stop() returns within one poll interval.
+//
+// Windows supports AF_UNIX since Windows 10 1803 (afunix.h); Winsock is linked through
+// #pragma comment because build_vulkan.bat does not list ws2_32.lib.
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "Metrics.h"
+
+#include <iostream>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+const int METRICS_ENDPOINT_POLL_MS = 100;
+
+
+class MetricsEndpoint
+{
+public:
+#ifdef _WIN32
+    typedef SOCKET Socket;
+    static const Socket INVALID = INVALID_SOCKET;
+#else
+    typedef int Socket;
+    static const Socket INVALID = -1;
+#endif
+
+
+    MetricsEndpoint() = default;
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+
+    ~MetricsEndpoint()
+    {
+        Stop();
+    }
+
+
+    // Replaces a stale socket file at path. Returns false (and logs) when the socket
+    // cannot be created; metrics keep working without the endpoint.
+    bool
+    Start(const std::string& path, MetricsRegistry& registry = MetricsRegistry::Instance())
+    {
+        Stop();
+
+        sockaddr_un address = {};
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            std::cerr << "[ ERROR ] Metrics socket path is too long: " << path << std::endl;
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+
+#ifdef _WIN32
+        WSADATA wsaData = {};
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        {
+            std::cerr << "[ ERROR ] WSAStartup failed, metrics endpoint disabled." << std::endl;
+            return false;
+        }
+        winsockStarted = true;
+#endif
+
+        std::remove(path.c_str());
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == INVALID ||
+            bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, 8) != 0)
+        {
+            std::cerr << "[ ERROR ] Failed to listen on metrics socket " << path << "." << std::endl;
+            Stop();
+            return false;
+        }
+
+        socketPath = path;
+        metrics    = &registry;
+        stopRequested.store(false, std::memory_order_relaxed);
+        server = std::thread(&MetricsEndpoint::ServeLoop, this);
+        std::cout << "[ INFO ] Metrics endpoint listening on " << path << "." << std::endl;
+        return true;
+    }
+
+
+    void
+    Stop()
+    {
+        stopRequested.store(true, std::memory_order_relaxed);
+        if (server.joinable()) server.join();
+
+        if (listener != INVALID)
+        {
+            CloseSocket(listener);
+            listener = INVALID;
+            std::remove(socketPath.c_str());
+        }
+        socketPath.clear();
+
+#ifdef _WIN32
+        if (winsockStarted) WSACleanup();
+        winsockStarted = false;
+#endif
+    }
+
+
+private:
+    static void
+    CloseSocket(Socket socketHandle)
+    {
+#ifdef _WIN32
+        closesocket(socketHandle);
+#else
+        close(socketHandle);
+#endif
+    }
+
+
+    static bool
+    Readable(Socket socketHandle, int timeoutMs)
+    {
+#ifdef _WIN32
+        WSAPOLLFD descriptor = {};
+        descriptor.fd     = socketHandle;
+        descriptor.events = POLLRDNORM;
+        return WSAPoll(&descriptor, 1, timeoutMs) > 0;
+#else
+        pollfd descriptor = {};
+        descriptor.fd     = socketHandle;
+        descriptor.events = POLLIN;
+        return poll(&descriptor, 1, timeoutMs) > 0;
+#endif
+    }
+
+
+    void
+    ServeLoop()
+    {
+        while (!stopRequested.load(std::memory_order_relaxed))
+        {
+            if (!Readable(listener, METRICS_ENDPOINT_POLL_MS)) continue;
+
+            Socket client = accept(listener, nullptr, nullptr);
+            if (client == INVALID) continue;
+
+            // Swallow the request if the client sent one; scrapers may also just read.
+            char request[1024];
+            if (Readable(client, METRICS_ENDPOINT_POLL_MS))
+            {
+                recv(client, request, sizeof(request), 0);
+            }
+
+            std::string body     = metrics->PrometheusText();
+            std::string response = "HTTP/1.0 200 OK\r\n"
+                                   "Content-Type: text/plain; version=0.0.4\r\n"
+                                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                   "Connection: close\r\n\r\n" + body;
+
+            size_t sent = 0;
+            while (sent < response.size())
+            {
+                int result = static_cast<int>(send(client, response.data() + sent,
+                                                   static_cast<int>(response.size() - sent), 0));
+                if (result <= 0) break;
+                sent += static_cast<size_t>(result);
+            }
+            CloseSocket(client);
+        }
+    }
+
+
+    MetricsRegistry*  metrics        = nullptr;
+    Socket            listener       = INVALID;
+    std::string       socketPath;
+    std::thread       server;
+    std::atomic<bool> stopRequested { false };
+#ifdef _WIN32
+    bool              winsockStarted = false;
+#endif
+};
+
+#endif // METRICS_ENDPOINT_H
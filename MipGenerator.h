@@ -0,0 +1,618 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+// Mip chain generation for runtime generated textures.
+//
+// The compute path writes up to 12 levels below level 0 with a single dispatch. Every
+// workgroup reduces a 64x64 tile of level 0 into levels 1-6 through workgroup shared
+// memory; the last workgroup to finish (found with a global atomic counter) then reduces
+// all of level 6, at most 64x64 texels, into levels 7-12. There are no barriers between
+// levels on the queue, so the GPU is never serialised on one small level at a time.
+//
+// When the compute path is unavailable (no shaderc, no compute capable queue, a format
+// without storage image support, or an image larger than 4096 texels) the classic
+// vkCmdBlitImage chain is recorded instead.
+
+#include <vulkan/vulkan.h>
+
+#include "ShaderCompiler.h"
+#include "VulkanUtilities.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+const uint32_t MIP_GENERATOR_MAX_LEVELS    = 12; // Levels written below level 0
+const uint32_t MIP_GENERATOR_MAX_DIMENSION = 4096;
+const uint32_t MIP_GENERATOR_MAX_SETS      = 64; // Generate() calls between Reset() calls
+
+
+// Single pass downsample shared with DepthPyramid. Every 256 invocation workgroup reduces a
+// 64x64 tile of level 0 into levels 1-6, and the last workgroup to finish reduces level 6
+// into levels 7-12. Compile with DOWNSAMPLE_TYPE (vec4 or float) defined, and
+// DOWNSAMPLE_MAX for a max reduction instead of the average. Set 0 binding 2 is the
+// finished workgroup counter, zeroed before the dispatch; the shader appended after this
+// one defines Load() and Store(), which clamp or drop texels outside a level.
+const char* const DOWNSAMPLE_GLSL = R"GLSL(
+layout(local_size_x = 256) in;
+
+layout(set = 0, binding = 2) buffer DownsampleCounter
+{
+    uint finishedWorkgroups;
+};
+
+shared DOWNSAMPLE_TYPE reduction[256];
+shared bool            isLastWorkgroup;
+
+DOWNSAMPLE_TYPE Load(uint level, ivec2 texel);
+void Store(uint level, ivec2 texel, DOWNSAMPLE_TYPE value);
+
+DOWNSAMPLE_TYPE Reduce(DOWNSAMPLE_TYPE a, DOWNSAMPLE_TYPE b, DOWNSAMPLE_TYPE c, DOWNSAMPLE_TYPE d)
+{
+#ifdef DOWNSAMPLE_MAX
+    return max(max(a, b), max(c, d));
+#else
+    return (a + b + c + d) * 0.25;
+#endif
+}
+
+// Reduces the 64x64 tile of level 'source' into levels source + 1 to source + 6.
+void DownsampleTile(uint source, ivec2 tile)
+{
+    uint  index = gl_LocalInvocationIndex;
+    ivec2 local = ivec2(index % 16, index / 16);
+
+    // Each invocation owns a 2x2 block of source + 1, i.e. a 4x4 block of source.
+    DOWNSAMPLE_TYPE values[4];
+    for (int yy = 0; yy < 2; yy++)
+    {
+        for (int xx = 0; xx < 2; xx++)
+        {
+            ivec2 texel = tile * 32 + local * 2 + ivec2(xx, yy);
+            ivec2 base  = texel * 2;
+            DOWNSAMPLE_TYPE value = Reduce(Load(source, base), Load(source, base + ivec2(1, 0)),
+                                           Load(source, base + ivec2(0, 1)), Load(source, base + ivec2(1, 1)));
+            Store(source + 1, texel, value);
+            values[yy * 2 + xx] = value;
+        }
+    }
+
+    DOWNSAMPLE_TYPE block = Reduce(values[0], values[1], values[2], values[3]);
+    Store(source + 2, tile * 16 + local, block);
+    reduction[index] = block;
+    barrier();
+
+    // Remaining levels come out of shared memory: 8x8, 4x4, 2x2, 1x1 texels per tile.
+    for (uint step = 0; step < 4; step++)
+    {
+        uint            inWidth  = 16u >> step;
+        uint            outWidth = inWidth / 2;
+        ivec2           texel    = ivec2(index % outWidth, index / outWidth);
+        DOWNSAMPLE_TYPE value    = DOWNSAMPLE_TYPE(0.0);
+
+        bool active = index < outWidth * outWidth;
+        if (active)
+        {
+            uint base = uint(texel.y) * 2 * inWidth + uint(texel.x) * 2;
+            value = Reduce(reduction[base], reduction[base + 1],
+                           reduction[base + inWidth], reduction[base + inWidth + 1]);
+            Store(source + 3 + step, tile * int(outWidth) + texel, value);
+        }
+        barrier();
+
+        if (active)
+        {
+            reduction[index] = value;
+        }
+        barrier();
+    }
+}
+
+// Call from main() with the same arguments in every invocation; tailLevels is whether
+// any level past 6 exists.
+void Downsample(bool tailLevels, uint workgroupCount)
+{
+    DownsampleTile(0, ivec2(gl_WorkGroupID.xy));
+    if (!tailLevels)
+    {
+        return;
+    }
+
+    // Make this workgroup's level 6 texel visible before counting it as finished.
+    memoryBarrierImage();
+    barrier();
+    if (gl_LocalInvocationIndex == 0)
+    {
+        isLastWorkgroup = atomicAdd(finishedWorkgroups, 1) == workgroupCount - 1;
+    }
+    barrier();
+
+    if (isLastWorkgroup)
+    {
+        memoryBarrierImage();
+        DownsampleTile(6, ivec2(0));
+    }
+}
+)GLSL";
+
+
+// Follows DOWNSAMPLE_GLSL; levels are numbered from the source, so outputLevels[0] is level 1.
+const char* const MIP_GENERATOR_GLSL = R"GLSL(
+layout(set = 0, binding = 0) uniform sampler2D sourceLevel;
+layout(set = 0, binding = 1, MIP_FORMAT) uniform coherent image2D outputLevels[12];
+
+layout(push_constant) uniform PushConstants
+{
+    ivec2 size;
+    uint  levelCount;
+    uint  workgroupCount;
+} pc;
+
+ivec2 LevelSize(uint level)
+{
+    return max(pc.size >> int(level), ivec2(1));
+}
+
+// Only level 0 and level 6 are ever read.
+vec4 Load(uint level, ivec2 texel)
+{
+    texel = min(texel, LevelSize(level) - 1);
+    if (level == 0)
+    {
+        return texelFetch(sourceLevel, texel, 0);
+    }
+    return imageLoad(outputLevels[5], texel);
+}
+
+// Image arrays are indexed with constants only, dynamic indexing is an optional feature.
+void Store(uint level, ivec2 texel, vec4 value)
+{
+    if (level > pc.levelCount || any(greaterThanEqual(texel, LevelSize(level))))
+    {
+        return;
+    }
+
+    switch (level)
+    {
+        case 1:  imageStore(outputLevels[0], texel, value);  break;
+        case 2:  imageStore(outputLevels[1], texel, value);  break;
+        case 3:  imageStore(outputLevels[2], texel, value);  break;
+        case 4:  imageStore(outputLevels[3], texel, value);  break;
+        case 5:  imageStore(outputLevels[4], texel, value);  break;
+        case 6:  imageStore(outputLevels[5], texel, value);  break;
+        case 7:  imageStore(outputLevels[6], texel, value);  break;
+        case 8:  imageStore(outputLevels[7], texel, value);  break;
+        case 9:  imageStore(outputLevels[8], texel, value);  break;
+        case 10: imageStore(outputLevels[9], texel, value);  break;
+        case 11: imageStore(outputLevels[10], texel, value); break;
+        case 12: imageStore(outputLevels[11], texel, value); break;
+    }
+}
+
+void main()
+{
+    Downsample(pc.levelCount > 6, pc.workgroupCount);
+}
+)GLSL";
+
+
+class MipGenerator
+{
+public:
+    // computeCapable: the queue Generate() records for supports VK_QUEUE_COMPUTE_BIT.
+    void
+    Create(VkPhysicalDevice gpu, VkDevice logicalDevice, bool computeCapable)
+    {
+        physicalDevice = gpu;
+        device         = logicalDevice;
+        computeUsable  = computeCapable && ShaderCompilerAvailable();
+        if (!computeUsable) return;
+
+        VkDescriptorSetLayoutBinding bindings[3] = {};
+        bindings[0].binding         = 0;
+        bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].binding         = 1;
+        bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount = MIP_GENERATOR_MAX_LEVELS;
+        bindings[1].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[2].binding         = 2;
+        bindings[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 3;
+        layoutInfo.pBindings    = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create mip generator descriptor set layout.");
+        }
+
+        VkPushConstantRange pushRange = {};
+        pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushRange.size       = 4 * sizeof(uint32_t);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         = 1;
+        pipelineLayoutInfo.pSetLayouts            = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges    = &pushRange;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create mip generator pipeline layout.");
+        }
+
+        VkDescriptorPoolSize poolSizes[3] = {};
+        poolSizes[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = MIP_GENERATOR_MAX_SETS;
+        poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[1].descriptorCount = MIP_GENERATOR_MAX_SETS * MIP_GENERATOR_MAX_LEVELS;
+        poolSizes[2].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[2].descriptorCount = MIP_GENERATOR_MAX_SETS;
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = MIP_GENERATOR_MAX_SETS;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes    = poolSizes;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create mip generator descriptor pool.");
+        }
+
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_NEAREST;
+        samplerInfo.minFilter    = VK_FILTER_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create mip generator sampler.");
+        }
+
+        // One counter per set, so every Generate() between Reset()s has its own.
+        CreateBuffer(physicalDevice, device, MIP_GENERATOR_MAX_SETS * sizeof(uint32_t),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, counterBuffer, counterMemory);
+    }
+
+
+    void
+    Destroy()
+    {
+        Reset();
+        for (auto& entry : pipelines)
+        {
+            vkDestroyPipeline(device, entry.pipeline, nullptr);
+        }
+        pipelines.clear();
+
+        if (counterBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, counterBuffer, nullptr);
+        if (counterMemory != VK_NULL_HANDLE) vkFreeMemory(device, counterMemory, nullptr);
+        if (sampler != VK_NULL_HANDLE) vkDestroySampler(device, sampler, nullptr);
+        if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        counterBuffer  = VK_NULL_HANDLE;
+        counterMemory  = VK_NULL_HANDLE;
+        sampler        = VK_NULL_HANDLE;
+        descriptorPool = VK_NULL_HANDLE;
+        pipelineLayout = VK_NULL_HANDLE;
+        setLayout      = VK_NULL_HANDLE;
+    }
+
+
+    // Image usage the texture needs for whichever path Generate() will take.
+    VkImageUsageFlags
+    RequiredUsage(VkFormat format, uint32_t width, uint32_t height) const
+    {
+        if (UsesCompute(format, width, height))
+        {
+            return VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+        }
+        return VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+
+
+    // Fills levels 1 to mipLevels - 1 from level 0. Level 0 must be in
+    // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL (i.e. just uploaded or rendered and copied);
+    // afterwards every level is in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+    void
+    Generate(VkCommandBuffer commandBuffer,
+             VkImage         image,
+             VkFormat        format,
+             uint32_t        width,
+             uint32_t        height,
+             uint32_t        mipLevels)
+    {
+        if (mipLevels > MIP_GENERATOR_MAX_LEVELS + 1)
+        {
+            throw std::runtime_error("[ ERROR ] Mip generator supports at most 13 levels.");
+        }
+
+        if (mipLevels > 1 && UsesCompute(format, width, height))
+        {
+            RecordCompute(commandBuffer, image, format, width, height, mipLevels);
+        }
+        else
+        {
+            RecordBlitChain(commandBuffer, image, format, width, height, mipLevels);
+        }
+    }
+
+
+    // Call once the command buffers holding Generate() calls have completed.
+    void
+    Reset()
+    {
+        for (VkImageView view : views)
+        {
+            vkDestroyImageView(device, view, nullptr);
+        }
+        views.clear();
+
+        if (descriptorPool != VK_NULL_HANDLE)
+        {
+            vkResetDescriptorPool(device, descriptorPool, 0);
+        }
+        setsUsed = 0;
+    }
+
+
+private:
+    struct FormatPipeline
+    {
+        VkFormat   format;
+        VkPipeline pipeline;
+    };
+
+
+    static const char*
+    GlslImageFormat(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_R8G8B8A8_UNORM:      return "rgba8";
+            case VK_FORMAT_R8G8B8A8_SNORM:      return "rgba8_snorm";
+            case VK_FORMAT_R16G16B16A16_SFLOAT: return "rgba16f";
+            case VK_FORMAT_R32G32B32A32_SFLOAT: return "rgba32f";
+            case VK_FORMAT_R16G16_SFLOAT:       return "rg16f";
+            case VK_FORMAT_R8G8_UNORM:          return "rg8";
+            case VK_FORMAT_R16_SFLOAT:          return "r16f";
+            case VK_FORMAT_R32_SFLOAT:          return "r32f";
+            case VK_FORMAT_R8_UNORM:            return "r8";
+            default:                            return nullptr;
+        }
+    }
+
+
+    bool
+    UsesCompute(VkFormat format, uint32_t width, uint32_t height) const
+    {
+        if (!computeUsable || !GlslImageFormat(format)) return false;
+        if (width > MIP_GENERATOR_MAX_DIMENSION || height > MIP_GENERATOR_MAX_DIMENSION) return false;
+
+        VkFormatProperties properties = {};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+        return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+    }
+
+
+    VkPipeline
+    PipelineFor(VkFormat format)
+    {
+        for (const auto& entry : pipelines)
+        {
+            if (entry.format == format) return entry.pipeline;
+        }
+
+        FormatPipeline entry = {};
+        entry.format   = format;
+        entry.pipeline = CreateComputePipeline(device, pipelineLayout,
+                                               std::string("#version 450\n") + DOWNSAMPLE_GLSL + MIP_GENERATOR_GLSL,
+                                               "MipGenerator.comp",
+                                               { { "MIP_FORMAT", GlslImageFormat(format) },
+                                                 { "DOWNSAMPLE_TYPE", "vec4" } });
+        pipelines.push_back(entry);
+        return entry.pipeline;
+    }
+
+
+    void
+    RecordCompute(VkCommandBuffer commandBuffer,
+                  VkImage         image,
+                  VkFormat        format,
+                  uint32_t        width,
+                  uint32_t        height,
+                  uint32_t        mipLevels)
+    {
+        if (setsUsed == MIP_GENERATOR_MAX_SETS)
+        {
+            throw std::runtime_error("[ ERROR ] Too many mip generations before MipGenerator::Reset().");
+        }
+
+        VkDescriptorSetAllocateInfo allocateInfo = {};
+        allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool     = descriptorPool;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts        = &setLayout;
+
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to allocate mip generator descriptor set.");
+        }
+
+        uint32_t counterIndex = setsUsed++;
+
+        VkDescriptorImageInfo sourceInfo = {};
+        sourceInfo.sampler     = sampler;
+        sourceInfo.imageView   = CreateImageView2D(device, image, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1);
+        sourceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        views.push_back(sourceInfo.imageView);
+
+        // Every array element must be valid, so unused slots alias the last real level;
+        // the shader never writes to them.
+        VkDescriptorImageInfo levelInfos[MIP_GENERATOR_MAX_LEVELS] = {};
+        for (uint32_t level = 1; level < mipLevels; level++)
+        {
+            levelInfos[level - 1].imageView   = CreateImageView2D(device, image, format, VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                  level, 1);
+            levelInfos[level - 1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            views.push_back(levelInfos[level - 1].imageView);
+        }
+        for (uint32_t slot = mipLevels - 1; slot < MIP_GENERATOR_MAX_LEVELS; slot++)
+        {
+            levelInfos[slot] = levelInfos[mipLevels - 2];
+        }
+
+        VkDescriptorBufferInfo counterInfo = {};
+        counterInfo.buffer = counterBuffer;
+        counterInfo.offset = counterIndex * sizeof(uint32_t);
+        counterInfo.range  = sizeof(uint32_t);
+
+        VkWriteDescriptorSet writes[3] = {};
+        for (auto& write : writes)
+        {
+            write.sType  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = descriptorSet;
+        }
+        writes[0].dstBinding      = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo      = &sourceInfo;
+        writes[1].dstBinding      = 1;
+        writes[1].descriptorCount = MIP_GENERATOR_MAX_LEVELS;
+        writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo      = levelInfos;
+        writes[2].dstBinding      = 2;
+        writes[2].descriptorCount = 1;
+        writes[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[2].pBufferInfo     = &counterInfo;
+        vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+
+        vkCmdFillBuffer(commandBuffer, counterBuffer, counterInfo.offset, sizeof(uint32_t), 0);
+
+        VkBufferMemoryBarrier counterBarrier = {};
+        counterBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        counterBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        counterBarrier.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        counterBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        counterBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        counterBarrier.buffer              = counterBuffer;
+        counterBarrier.offset              = counterInfo.offset;
+        counterBarrier.size                = sizeof(uint32_t);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, nullptr, 1, &counterBarrier, 0, nullptr);
+
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 1, mipLevels - 1,
+                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                     0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        uint32_t groupsX = (width + 63) / 64;
+        uint32_t groupsY = (height + 63) / 64;
+        uint32_t pushConstants[4] = { width, height, mipLevels - 1, groupsX * groupsY };
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, PipelineFor(format));
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                                0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(pushConstants), pushConstants);
+        vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, 1, mipLevels - 1,
+                     VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+
+
+    void
+    RecordBlitChain(VkCommandBuffer commandBuffer,
+                    VkImage         image,
+                    VkFormat        format,
+                    uint32_t        width,
+                    uint32_t        height,
+                    uint32_t        mipLevels)
+    {
+        VkFormatProperties properties = {};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+        const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        if (mipLevels > 1 && (properties.optimalTilingFeatures & required) != required)
+        {
+            throw std::runtime_error("[ ERROR ] Format does not support linear blits for mip generation.");
+        }
+
+        int32_t levelWidth  = static_cast<int32_t>(width);
+        int32_t levelHeight = static_cast<int32_t>(height);
+        for (uint32_t level = 1; level < mipLevels; level++)
+        {
+            ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 1,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+            ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, level, 1,
+                         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            int32_t nextWidth  = std::max(levelWidth / 2, 1);
+            int32_t nextHeight = std::max(levelHeight / 2, 1);
+
+            VkImageBlit blit = {};
+            blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.srcSubresource.mipLevel   = level - 1;
+            blit.srcSubresource.layerCount = 1;
+            blit.srcOffsets[1]             = { levelWidth, levelHeight, 1 };
+            blit.dstSubresource            = blit.srcSubresource;
+            blit.dstSubresource.mipLevel   = level;
+            blit.dstOffsets[1]             = { nextWidth, nextHeight, 1 };
+            vkCmdBlitImage(commandBuffer,
+                           image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1, &blit, VK_FILTER_LINEAR);
+
+            ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 1,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+            levelWidth  = nextWidth;
+            levelHeight = nextHeight;
+        }
+
+        ImageBarrier(commandBuffer, image, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels - 1, 1,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+
+    VkPhysicalDevice            physicalDevice = VK_NULL_HANDLE;
+    VkDevice                    device         = VK_NULL_HANDLE;
+    bool                        computeUsable  = false;
+    VkDescriptorSetLayout       setLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout            pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorPool            descriptorPool = VK_NULL_HANDLE;
+    VkSampler                   sampler        = VK_NULL_HANDLE;
+    VkBuffer                    counterBuffer  = VK_NULL_HANDLE;
+    VkDeviceMemory              counterMemory  = VK_NULL_HANDLE;
+    uint32_t                    setsUsed       = 0;
+    std::vector<FormatPipeline> pipelines;
+    std::vector<VkImageView>    views;
+};
+
+#endif // MIP_GENERATOR_H
@@ -0,0 +1,587 @@
+#ifndef PERFORMANCE_COUNTERS_H
+#define PERFORMANCE_COUNTERS_H
+
+// Hardware performance counters per pass through VK_KHR_performance_query.
+//
+// Create() enumerates the counters of the queue family and selects the ones whose name or
+// category contains one of the filters (by default occupancy, cache hit rates and
+// bandwidth). Counters scoped to whole command buffers are skipped, since a pass query
+// cannot be the first command of its command buffer. The driver may need several passes
+// to collect the selection; every frame's command buffer is then submitted PassCount()
+// times, once per VkSubmitInfo with SubmitInfo(pass) in its pNext. That needs
+// VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT when PassCount() > 1 and leaves frame times
+// meaningless, so this is a profiling mode rather than something to leave on.
+//
+// Every frame in flight owns a query pool with one query per scope. BeginFrame() reads
+// back what the pool collected last time, after the caller waited on the frame's fence,
+// and resets it from the host: performance queries cannot be reset in the command buffer
+// that uses them, so hostQueryReset (VK_EXT_host_query_reset) is required. Results go to
+// Tracer::AddGpuCounter(), timestamped with the host time the scope was recorded at, and
+// into running averages for Print(). Scopes do not nest; only one performance query may
+// be active at a time. Begin scopes outside render pass instances.
+//
+// Without the extension, the feature, the profiling lock or host query reset every call
+// is a no-op, which covers software ICDs. The Vulkan headers in includes/ (version 126)
+// predate the extension, so its types are declared below when the headers lack them.
+
+#include <vulkan/vulkan.h>
+
+#include "Tracing.h"
+#include "VulkanUtilities.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+const uint32_t PERFORMANCE_COUNTERS_MAX_SCOPES = 64; // Per frame
+
+
+#ifndef VK_KHR_performance_query
+// VK_KHR_performance_query as published in headers 1.2.131; extension number 117.
+#define VK_KHR_performance_query 1
+#define VK_KHR_PERFORMANCE_QUERY_SPEC_VERSION 1
+#define VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME "VK_KHR_performance_query"
+
+const VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PERFORMANCE_QUERY_FEATURES_KHR   = static_cast<VkStructureType>(1000116000);
+const VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PERFORMANCE_QUERY_PROPERTIES_KHR = static_cast<VkStructureType>(1000116001);
+const VkStructureType VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR           = static_cast<VkStructureType>(1000116002);
+const VkStructureType VK_STRUCTURE_TYPE_PERFORMANCE_QUERY_SUBMIT_INFO_KHR                = static_cast<VkStructureType>(1000116003);
+const VkStructureType VK_STRUCTURE_TYPE_ACQUIRE_PROFILING_LOCK_INFO_KHR                  = static_cast<VkStructureType>(1000116004);
+const VkStructureType VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_KHR                          = static_cast<VkStructureType>(1000116005);
+const VkStructureType VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_DESCRIPTION_KHR              = static_cast<VkStructureType>(1000116006);
+const VkQueryType     VK_QUERY_TYPE_PERFORMANCE_QUERY_KHR                                = static_cast<VkQueryType>(1000116000);
+
+typedef enum VkPerformanceCounterUnitKHR {
+    VK_PERFORMANCE_COUNTER_UNIT_GENERIC_KHR = 0,
+    VK_PERFORMANCE_COUNTER_UNIT_PERCENTAGE_KHR = 1,
+    VK_PERFORMANCE_COUNTER_UNIT_NANOSECONDS_KHR = 2,
+    VK_PERFORMANCE_COUNTER_UNIT_BYTES_KHR = 3,
+    VK_PERFORMANCE_COUNTER_UNIT_BYTES_PER_SECOND_KHR = 4,
+    VK_PERFORMANCE_COUNTER_UNIT_KELVIN_KHR = 5,
+    VK_PERFORMANCE_COUNTER_UNIT_WATTS_KHR = 6,
+    VK_PERFORMANCE_COUNTER_UNIT_VOLTS_KHR = 7,
+    VK_PERFORMANCE_COUNTER_UNIT_AMPS_KHR = 8,
+    VK_PERFORMANCE_COUNTER_UNIT_HERTZ_KHR = 9,
+    VK_PERFORMANCE_COUNTER_UNIT_CYCLES_KHR = 10,
+    VK_PERFORMANCE_COUNTER_UNIT_MAX_ENUM_KHR = 0x7FFFFFFF
+} VkPerformanceCounterUnitKHR;
+
+typedef enum VkPerformanceCounterScopeKHR {
+    VK_PERFORMANCE_COUNTER_SCOPE_COMMAND_BUFFER_KHR = 0,
+    VK_PERFORMANCE_COUNTER_SCOPE_RENDER_PASS_KHR = 1,
+    VK_PERFORMANCE_COUNTER_SCOPE_COMMAND_KHR = 2,
+    VK_PERFORMANCE_COUNTER_SCOPE_MAX_ENUM_KHR = 0x7FFFFFFF
+} VkPerformanceCounterScopeKHR;
+
+typedef enum VkPerformanceCounterStorageKHR {
+    VK_PERFORMANCE_COUNTER_STORAGE_INT32_KHR = 0,
+    VK_PERFORMANCE_COUNTER_STORAGE_INT64_KHR = 1,
+    VK_PERFORMANCE_COUNTER_STORAGE_UINT32_KHR = 2,
+    VK_PERFORMANCE_COUNTER_STORAGE_UINT64_KHR = 3,
+    VK_PERFORMANCE_COUNTER_STORAGE_FLOAT32_KHR = 4,
+    VK_PERFORMANCE_COUNTER_STORAGE_FLOAT64_KHR = 5,
+    VK_PERFORMANCE_COUNTER_STORAGE_MAX_ENUM_KHR = 0x7FFFFFFF
+} VkPerformanceCounterStorageKHR;
+
+typedef VkFlags VkPerformanceCounterDescriptionFlagsKHR;
+typedef VkFlags VkAcquireProfilingLockFlagsKHR;
+
+typedef struct VkPhysicalDevicePerformanceQueryFeaturesKHR {
+    VkStructureType    sType;
+    void*              pNext;
+    VkBool32           performanceCounterQueryPools;
+    VkBool32           performanceCounterMultipleQueryPools;
+} VkPhysicalDevicePerformanceQueryFeaturesKHR;
+
+typedef struct VkPerformanceCounterKHR {
+    VkStructureType                   sType;
+    const void*                       pNext;
+    VkPerformanceCounterUnitKHR       unit;
+    VkPerformanceCounterScopeKHR      scope;
+    VkPerformanceCounterStorageKHR    storage;
+    uint8_t                           uuid[VK_UUID_SIZE];
+} VkPerformanceCounterKHR;
+
+typedef struct VkPerformanceCounterDescriptionKHR {
+    VkStructureType                            sType;
+    const void*                                pNext;
+    VkPerformanceCounterDescriptionFlagsKHR    flags;
+    char                                       name[VK_MAX_DESCRIPTION_SIZE];
+    char                                       category[VK_MAX_DESCRIPTION_SIZE];
+    char                                       description[VK_MAX_DESCRIPTION_SIZE];
+} VkPerformanceCounterDescriptionKHR;
+
+typedef struct VkQueryPoolPerformanceCreateInfoKHR {
+    VkStructureType    sType;
+    const void*        pNext;
+    uint32_t           queueFamilyIndex;
+    uint32_t           counterIndexCount;
+    const uint32_t*    pCounterIndices;
+} VkQueryPoolPerformanceCreateInfoKHR;
+
+typedef union VkPerformanceCounterResultKHR {
+    int32_t     int32;
+    int64_t     int64;
+    uint32_t    uint32;
+    uint64_t    uint64;
+    float       float32;
+    double      float64;
+} VkPerformanceCounterResultKHR;
+
+typedef struct VkAcquireProfilingLockInfoKHR {
+    VkStructureType                   sType;
+    const void*                       pNext;
+    VkAcquireProfilingLockFlagsKHR    flags;
+    uint64_t                          timeout;
+} VkAcquireProfilingLockInfoKHR;
+
+typedef struct VkPerformanceQuerySubmitInfoKHR {
+    VkStructureType    sType;
+    const void*        pNext;
+    uint32_t           counterPassIndex;
+} VkPerformanceQuerySubmitInfoKHR;
+
+typedef VkResult (VKAPI_PTR *PFN_vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR)(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t* pCounterCount, VkPerformanceCounterKHR* pCounters, VkPerformanceCounterDescriptionKHR* pCounterDescriptions);
+typedef void (VKAPI_PTR *PFN_vkGetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR)(VkPhysicalDevice physicalDevice, const VkQueryPoolPerformanceCreateInfoKHR* pPerformanceQueryCreateInfo, uint32_t* pNumPasses);
+typedef VkResult (VKAPI_PTR *PFN_vkAcquireProfilingLockKHR)(VkDevice device, const VkAcquireProfilingLockInfoKHR* pInfo);
+typedef void (VKAPI_PTR *PFN_vkReleaseProfilingLockKHR)(VkDevice device);
+#endif // VK_KHR_performance_query
+
+
+// Substrings selecting the counters when Create() gets no filters.
+inline std::vector<std::string>
+DefaultPerformanceCounterFilters()
+{
+    return { "occupancy", "hit", "bandwidth" };
+}
+
+
+class PerformanceCounters
+{
+public:
+    // extensionEnabled: VK_KHR_performance_query is enabled on the device with its
+    // performanceCounterQueryPools feature. hostQueryReset: VK_EXT_host_query_reset is
+    // enabled with its hostQueryReset feature.
+    void
+    Create(VkInstance                      instance,
+           VkPhysicalDevice                gpu,
+           VkDevice                        logicalDevice,
+           uint32_t                        queueFamilyIndex,
+           uint32_t                        framesInFlight,
+           bool                            extensionEnabled,
+           bool                            hostQueryReset,
+           const std::vector<std::string>& filters = DefaultPerformanceCounterFilters())
+    {
+        device = logicalDevice;
+        if (!extensionEnabled) return;
+        if (!hostQueryReset)
+        {
+            std::cout << "[ INFO ] Performance counters disabled: VK_EXT_host_query_reset is required." << std::endl;
+            return;
+        }
+
+        auto enumerateCounters = reinterpret_cast<PFN_vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR>(
+            vkGetInstanceProcAddr(instance, "vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR"));
+        auto getPassCount = reinterpret_cast<PFN_vkGetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR>(
+            vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR"));
+        auto acquireLock = LoadDeviceFunction<PFN_vkAcquireProfilingLockKHR>(device, "vkAcquireProfilingLockKHR");
+        releaseLock      = LoadDeviceFunction<PFN_vkReleaseProfilingLockKHR>(device, "vkReleaseProfilingLockKHR");
+        resetQueryPool   = LoadDeviceFunction<PFN_vkResetQueryPoolEXT>(device, "vkResetQueryPoolEXT");
+        if (!enumerateCounters || !getPassCount || !acquireLock || !releaseLock || !resetQueryPool)
+        {
+            Disable();
+            return;
+        }
+
+        uint32_t counterCount = 0;
+        enumerateCounters(gpu, queueFamilyIndex, &counterCount, nullptr, nullptr);
+        std::vector<VkPerformanceCounterKHR>            counters(counterCount);
+        std::vector<VkPerformanceCounterDescriptionKHR> descriptions(counterCount);
+        for (uint32_t ii = 0; ii < counterCount; ii++)
+        {
+            counters[ii]           = {};
+            counters[ii].sType     = VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_KHR;
+            descriptions[ii]       = {};
+            descriptions[ii].sType = VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_DESCRIPTION_KHR;
+        }
+        enumerateCounters(gpu, queueFamilyIndex, &counterCount, counters.data(), descriptions.data());
+
+        for (uint32_t ii = 0; ii < counterCount; ii++)
+        {
+            if (counters[ii].scope == VK_PERFORMANCE_COUNTER_SCOPE_COMMAND_BUFFER_KHR) continue;
+            if (!Matches(descriptions[ii], filters)) continue;
+
+            Counter counter;
+            counter.index   = ii;
+            counter.label   = std::string(descriptions[ii].name) + UnitSuffix(counters[ii].unit);
+            counter.storage = counters[ii].storage;
+            selected.push_back(counter);
+            counterIndices.push_back(ii);
+        }
+        if (selected.empty())
+        {
+            std::cout << "[ INFO ] Performance counters disabled: no counter matches the filters ("
+                      << counterCount << " available)." << std::endl;
+            Disable();
+            return;
+        }
+
+        VkQueryPoolPerformanceCreateInfoKHR performanceInfo = {};
+        performanceInfo.sType             = VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR;
+        performanceInfo.queueFamilyIndex  = queueFamilyIndex;
+        performanceInfo.counterIndexCount = static_cast<uint32_t>(counterIndices.size());
+        performanceInfo.pCounterIndices   = counterIndices.data();
+
+        uint32_t passCount = 0;
+        getPassCount(gpu, &performanceInfo, &passCount);
+
+        VkAcquireProfilingLockInfoKHR lockInfo = {};
+        lockInfo.sType   = VK_STRUCTURE_TYPE_ACQUIRE_PROFILING_LOCK_INFO_KHR;
+        lockInfo.timeout = UINT64_MAX;
+        if (passCount == 0 || acquireLock(device, &lockInfo) != VK_SUCCESS)
+        {
+            std::cout << "[ INFO ] Performance counters disabled: profiling lock unavailable." << std::endl;
+            Disable();
+            return;
+        }
+        lockHeld = true;
+
+        submitInfos.resize(passCount);
+        for (uint32_t pass = 0; pass < passCount; pass++)
+        {
+            submitInfos[pass]                  = {};
+            submitInfos[pass].sType            = VK_STRUCTURE_TYPE_PERFORMANCE_QUERY_SUBMIT_INFO_KHR;
+            submitInfos[pass].counterPassIndex = pass;
+        }
+
+        frames.resize(framesInFlight);
+        for (auto& frame : frames)
+        {
+            VkQueryPoolCreateInfo poolInfo = {};
+            poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.pNext      = &performanceInfo;
+            poolInfo.queryType  = VK_QUERY_TYPE_PERFORMANCE_QUERY_KHR;
+            poolInfo.queryCount = PERFORMANCE_COUNTERS_MAX_SCOPES;
+            if (vkCreateQueryPool(device, &poolInfo, nullptr, &frame.queryPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to create performance query pool.");
+            }
+            resetQueryPool(device, frame.queryPool, 0, PERFORMANCE_COUNTERS_MAX_SCOPES);
+        }
+        averages.assign(selected.size(), std::vector<Average>());
+
+        std::cout << "[ INFO ] Sampling " << selected.size() << " of " << counterCount << " performance counters in "
+                  << passCount << " passes:" << std::endl;
+        for (const auto& counter : selected)
+        {
+            std::cout << "[ INFO ]     " << counter.label << std::endl;
+        }
+    }
+
+
+    void
+    Destroy()
+    {
+        for (auto& frame : frames)
+        {
+            if (frame.queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, frame.queryPool, nullptr);
+        }
+        Disable();
+    }
+
+
+    bool
+    Enabled() const
+    {
+        return !frames.empty();
+    }
+
+
+    // Submissions every frame's command buffer needs; 1 when disabled.
+    uint32_t
+    PassCount() const
+    {
+        return Enabled() ? static_cast<uint32_t>(submitInfos.size()) : 1;
+    }
+
+
+    // VkPerformanceQuerySubmitInfoKHR for VkSubmitInfo::pNext of the pass's submission;
+    // nullptr when disabled.
+    const void*
+    SubmitInfo(uint32_t pass) const
+    {
+        return Enabled() ? &submitInfos[pass] : nullptr;
+    }
+
+
+    // Call once frameIndex's fence has been waited on, before recording its scopes.
+    void
+    BeginFrame(uint32_t frameIndex)
+    {
+        if (!Enabled()) return;
+        if (scopeOpen)
+        {
+            throw std::runtime_error("[ ERROR ] Performance counter scope left open at the end of a frame.");
+        }
+
+        currentFrame = frameIndex;
+        Frame& frame = frames[frameIndex];
+        Collect(frame);
+        resetQueryPool(device, frame.queryPool, 0, PERFORMANCE_COUNTERS_MAX_SCOPES);
+        frame.scopes.clear();
+    }
+
+
+    // name must outlive the trace export; string literals are the intended use.
+    void
+    BeginScope(VkCommandBuffer commandBuffer, const char* name)
+    {
+        if (!Enabled()) return;
+        if (scopeOpen)
+        {
+            throw std::runtime_error("[ ERROR ] Performance counter scopes do not nest.");
+        }
+
+        Frame& frame = frames[currentFrame];
+        scopeOpen    = true;
+        scopeDropped = frame.scopes.size() == PERFORMANCE_COUNTERS_MAX_SCOPES;
+        if (scopeDropped) return;
+
+        Scope scope = {};
+        scope.name      = name;
+        scope.hostTicks = HostClockTicks();
+        frame.scopes.push_back(scope);
+        vkCmdBeginQuery(commandBuffer, frame.queryPool, static_cast<uint32_t>(frame.scopes.size() - 1), 0);
+    }
+
+
+    void
+    EndScope(VkCommandBuffer commandBuffer)
+    {
+        if (!Enabled()) return;
+        if (!scopeOpen)
+        {
+            throw std::runtime_error("[ ERROR ] PerformanceCounters::EndScope() without a matching BeginScope().");
+        }
+
+        scopeOpen = false;
+        if (scopeDropped) return;
+
+        const Frame& frame = frames[currentFrame];
+        vkCmdEndQuery(commandBuffer, frame.queryPool, static_cast<uint32_t>(frame.scopes.size() - 1));
+    }
+
+
+    // Average of every counter per scope name over the frames read back so far.
+    void
+    Print() const
+    {
+        for (size_t counter = 0; counter < selected.size(); counter++)
+        {
+            for (const Average& average : averages[counter])
+            {
+                std::cout << "[ INFO ] " << average.scope << ": " << selected[counter].label << " avg "
+                          << average.sum / static_cast<double>(average.count) << " (" << average.count
+                          << " samples)" << std::endl;
+            }
+        }
+    }
+
+
+private:
+    struct Counter
+    {
+        uint32_t                       index   = 0;
+        std::string                    label;
+        VkPerformanceCounterStorageKHR storage = VK_PERFORMANCE_COUNTER_STORAGE_FLOAT64_KHR;
+    };
+
+
+    struct Scope
+    {
+        const char* name;
+        uint64_t    hostTicks; // When the scope was recorded
+    };
+
+
+    struct Frame
+    {
+        VkQueryPool        queryPool = VK_NULL_HANDLE;
+        std::vector<Scope> scopes;
+    };
+
+
+    struct Average
+    {
+        const char* scope = nullptr;
+        double      sum   = 0.0;
+        uint64_t    count = 0;
+    };
+
+
+    static bool
+    Matches(const VkPerformanceCounterDescriptionKHR& description, const std::vector<std::string>& filters)
+    {
+        std::string text = std::string(description.name) + " " + description.category;
+        std::transform(text.begin(), text.end(), text.begin(), [](char character)
+        {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+        });
+
+        for (const auto& filter : filters)
+        {
+            std::string lower = filter;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](char character)
+            {
+                return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+            });
+            if (text.find(lower) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+
+    static const char*
+    UnitSuffix(VkPerformanceCounterUnitKHR unit)
+    {
+        switch (unit)
+        {
+            case VK_PERFORMANCE_COUNTER_UNIT_PERCENTAGE_KHR:       return " (%)";
+            case VK_PERFORMANCE_COUNTER_UNIT_NANOSECONDS_KHR:      return " (ns)";
+            case VK_PERFORMANCE_COUNTER_UNIT_BYTES_KHR:            return " (bytes)";
+            case VK_PERFORMANCE_COUNTER_UNIT_BYTES_PER_SECOND_KHR: return " (bytes/s)";
+            case VK_PERFORMANCE_COUNTER_UNIT_KELVIN_KHR:           return " (K)";
+            case VK_PERFORMANCE_COUNTER_UNIT_WATTS_KHR:            return " (W)";
+            case VK_PERFORMANCE_COUNTER_UNIT_VOLTS_KHR:            return " (V)";
+            case VK_PERFORMANCE_COUNTER_UNIT_AMPS_KHR:             return " (A)";
+            case VK_PERFORMANCE_COUNTER_UNIT_HERTZ_KHR:            return " (Hz)";
+            case VK_PERFORMANCE_COUNTER_UNIT_CYCLES_KHR:           return " (cycles)";
+            default:                                               return "";
+        }
+    }
+
+
+    static double
+    ToDouble(const VkPerformanceCounterResultKHR& result, VkPerformanceCounterStorageKHR storage)
+    {
+        switch (storage)
+        {
+            case VK_PERFORMANCE_COUNTER_STORAGE_INT32_KHR:   return static_cast<double>(result.int32);
+            case VK_PERFORMANCE_COUNTER_STORAGE_INT64_KHR:   return static_cast<double>(result.int64);
+            case VK_PERFORMANCE_COUNTER_STORAGE_UINT32_KHR:  return static_cast<double>(result.uint32);
+            case VK_PERFORMANCE_COUNTER_STORAGE_UINT64_KHR:  return static_cast<double>(result.uint64);
+            case VK_PERFORMANCE_COUNTER_STORAGE_FLOAT32_KHR: return static_cast<double>(result.float32);
+            default:                                         return result.float64;
+        }
+    }
+
+
+    void
+    Collect(const Frame& frame)
+    {
+        if (frame.scopes.empty()) return;
+
+        // Availability is not reported for performance queries; the frame's fence already
+        // guarantees completion, VK_NOT_READY means the frame was never submitted.
+        const size_t                               counterCount = selected.size();
+        std::vector<VkPerformanceCounterResultKHR> results(frame.scopes.size() * counterCount);
+        VkResult result = vkGetQueryPoolResults(device, frame.queryPool, 0, static_cast<uint32_t>(frame.scopes.size()),
+                                                results.size() * sizeof(VkPerformanceCounterResultKHR), results.data(),
+                                                counterCount * sizeof(VkPerformanceCounterResultKHR), 0);
+        if (result != VK_SUCCESS) return;
+
+        for (size_t scope = 0; scope < frame.scopes.size(); scope++)
+        {
+            for (size_t counter = 0; counter < counterCount; counter++)
+            {
+                double value = ToDouble(results[scope * counterCount + counter], selected[counter].storage);
+                Tracer::Instance().AddGpuCounter(selected[counter].label, frame.scopes[scope].name,
+                                                 frame.scopes[scope].hostTicks, value);
+                AddSample(counter, frame.scopes[scope].name, value);
+            }
+        }
+    }
+
+
+    void
+    AddSample(size_t counter, const char* scope, double value)
+    {
+        std::vector<Average>& scopes = averages[counter];
+        auto found = std::find_if(scopes.begin(), scopes.end(), [scope](const Average& average)
+        {
+            return std::string(average.scope) == scope;
+        });
+        if (found == scopes.end())
+        {
+            Average average;
+            average.scope = scope;
+            scopes.push_back(average);
+            found = scopes.end() - 1;
+        }
+        found->sum += value;
+        found->count++;
+    }
+
+
+    void
+    Disable()
+    {
+        if (lockHeld) releaseLock(device);
+        lockHeld       = false;
+        releaseLock    = nullptr;
+        resetQueryPool = nullptr;
+        frames.clear();
+        selected.clear();
+        counterIndices.clear();
+        submitInfos.clear();
+        averages.clear();
+        scopeOpen = false;
+    }
+
+    VkDevice                                     device         = VK_NULL_HANDLE;
+    PFN_vkReleaseProfilingLockKHR                releaseLock    = nullptr;
+    PFN_vkResetQueryPoolEXT                      resetQueryPool = nullptr;
+    bool                                         lockHeld       = false;
+    std::vector<Counter>                         selected;
+    std::vector<uint32_t>                        counterIndices;
+    std::vector<VkPerformanceQuerySubmitInfoKHR> submitInfos;
+    std::vector<Frame>                           frames;
+    std::vector<std::vector<Average>>            averages;     // Per selected counter
+    uint32_t                                     currentFrame = 0;
+    bool                                         scopeOpen    = false;
+    bool                                         scopeDropped = false;
+};
+
+
+// Samples the counters over the lifetime of the object, e.g. one pass:
+//   { PerformanceCounterScope scope(counters, commandBuffer, "Shadows"); ... }
+class PerformanceCounterScope
+{
+public:
+    PerformanceCounterScope(PerformanceCounters& performanceCounters, VkCommandBuffer scopeCommandBuffer, const char* name)
+        : counters(performanceCounters), commandBuffer(scopeCommandBuffer)
+    {
+        counters.BeginScope(commandBuffer, name);
+    }
+
+
+    ~PerformanceCounterScope()
+    {
+        counters.EndScope(commandBuffer);
+    }
+
+
+    PerformanceCounterScope(const PerformanceCounterScope&) = delete;
+    PerformanceCounterScope& operator=(const PerformanceCounterScope&) = delete;
+
+
+private:
+    PerformanceCounters& counters;
+    VkCommandBuffer      commandBuffer;
+};
+
+#endif // PERFORMANCE_COUNTERS_H
@@ -0,0 +1,350 @@
+#ifndef PIPELINE_TELEMETRY_H
+#define PIPELINE_TELEMETRY_H
+
+// Per pipeline creation telemetry: host side creation time, the driver's own timing and
+// pipeline cache hit flags from VK_EXT_pipeline_creation_feedback, and the driver's
+// statistics for every executable (register count, spills, instruction count, ... names
+// vary by vendor) from VK_KHR_pipeline_executable_properties.
+//
+// Pipeline creation sites wrap their vkCreate*Pipelines call in Begin()/End(), which
+// chain the feedback request and add the statistics capture flag when the extensions are
+// enabled; CreateComputePipeline() does so for every compute pipeline, and RenderBenchmark
+// for its graphics pipeline. Nothing is recorded until Enable() is called. WriteReport()
+// saves everything as JSON, and PrintSummary() lists the slowest cache misses; both do
+// nothing while no pipeline has been recorded.
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanUtilities.h"
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+const uint32_t PIPELINE_TELEMETRY_MAX_STAGES = 8;
+
+
+// Filled by PipelineTelemetry::Begin(); must stay alive until End().
+struct PipelineFeedback
+{
+    VkPipelineCreationFeedbackEXT            pipeline = {};
+    VkPipelineCreationFeedbackEXT            stages[PIPELINE_TELEMETRY_MAX_STAGES] = {};
+    VkPipelineCreationFeedbackCreateInfoEXT  createInfo = {};
+    uint32_t                                 stageCount = 0;
+    std::chrono::steady_clock::time_point    start;
+};
+
+
+struct PipelineStatistic
+{
+    std::string                            name;
+    VkPipelineExecutableStatisticFormatKHR format;
+    VkPipelineExecutableStatisticValueKHR  value;
+};
+
+
+struct PipelineExecutableReport
+{
+    std::string                    name;
+    VkShaderStageFlags             stages       = 0;
+    uint32_t                       subgroupSize = 0;
+    std::vector<PipelineStatistic> statistics;
+};
+
+
+struct PipelineReport
+{
+    std::string                           name;
+    double                                hostMs        = 0.0;
+    bool                                  feedbackValid = false; // Remaining fields below need it
+    double                                driverMs      = 0.0;
+    bool                                  cacheHit      = false;
+    std::vector<double>                   stageMs;
+    std::vector<bool>                     stageCacheHits;
+    std::vector<PipelineExecutableReport> executables;
+};
+
+
+class PipelineTelemetry
+{
+public:
+    static PipelineTelemetry&
+    Instance()
+    {
+        static PipelineTelemetry telemetry;
+        return telemetry;
+    }
+
+
+    PipelineTelemetry(const PipelineTelemetry&) = delete;
+    PipelineTelemetry& operator=(const PipelineTelemetry&) = delete;
+
+
+    // creationFeedback: VK_EXT_pipeline_creation_feedback is enabled. executableProperties:
+    // VK_KHR_pipeline_executable_properties is enabled with its pipelineExecutableInfo
+    // feature. Timing alone is recorded when neither is.
+    void
+    Enable(VkDevice logicalDevice, bool creationFeedback, bool executableProperties)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        device           = logicalDevice;
+        enabled          = true;
+        feedbackEnabled  = creationFeedback;
+        getExecutables   = nullptr;
+        getStatistics    = nullptr;
+        if (executableProperties)
+        {
+            getExecutables = LoadDeviceFunction<PFN_vkGetPipelineExecutablePropertiesKHR>(
+                device, "vkGetPipelineExecutablePropertiesKHR");
+            getStatistics  = LoadDeviceFunction<PFN_vkGetPipelineExecutableStatisticsKHR>(
+                device, "vkGetPipelineExecutableStatisticsKHR");
+        }
+    }
+
+
+    // Call before the device is destroyed.
+    void
+    Disable()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        enabled = false;
+        device  = VK_NULL_HANDLE;
+    }
+
+
+    // Right before vkCreate*Pipelines for one pipeline of stageCount stages: puts the
+    // feedback request in front of pNext and returns flags to add to the create info.
+    VkPipelineCreateFlags
+    Begin(PipelineFeedback& feedback, const void*& pNext, uint32_t stageCount)
+    {
+        feedback.stageCount = std::min(stageCount, PIPELINE_TELEMETRY_MAX_STAGES);
+        feedback.start      = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!enabled) return 0;
+
+        if (feedbackEnabled && stageCount <= PIPELINE_TELEMETRY_MAX_STAGES)
+        {
+            feedback.createInfo.sType                              = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+            feedback.createInfo.pNext                              = pNext;
+            feedback.createInfo.pPipelineCreationFeedback          = &feedback.pipeline;
+            feedback.createInfo.pipelineStageCreationFeedbackCount = stageCount;
+            feedback.createInfo.pPipelineStageCreationFeedbacks    = feedback.stages;
+            pNext = &feedback.createInfo;
+        }
+        return getStatistics ? VK_PIPELINE_CREATE_CAPTURE_STATISTICS_BIT_KHR : 0;
+    }
+
+
+    // Right after a successful vkCreate*Pipelines.
+    void
+    End(const PipelineFeedback& feedback, const std::string& name, VkPipeline pipeline)
+    {
+        double hostMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                                  feedback.start).count();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!enabled) return;
+
+        PipelineReport report;
+        report.name          = name;
+        report.hostMs        = hostMs;
+        report.feedbackValid = (feedback.pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT) != 0;
+        if (report.feedbackValid)
+        {
+            report.driverMs = static_cast<double>(feedback.pipeline.duration) * 1e-6;
+            report.cacheHit = (feedback.pipeline.flags &
+                               VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+            for (uint32_t stage = 0; stage < feedback.stageCount; stage++)
+            {
+                const VkPipelineCreationFeedbackEXT& stageFeedback = feedback.stages[stage];
+                report.stageMs.push_back(static_cast<double>(stageFeedback.duration) * 1e-6);
+                report.stageCacheHits.push_back((stageFeedback.flags &
+                                                 VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0);
+            }
+        }
+
+        if (getExecutables && getStatistics)
+        {
+            QueryExecutables(pipeline, report);
+        }
+        reports.push_back(report);
+    }
+
+
+    std::vector<PipelineReport>
+    Reports() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reports;
+    }
+
+
+    void
+    WriteReport(const std::string& path) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (reports.empty()) return;
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to open pipeline report " + path + ".");
+        }
+
+        file << "{\"pipelines\":[";
+        for (size_t ii = 0; ii < reports.size(); ii++)
+        {
+            const PipelineReport& report = reports[ii];
+            file << (ii ? ",\n" : "\n") << "{\"name\":\"" << EscapeJson(report.name) << "\",\"hostMs\":" << report.hostMs;
+            if (report.feedbackValid)
+            {
+                file << ",\"driverMs\":" << report.driverMs << ",\"cacheHit\":" << (report.cacheHit ? "true" : "false")
+                     << ",\"stages\":[";
+                for (size_t stage = 0; stage < report.stageMs.size(); stage++)
+                {
+                    file << (stage ? "," : "") << "{\"ms\":" << report.stageMs[stage] << ",\"cacheHit\":"
+                         << (report.stageCacheHits[stage] ? "true" : "false") << "}";
+                }
+                file << "]";
+            }
+
+            file << ",\"executables\":[";
+            for (size_t executable = 0; executable < report.executables.size(); executable++)
+            {
+                const PipelineExecutableReport& entry = report.executables[executable];
+                file << (executable ? "," : "") << "{\"name\":\"" << EscapeJson(entry.name) << "\",\"stages\":"
+                     << entry.stages << ",\"subgroupSize\":" << entry.subgroupSize << ",\"statistics\":{";
+                for (size_t statistic = 0; statistic < entry.statistics.size(); statistic++)
+                {
+                    file << (statistic ? "," : "") << "\"" << EscapeJson(entry.statistics[statistic].name) << "\":";
+                    WriteValue(file, entry.statistics[statistic]);
+                }
+                file << "}}";
+            }
+            file << "]}";
+        }
+        file << "\n]}\n";
+
+        std::cout << "[ INFO ] Wrote " << reports.size() << " pipeline reports to " << path << "." << std::endl;
+    }
+
+
+    void
+    PrintSummary() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (reports.empty()) return;
+
+        uint32_t cacheHits = 0;
+        double   totalMs   = 0.0;
+        std::vector<const PipelineReport*> misses;
+        for (const auto& report : reports)
+        {
+            totalMs += report.hostMs;
+            if (report.cacheHit) cacheHits++;
+            else misses.push_back(&report);
+        }
+        std::sort(misses.begin(), misses.end(), [](const PipelineReport* left, const PipelineReport* right)
+        {
+            return left->hostMs > right->hostMs;
+        });
+
+        std::cout << "[ INFO ] " << reports.size() << " pipelines created in " << totalMs << " ms, "
+                  << cacheHits << " pipeline cache hits." << std::endl;
+        for (size_t ii = 0; ii < std::min<size_t>(misses.size(), 5); ii++)
+        {
+            std::cout << "[ INFO ]     " << misses[ii]->name << ": " << misses[ii]->hostMs << " ms"
+                      << (misses[ii]->feedbackValid ? ", cache miss" : "") << std::endl;
+        }
+    }
+
+
+private:
+    PipelineTelemetry() = default;
+
+
+    void
+    QueryExecutables(VkPipeline pipeline, PipelineReport& report) const
+    {
+        VkPipelineInfoKHR pipelineInfo = {};
+        pipelineInfo.sType    = VK_STRUCTURE_TYPE_PIPELINE_INFO_KHR;
+        pipelineInfo.pipeline = pipeline;
+
+        uint32_t executableCount = 0;
+        if (getExecutables(device, &pipelineInfo, &executableCount, nullptr) != VK_SUCCESS) return;
+        std::vector<VkPipelineExecutablePropertiesKHR> executables(executableCount);
+        for (auto& executable : executables)
+        {
+            executable.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_PROPERTIES_KHR;
+        }
+        if (getExecutables(device, &pipelineInfo, &executableCount, executables.data()) != VK_SUCCESS) return;
+
+        for (uint32_t index = 0; index < executableCount; index++)
+        {
+            PipelineExecutableReport entry;
+            entry.name         = executables[index].name;
+            entry.stages       = executables[index].stages;
+            entry.subgroupSize = executables[index].subgroupSize;
+
+            VkPipelineExecutableInfoKHR executableInfo = {};
+            executableInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_INFO_KHR;
+            executableInfo.pipeline        = pipeline;
+            executableInfo.executableIndex = index;
+
+            uint32_t statisticCount = 0;
+            if (getStatistics(device, &executableInfo, &statisticCount, nullptr) == VK_SUCCESS)
+            {
+                std::vector<VkPipelineExecutableStatisticKHR> statistics(statisticCount);
+                for (auto& statistic : statistics)
+                {
+                    statistic.sType = VK_STRUCTURE_TYPE_PIPELINE_EXECUTABLE_STATISTIC_KHR;
+                }
+                if (getStatistics(device, &executableInfo, &statisticCount, statistics.data()) == VK_SUCCESS)
+                {
+                    for (uint32_t ii = 0; ii < statisticCount; ii++)
+                    {
+                        PipelineStatistic statistic = { statistics[ii].name, statistics[ii].format, statistics[ii].value };
+                        entry.statistics.push_back(statistic);
+                    }
+                }
+            }
+            report.executables.push_back(entry);
+        }
+    }
+
+
+    static void
+    WriteValue(std::ofstream& file, const PipelineStatistic& statistic)
+    {
+        switch (statistic.format)
+        {
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_BOOL32_KHR:  file << (statistic.value.b32 ? "true" : "false"); break;
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_INT64_KHR:   file << statistic.value.i64; break;
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_UINT64_KHR:  file << statistic.value.u64; break;
+            case VK_PIPELINE_EXECUTABLE_STATISTIC_FORMAT_FLOAT64_KHR:
+                // JSON has no NaN or infinity.
+                if (std::isfinite(statistic.value.f64)) file << statistic.value.f64;
+                else                                    file << "null";
+                break;
+            default:                                                  file << "null"; break;
+        }
+    }
+
+    mutable std::mutex                       mutex;
+    VkDevice                                 device          = VK_NULL_HANDLE;
+    bool                                     enabled         = false;
+    bool                                     feedbackEnabled = false;
+    PFN_vkGetPipelineExecutablePropertiesKHR getExecutables  = nullptr;
+    PFN_vkGetPipelineExecutableStatisticsKHR getStatistics   = nullptr;
+    std::vector<PipelineReport>              reports;
+};
+
+#endif // PIPELINE_TELEMETRY_H
@@ -0,0 +1,2387 @@
+// Headless rendering benchmark: a procedural scene drawn offscreen along a fixed camera
+// path, with results written as JSON so runs can be compared across commits.
+//
+// Usage:
+//   RenderBenchmark [--meshes N] [--materials M] [--lights K] [--instances I]
+//                   [--frames F] [--warmup W] [--width X] [--height Y] [--seed S]
+//                   [--output results.json] [--breadcrumbs 1] [--counters 1]
+//                   [--trace trace.json] [--pipeline-cache cache.bin]
+//                   [--metrics metrics.prom] [--gpu-driven 1] [--draw-queue 1]
+//                   [--centerpiece S] [--clusters 1] [--textures textures.vkpa]
+//                   [--detail-texture S]
+//
+// The scene is fully determined by the arguments and the seed: N noise displaced spheres of
+// varying tessellation, I instances of them spread over a cube, M materials and K point
+// lights that every fragment loops over. The camera position is a function of the frame
+// index only, so every run renders the same frames. No window or surface is created,
+// which lets the benchmark run on a software ICD (lavapipe, SwiftShader) in CI.
+//
+// Each frame the instances are frustum culled on the job system (FrustumCulling.h), the
+// visible ones are written into a per frame index buffer and drawn with one instanced draw
+// per mesh. Reported per frame, over the F frames after W warmup frames:
+//   frameMs  time between the starts of consecutive frames
+//   cpuMs    culling, command recording and submission
+//   waitMs   time blocked on the frame's fence
+//   gpuMs    device time of the frame's command buffer (GpuProfiler.h)
+// as mean, min, max and percentiles, plus device memory allocated by the benchmark and the
+// process's peak resident set.
+//
+// --breadcrumbs 1 marks every pass with GPU crash breadcrumbs (GpuBreadcrumbs.h) and dumps
+// them if the device is lost. They cost GPU overlap, so results are recorded but should not
+// be compared with runs without them.
+//
+// --trace writes a Chrome trace (Tracing.h) of the measured frames. --counters 1 samples
+// hardware performance counters per pass through VK_KHR_performance_query
+// (PerformanceCounters.h) into that trace and prints their averages; the driver may need
+// several submissions per frame to collect them, so frame times are not comparable either.
+// Both degrade to a no-op where the extension is missing, e.g. on software ICDs.
+//
+// The graphics pipeline is created through a VkPipelineCache and recorded by
+// PipelineTelemetry.h, whose summary is printed at the end. --pipeline-cache loads the cache
+// from that file and saves it back after the run, so pipelineCreationMs of the next run
+// measures a warm cache; without it every run creates the pipeline from scratch.
+//
+// --draw-queue 1 records the CPU culled instances through DrawQueue.h instead: one packet
+// per visible instance keyed by mesh and quantized camera distance, radix sorted and
+// merged back into one instanced draw per mesh whose instances run front to back. The
+// last frame's bind statistics are printed at the end.
+//
+// --centerpiece S adds one dense noise sphere of S segments at the scene center, outside
+// the instance culling, drawn whole. --clusters 1 splits it into meshlets (Meshlets.h)
+// and draws only the clusters a compute pass keeps after frustum and normal cone culling
+// (ClusterCulling.h). Both use the CPU culled path's instance buffer, so they cannot be
+// combined with --gpu-driven.
+//
+// --textures streams up to 16 single layer 2D textures of a packed asset archive
+// (AssetPacker.cpp) through TextureStreaming.h: every mesh samples one of them, the
+// fragment shader writes the mip it wanted into a feedback buffer, and the streamer's
+// decisions are applied at the start of every frame, before the scene pass. The CPU culled
+// path only; the streamed images are not part of deviceBytes.
+//
+// --detail-texture S instead modulates every mesh with one S x S texture generated at
+// startup: level 0 is filled on the CPU and the rest of the chain by MipGenerator.h,
+// with its single dispatch compute path where the device allows and blits otherwise.
+// The CPU culled path only.
+//
+// Every frame is also tallied in FrameMetrics (Metrics.h): draw calls, triangles, pipeline
+// binds, descriptor writes and upload bytes, plus the benchmark's allocations per memory
+// heap. The last frame's line is printed at the end, and --metrics writes the whole
+// registry in Prometheus text format.
+//
+// --gpu-driven 1 replaces the CPU culling with GpuScene.h: the instances are uploaded
+// once, a compute pass culls them every frame and compacts the survivors into indirect
+// commands, drawn with one indirect draw per material. Culling is two phase against a
+// depth pyramid (DepthPyramid.h), so the frame is drawn in an early and a late render
+// pass. The meshes carry LOD chains (MeshSimplifier.h) that the culling pass selects
+// from by projected error, so distant instances also draw fewer triangles. Recording
+// then costs the same whatever the camera sees, which is what the comparison with the
+// default path measures. The visible instance count stays on the GPU, so the results
+// report averageVisibleInstances as null, and the culling buffers GpuScene allocates are
+// not part of deviceBytes.
+//
+// Requires runtime shader compilation (HAVE_SHADERC, see ShaderCompiler.h).
+
+#ifndef GLM_FORCE_PURE
+#define GLM_FORCE_INTRINSICS
+#endif
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no psapi.lib
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <vulkan/vulkan.h>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "ClusterCulling.h"
+#include "DepthPyramid.h"
+#include "DrawQueue.h"
+#include "FrustumCulling.h"
+#include "GpuBreadcrumbs.h"
+#include "GpuProfiler.h"
+#include "GpuScene.h"
+#include "JobSystem.h"
+#include "Meshlets.h"
+#include "MeshSimplifier.h"
+#include "Metrics.h"
+#include "MipGenerator.h"
+#include "PerformanceCounters.h"
+#include "PipelineTelemetry.h"
+#include "ShaderCompiler.h"
+#include "TextureStreaming.h"
+#include "Tracing.h"
+#include "VulkanUtilities.h"
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+const uint32_t     BENCHMARK_FRAMES_IN_FLIGHT      = 2;
+const float        BENCHMARK_NEAR_PLANE            = 0.1f;
+const float        BENCHMARK_CENTERPIECE_SCALE     = 0.15f;            // Of the scene extent
+const uint32_t     BENCHMARK_MAX_STREAMED_TEXTURES = 16;
+const VkDeviceSize BENCHMARK_STREAMING_STAGING     = 16 * 1024 * 1024; // Per frame in flight
+
+
+struct BenchmarkConfig
+{
+    uint32_t    meshCount     = 32;
+    uint32_t    materialCount = 16;
+    uint32_t    lightCount    = 64;
+    uint32_t    instanceCount = 20000;
+    uint32_t    frameCount    = 500;
+    uint32_t    warmupFrames  = 50;
+    uint32_t    width         = 1280;
+    uint32_t    height        = 720;
+    uint32_t    seed          = 1;
+    std::string outputPath    = "benchmark.json";
+    bool        breadcrumbs   = false;
+    bool        counters      = false;
+    bool        gpuDriven     = false;
+    bool        drawQueue     = false;
+    uint32_t    centerpiece   = 0;       // Segments of the centerpiece mesh, 0 = none
+    bool        clusters      = false;
+    std::string tracePath;
+    std::string pipelineCachePath;
+    std::string metricsPath;
+    std::string texturesPath;
+    uint32_t    detailTexture = 0;       // Size of the generated detail texture, 0 = none
+};
+
+
+struct BenchmarkVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+
+// std430 mirrors of the shader's storage buffer elements.
+struct BenchmarkInstance
+{
+    glm::mat4 model;
+    uint32_t  material;
+    uint32_t  texture;    // Streamed texture, the same for every instance of a mesh
+    uint32_t  padding[2];
+};
+static_assert(sizeof(BenchmarkInstance) == 80, "BenchmarkInstance must match its std430 layout.");
+
+struct BenchmarkMaterial
+{
+    glm::vec4 albedo;    // rgb, a unused
+    glm::vec4 specular;  // rgb, a = shininess
+};
+
+struct BenchmarkLight
+{
+    glm::vec4 positionRadius;
+    glm::vec4 color;
+};
+
+
+struct BenchmarkPushConstants
+{
+    glm::mat4 viewProjection;
+    glm::vec4 cameraPosition;
+    uint32_t  lightCount;
+};
+
+
+struct BenchmarkMesh
+{
+    uint32_t firstIndex     = 0;
+    uint32_t indexCount     = 0;
+    int32_t  vertexOffset   = 0;
+    float    boundingRadius = 0.0f;
+    uint32_t firstInstance  = 0; // Instances are sorted by mesh
+    uint32_t instanceCount  = 0;
+};
+
+
+struct FrameTimes
+{
+    std::vector<double> frameMs;
+    std::vector<double> cpuMs;
+    std::vector<double> waitMs;
+    std::vector<double> gpuMs;
+};
+
+
+const char* const BENCHMARK_VERTEX_GLSL = R"GLSL(
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+struct Instance
+{
+    mat4 model;
+    uint material;
+    uint texture;
+    uint padding0;
+    uint padding1;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances { Instance instances[]; };
+layout(std430, set = 0, binding = 1) readonly buffer Visible   { uint visibleInstances[]; };
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    uint lightCount;
+} pc;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) flat out uint outMaterial;
+#if defined(STREAMED_TEXTURES) || defined(DETAIL_TEXTURE)
+layout(location = 3) out vec2 outUv;
+#endif
+#ifdef STREAMED_TEXTURES
+layout(location = 4) flat out uint outTexture;
+#endif
+
+void main()
+{
+    Instance instance = instances[visibleInstances[gl_InstanceIndex]];
+    vec4     world    = instance.model * vec4(inPosition, 1.0);
+
+    outPosition = world.xyz;
+    outNormal   = mat3(instance.model) * inNormal;
+    outMaterial = instance.material;
+#if defined(STREAMED_TEXTURES) || defined(DETAIL_TEXTURE)
+    outUv       = inPosition.xz * 2.0;
+#endif
+#ifdef STREAMED_TEXTURES
+    outTexture  = instance.texture;
+#endif
+    gl_Position = pc.viewProjection * world;
+}
+)GLSL";
+
+
+// Vertex shader of --gpu-driven 1, compiled after "#version 450" and
+// GPU_SCENE_INSTANCE_GLSL. GpuScene draws every instance with its index as firstInstance.
+const char* const BENCHMARK_GPU_DRIVEN_VERTEX_GLSL = R"GLSL(
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances { Instance instances[]; };
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    uint lightCount;
+} pc;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) flat out uint outMaterial;
+
+void main()
+{
+    Instance instance = instances[gl_InstanceIndex];
+    vec4     world    = instance.model * vec4(inPosition, 1.0);
+
+    outPosition = world.xyz;
+    outNormal   = mat3(instance.model) * inNormal;
+    outMaterial = instance.material;
+    gl_Position = pc.viewProjection * world;
+}
+)GLSL";
+
+
+// Compiled after "#version 450" and, with STREAMED_TEXTURES defined, after
+// TEXTURE_STREAMING_FEEDBACK_GLSL. Every draw samples one streamed texture, so the index
+// into streamedTextures is dynamically uniform.
+const char* const BENCHMARK_FRAGMENT_GLSL = R"GLSL(
+struct Material
+{
+    vec4 albedo;
+    vec4 specular;
+};
+
+struct Light
+{
+    vec4 positionRadius;
+    vec4 color;
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Materials { Material materials[]; };
+layout(std430, set = 0, binding = 3) readonly buffer Lights    { Light lights[]; };
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    uint lightCount;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) flat in uint inMaterial;
+#if defined(STREAMED_TEXTURES) || defined(DETAIL_TEXTURE)
+layout(location = 3) in vec2 inUv;
+#endif
+#ifdef STREAMED_TEXTURES
+layout(location = 4) flat in uint inTexture;
+
+layout(set = 0, binding = 4) uniform sampler2D streamedTextures[STREAMED_TEXTURE_COUNT];
+#endif
+#ifdef DETAIL_TEXTURE
+layout(set = 0, binding = 4) uniform sampler2D detailTexture;
+#endif
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    Material material = materials[inMaterial];
+#ifdef STREAMED_TEXTURES
+    material.albedo.rgb *= SampleStreamed(inTexture, streamedTextures[inTexture], inUv).rgb;
+#endif
+#ifdef DETAIL_TEXTURE
+    material.albedo.rgb *= texture(detailTexture, inUv).rgb;
+#endif
+    vec3     normal   = normalize(inNormal);
+    vec3     toEye    = normalize(pc.cameraPosition.xyz - inPosition);
+    vec3     color    = material.albedo.rgb * 0.03;
+
+    for (uint ii = 0; ii < pc.lightCount; ii++)
+    {
+        vec3  toLight     = lights[ii].positionRadius.xyz - inPosition;
+        float distance    = length(toLight);
+        float attenuation = clamp(1.0 - distance / lights[ii].positionRadius.w, 0.0, 1.0);
+        if (attenuation == 0.0)
+        {
+            continue;
+        }
+
+        vec3  direction = toLight / distance;
+        vec3  halfway   = normalize(direction + toEye);
+        float diffuse   = max(dot(normal, direction), 0.0);
+        float specular  = pow(max(dot(normal, halfway), 0.0), material.specular.a);
+        color += (material.albedo.rgb * diffuse + material.specular.rgb * specular) *
+                 lights[ii].color.rgb * attenuation * attenuation;
+    }
+
+    outColor = vec4(color, 1.0);
+}
+)GLSL";
+
+
+void
+PrintUsage()
+{
+    std::cout << "Usage: RenderBenchmark [--meshes N] [--materials M] [--lights K] [--instances I]\n"
+              << "                       [--frames F] [--warmup W] [--width X] [--height Y] [--seed S]\n"
+              << "                       [--output results.json] [--breadcrumbs 1] [--counters 1]\n"
+              << "                       [--trace trace.json] [--pipeline-cache cache.bin]\n"
+              << "                       [--metrics metrics.prom] [--gpu-driven 1] [--draw-queue 1]\n"
+              << "                       [--centerpiece S] [--clusters 1] [--textures textures.vkpa]\n"
+              << "                       [--detail-texture S]" << std::endl;
+}
+
+
+BenchmarkConfig
+ParseArguments(int argc, char** argv)
+{
+    BenchmarkConfig config;
+    for (int ii = 1; ii < argc; ii++)
+    {
+        std::string option = argv[ii];
+        if (ii + 1 >= argc)
+        {
+            throw std::runtime_error("[ ERROR ] Missing value for " + option + ".");
+        }
+        std::string value  = argv[++ii];
+        uint32_t    number = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+
+        if      (option == "--meshes")         config.meshCount         = number;
+        else if (option == "--materials")      config.materialCount     = number;
+        else if (option == "--lights")         config.lightCount        = number;
+        else if (option == "--instances")      config.instanceCount     = number;
+        else if (option == "--frames")         config.frameCount        = number;
+        else if (option == "--warmup")         config.warmupFrames      = number;
+        else if (option == "--width")          config.width             = number;
+        else if (option == "--height")         config.height            = number;
+        else if (option == "--seed")           config.seed              = number;
+        else if (option == "--output")         config.outputPath        = value;
+        else if (option == "--breadcrumbs")    config.breadcrumbs       = number != 0;
+        else if (option == "--counters")       config.counters          = number != 0;
+        else if (option == "--trace")          config.tracePath         = value;
+        else if (option == "--pipeline-cache") config.pipelineCachePath = value;
+        else if (option == "--metrics")        config.metricsPath       = value;
+        else if (option == "--gpu-driven")     config.gpuDriven         = number != 0;
+        else if (option == "--draw-queue")     config.drawQueue         = number != 0;
+        else if (option == "--centerpiece")    config.centerpiece       = number;
+        else if (option == "--clusters")       config.clusters          = number != 0;
+        else if (option == "--textures")       config.texturesPath      = value;
+        else if (option == "--detail-texture") config.detailTexture     = number;
+        else
+        {
+            throw std::runtime_error("[ ERROR ] Unknown option " + option + ".");
+        }
+    }
+
+    if (config.meshCount == 0 || config.materialCount == 0 || config.instanceCount == 0 ||
+        config.frameCount == 0 || config.width == 0 || config.height == 0)
+    {
+        throw std::runtime_error("[ ERROR ] Meshes, materials, instances, frames and the resolution must be positive.");
+    }
+    if (config.gpuDriven && config.drawQueue)
+    {
+        throw std::runtime_error("[ ERROR ] --draw-queue records the CPU culled path, it cannot be combined with --gpu-driven.");
+    }
+    if (config.clusters && config.centerpiece == 0)
+    {
+        throw std::runtime_error("[ ERROR ] --clusters culls the centerpiece, it needs --centerpiece.");
+    }
+    if (config.gpuDriven && config.centerpiece != 0)
+    {
+        throw std::runtime_error("[ ERROR ] --centerpiece draws through the CPU culled path, it cannot be combined with --gpu-driven.");
+    }
+    if (config.gpuDriven && !config.texturesPath.empty())
+    {
+        throw std::runtime_error("[ ERROR ] --textures draws through the CPU culled path, it cannot be combined with --gpu-driven.");
+    }
+    if (config.gpuDriven && config.detailTexture != 0)
+    {
+        throw std::runtime_error("[ ERROR ] --detail-texture draws through the CPU culled path, it cannot be combined with --gpu-driven.");
+    }
+    if (config.detailTexture > MIP_GENERATOR_MAX_DIMENSION)
+    {
+        throw std::runtime_error("[ ERROR ] --detail-texture is at most 4096 texels.");
+    }
+    if (!config.texturesPath.empty() && config.detailTexture != 0)
+    {
+        throw std::runtime_error("[ ERROR ] --detail-texture and --textures both sample binding 4, use one of them.");
+    }
+    return config;
+}
+
+
+// UV sphere whose radius is perturbed by a product of two random sine waves. Appends to
+// vertices/indices; returns the bounding radius.
+float
+GenerateMesh(std::mt19937&                 random,
+             uint32_t                      segments,
+             std::vector<BenchmarkVertex>& vertices,
+             std::vector<uint32_t>&        indices)
+{
+    std::uniform_real_distribution<float> amplitude(0.0f, 0.3f);
+    std::uniform_real_distribution<float> frequency(1.0f, 6.0f);
+    std::uniform_real_distribution<float> phase(0.0f, glm::two_pi<float>());
+
+    float    noiseAmplitude = amplitude(random);
+    float    frequencyTheta = std::floor(frequency(random));
+    float    frequencyPhi   = std::floor(frequency(random));
+    float    phaseTheta     = phase(random);
+    float    phasePhi       = phase(random);
+    uint32_t rings          = std::max(segments / 2, 2u);
+    uint32_t baseVertex     = static_cast<uint32_t>(vertices.size());
+
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float theta = glm::pi<float>() * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float phi    = glm::two_pi<float>() * static_cast<float>(segment) / static_cast<float>(segments);
+            float radius = 1.0f + noiseAmplitude * std::sin(frequencyTheta * theta + phaseTheta) *
+                                                   std::sin(frequencyPhi * phi + phasePhi);
+
+            BenchmarkVertex vertex;
+            vertex.position = radius * glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                                 std::sin(theta) * std::sin(phi));
+            vertex.normal   = glm::vec3(0.0f);
+            vertices.push_back(vertex);
+        }
+    }
+
+    size_t firstIndex = indices.size();
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t current = ring * (segments + 1) + segment;
+            uint32_t below   = current + segments + 1;
+            uint32_t quad[6] = { current, current + 1, below, current + 1, below + 1, below };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    // Area weighted normals; degenerate pole triangles contribute nothing.
+    for (size_t ii = firstIndex; ii < indices.size(); ii += 3)
+    {
+        BenchmarkVertex& a = vertices[baseVertex + indices[ii + 0]];
+        BenchmarkVertex& b = vertices[baseVertex + indices[ii + 1]];
+        BenchmarkVertex& c = vertices[baseVertex + indices[ii + 2]];
+        glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+        a.normal += normal;
+        b.normal += normal;
+        c.normal += normal;
+    }
+
+    float boundingRadius = 0.0f;
+    for (size_t ii = baseVertex; ii < vertices.size(); ii++)
+    {
+        float length = glm::length(vertices[ii].normal);
+        vertices[ii].normal = length > 0.0f ? vertices[ii].normal / length : glm::normalize(vertices[ii].position);
+        boundingRadius      = std::max(boundingRadius, glm::length(vertices[ii].position));
+    }
+    return boundingRadius;
+}
+
+
+// Nearest rank percentile of sorted samples.
+double
+Percentile(const std::vector<double>& sorted, double percent)
+{
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::min(std::max(rank, static_cast<size_t>(1)), sorted.size()) - 1];
+}
+
+
+void
+WriteStatistics(std::ostream& stream, const char* name, std::vector<double> samples, bool last)
+{
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples)
+    {
+        sum += sample;
+    }
+
+    stream << "    \"" << name << "\": { "
+           << "\"samples\": " << samples.size()
+           << ", \"mean\": " << (samples.empty() ? 0.0 : sum / static_cast<double>(samples.size()))
+           << ", \"min\": "  << (samples.empty() ? 0.0 : samples.front())
+           << ", \"p50\": "  << Percentile(samples, 50.0)
+           << ", \"p90\": "  << Percentile(samples, 90.0)
+           << ", \"p95\": "  << Percentile(samples, 95.0)
+           << ", \"p99\": "  << Percentile(samples, 99.0)
+           << ", \"max\": "  << (samples.empty() ? 0.0 : samples.back())
+           << " }" << (last ? "\n" : ",\n");
+}
+
+
+uint64_t
+PeakResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    counters.cb = sizeof(counters);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+#else
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+}
+
+
+// One pass of the frame: a GpuProfiler scope nested in the frame's, a breadcrumb, and a
+// performance counter scope, which cannot nest and so are taken per pass only. Begin
+// outside render pass instances.
+class BenchmarkPassScope
+{
+public:
+    BenchmarkPassScope(GpuProfiler&         profiler,
+                       GpuBreadcrumbs&      breadcrumbs,
+                       PerformanceCounters& counters,
+                       VkCommandBuffer      commandBuffer,
+                       const char*          name)
+        : profilerScope(profiler, commandBuffer, name),
+          breadcrumb(breadcrumbs, commandBuffer, name),
+          counterScope(counters, commandBuffer, name)
+    {
+    }
+
+
+    BenchmarkPassScope(const BenchmarkPassScope&) = delete;
+    BenchmarkPassScope& operator=(const BenchmarkPassScope&) = delete;
+
+
+private:
+    GpuProfilerScope        profilerScope;
+    GpuBreadcrumb           breadcrumb;
+    PerformanceCounterScope counterScope;
+};
+
+
+class RenderBenchmark
+{
+public:
+    explicit RenderBenchmark(const BenchmarkConfig& benchmarkConfig)
+        : config(benchmarkConfig)
+    {
+    }
+
+
+    void
+    Run()
+    {
+        if (!ShaderCompilerAvailable())
+        {
+            throw std::runtime_error("[ ERROR ] RenderBenchmark needs runtime shader compilation, build with shaderc.");
+        }
+
+        CreateDevice();
+        metrics.Create();
+        metrics.SetHeapSizes(physicalDevice);
+        CreateTargets();
+        CreateTextures();
+        CreatePipeline();
+        CreateScene();
+        CreateFrames();
+
+        std::cout << "[ INFO ] Benchmarking " << deviceProperties.deviceName << ": "
+                  << config.instanceCount << " instances of " << config.meshCount << " meshes, "
+                  << config.materialCount << " materials, " << config.lightCount << " lights, "
+                  << config.width << "x" << config.height << ", "
+                  << config.warmupFrames << " + " << config.frameCount << " frames" << std::endl;
+
+        RenderFrames();
+        WriteResults();
+        WriteMetrics();
+        if (config.drawQueue) drawQueue.Statistics().Print();
+        if (streamedTextureCount != 0)
+        {
+            std::cout << "[ INFO ] Streamed textures resident: " << textureStreamer.ResidentBytes() / 1024 << " KiB." << std::endl;
+        }
+
+        PipelineTelemetry::Instance().PrintSummary();
+        if (!config.pipelineCachePath.empty())
+        {
+            SavePipelineCache(device, pipelineCache, config.pipelineCachePath);
+        }
+    }
+
+
+    void
+    Cleanup()
+    {
+        if (device == VK_NULL_HANDLE)
+        {
+            if (instance != VK_NULL_HANDLE) vkDestroyInstance(instance, nullptr);
+            instance = VK_NULL_HANDLE;
+            return;
+        }
+
+        vkDeviceWaitIdle(device);
+        PipelineTelemetry::Instance().Disable();
+        profiler.Destroy();
+        breadcrumbs.Destroy();
+        counters.Destroy();
+        gpuScene.Destroy();
+        depthPyramid.Destroy();
+        clusterCuller.Destroy();
+        textureStreamer.Stop();
+        textureBackend.Destroy();
+        textureFeedback.Destroy();
+        detailMips.Destroy();
+        if (detailView != VK_NULL_HANDLE)     vkDestroyImageView(device, detailView, nullptr);
+        if (detailImage != VK_NULL_HANDLE)    vkDestroyImage(device, detailImage, nullptr);
+        if (detailMemory != VK_NULL_HANDLE)   vkFreeMemory(device, detailMemory, nullptr);
+        if (textureSampler != VK_NULL_HANDLE) vkDestroySampler(device, textureSampler, nullptr);
+        detailView     = VK_NULL_HANDLE;
+        detailImage    = VK_NULL_HANDLE;
+        detailMemory   = VK_NULL_HANDLE;
+        textureSampler = VK_NULL_HANDLE;
+
+        for (auto& frame : frames)
+        {
+            if (frame.fence != VK_NULL_HANDLE)         vkDestroyFence(device, frame.fence, nullptr);
+            if (frame.visibleBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, frame.visibleBuffer, nullptr);
+            if (frame.visibleMemory != VK_NULL_HANDLE) vkFreeMemory(device, frame.visibleMemory, nullptr);
+        }
+        frames.clear();
+
+        VkBuffer       buffers[]  = { vertexBuffer, indexBuffer, instanceBuffer, materialBuffer, lightBuffer };
+        VkDeviceMemory memories[] = { vertexMemory, indexMemory, instanceMemory, materialMemory, lightMemory };
+        for (size_t ii = 0; ii < sizeof(buffers) / sizeof(buffers[0]); ii++)
+        {
+            if (buffers[ii] != VK_NULL_HANDLE)  vkDestroyBuffer(device, buffers[ii], nullptr);
+            if (memories[ii] != VK_NULL_HANDLE) vkFreeMemory(device, memories[ii], nullptr);
+        }
+        vertexBuffer = indexBuffer = instanceBuffer = materialBuffer = lightBuffer = VK_NULL_HANDLE;
+        vertexMemory = indexMemory = instanceMemory = materialMemory = lightMemory = VK_NULL_HANDLE;
+
+        if (descriptorPool != VK_NULL_HANDLE)      vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        if (pipeline != VK_NULL_HANDLE)            vkDestroyPipeline(device, pipeline, nullptr);
+        if (pipelineCache != VK_NULL_HANDLE)       vkDestroyPipelineCache(device, pipelineCache, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE)      vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        if (framebuffer != VK_NULL_HANDLE)         vkDestroyFramebuffer(device, framebuffer, nullptr);
+        if (renderPass != VK_NULL_HANDLE)          vkDestroyRenderPass(device, renderPass, nullptr);
+        if (lateRenderPass != VK_NULL_HANDLE)      vkDestroyRenderPass(device, lateRenderPass, nullptr);
+        if (colorView != VK_NULL_HANDLE)           vkDestroyImageView(device, colorView, nullptr);
+        if (colorImage != VK_NULL_HANDLE)          vkDestroyImage(device, colorImage, nullptr);
+        if (colorMemory != VK_NULL_HANDLE)         vkFreeMemory(device, colorMemory, nullptr);
+        if (depthView != VK_NULL_HANDLE)           vkDestroyImageView(device, depthView, nullptr);
+        if (depthImage != VK_NULL_HANDLE)          vkDestroyImage(device, depthImage, nullptr);
+        if (depthMemory != VK_NULL_HANDLE)         vkFreeMemory(device, depthMemory, nullptr);
+        if (commandPool != VK_NULL_HANDLE)         vkDestroyCommandPool(device, commandPool, nullptr);
+        descriptorPool      = VK_NULL_HANDLE;
+        pipeline            = VK_NULL_HANDLE;
+        pipelineCache       = VK_NULL_HANDLE;
+        pipelineLayout      = VK_NULL_HANDLE;
+        descriptorSetLayout = VK_NULL_HANDLE;
+        framebuffer         = VK_NULL_HANDLE;
+        renderPass          = VK_NULL_HANDLE;
+        lateRenderPass      = VK_NULL_HANDLE;
+        colorView           = VK_NULL_HANDLE;
+        colorImage          = VK_NULL_HANDLE;
+        colorMemory         = VK_NULL_HANDLE;
+        depthView           = VK_NULL_HANDLE;
+        depthImage          = VK_NULL_HANDLE;
+        depthMemory         = VK_NULL_HANDLE;
+        commandPool         = VK_NULL_HANDLE;
+
+        vkDestroyDevice(device, nullptr);
+        vkDestroyInstance(instance, nullptr);
+        device   = VK_NULL_HANDLE;
+        instance = VK_NULL_HANDLE;
+    }
+
+
+private:
+    struct Frame
+    {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence         fence         = VK_NULL_HANDLE;
+        VkBuffer        visibleBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory  visibleMemory = VK_NULL_HANDLE;
+        uint32_t*       visibleMapped = nullptr;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t        frameNumber   = UINT32_MAX; // Last frame recorded into this slot
+        std::vector<VkImageView> textureViews;      // Streamed texture views in descriptorSet
+    };
+
+
+    void
+    CreateDevice()
+    {
+        VkApplicationInfo appInfo = {};
+        appInfo.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName   = "Render Benchmark";
+        appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+        appInfo.pEngineName        = "No Engine";
+        appInfo.engineVersion      = VK_MAKE_VERSION(1, 0, 0);
+        appInfo.apiVersion         = VK_API_VERSION_1_0;
+
+        // VK_KHR_performance_query and VK_KHR_pipeline_executable_properties depend on
+        // VK_KHR_get_physical_device_properties2.
+        std::vector<const char*> instanceExtensions;
+        bool properties2 = InstanceExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        if (properties2) instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
+        VkInstanceCreateInfo instanceInfo = {};
+        instanceInfo.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceInfo.pApplicationInfo        = &appInfo;
+        instanceInfo.enabledExtensionCount   = static_cast<uint32_t>(instanceExtensions.size());
+        instanceInfo.ppEnabledExtensionNames = instanceExtensions.data();
+        if (vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create Vulkan instance.");
+        }
+
+        uint32_t gpuCount = 0;
+        vkEnumeratePhysicalDevices(instance, &gpuCount, nullptr);
+        std::vector<VkPhysicalDevice> gpus(gpuCount);
+        vkEnumeratePhysicalDevices(instance, &gpuCount, gpus.data());
+
+        // First device with a graphics queue; discrete GPUs win over everything else.
+        for (VkPhysicalDevice candidate : gpus)
+        {
+            uint32_t familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+
+            for (uint32_t ii = 0; ii < familyCount; ii++)
+            {
+                if (!(families[ii].queueFlags & VK_QUEUE_GRAPHICS_BIT)) continue;
+
+                VkPhysicalDeviceProperties properties = {};
+                vkGetPhysicalDeviceProperties(candidate, &properties);
+                if (physicalDevice == VK_NULL_HANDLE || properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+                {
+                    physicalDevice   = candidate;
+                    queueFamilyIndex = ii;
+                    queueCompute     = (families[ii].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+                }
+                break;
+            }
+        }
+        if (physicalDevice == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("[ ERROR ] No Vulkan device with a graphics queue found.");
+        }
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+        float                   priority  = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo = {};
+        queueInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = queueFamilyIndex;
+        queueInfo.queueCount       = 1;
+        queueInfo.pQueuePriorities = &priority;
+
+        // Checkpoints are the cheaper breadcrumbs; without them GpuBreadcrumbs falls back to
+        // its marker buffer.
+        std::vector<const char*> extensions;
+        bool checkpoints = config.breadcrumbs &&
+                           DeviceExtensionSupported(physicalDevice, VK_NV_DEVICE_DIAGNOSTIC_CHECKPOINTS_EXTENSION_NAME);
+        if (checkpoints) extensions.push_back(VK_NV_DEVICE_DIAGNOSTIC_CHECKPOINTS_EXTENSION_NAME);
+
+        // Cache hits and driver timing, and driver statistics per executable, for
+        // PipelineTelemetry when the device has them.
+        void* features         = nullptr;
+        bool  creationFeedback = DeviceExtensionSupported(physicalDevice, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+        if (creationFeedback) extensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+        VkPhysicalDevicePipelineExecutablePropertiesFeaturesKHR executableFeatures = {};
+        executableFeatures.sType                  = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PIPELINE_EXECUTABLE_PROPERTIES_FEATURES_KHR;
+        executableFeatures.pipelineExecutableInfo = VK_TRUE;
+        bool executableProperties = properties2 &&
+                                    DeviceExtensionSupported(physicalDevice, VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME);
+        if (executableProperties)
+        {
+            extensions.push_back(VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME);
+            executableFeatures.pNext = features;
+            features                 = &executableFeatures;
+        }
+
+        // Performance queries are reset from the host, so the counters need both.
+        VkPhysicalDeviceHostQueryResetFeaturesEXT hostQueryResetFeatures = {};
+        hostQueryResetFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT;
+
+        VkPhysicalDevicePerformanceQueryFeaturesKHR performanceQueryFeatures = {};
+        performanceQueryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PERFORMANCE_QUERY_FEATURES_KHR;
+        if (config.counters && properties2 &&
+            DeviceExtensionSupported(physicalDevice, VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME) &&
+            DeviceExtensionSupported(physicalDevice, VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME))
+        {
+            auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+                vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+            performanceQueryFeatures.pNext = &hostQueryResetFeatures;
+            VkPhysicalDeviceFeatures2 supported = {};
+            supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            supported.pNext = &performanceQueryFeatures;
+            if (getFeatures2) getFeatures2(physicalDevice, &supported);
+
+            if (performanceQueryFeatures.performanceCounterQueryPools && hostQueryResetFeatures.hostQueryReset)
+            {
+                extensions.push_back(VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME);
+                extensions.push_back(VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME);
+                performanceQueryFeatures.performanceCounterMultipleQueryPools = VK_FALSE;
+                hostQueryResetFeatures.pNext   = features;
+                features                       = &performanceQueryFeatures;
+                countersEnabled                = true;
+            }
+        }
+        if (config.counters && !countersEnabled)
+        {
+            std::cout << "[ INFO ] Performance counters unavailable on this device." << std::endl;
+        }
+
+        // GpuScene and ClusterCuller draw indirectly with a non-zero firstInstance.
+        // multiDrawIndirect and VK_KHR_draw_indirect_count only turn their draws into fewer
+        // commands.
+        VkPhysicalDeviceFeatures supportedFeatures = {};
+        VkPhysicalDeviceFeatures enabledFeatures   = {};
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        if (config.gpuDriven || config.clusters)
+        {
+            if (!supportedFeatures.drawIndirectFirstInstance)
+            {
+                throw std::runtime_error("[ ERROR ] --gpu-driven and --clusters need the drawIndirectFirstInstance feature.");
+            }
+            enabledFeatures.drawIndirectFirstInstance = VK_TRUE;
+            enabledFeatures.multiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+            multiDrawIndirect = supportedFeatures.multiDrawIndirect == VK_TRUE;
+            drawIndirectCount = DeviceExtensionSupported(physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+            if (drawIndirectCount) extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+
+        // The streamed texture is picked per draw from the instance, a dynamically uniform index.
+        if (!config.texturesPath.empty())
+        {
+            if (!supportedFeatures.shaderSampledImageArrayDynamicIndexing)
+            {
+                throw std::runtime_error("[ ERROR ] --textures needs the shaderSampledImageArrayDynamicIndexing feature.");
+            }
+            enabledFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+        }
+
+        VkDeviceCreateInfo deviceInfo = {};
+        deviceInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceInfo.pNext                   = features;
+        deviceInfo.queueCreateInfoCount    = 1;
+        deviceInfo.pQueueCreateInfos       = &queueInfo;
+        deviceInfo.pEnabledFeatures        = &enabledFeatures;
+        deviceInfo.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
+        deviceInfo.ppEnabledExtensionNames = extensions.data();
+        if (vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create logical device.");
+        }
+        vkGetDeviceQueue(device, queueFamilyIndex, 0, &queue);
+
+        PipelineTelemetry::Instance().Enable(device, creationFeedback, executableProperties);
+        if (config.breadcrumbs)
+        {
+            breadcrumbs.Create(physicalDevice, device, queue, "graphics queue", checkpoints);
+        }
+
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = queueFamilyIndex;
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create command pool.");
+        }
+    }
+
+
+    void
+    CreateTargets()
+    {
+        // The depth pyramid samples the depth buffer.
+        VkFormatFeatureFlags depthFeatures = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        VkImageUsageFlags    depthUsage    = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (config.gpuDriven)
+        {
+            depthFeatures |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+            depthUsage    |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        depthFormat = VK_FORMAT_D32_SFLOAT;
+        VkFormatProperties formatProperties = {};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, depthFormat, &formatProperties);
+        if ((formatProperties.optimalTilingFeatures & depthFeatures) != depthFeatures)
+        {
+            depthFormat = VK_FORMAT_X8_D24_UNORM_PACK32;
+        }
+
+        CreateImage2D(physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, config.width, config.height, 1,
+                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, colorImage, colorMemory);
+        colorView = CreateImageView2D(device, colorImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1);
+        CreateImage2D(physicalDevice, device, depthFormat, config.width, config.height, 1,
+                      depthUsage, depthImage, depthMemory);
+        depthView = CreateImageView2D(device, depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1);
+        TrackImage(colorImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        TrackImage(depthImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkAttachmentDescription attachments[2] = {};
+        attachments[0].format         = VK_FORMAT_R8G8B8A8_UNORM;
+        attachments[0].samples        = VK_SAMPLE_COUNT_1_BIT;
+        attachments[0].loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[0].storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        attachments[0].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[0].initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[0].finalLayout    = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachments[1]                = attachments[0];
+        attachments[1].format         = depthFormat;
+        attachments[1].storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[1].finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        if (config.gpuDriven)
+        {
+            // The early pass's depth is read by DepthPyramid::Build().
+            attachments[1].storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+            attachments[1].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount    = 1;
+        subpass.pColorAttachments       = &colorReference;
+        subpass.pDepthStencilAttachment = &depthReference;
+
+        // Both frames in flight render into the same targets; order them against the
+        // previous frame's attachment writes.
+        VkSubpassDependency dependencies[2] = {};
+        dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass    = 0;
+        dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        // Early pass depth writes -> pyramid build.
+        dependencies[1].srcSubpass    = 0;
+        dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask  = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkRenderPassCreateInfo renderPassInfo = {};
+        renderPassInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = 2;
+        renderPassInfo.pAttachments    = attachments;
+        renderPassInfo.subpassCount    = 1;
+        renderPassInfo.pSubpasses      = &subpass;
+        renderPassInfo.dependencyCount = config.gpuDriven ? 2 : 1;
+        renderPassInfo.pDependencies   = dependencies;
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create render pass.");
+        }
+
+        // The late pass continues on the early pass's color and depth, after the pyramid
+        // build has read the depth. Compatible with the framebuffer and the pipeline.
+        if (config.gpuDriven)
+        {
+            attachments[0].loadOp        = VK_ATTACHMENT_LOAD_OP_LOAD;
+            attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            attachments[1].loadOp        = VK_ATTACHMENT_LOAD_OP_LOAD;
+            attachments[1].storeOp       = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachments[1].initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            attachments[1].finalLayout   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+            dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            renderPassInfo.dependencyCount = 1;
+            if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &lateRenderPass) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to create late render pass.");
+            }
+        }
+
+        VkImageView views[2] = { colorView, depthView };
+        VkFramebufferCreateInfo framebufferInfo = {};
+        framebufferInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass      = renderPass;
+        framebufferInfo.attachmentCount = 2;
+        framebufferInfo.pAttachments    = views;
+        framebufferInfo.width           = config.width;
+        framebufferInfo.height          = config.height;
+        framebufferInfo.layers          = 1;
+        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create framebuffer.");
+        }
+    }
+
+
+    // Registers the archive's streamable textures, or creates the detail texture. Their
+    // contents are uploaded with the scene.
+    void
+    CreateTextures()
+    {
+        if (config.texturesPath.empty() && config.detailTexture == 0) return;
+
+        if (config.detailTexture != 0)
+        {
+            uint32_t size = config.detailTexture;
+            detailLevels = 1;
+            while ((size >> detailLevels) > 0) detailLevels++;
+
+            detailMips.Create(physicalDevice, device, queueCompute);
+            CreateImage2D(physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, size, size, detailLevels,
+                          detailMips.RequiredUsage(VK_FORMAT_R8G8B8A8_UNORM, size, size) |
+                          VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                          detailImage, detailMemory);
+            TrackImage(detailImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            detailView = CreateImageView2D(device, detailImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT,
+                                           0, detailLevels);
+        }
+        else
+        {
+            textureArchive.Open(config.texturesPath);
+            for (uint32_t ii = 0; ii < textureArchive.EntryCount(); ii++)
+            {
+                const AssetArchiveEntry& entry = textureArchive.Entry(ii);
+                if (entry.type != ASSET_TYPE_TEXTURE || entry.info[4] != 1) continue;
+                if (streamedTextureCount == BENCHMARK_MAX_STREAMED_TEXTURES) break;
+
+                std::vector<uint64_t> mipSizes = VulkanTextureStreamingBackend::MipSizes(textureArchive, entry);
+                textureStreamer.RegisterTexture(entry.info[1], entry.info[2], mipSizes);
+                textureBackend.AddTexture(textureArchive, entry);
+                streamedTextureLevels.push_back(entry.info[3]);
+                streamedTextureCount++;
+            }
+            if (streamedTextureCount == 0)
+            {
+                throw std::runtime_error("[ ERROR ] " + config.texturesPath + " holds no single layer 2D texture.");
+            }
+
+            textureBackend.Create(physicalDevice, device, BENCHMARK_STREAMING_STAGING, BENCHMARK_FRAMES_IN_FLIGHT);
+            textureFeedback.Create(physicalDevice, device, streamedTextureCount, BENCHMARK_FRAMES_IN_FLIGHT);
+        }
+
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter    = VK_FILTER_LINEAR;
+        samplerInfo.minFilter    = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode   = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.maxLod       = VK_LOD_CLAMP_NONE;
+        if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create texture sampler.");
+        }
+
+        if (streamedTextureCount != 0)
+        {
+            std::cout << "[ INFO ] Streaming " << streamedTextureCount << " textures from " << config.texturesPath << "." << std::endl;
+        }
+    }
+
+
+    void
+    CreatePipeline()
+    {
+        // Bindings 4 to 6 are the streamed textures, their feedback and residency buffers;
+        // binding 4 alone is the detail texture.
+        VkDescriptorSetLayoutBinding bindings[7] = {};
+        for (uint32_t ii = 0; ii < 7; ii++)
+        {
+            bindings[ii].binding         = ii;
+            bindings[ii].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[ii].descriptorCount = 1;
+            bindings[ii].stageFlags      = ii < 2 ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+        bindings[4].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[4].descriptorCount = std::max(streamedTextureCount, 1u);
+
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo = {};
+        setLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.bindingCount = streamedTextureCount != 0 ? 7 : config.detailTexture != 0 ? 5 : 4;
+        setLayoutInfo.pBindings    = bindings;
+        if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create descriptor set layout.");
+        }
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.size       = sizeof(BenchmarkPushConstants);
+
+        VkPipelineLayoutCreateInfo layoutInfo = {};
+        layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount         = 1;
+        layoutInfo.pSetLayouts            = &descriptorSetLayout;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges    = &pushConstantRange;
+        if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create pipeline layout.");
+        }
+
+        std::string vertexSource = config.gpuDriven ?
+            std::string("#version 450\n") + GPU_SCENE_INSTANCE_GLSL + BENCHMARK_GPU_DRIVEN_VERTEX_GLSL :
+            std::string(BENCHMARK_VERTEX_GLSL);
+        std::string   fragmentSource = "#version 450\n";
+        ShaderDefines defines;
+        if (streamedTextureCount != 0)
+        {
+            fragmentSource += TEXTURE_STREAMING_FEEDBACK_GLSL;
+            defines.push_back({ "STREAMED_TEXTURES", "1" });
+            defines.push_back({ "STREAMED_TEXTURE_COUNT", std::to_string(streamedTextureCount) });
+            defines.push_back({ "STREAMING_SET", "0" });
+            defines.push_back({ "STREAMING_FEEDBACK_BINDING", "5" });
+            defines.push_back({ "STREAMING_RESIDENCY_BINDING", "6" });
+        }
+        if (config.detailTexture != 0)
+        {
+            defines.push_back({ "DETAIL_TEXTURE", "1" });
+        }
+        fragmentSource += BENCHMARK_FRAGMENT_GLSL;
+
+        VkShaderModule vertexModule   = CreateShaderModule(device, CompileGlsl(vertexSource, SHADER_KIND_VERTEX,
+                                                                               "benchmark.vert", defines));
+        VkShaderModule fragmentModule = CreateShaderModule(device, CompileGlsl(fragmentSource, SHADER_KIND_FRAGMENT,
+                                                                               "benchmark.frag", defines));
+
+        VkPipelineShaderStageCreateInfo stages[2] = {};
+        stages[0].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage  = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = vertexModule;
+        stages[0].pName  = "main";
+        stages[1]        = stages[0];
+        stages[1].stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = fragmentModule;
+
+        VkVertexInputBindingDescription vertexBinding = { 0, sizeof(BenchmarkVertex), VK_VERTEX_INPUT_RATE_VERTEX };
+        VkVertexInputAttributeDescription vertexAttributes[2] =
+        {
+            { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(BenchmarkVertex, position) },
+            { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(BenchmarkVertex, normal) }
+        };
+
+        VkPipelineVertexInputStateCreateInfo vertexInput = {};
+        vertexInput.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInput.vertexBindingDescriptionCount   = 1;
+        vertexInput.pVertexBindingDescriptions      = &vertexBinding;
+        vertexInput.vertexAttributeDescriptionCount = 2;
+        vertexInput.pVertexAttributeDescriptions    = vertexAttributes;
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+        inputAssembly.sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        VkViewport viewport = { 0.0f, 0.0f, static_cast<float>(config.width), static_cast<float>(config.height), 0.0f, 1.0f };
+        VkRect2D   scissor  = { { 0, 0 }, { config.width, config.height } };
+
+        VkPipelineViewportStateCreateInfo viewportState = {};
+        viewportState.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportState.viewportCount = 1;
+        viewportState.pViewports    = &viewport;
+        viewportState.scissorCount  = 1;
+        viewportState.pScissors     = &scissor;
+
+        VkPipelineRasterizationStateCreateInfo rasterizer = {};
+        rasterizer.sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterizer.cullMode    = VK_CULL_MODE_BACK_BIT;
+        rasterizer.frontFace   = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rasterizer.lineWidth   = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisampling = {};
+        multisampling.sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+        depthStencil.sType            = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable  = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp   = VK_COMPARE_OP_LESS;
+
+        VkPipelineColorBlendAttachmentState blendAttachment = {};
+        blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                         VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+        VkPipelineColorBlendStateCreateInfo colorBlend = {};
+        colorBlend.sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlend.attachmentCount = 1;
+        colorBlend.pAttachments    = &blendAttachment;
+
+        VkGraphicsPipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount          = 2;
+        pipelineInfo.pStages             = stages;
+        pipelineInfo.pVertexInputState   = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState      = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState   = &multisampling;
+        pipelineInfo.pDepthStencilState  = &depthStencil;
+        pipelineInfo.pColorBlendState    = &colorBlend;
+        pipelineInfo.layout              = pipelineLayout;
+        pipelineInfo.renderPass          = renderPass;
+
+        pipelineCache = CreatePipelineCache(physicalDevice, device, config.pipelineCachePath);
+
+        PipelineFeedback feedback;
+        pipelineInfo.flags |= PipelineTelemetry::Instance().Begin(feedback, pipelineInfo.pNext, 2);
+
+        auto     start  = std::chrono::steady_clock::now();
+        VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+        pipelineMs      = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        vkDestroyShaderModule(device, vertexModule, nullptr);
+        vkDestroyShaderModule(device, fragmentModule, nullptr);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create graphics pipeline.");
+        }
+
+        PipelineTelemetry::Instance().End(feedback, "benchmark", pipeline);
+        std::vector<PipelineReport> reports = PipelineTelemetry::Instance().Reports();
+        pipelineCacheHit = !reports.empty() && reports.back().feedbackValid && reports.back().cacheHit;
+    }
+
+
+    void
+    CreateScene()
+    {
+        std::mt19937 random(config.seed);
+
+        std::vector<BenchmarkVertex> vertices;
+        std::vector<uint32_t>        indices;
+        meshes.resize(config.meshCount);
+        for (uint32_t ii = 0; ii < config.meshCount; ii++)
+        {
+            meshes[ii].firstIndex     = static_cast<uint32_t>(indices.size());
+            meshes[ii].vertexOffset   = static_cast<int32_t>(vertices.size());
+            meshes[ii].boundingRadius = GenerateMesh(random, 8 + 8 * (ii % 8), vertices, indices);
+            meshes[ii].indexCount     = static_cast<uint32_t>(indices.size()) - meshes[ii].firstIndex;
+        }
+        triangleCount = indices.size() / 3;
+
+        // Instances fill a cube at roughly constant density, sorted by mesh so every mesh
+        // draws a contiguous range.
+        sceneExtent = 4.0f * std::cbrt(static_cast<float>(config.instanceCount));
+        std::uniform_real_distribution<float> position(-sceneExtent, sceneExtent);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+        std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<uint32_t> meshIndex(0, config.meshCount - 1);
+        std::uniform_int_distribution<uint32_t> materialIndex(0, config.materialCount - 1);
+
+        std::vector<uint32_t> instanceMeshes(config.instanceCount);
+        for (auto& mesh : instanceMeshes)
+        {
+            mesh = meshIndex(random);
+        }
+        std::sort(instanceMeshes.begin(), instanceMeshes.end());
+
+        // Both paths draw the same random scene; the GPU driven one keeps its instances in
+        // gpuScene instead of the instance buffer and the culling bounds.
+        if (config.gpuDriven)
+        {
+            gpuScene.Create(physicalDevice, device, BENCHMARK_FRAMES_IN_FLIGHT, drawIndirectCount, multiDrawIndirect);
+            depthPyramid.Create(physicalDevice, device);
+            for (const auto& mesh : meshes)
+            {
+                std::vector<MeshLod> lods = GenerateBenchmarkLods(mesh, vertices, indices);
+                gpuScene.AddMesh(lods.data(), static_cast<uint32_t>(lods.size()), 0, mesh.vertexOffset,
+                                 glm::vec4(0.0f, 0.0f, 0.0f, mesh.boundingRadius));
+            }
+            gpuScene.SetLodSelection(static_cast<float>(config.height));
+        }
+        else
+        {
+            bounds.Reserve(config.instanceCount);
+        }
+
+        std::vector<BenchmarkInstance> instances(config.instanceCount);
+        for (uint32_t ii = 0; ii < config.instanceCount; ii++)
+        {
+            BenchmarkMesh& mesh = meshes[instanceMeshes[ii]];
+            if (mesh.instanceCount == 0) mesh.firstInstance = ii;
+            mesh.instanceCount++;
+
+            glm::vec3 center(position(random), position(random), position(random));
+            float     size = scale(random);
+            glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.01f));
+
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), center);
+            model = glm::rotate(model, angle(random), axis);
+            model = glm::scale(model, glm::vec3(size));
+
+            instances[ii]          = {};
+            instances[ii].model    = model;
+            instances[ii].material = materialIndex(random);
+            instances[ii].texture  = streamedTextureCount != 0 ? instanceMeshes[ii] % streamedTextureCount : 0;
+            if (config.gpuDriven) gpuScene.AddInstance(model, instanceMeshes[ii], instances[ii].material);
+            else                  bounds.AddSphere(center, mesh.boundingRadius * size);
+        }
+
+        std::vector<BenchmarkMaterial> materials(config.materialCount);
+        for (auto& material : materials)
+        {
+            material.albedo   = glm::vec4(unit(random), unit(random), unit(random), 1.0f);
+            material.specular = glm::vec4(glm::vec3(0.04f + 0.5f * unit(random)), 8.0f + 120.0f * unit(random));
+        }
+
+        // At least one element, the storage buffer may not be empty.
+        std::vector<BenchmarkLight> lights(std::max(config.lightCount, 1u));
+        for (auto& light : lights)
+        {
+            light.positionRadius = glm::vec4(position(random), position(random), position(random),
+                                             sceneExtent * (0.25f + 0.5f * unit(random)));
+            light.color          = glm::vec4(unit(random), unit(random), unit(random), 1.0f) * 2.0f;
+        }
+
+        // Last, so the rest of the scene stays the same with and without it. Its instance
+        // follows the culled ones.
+        MeshletMesh meshlets;
+        if (config.centerpiece != 0)
+        {
+            centerpiece.firstIndex     = static_cast<uint32_t>(indices.size());
+            centerpiece.vertexOffset   = static_cast<int32_t>(vertices.size());
+            centerpiece.boundingRadius = GenerateMesh(random, config.centerpiece, vertices, indices);
+            centerpiece.indexCount     = static_cast<uint32_t>(indices.size()) - centerpiece.firstIndex;
+            triangleCount             += centerpiece.indexCount / 3;
+
+            BenchmarkInstance centerpieceInstance = {};
+            centerpieceInstance.model = glm::scale(glm::mat4(1.0f), glm::vec3(BENCHMARK_CENTERPIECE_SCALE * sceneExtent));
+            instances.push_back(centerpieceInstance);
+        }
+        if (config.clusters)
+        {
+            meshlets = BuildBenchmarkMeshlets(centerpiece, vertices, indices);
+            clusterCuller.Create(physicalDevice, device, BENCHMARK_FRAMES_IN_FLIGHT, drawIndirectCount, multiDrawIndirect);
+        }
+
+        VkCommandBuffer commandBuffer = AllocateCommandBuffer();
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        StagingBuffer staging[6];
+        RecordBufferUpload(physicalDevice, device, commandBuffer, vertices.data(), vertices.size() * sizeof(BenchmarkVertex),
+                           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexBuffer, vertexMemory, staging[0]);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, indices.data(), indices.size() * sizeof(uint32_t),
+                           VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBuffer, indexMemory, staging[1]);
+        if (config.gpuDriven)
+        {
+            gpuScene.Upload(commandBuffer);
+            depthPyramid.Resize(commandBuffer, depthView, config.width, config.height);
+        }
+        else
+        {
+            RecordBufferUpload(physicalDevice, device, commandBuffer, instances.data(), instances.size() * sizeof(BenchmarkInstance),
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, instanceBuffer, instanceMemory, staging[2]);
+        }
+        if (config.clusters)
+        {
+            clusterCuller.Upload(commandBuffer, meshlets);
+        }
+
+        // Every streamed texture starts from nothing resident with its tail, which stays.
+        if (streamedTextureCount != 0)
+        {
+            textureBackend.BeginFrame(commandBuffer, 0, 0, 0);
+            for (uint32_t texture = 0; texture < streamedTextureCount; texture++)
+            {
+                if (!textureBackend.SetResidency(texture, streamedTextureLevels[texture], textureStreamer.TailMip(texture)))
+                {
+                    throw std::runtime_error("[ ERROR ] The streamed texture tails do not fit in the staging buffer.");
+                }
+            }
+        }
+        RecordBufferUpload(physicalDevice, device, commandBuffer, materials.data(), materials.size() * sizeof(BenchmarkMaterial),
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, materialBuffer, materialMemory, staging[3]);
+        RecordBufferUpload(physicalDevice, device, commandBuffer, lights.data(), lights.size() * sizeof(BenchmarkLight),
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, lightBuffer, lightMemory, staging[4]);
+        if (config.detailTexture != 0)
+        {
+            RecordDetailTexture(commandBuffer, staging[5]);
+        }
+
+        VkMemoryBarrier barrier = {};
+        barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+        vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(queue);
+
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        for (auto& buffer : staging)
+        {
+            buffer.Destroy(device);
+        }
+        gpuScene.ReleaseStaging();
+        clusterCuller.ReleaseStaging();
+        detailMips.Reset();
+        if (streamedTextureCount != 0) textureStreamer.Start();
+
+        VkBuffer sceneBuffers[] = { vertexBuffer, indexBuffer, instanceBuffer, materialBuffer, lightBuffer };
+        for (VkBuffer buffer : sceneBuffers)
+        {
+            if (buffer != VK_NULL_HANDLE) TrackBuffer(buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+
+        // Counted in the first warmup frame.
+        VkDeviceSize instanceBytes = config.gpuDriven ? instances.size() * sizeof(GpuSceneInstance) :
+                                                        instances.size() * sizeof(BenchmarkInstance);
+        metrics.AddUploadBytes(vertices.size() * sizeof(BenchmarkVertex) + indices.size() * sizeof(uint32_t) +
+                               instanceBytes + materials.size() * sizeof(BenchmarkMaterial) +
+                               lights.size() * sizeof(BenchmarkLight) +
+                               static_cast<VkDeviceSize>(config.detailTexture) * config.detailTexture * 4);
+    }
+
+
+    // Fills level 0 of the detail texture with tinted 16 texel cells plus per texel noise, so
+    // every level of the chain differs, and records MipGenerator for the rest.
+    void
+    RecordDetailTexture(VkCommandBuffer commandBuffer, StagingBuffer& staging)
+    {
+        uint32_t     size  = config.detailTexture;
+        VkDeviceSize bytes = static_cast<VkDeviceSize>(size) * size * 4;
+
+        std::mt19937                            random(config.seed);
+        std::uniform_int_distribution<uint32_t> noise(0, 63);
+        uint32_t                                cells = (size + 15) / 16;
+        std::vector<uint32_t>                   cellTints(cells * cells);
+        for (auto& tint : cellTints)
+        {
+            tint = 160 + noise(random);
+        }
+
+        std::vector<uint8_t> texels(static_cast<size_t>(bytes));
+        for (uint32_t yy = 0; yy < size; yy++)
+        {
+            for (uint32_t xx = 0; xx < size; xx++)
+            {
+                uint32_t tint  = cellTints[(yy / 16) * cells + xx / 16] + noise(random);
+                uint8_t* texel = &texels[(static_cast<size_t>(yy) * size + xx) * 4];
+                texel[0] = static_cast<uint8_t>(std::min(tint, 255u));
+                texel[1] = static_cast<uint8_t>(std::min(tint + 8, 255u));
+                texel[2] = static_cast<uint8_t>(std::min(tint + 16, 255u));
+                texel[3] = 255;
+            }
+        }
+
+        CreateBuffer(physicalDevice, device, bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     staging.buffer, staging.memory);
+        void* mapped = nullptr;
+        if (vkMapMemory(device, staging.memory, 0, bytes, 0, &mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to map detail texture staging memory.");
+        }
+        memcpy(mapped, texels.data(), texels.size());
+        vkUnmapMemory(device, staging.memory);
+
+        ImageBarrier(commandBuffer, detailImage, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1,
+                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkBufferImageCopy region = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent                 = { size, size, 1 };
+        vkCmdCopyBufferToImage(commandBuffer, staging.buffer, detailImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               1, &region);
+
+        detailMips.Generate(commandBuffer, detailImage, VK_FORMAT_R8G8B8A8_UNORM, size, size, detailLevels);
+
+        bool compute = (detailMips.RequiredUsage(VK_FORMAT_R8G8B8A8_UNORM, size, size) & VK_IMAGE_USAGE_STORAGE_BIT) != 0;
+        std::cout << "[ INFO ] Detail texture " << size << "x" << size << ", " << detailLevels << " levels generated with "
+                  << (compute ? "one compute dispatch." : "blits.") << std::endl;
+    }
+
+
+    // LOD chain of mesh (MeshSimplifier.h) for gpuScene. The simplified LODs are appended to
+    // indices; the returned LODs hold absolute first indices, lods[0] being the mesh itself.
+    static std::vector<MeshLod>
+    GenerateBenchmarkLods(const BenchmarkMesh&                mesh,
+                          const std::vector<BenchmarkVertex>& vertices,
+                          std::vector<uint32_t>&              indices)
+    {
+        ImportedMesh source;
+        source.indices.assign(indices.begin() + mesh.firstIndex, indices.begin() + mesh.firstIndex + mesh.indexCount);
+        uint32_t vertexCount = 0;
+        for (uint32_t index : source.indices) vertexCount = std::max(vertexCount, index + 1);
+        for (uint32_t ii = 0; ii < vertexCount; ii++)
+        {
+            MeshVertex vertex = {};
+            vertex.position = vertices[mesh.vertexOffset + ii].position;
+            vertex.normal   = vertices[mesh.vertexOffset + ii].normal;
+            source.vertices.push_back(vertex);
+        }
+
+        MeshLodChain chain = GenerateLods(source, { 0.5f, 0.25f, 0.125f });
+        std::vector<MeshLod> lods = chain.lods;
+        lods[0].firstIndex = mesh.firstIndex;
+        for (size_t ii = 1; ii < lods.size(); ii++)
+        {
+            lods[ii].firstIndex = static_cast<uint32_t>(indices.size());
+            indices.insert(indices.end(), chain.indices.begin() + chain.lods[ii].firstIndex,
+                           chain.indices.begin() + chain.lods[ii].firstIndex + chain.lods[ii].indexCount);
+        }
+        return lods;
+    }
+
+
+    // Meshlets of mesh, the last one in vertices, for clusterCuller. Its indirect draws have
+    // no vertex offset, so the meshlet indices address the shared vertex buffer directly.
+    static MeshletMesh
+    BuildBenchmarkMeshlets(const BenchmarkMesh&                mesh,
+                           const std::vector<BenchmarkVertex>& vertices,
+                           const std::vector<uint32_t>&        indices)
+    {
+        std::vector<uint32_t> meshIndices(indices.begin() + mesh.firstIndex,
+                                          indices.begin() + mesh.firstIndex + mesh.indexCount);
+        std::vector<MeshVertex> meshVertices(vertices.size() - static_cast<size_t>(mesh.vertexOffset));
+        for (size_t ii = 0; ii < meshVertices.size(); ii++)
+        {
+            meshVertices[ii]          = {};
+            meshVertices[ii].position = vertices[mesh.vertexOffset + ii].position;
+            meshVertices[ii].normal   = vertices[mesh.vertexOffset + ii].normal;
+        }
+
+        MeshletMesh meshlets = BuildMeshlets(meshIndices, meshVertices.data(), meshVertices.size());
+        for (auto& index : meshlets.indices)
+        {
+            index += static_cast<uint32_t>(mesh.vertexOffset);
+        }
+        return meshlets;
+    }
+
+
+    void
+    CreateFrames()
+    {
+        VkDescriptorPoolSize poolSizes[2] =
+        {
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         6 * BENCHMARK_FRAMES_IN_FLIGHT },
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, std::max(streamedTextureCount, 1u) * BENCHMARK_FRAMES_IN_FLIGHT }
+        };
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets       = BENCHMARK_FRAMES_IN_FLIGHT;
+        poolInfo.poolSizeCount = streamedTextureCount != 0 || config.detailTexture != 0 ? 2 : 1;
+        poolInfo.pPoolSizes    = poolSizes;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to create descriptor pool.");
+        }
+
+        frames.resize(BENCHMARK_FRAMES_IN_FLIGHT);
+        for (uint32_t frameIndex = 0; frameIndex < BENCHMARK_FRAMES_IN_FLIGHT; frameIndex++)
+        {
+            Frame& frame = frames[frameIndex];
+            frame.commandBuffer = AllocateCommandBuffer();
+
+            VkFenceCreateInfo fenceInfo = {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+            if (vkCreateFence(device, &fenceInfo, nullptr, &frame.fence) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to create fence.");
+            }
+
+            // The GPU driven vertex shader reads gpuScene's instances directly.
+            if (!config.gpuDriven)
+            {
+                // The centerpiece's slot is the last one, after every culled instance.
+                VkDeviceSize visibleSize = (config.instanceCount + 1) * sizeof(uint32_t);
+                CreateBuffer(physicalDevice, device, visibleSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             frame.visibleBuffer, frame.visibleMemory);
+                TrackBuffer(frame.visibleBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+                void* mapped = nullptr;
+                if (vkMapMemory(device, frame.visibleMemory, 0, visibleSize, 0, &mapped) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("[ ERROR ] Failed to map visible instance buffer.");
+                }
+                frame.visibleMapped = static_cast<uint32_t*>(mapped);
+                frame.visibleMapped[config.instanceCount] = config.instanceCount;
+            }
+
+            VkDescriptorSetAllocateInfo allocateInfo = {};
+            allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocateInfo.descriptorPool     = descriptorPool;
+            allocateInfo.descriptorSetCount = 1;
+            allocateInfo.pSetLayouts        = &descriptorSetLayout;
+            if (vkAllocateDescriptorSets(device, &allocateInfo, &frame.descriptorSet) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to allocate descriptor set.");
+            }
+
+            // Binding 1, the visible list, is not used by the GPU driven vertex shader.
+            VkDescriptorBufferInfo bufferInfos[4] =
+            {
+                { config.gpuDriven ? gpuScene.InstanceBuffer() : instanceBuffer, 0, VK_WHOLE_SIZE },
+                { frame.visibleBuffer, 0, VK_WHOLE_SIZE },
+                { materialBuffer,      0, VK_WHOLE_SIZE },
+                { lightBuffer,         0, VK_WHOLE_SIZE }
+            };
+            VkWriteDescriptorSet writes[4] = {};
+            uint32_t             writeCount = 0;
+            for (uint32_t ii = 0; ii < 4; ii++)
+            {
+                if (ii == 1 && config.gpuDriven) continue;
+                writes[writeCount].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[writeCount].dstSet          = frame.descriptorSet;
+                writes[writeCount].dstBinding      = ii;
+                writes[writeCount].descriptorCount = 1;
+                writes[writeCount].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[writeCount].pBufferInfo     = &bufferInfos[ii];
+                writeCount++;
+            }
+            vkUpdateDescriptorSets(device, writeCount, writes, 0, nullptr);
+            metrics.AddDescriptorWrites(writeCount);
+
+            // The textures themselves are written by UpdateTextureDescriptors() before use.
+            if (streamedTextureCount != 0)
+            {
+                VkDescriptorBufferInfo streamingInfos[2] =
+                {
+                    { textureFeedback.FeedbackBuffer(frameIndex), 0, VK_WHOLE_SIZE },
+                    { textureFeedback.ResidencyBuffer(),          0, VK_WHOLE_SIZE }
+                };
+                for (uint32_t ii = 0; ii < 2; ii++)
+                {
+                    writes[ii]                 = {};
+                    writes[ii].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    writes[ii].dstSet          = frame.descriptorSet;
+                    writes[ii].dstBinding      = 5 + ii;
+                    writes[ii].descriptorCount = 1;
+                    writes[ii].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    writes[ii].pBufferInfo     = &streamingInfos[ii];
+                }
+                vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+                metrics.AddDescriptorWrites(2);
+                frame.textureViews.assign(streamedTextureCount, VK_NULL_HANDLE);
+            }
+
+            if (config.detailTexture != 0)
+            {
+                VkDescriptorImageInfo detailInfo = { textureSampler, detailView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+                writes[0]                 = {};
+                writes[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[0].dstSet          = frame.descriptorSet;
+                writes[0].dstBinding      = 4;
+                writes[0].descriptorCount = 1;
+                writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                writes[0].pImageInfo      = &detailInfo;
+                vkUpdateDescriptorSets(device, 1, writes, 0, nullptr);
+                metrics.AddDescriptorWrites(1);
+            }
+        }
+
+        // One draw queue material per frame in flight, so its id is the frame index.
+        if (config.drawQueue)
+        {
+            drawQueue.AddPipeline(pipeline, pipelineLayout);
+            for (const auto& frame : frames)
+            {
+                drawQueue.AddMaterial(frame.descriptorSet, 0);
+            }
+            for (const auto& mesh : meshes)
+            {
+                drawQueue.AddMesh(vertexBuffer, 0, indexBuffer, 0, VK_INDEX_TYPE_UINT32,
+                                  mesh.indexCount, mesh.firstIndex, mesh.vertexOffset);
+            }
+        }
+
+        for (uint32_t heap = 0; heap < heapBytes.size(); heap++)
+        {
+            if (heapBytes[heap] != 0) metrics.SetHeapUsage(heap, heapBytes[heap]);
+        }
+
+        profiler.Create(physicalDevice, device, queueFamilyIndex, BENCHMARK_FRAMES_IN_FLIGHT, false);
+        profiler.SetTimestampCallback([this](const char* name, uint64_t begin, uint64_t end)
+        {
+            if (collectingFrame >= config.warmupFrames && collectingFrame != UINT32_MAX &&
+                std::strcmp(name, "Frame") == 0)
+            {
+                times.gpuMs.push_back(static_cast<double>(end - begin) * deviceProperties.limits.timestampPeriod * 1e-6);
+            }
+        });
+
+        counters.Create(instance, physicalDevice, device, queueFamilyIndex, BENCHMARK_FRAMES_IN_FLIGHT,
+                        countersEnabled, countersEnabled);
+    }
+
+
+    // Two orbits around the scene center with a vertical bob, parameterized by the frame
+    // index alone.
+    void
+    CameraAt(uint32_t frame, glm::mat4& view, glm::mat4& projection, glm::vec3& position) const
+    {
+        float t      = static_cast<float>(frame) / static_cast<float>(config.warmupFrames + config.frameCount);
+        float orbit  = 2.0f * glm::two_pi<float>() * t;
+        float radius = sceneExtent * 0.7f;
+        position = glm::vec3(radius * std::cos(orbit), sceneExtent * 0.3f * std::sin(2.0f * orbit), radius * std::sin(orbit));
+
+        glm::vec3 target = glm::vec3(0.0f, 0.0f, 0.0f);
+        view       = glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+        projection = glm::perspective(glm::radians(60.0f),
+                                      static_cast<float>(config.width) / static_cast<float>(config.height),
+                                      BENCHMARK_NEAR_PLANE, 4.0f * sceneExtent);
+        projection[1][1] *= -1.0f;
+    }
+
+
+    void
+    RenderFrames()
+    {
+        JobSystem            jobs;
+        std::vector<uint8_t> visible;
+
+        // The trailing frames only read back the GPU times of the last measured frames.
+        uint32_t totalFrames = config.warmupFrames + config.frameCount + BENCHMARK_FRAMES_IN_FLIGHT;
+        auto     previousStart = std::chrono::steady_clock::now();
+        uint64_t visibleSum    = 0;
+        uint64_t drawSum       = 0;
+        bool     tracing       = !config.tracePath.empty();
+        Tracer::Instance().SetThreadName("Main thread");
+
+        for (uint32_t frameNumber = 0; frameNumber < totalFrames; frameNumber++)
+        {
+            bool     measured   = frameNumber >= config.warmupFrames && frameNumber < config.warmupFrames + config.frameCount;
+            uint32_t frameIndex = frameNumber % BENCHMARK_FRAMES_IN_FLIGHT;
+            Frame&   frame      = frames[frameIndex];
+            if (tracing && frameNumber == config.warmupFrames)                      Tracer::Instance().BeginCapture();
+            if (tracing && frameNumber == config.warmupFrames + config.frameCount) Tracer::Instance().EndCapture();
+
+            auto frameStart = std::chrono::steady_clock::now();
+            if (breadcrumbs.Check(vkWaitForFences(device, 1, &frame.fence, VK_TRUE, UINT64_MAX)) == VK_ERROR_DEVICE_LOST)
+            {
+                throw std::runtime_error("[ ERROR ] Device lost while waiting for frame " + std::to_string(frame.frameNumber) + ".");
+            }
+            auto waitEnd = std::chrono::steady_clock::now();
+            vkResetFences(device, 1, &frame.fence);
+            counters.BeginFrame(frameIndex);
+            if (streamedTextureCount != 0) textureFeedback.Collect(frameIndex, frameNumber, textureStreamer);
+
+            glm::mat4 view;
+            glm::mat4 projection;
+            glm::vec3 cameraPosition;
+            CameraAt(frameNumber, view, projection, cameraPosition);
+            BenchmarkPushConstants pushConstants = {};
+            pushConstants.viewProjection = projection * view;
+            pushConstants.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+            pushConstants.lightCount     = config.lightCount;
+
+            if (!config.gpuDriven)
+            {
+                TraceScope scope("Cull");
+                CullFrustum(jobs, MakeCullingFrustum(pushConstants.viewProjection), bounds, CULLING_VOLUME_SPHERE, visible);
+            }
+            TraceScope recordScope("Record and submit");
+
+            // Submitted once per counter pass; the profiler's queries are reset inside the
+            // command buffer, so every pass starts them over.
+            vkResetCommandBuffer(frame.commandBuffer, 0);
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = counters.PassCount() > 1 ? VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT :
+                                                         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+
+            collectingFrame = frame.frameNumber;
+            profiler.BeginFrame(frame.commandBuffer, frameIndex);
+            frame.frameNumber = frameNumber;
+            profiler.BeginScope(frame.commandBuffer, "Frame");
+            breadcrumbs.Begin(frame.commandBuffer, "Frame");
+            if (streamedTextureCount != 0)
+            {
+                BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Texture Streaming");
+                RecordTextureStreaming(frame, frameIndex, frameNumber);
+            }
+
+            // Two phase occlusion culling (DepthPyramid.h) for the GPU driven path: draw what
+            // was visible last frame, build the pyramid from that depth, then draw what the
+            // pyramid does not hide and was not drawn yet.
+            uint32_t visibleCount = 0;
+            uint32_t drawCount    = 0;
+            if (config.gpuDriven)
+            {
+                GpuCullingView cullingView = MakeGpuCullingView(view, projection, cameraPosition, BENCHMARK_NEAR_PLANE,
+                                                                depthPyramid.Width(), depthPyramid.Height(),
+                                                                depthPyramid.LevelCount());
+                {
+                    BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Early Cull");
+                    gpuScene.Cull(frame.commandBuffer, frameIndex, cullingView, depthPyramid.View(), GPU_SCENE_PHASE_EARLY);
+                }
+                {
+                    BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Early Pass");
+                    drawCount += RecordScenePass(frame, frameIndex, renderPass, pushConstants, visible, visibleCount);
+                }
+                {
+                    BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Depth Pyramid");
+                    depthPyramid.Build(frame.commandBuffer);
+                }
+                {
+                    BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Late Cull");
+                    gpuScene.Cull(frame.commandBuffer, frameIndex, cullingView, depthPyramid.View(), GPU_SCENE_PHASE_LATE);
+                }
+                {
+                    BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Late Pass");
+                    drawCount += RecordScenePass(frame, frameIndex, lateRenderPass, pushConstants, visible, visibleCount);
+                }
+            }
+            else
+            {
+                if (config.clusters)
+                {
+                    BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Cluster Cull");
+                    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(BENCHMARK_CENTERPIECE_SCALE * sceneExtent));
+                    clusterCuller.Cull(frame.commandBuffer, frameIndex,
+                                       MakeGpuCullingView(view, projection, cameraPosition, BENCHMARK_NEAR_PLANE),
+                                       model, BENCHMARK_CENTERPIECE_SCALE * sceneExtent, config.instanceCount, VK_NULL_HANDLE);
+                }
+                BenchmarkPassScope passScope(profiler, breadcrumbs, counters, frame.commandBuffer, "Scene Pass");
+                drawCount = RecordScenePass(frame, frameIndex, renderPass, pushConstants, visible, visibleCount);
+            }
+            metrics.AddDrawCalls(drawCount);
+
+            // The texture feedback is read on the host once the frame's fence has signalled.
+            if (streamedTextureCount != 0)
+            {
+                VkMemoryBarrier feedbackBarrier = {};
+                feedbackBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                feedbackBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                feedbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+                vkCmdPipelineBarrier(frame.commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                                     0, 1, &feedbackBarrier, 0, nullptr, 0, nullptr);
+            }
+            breadcrumbs.End(frame.commandBuffer);
+            profiler.EndScope(frame.commandBuffer);
+            vkEndCommandBuffer(frame.commandBuffer);
+
+            std::vector<VkSubmitInfo> submitInfos(counters.PassCount());
+            for (uint32_t pass = 0; pass < counters.PassCount(); pass++)
+            {
+                submitInfos[pass]                    = {};
+                submitInfos[pass].sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfos[pass].pNext              = counters.SubmitInfo(pass);
+                submitInfos[pass].commandBufferCount = 1;
+                submitInfos[pass].pCommandBuffers    = &frame.commandBuffer;
+            }
+            if (breadcrumbs.Check(vkQueueSubmit(queue, counters.PassCount(), submitInfos.data(), frame.fence)) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[ ERROR ] Failed to submit frame " + std::to_string(frameNumber) + ".");
+            }
+            auto submitEnd = std::chrono::steady_clock::now();
+
+            if (measured)
+            {
+                times.frameMs.push_back(std::chrono::duration<double, std::milli>(frameStart - previousStart).count());
+                times.waitMs.push_back(std::chrono::duration<double, std::milli>(waitEnd - frameStart).count());
+                times.cpuMs.push_back(std::chrono::duration<double, std::milli>(submitEnd - waitEnd).count());
+                visibleSum += visibleCount;
+                drawSum    += drawCount;
+            }
+            metrics.EndFrame(std::chrono::duration<double>(frameStart - previousStart).count());
+            previousStart = frameStart;
+        }
+
+        vkDeviceWaitIdle(device);
+        counters.Print();
+        if (tracing) Tracer::Instance().WriteChromeTrace(config.tracePath);
+        averageVisible = static_cast<double>(visibleSum) / static_cast<double>(config.frameCount);
+        averageDraws   = static_cast<double>(drawSum) / static_cast<double>(config.frameCount);
+    }
+
+
+    // Records the streamer's latest residency changes ahead of the scene pass and points
+    // the frame's descriptor set at the resulting views. The set is not in use, the frame's
+    // fence has been waited on.
+    void
+    RecordTextureStreaming(Frame& frame, uint32_t frameIndex, uint32_t frameNumber)
+    {
+        // Streaming frame numbers run ahead by the frames in flight, so frameNumber is the
+        // last one known complete once this slot's fence has signalled.
+        textureBackend.BeginFrame(frame.commandBuffer, frameIndex, frameNumber, frameNumber + BENCHMARK_FRAMES_IN_FLIGHT);
+        textureStreamer.ApplyDecisions(textureBackend);
+
+        std::vector<VkDescriptorImageInfo> imageInfos;
+        std::vector<VkWriteDescriptorSet>  writes;
+        imageInfos.reserve(streamedTextureCount);
+        for (uint32_t texture = 0; texture < streamedTextureCount; texture++)
+        {
+            VkImageView view = textureBackend.View(texture);
+            if (view == frame.textureViews[texture]) continue;
+            frame.textureViews[texture] = view;
+
+            imageInfos.push_back({ textureSampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+            VkWriteDescriptorSet write = {};
+            write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet          = frame.descriptorSet;
+            write.dstBinding      = 4;
+            write.dstArrayElement = texture;
+            write.descriptorCount = 1;
+            write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo      = &imageInfos.back();
+            writes.push_back(write);
+        }
+        if (writes.empty()) return;
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        metrics.AddDescriptorWrites(static_cast<uint32_t>(writes.size()));
+    }
+
+
+    // Records one render pass over the scene and returns its draw count: every material's
+    // command range of gpuScene, or the instances left in visible by the CPU culling,
+    // compacted into the frame's visible list after visibleCount, directly or in drawQueue
+    // order, after the centerpiece. The GPU driven and cluster culled triangle counts are
+    // not known on the CPU.
+    uint32_t
+    RecordScenePass(Frame&                        frame,
+                    uint32_t                      frameIndex,
+                    VkRenderPass                  pass,
+                    const BenchmarkPushConstants& pushConstants,
+                    const std::vector<uint8_t>&   visible,
+                    uint32_t&                     visibleCount)
+    {
+        VkClearValue clearValues[2] = {};
+        clearValues[0].color        = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+        clearValues[1].depthStencil = { 1.0f, 0 };
+
+        VkRenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass        = pass;
+        renderPassInfo.framebuffer       = framebuffer;
+        renderPassInfo.renderArea.extent = { config.width, config.height };
+        renderPassInfo.clearValueCount   = 2;
+        renderPassInfo.pClearValues      = clearValues;
+        vkCmdBeginRenderPass(frame.commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        // The draw queue binds for itself; push constants only need the layout. The
+        // centerpiece is drawn outside of it.
+        vkCmdPushConstants(frame.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0, sizeof(pushConstants), &pushConstants);
+        if (!config.drawQueue || config.centerpiece != 0)
+        {
+            VkDeviceSize vertexOffset = 0;
+            vkCmdBindPipeline(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            metrics.AddPipelineBinds(1);
+            vkCmdBindDescriptorSets(frame.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
+                                    0, 1, &frame.descriptorSet, 0, nullptr);
+            vkCmdBindVertexBuffers(frame.commandBuffer, 0, 1, &vertexBuffer, &vertexOffset);
+            vkCmdBindIndexBuffer(frame.commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        }
+
+        // First, as the largest occluder. Its instance is the last slot of the visible list.
+        uint32_t drawCount = 0;
+        if (config.clusters)
+        {
+            clusterCuller.Draw(frame.commandBuffer, frameIndex);
+            vkCmdBindIndexBuffer(frame.commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            drawCount++;
+        }
+        else if (config.centerpiece != 0)
+        {
+            vkCmdDrawIndexed(frame.commandBuffer, centerpiece.indexCount, 1, centerpiece.firstIndex,
+                             centerpiece.vertexOffset, config.instanceCount);
+            drawCount++;
+            metrics.AddTriangles(centerpiece.indexCount / 3);
+        }
+
+        if (config.gpuDriven)
+        {
+            for (uint32_t bucket = 0; bucket < gpuScene.BucketCount(); bucket++)
+            {
+                gpuScene.DrawBucket(frame.commandBuffer, frameIndex, bucket);
+            }
+            drawCount += gpuScene.BucketCount();
+        }
+        else if (config.drawQueue)
+        {
+            glm::vec3 camera   = glm::vec3(pushConstants.cameraPosition);
+            float     farPlane = 4.0f * sceneExtent;
+            drawQueue.Clear();
+            for (uint32_t meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
+            {
+                const BenchmarkMesh& mesh        = meshes[meshIndex];
+                uint32_t             meshVisible = 0;
+                for (uint32_t ii = mesh.firstInstance; ii < mesh.firstInstance + mesh.instanceCount; ii++)
+                {
+                    if (!visible[ii]) continue;
+
+                    glm::vec3 center(bounds.centerX[ii], bounds.centerY[ii], bounds.centerZ[ii]);
+                    drawQueue.Submit(0, 0, frameIndex, meshIndex, QuantizeDrawDepth(glm::length(center - camera), farPlane), ii);
+                    meshVisible++;
+                }
+                metrics.AddTriangles(static_cast<uint64_t>(mesh.indexCount / 3) * meshVisible);
+            }
+            drawQueue.Sort();
+
+            const std::vector<uint32_t>& sortedInstances = drawQueue.SortedInstanceData();
+            if (!sortedInstances.empty())
+            {
+                memcpy(frame.visibleMapped, sortedInstances.data(), sortedInstances.size() * sizeof(uint32_t));
+            }
+            visibleCount = static_cast<uint32_t>(sortedInstances.size());
+            drawQueue.Record(frame.commandBuffer, 0);
+
+            DrawQueueStatistics statistics = drawQueue.Statistics();
+            drawCount += statistics.drawCalls;
+            metrics.AddPipelineBinds(statistics.pipelineBinds);
+        }
+        else
+        {
+            for (const auto& mesh : meshes)
+            {
+                uint32_t firstVisible = visibleCount;
+                for (uint32_t ii = mesh.firstInstance; ii < mesh.firstInstance + mesh.instanceCount; ii++)
+                {
+                    if (visible[ii]) frame.visibleMapped[visibleCount++] = ii;
+                }
+                if (visibleCount == firstVisible) continue;
+
+                vkCmdDrawIndexed(frame.commandBuffer, mesh.indexCount, visibleCount - firstVisible,
+                                 mesh.firstIndex, mesh.vertexOffset, firstVisible);
+                drawCount++;
+                metrics.AddTriangles(static_cast<uint64_t>(mesh.indexCount / 3) * (visibleCount - firstVisible));
+            }
+        }
+
+        vkCmdEndRenderPass(frame.commandBuffer);
+        return drawCount;
+    }
+
+
+    void
+    WriteResults() const
+    {
+        std::ofstream file(config.outputPath);
+        if (!file)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to open " + config.outputPath + " for writing.");
+        }
+        file << std::fixed;
+        file.precision(4);
+
+        file << "{\n"
+             << "  \"config\": { \"meshes\": " << config.meshCount << ", \"materials\": " << config.materialCount
+             << ", \"lights\": " << config.lightCount << ", \"instances\": " << config.instanceCount
+             << ", \"frames\": " << config.frameCount << ", \"warmup\": " << config.warmupFrames
+             << ", \"width\": " << config.width << ", \"height\": " << config.height
+             << ", \"seed\": " << config.seed << ", \"breadcrumbs\": " << (config.breadcrumbs ? "true" : "false")
+             << ", \"counters\": " << (config.counters ? "true" : "false")
+             << ", \"pipelineCache\": " << (config.pipelineCachePath.empty() ? "false" : "true")
+             << ", \"gpuDriven\": " << (config.gpuDriven ? "true" : "false")
+             << ", \"drawQueue\": " << (config.drawQueue ? "true" : "false")
+             << ", \"centerpiece\": " << config.centerpiece
+             << ", \"clusters\": " << (config.clusters ? "true" : "false")
+             << ", \"textures\": " << (config.texturesPath.empty() ? "false" : "true")
+             << ", \"detailTexture\": " << config.detailTexture << " },\n"
+             << "  \"device\": { \"name\": \"" << deviceProperties.deviceName << "\""
+             << ", \"vendorId\": " << deviceProperties.vendorID
+             << ", \"driverVersion\": " << deviceProperties.driverVersion
+             << ", \"apiVersion\": \"" << VK_VERSION_MAJOR(deviceProperties.apiVersion) << "."
+             << VK_VERSION_MINOR(deviceProperties.apiVersion) << "." << VK_VERSION_PATCH(deviceProperties.apiVersion) << "\" },\n"
+             << "  \"scene\": { \"triangles\": " << triangleCount
+             << ", \"averageVisibleInstances\": ";
+        if (config.gpuDriven) file << "null";
+        else                  file << averageVisible;
+        file << ", \"averageDrawCalls\": " << averageDraws
+             << ", \"pipelineCreationMs\": " << pipelineMs
+             << ", \"pipelineCacheHit\": " << (pipelineCacheHit ? "true" : "false") << " },\n"
+             << "  \"timings\": {\n";
+        WriteStatistics(file, "frameMs", times.frameMs, false);
+        WriteStatistics(file, "cpuMs",   times.cpuMs,   false);
+        WriteStatistics(file, "waitMs",  times.waitMs,  false);
+        WriteStatistics(file, "gpuMs",   times.gpuMs,   true);
+        file << "  },\n"
+             << "  \"memory\": { \"deviceBytes\": " << deviceBytes
+             << ", \"peakResidentBytes\": " << PeakResidentBytes() << " }\n"
+             << "}\n";
+
+        std::cout << "[ INFO ] Wrote " << config.outputPath << std::endl;
+    }
+
+
+    void
+    WriteMetrics() const
+    {
+        std::cout << "[ INFO ] Last frame: " << metrics.OverlayText() << std::endl;
+        if (config.metricsPath.empty()) return;
+
+        std::ofstream file(config.metricsPath);
+        if (!file)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to open " + config.metricsPath + " for writing.");
+        }
+        file << MetricsRegistry::Instance().PrometheusText();
+        std::cout << "[ INFO ] Wrote " << config.metricsPath << std::endl;
+    }
+
+
+    VkCommandBuffer
+    AllocateCommandBuffer()
+    {
+        VkCommandBufferAllocateInfo allocateInfo = {};
+        allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool        = commandPool;
+        allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to allocate command buffer.");
+        }
+        return commandBuffer;
+    }
+
+
+    // properties: as passed to CreateBuffer() / implied by CreateImage2D(), to find the heap.
+    void
+    TrackBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties)
+    {
+        VkMemoryRequirements requirements = {};
+        vkGetBufferMemoryRequirements(device, buffer, &requirements);
+        TrackAllocation(requirements, properties);
+    }
+
+
+    void
+    TrackImage(VkImage image, VkMemoryPropertyFlags properties)
+    {
+        VkMemoryRequirements requirements = {};
+        vkGetImageMemoryRequirements(device, image, &requirements);
+        TrackAllocation(requirements, properties);
+    }
+
+
+    void
+    TrackAllocation(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memoryProperties = {};
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        uint32_t heap = memoryProperties.memoryTypes[FindMemoryType(physicalDevice, requirements.memoryTypeBits,
+                                                                    properties)].heapIndex;
+        if (heapBytes.size() <= heap) heapBytes.resize(heap + 1, 0);
+        heapBytes[heap] += requirements.size;
+        deviceBytes     += requirements.size;
+    }
+
+
+    BenchmarkConfig            config;
+
+    VkInstance                 instance            = VK_NULL_HANDLE;
+    VkPhysicalDevice           physicalDevice      = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties deviceProperties    = {};
+    VkDevice                   device              = VK_NULL_HANDLE;
+    VkQueue                    queue               = VK_NULL_HANDLE;
+    uint32_t                   queueFamilyIndex    = 0;
+    bool                       queueCompute        = false; // The queue family supports compute, for detailMips
+    VkCommandPool              commandPool         = VK_NULL_HANDLE;
+
+    VkFormat                   depthFormat         = VK_FORMAT_UNDEFINED;
+    VkImage                    colorImage          = VK_NULL_HANDLE;
+    VkDeviceMemory             colorMemory         = VK_NULL_HANDLE;
+    VkImageView                colorView           = VK_NULL_HANDLE;
+    VkImage                    depthImage          = VK_NULL_HANDLE;
+    VkDeviceMemory             depthMemory         = VK_NULL_HANDLE;
+    VkImageView                depthView           = VK_NULL_HANDLE;
+    VkRenderPass               renderPass          = VK_NULL_HANDLE; // Early pass with --gpu-driven 1
+    VkRenderPass               lateRenderPass      = VK_NULL_HANDLE; // --gpu-driven 1 only
+    VkFramebuffer              framebuffer         = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout      descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout           pipelineLayout      = VK_NULL_HANDLE;
+    VkPipeline                 pipeline            = VK_NULL_HANDLE;
+    VkPipelineCache            pipelineCache       = VK_NULL_HANDLE;
+    VkDescriptorPool           descriptorPool      = VK_NULL_HANDLE;
+
+    VkBuffer                   vertexBuffer        = VK_NULL_HANDLE;
+    VkDeviceMemory             vertexMemory        = VK_NULL_HANDLE;
+    VkBuffer                   indexBuffer         = VK_NULL_HANDLE;
+    VkDeviceMemory             indexMemory         = VK_NULL_HANDLE;
+    VkBuffer                   instanceBuffer      = VK_NULL_HANDLE;
+    VkDeviceMemory             instanceMemory      = VK_NULL_HANDLE;
+    VkBuffer                   materialBuffer      = VK_NULL_HANDLE;
+    VkDeviceMemory             materialMemory      = VK_NULL_HANDLE;
+    VkBuffer                   lightBuffer         = VK_NULL_HANDLE;
+    VkDeviceMemory             lightMemory         = VK_NULL_HANDLE;
+
+    std::vector<BenchmarkMesh> meshes;
+    CullingBounds              bounds;             // CPU culling only
+    GpuScene                   gpuScene;           // --gpu-driven 1 only
+    DepthPyramid               depthPyramid;       // --gpu-driven 1 only
+    DrawQueue                  drawQueue;          // --draw-queue 1 only
+    BenchmarkMesh              centerpiece;        // --centerpiece S only, instance config.instanceCount
+    ClusterCuller              clusterCuller;      // --clusters 1 only
+    AssetArchive               textureArchive;     // --textures only
+    TextureStreamer            textureStreamer;
+    VulkanTextureStreamingBackend textureBackend;
+    TextureStreamingFeedback   textureFeedback;
+    VkSampler                  textureSampler      = VK_NULL_HANDLE;
+    uint32_t                   streamedTextureCount = 0;
+    std::vector<uint32_t>      streamedTextureLevels; // Mip levels per streamed texture
+    MipGenerator               detailMips;         // --detail-texture only
+    VkImage                    detailImage         = VK_NULL_HANDLE;
+    VkDeviceMemory             detailMemory        = VK_NULL_HANDLE;
+    VkImageView                detailView          = VK_NULL_HANDLE;
+    uint32_t                   detailLevels        = 0;
+    bool                       drawIndirectCount   = false; // VK_KHR_draw_indirect_count enabled for indirect draws
+    bool                       multiDrawIndirect   = false;
+    float                      sceneExtent         = 1.0f;
+    size_t                     triangleCount       = 0;
+
+    std::vector<Frame>         frames;
+    GpuProfiler                profiler;
+    GpuBreadcrumbs             breadcrumbs;        // Inactive unless --breadcrumbs 1
+    PerformanceCounters        counters;           // Inactive unless --counters 1 and supported
+    bool                       countersEnabled     = false;
+    uint32_t                   collectingFrame     = UINT32_MAX; // Frame whose GPU times BeginFrame() reads back
+
+    FrameTimes                 times;
+    double                     averageVisible      = 0.0;
+    double                     averageDraws        = 0.0;
+    double                     pipelineMs          = 0.0;
+    bool                       pipelineCacheHit    = false; // Reported by VK_EXT_pipeline_creation_feedback
+    VkDeviceSize               deviceBytes         = 0;
+    std::vector<VkDeviceSize>  heapBytes;          // deviceBytes per memory heap
+    FrameMetrics               metrics;
+};
+
+
+int
+main(int argc, char** argv)
+{
+    BenchmarkConfig config;
+    try
+    {
+        config = ParseArguments(argc, argv);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    RenderBenchmark benchmark(config);
+    try
+    {
+        benchmark.Run();
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        benchmark.Cleanup();
+        return EXIT_FAILURE;
+    }
+
+    benchmark.Cleanup();
+    return EXIT_SUCCESS;
+}
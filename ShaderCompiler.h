@@ -0,0 +1,132 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+// Runtime GLSL -> SPIR-V compilation through the bundled shaderc headers.
+//
+// build_vulkan.bat defines HAVE_SHADERC and links shaderc_combined.lib when that library
+// is present in libs/ (it ships with the Vulkan SDK). Without it CompileGlsl() throws and
+// callers are expected to check ShaderCompilerAvailable() and take a fallback path.
+
+#include <vulkan/vulkan.h>
+
+#include "PipelineTelemetry.h"
+
+#ifdef HAVE_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+
+enum ShaderKind : uint32_t
+{
+    SHADER_KIND_VERTEX   = 0,
+    SHADER_KIND_FRAGMENT = 1,
+    SHADER_KIND_COMPUTE  = 2
+};
+
+typedef std::vector<std::pair<std::string, std::string>> ShaderDefines;
+
+
+inline bool
+ShaderCompilerAvailable()
+{
+#ifdef HAVE_SHADERC
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+inline std::vector<uint32_t>
+CompileGlsl(const std::string&   source,
+            ShaderKind           kind,
+            const std::string&   name,
+            const ShaderDefines& defines = ShaderDefines())
+{
+#ifdef HAVE_SHADERC
+    shaderc_shader_kind shadercKind = shaderc_glsl_compute_shader;
+    if (kind == SHADER_KIND_VERTEX)   shadercKind = shaderc_glsl_vertex_shader;
+    if (kind == SHADER_KIND_FRAGMENT) shadercKind = shaderc_glsl_fragment_shader;
+
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+    for (const auto& define : defines)
+    {
+        options.AddMacroDefinition(define.first, define.second);
+    }
+
+    shaderc::Compiler compiler;
+    shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, shadercKind, name.c_str(), options);
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to compile shader " + name + ":\n" + result.GetErrorMessage());
+    }
+
+    return std::vector<uint32_t>(result.cbegin(), result.cend());
+#else
+    if (source.empty() || kind > SHADER_KIND_COMPUTE || defines.size()) {} // Silence unused arguments warning
+    throw std::runtime_error("[ ERROR ] Cannot compile " + name + ": built without shaderc.");
+#endif
+}
+
+
+inline VkShaderModule
+CreateShaderModule(VkDevice device, const std::vector<uint32_t>& spirv)
+{
+    VkShaderModuleCreateInfo createInfo = {};
+    createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = spirv.size() * sizeof(uint32_t);
+    createInfo.pCode    = spirv.data();
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to create shader module.");
+    }
+    return shaderModule;
+}
+
+
+// Compiles a compute shader and wraps it in a pipeline using the given layout. Creation is
+// recorded by PipelineTelemetry under name.
+inline VkPipeline
+CreateComputePipeline(VkDevice             device,
+                      VkPipelineLayout     layout,
+                      const std::string&   source,
+                      const std::string&   name,
+                      const ShaderDefines& defines = ShaderDefines(),
+                      VkPipelineCache      pipelineCache = VK_NULL_HANDLE)
+{
+    VkShaderModule shaderModule = CreateShaderModule(device, CompileGlsl(source, SHADER_KIND_COMPUTE, name, defines));
+
+    VkComputePipelineCreateInfo createInfo = {};
+    createInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    createInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    createInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+    createInfo.stage.module = shaderModule;
+    createInfo.stage.pName  = "main";
+    createInfo.layout       = layout;
+
+    PipelineFeedback feedback;
+    createInfo.flags |= PipelineTelemetry::Instance().Begin(feedback, createInfo.pNext, 1);
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult   result   = vkCreateComputePipelines(device, pipelineCache, 1, &createInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to create compute pipeline " + name + ".");
+    }
+    PipelineTelemetry::Instance().End(feedback, name, pipeline);
+    return pipeline;
+}
+
+#endif // SHADER_COMPILER_H
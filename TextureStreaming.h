@@ -0,0 +1,826 @@
+#ifndef TEXTURE_STREAMING_H
+#define TEXTURE_STREAMING_H
+
+// Feedback driven texture streaming.
+//
+// Every texture keeps its mip tail (all levels no larger than mipTailDimension) resident
+// for its whole lifetime. Shaders write the finest mip they wanted for each texture into
+// a small feedback buffer (see TEXTURE_STREAMING_FEEDBACK_GLSL); once a frame's fence has
+// signalled, that buffer is handed to TextureStreamer::SubmitFeedback(). A background
+// thread turns the feedback into residency decisions under the memory budget, and the
+// render thread applies them through a TextureStreamingBackend in ApplyDecisions().
+//
+// The render thread never waits on the worker: if no new decisions are ready it simply
+// keeps the current residency.
+
+#include <vulkan/vulkan.h>
+
+#include "AssetArchive.h"
+#include "VulkanUtilities.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <assert.h>
+
+const uint32_t TEXTURE_STREAMING_NOT_REQUESTED = 0xFFFFFFFF;
+
+
+// [ cfarvin::NOTE ] Include in any shader that samples streamed textures. The residency
+// buffer holds the finest resident mip per texture. Because a streamed image only contains
+// its resident levels, the level of detail from textureQueryLod() is relative to that
+// level and is offset back into the full chain before being reported. Implicit derivatives
+// are only defined in uniform control flow, so every pixel queries the level of detail and
+// only the atomic is limited to one pixel in each 4x4 block to keep the atomics cheap.
+const char* const TEXTURE_STREAMING_FEEDBACK_GLSL = R"GLSL(
+layout(std430, set = STREAMING_SET, binding = STREAMING_FEEDBACK_BINDING) buffer StreamingFeedback
+{
+    uint streamingRequestedMip[];
+};
+
+layout(std430, set = STREAMING_SET, binding = STREAMING_RESIDENCY_BINDING) readonly buffer StreamingResidency
+{
+    uint streamingResidentMip[];
+};
+
+vec4 SampleStreamed(uint textureIndex, sampler2D streamedTexture, vec2 uv)
+{
+    float lod = textureQueryLod(streamedTexture, uv).y + float(streamingResidentMip[textureIndex]);
+    if (((uint(gl_FragCoord.x) | uint(gl_FragCoord.y)) & 3u) == 0u)
+    {
+        atomicMin(streamingRequestedMip[textureIndex], uint(max(lod, 0.0)));
+    }
+    return texture(streamedTexture, uv);
+}
+)GLSL";
+
+
+struct TextureStreamingConfig
+{
+    uint64_t memoryBudget               = 256ull * 1024 * 1024;
+    uint64_t maxPromotionBytesPerUpdate = 16ull * 1024 * 1024; // Bounds upload bandwidth per decision batch
+    uint32_t mipTailDimension           = 128;                 // Levels this size and below are never evicted
+    uint32_t evictionDelayFrames        = 120;                 // Unrequested textures drop to their tail after this
+};
+
+
+// Performs the actual residency change for a texture. Returning false leaves the texture
+// as it was and the decision is retried on a later update (e.g. when staging is full).
+class TextureStreamingBackend
+{
+public:
+    virtual ~TextureStreamingBackend() = default;
+
+    virtual bool
+    SetResidency(uint32_t textureId, uint32_t oldResidentMip, uint32_t newResidentMip) = 0;
+};
+
+
+class TextureStreamer
+{
+public:
+    explicit TextureStreamer(const TextureStreamingConfig& streamingConfig = TextureStreamingConfig())
+        : config(streamingConfig)
+    {
+    }
+
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    ~TextureStreamer()
+    {
+        Stop();
+    }
+
+
+    void
+    Start()
+    {
+        if (worker.joinable()) return;
+        stopRequested = false;
+        worker = std::thread(&TextureStreamer::WorkerLoop, this);
+    }
+
+
+    void
+    Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopRequested = true;
+        }
+        feedbackReady.notify_one();
+
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+
+    // mipSizes[level] is the size in bytes of that level. The texture starts with only its
+    // tail resident; the caller is expected to upload the tail itself.
+    uint32_t
+    RegisterTexture(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipSizes)
+    {
+        if (mipSizes.empty())
+        {
+            throw std::runtime_error("[ ERROR ] Streamed textures need at least one mip level.");
+        }
+
+        StreamedTexture texture = {};
+        texture.mipSizes     = mipSizes;
+        texture.tailMip      = static_cast<uint32_t>(mipSizes.size() - 1);
+        texture.requestedMip = TEXTURE_STREAMING_NOT_REQUESTED;
+
+        for (uint32_t level = 0; level < mipSizes.size(); level++)
+        {
+            uint32_t levelWidth  = std::max(width >> level, 1u);
+            uint32_t levelHeight = std::max(height >> level, 1u);
+            if (std::max(levelWidth, levelHeight) <= config.mipTailDimension)
+            {
+                texture.tailMip = level;
+                break;
+            }
+        }
+        texture.residentMip = texture.tailMip;
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        textures.push_back(texture);
+        return static_cast<uint32_t>(textures.size() - 1);
+    }
+
+
+    uint32_t
+    TextureCount() const
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        return static_cast<uint32_t>(textures.size());
+    }
+
+
+    uint32_t
+    TailMip(uint32_t textureId) const
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        return textures[textureId].tailMip;
+    }
+
+
+    uint32_t
+    ResidentMip(uint32_t textureId) const
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        return textures[textureId].residentMip;
+    }
+
+
+    uint64_t
+    ResidentBytes() const
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        uint64_t total = 0;
+        for (const auto& texture : textures)
+        {
+            total += ResidencyBytes(texture, texture.residentMip);
+        }
+        return total;
+    }
+
+
+    // requestedMips[textureId] as written by the shaders, TEXTURE_STREAMING_NOT_REQUESTED
+    // for textures that were not sampled. Only the most recent unprocessed feedback is
+    // kept; the worker never falls more than one frame behind.
+    void
+    SubmitFeedback(const uint32_t* requestedMips, uint32_t count, uint64_t frameNumber)
+    {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            pendingFeedback.assign(requestedMips, requestedMips + count);
+            pendingFeedbackFrame = frameNumber;
+            hasPendingFeedback   = true;
+        }
+        feedbackReady.notify_one();
+    }
+
+
+    // Runs on the render thread. Returns the number of residency changes applied.
+    uint32_t
+    ApplyDecisions(TextureStreamingBackend& backend)
+    {
+        std::vector<StreamingDecision> ready;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            ready.swap(decisions);
+        }
+
+        uint32_t applied = 0;
+        for (const auto& decision : ready)
+        {
+            uint32_t residentMip = ResidentMip(decision.textureId);
+            if (residentMip != decision.fromMip) continue; // Stale, the next batch will have a fresh one
+
+            if (backend.SetResidency(decision.textureId, decision.fromMip, decision.toMip))
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                textures[decision.textureId].residentMip = decision.toMip;
+                applied++;
+            }
+        }
+        return applied;
+    }
+
+
+private:
+    struct StreamedTexture
+    {
+        std::vector<uint64_t> mipSizes;
+        uint32_t              tailMip;
+        uint32_t              residentMip;
+        uint32_t              requestedMip;
+        uint64_t              lastRequestedFrame;
+    };
+
+
+    struct StreamingDecision
+    {
+        uint32_t textureId;
+        uint32_t fromMip;
+        uint32_t toMip;
+    };
+
+
+    static uint64_t
+    ResidencyBytes(const StreamedTexture& texture, uint32_t residentMip)
+    {
+        uint64_t total = 0;
+        for (size_t level = residentMip; level < texture.mipSizes.size(); level++)
+        {
+            total += texture.mipSizes[level];
+        }
+        return total;
+    }
+
+
+    void
+    WorkerLoop()
+    {
+        std::vector<uint32_t>        feedback;
+        std::vector<StreamedTexture> snapshot;
+
+        for (;;)
+        {
+            uint64_t frameNumber = 0;
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                feedbackReady.wait(lock, [this]() { return stopRequested || hasPendingFeedback; });
+                if (stopRequested) return;
+
+                feedback.swap(pendingFeedback);
+                frameNumber        = pendingFeedbackFrame;
+                hasPendingFeedback = false;
+
+                size_t count = std::min(feedback.size(), textures.size());
+                for (size_t ii = 0; ii < count; ii++)
+                {
+                    if (feedback[ii] != TEXTURE_STREAMING_NOT_REQUESTED)
+                    {
+                        textures[ii].requestedMip       = feedback[ii];
+                        textures[ii].lastRequestedFrame = frameNumber;
+                    }
+                }
+                snapshot = textures;
+            }
+
+            std::vector<StreamingDecision> batch = Decide(snapshot, frameNumber);
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            decisions.swap(batch);
+        }
+    }
+
+
+    std::vector<StreamingDecision>
+    Decide(const std::vector<StreamedTexture>& state, uint64_t frameNumber) const
+    {
+        // Desired residency ignoring the budget.
+        std::vector<uint32_t> target(state.size());
+        uint64_t              targetBytes = 0;
+        for (size_t ii = 0; ii < state.size(); ii++)
+        {
+            const StreamedTexture& texture = state[ii];
+            bool recentlyUsed = texture.requestedMip != TEXTURE_STREAMING_NOT_REQUESTED &&
+                frameNumber - texture.lastRequestedFrame <= config.evictionDelayFrames;
+
+            if (!recentlyUsed)
+            {
+                target[ii] = texture.tailMip;
+            }
+            else if (texture.requestedMip >= texture.residentMip)
+            {
+                // Still in use: hold what is resident rather than thrash on small LOD changes.
+                target[ii] = texture.residentMip;
+            }
+            else
+            {
+                target[ii] = texture.requestedMip;
+            }
+            targetBytes += ResidencyBytes(texture, target[ii]);
+        }
+
+        // Over budget: strip one top mip at a time from the least recently requested
+        // texture, and among equally recent textures from the one holding the finest level,
+        // so that textures in view degrade together rather than one after another.
+        if (targetBytes > config.memoryBudget)
+        {
+            auto stripFirst = [&state, &target](uint32_t lhs, uint32_t rhs)
+            {
+                if (state[lhs].lastRequestedFrame != state[rhs].lastRequestedFrame)
+                {
+                    return state[lhs].lastRequestedFrame > state[rhs].lastRequestedFrame;
+                }
+                return target[lhs] > target[rhs];
+            };
+
+            std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(stripFirst)> candidates(stripFirst);
+            for (uint32_t ii = 0; ii < state.size(); ii++)
+            {
+                if (target[ii] < state[ii].tailMip) candidates.push(ii);
+            }
+
+            while (targetBytes > config.memoryBudget && !candidates.empty())
+            {
+                uint32_t index = candidates.top();
+                candidates.pop();
+                targetBytes -= state[index].mipSizes[target[index]];
+                target[index]++;
+                if (target[index] < state[index].tailMip) candidates.push(index);
+            }
+        }
+
+        // Evictions go straight to their target and come first so that the memory they
+        // free is available to the promotions. Promotions move one level at a time, most
+        // wanted first, within the per-update upload budget.
+        std::vector<StreamingDecision> evictions;
+        std::vector<StreamingDecision> promotions;
+        for (uint32_t ii = 0; ii < state.size(); ii++)
+        {
+            if (target[ii] > state[ii].residentMip)
+            {
+                evictions.push_back({ ii, state[ii].residentMip, target[ii] });
+            }
+            else if (target[ii] < state[ii].residentMip)
+            {
+                promotions.push_back({ ii, state[ii].residentMip, state[ii].residentMip - 1 });
+            }
+        }
+
+        std::sort(promotions.begin(), promotions.end(),
+                  [&state](const StreamingDecision& lhs, const StreamingDecision& rhs)
+                  {
+                      uint32_t lhsDeficit = lhs.fromMip - state[lhs.textureId].requestedMip;
+                      uint32_t rhsDeficit = rhs.fromMip - state[rhs.textureId].requestedMip;
+                      return lhsDeficit > rhsDeficit;
+                  });
+
+        uint64_t uploadBytes = 0;
+        for (const auto& promotion : promotions)
+        {
+            uint64_t levelBytes = state[promotion.textureId].mipSizes[promotion.toMip];
+            if (uploadBytes && uploadBytes + levelBytes > config.maxPromotionBytesPerUpdate) break;
+            uploadBytes += levelBytes;
+            evictions.push_back(promotion);
+        }
+
+        return evictions;
+    }
+
+    TextureStreamingConfig         config;
+    mutable std::mutex             stateMutex;
+    std::condition_variable        feedbackReady;
+    std::thread                    worker;
+    bool                           stopRequested        = false;
+    bool                           hasPendingFeedback   = false;
+    uint64_t                       pendingFeedbackFrame = 0;
+    std::vector<uint32_t>          pendingFeedback;
+    std::vector<StreamedTexture>   textures;
+    std::vector<StreamingDecision> decisions;
+};
+
+
+// Host visible feedback buffers (one per frame in flight) and the residency buffer read by
+// TEXTURE_STREAMING_FEEDBACK_GLSL. Both are small: four bytes per streamed texture.
+class TextureStreamingFeedback
+{
+public:
+    void
+    Create(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t maxTextures, uint32_t framesInFlight)
+    {
+        device       = logicalDevice;
+        textureCount = maxTextures;
+        bufferSize   = static_cast<VkDeviceSize>(maxTextures) * sizeof(uint32_t);
+
+        frames.resize(framesInFlight);
+        for (auto& frame : frames)
+        {
+            CreateMappedBuffer(physicalDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, frame);
+            memset(frame.mapped, 0xFF, static_cast<size_t>(bufferSize));
+        }
+
+        CreateMappedBuffer(physicalDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, residency);
+        memset(residency.mapped, 0, static_cast<size_t>(bufferSize));
+    }
+
+
+    void
+    Destroy()
+    {
+        for (auto& frame : frames)
+        {
+            DestroyMappedBuffer(frame);
+        }
+        frames.clear();
+        DestroyMappedBuffer(residency);
+    }
+
+
+    VkBuffer
+    FeedbackBuffer(uint32_t frameIndex) const
+    {
+        return frames[frameIndex].buffer;
+    }
+
+
+    VkBuffer
+    ResidencyBuffer() const
+    {
+        return residency.buffer;
+    }
+
+
+    // Call once the fence of frameIndex has signalled, before the frame is recorded again.
+    void
+    Collect(uint32_t frameIndex, uint64_t frameNumber, TextureStreamer& streamer)
+    {
+        uint32_t* feedback = static_cast<uint32_t*>(frames[frameIndex].mapped);
+        uint32_t  count    = std::min(textureCount, streamer.TextureCount());
+        streamer.SubmitFeedback(feedback, count, frameNumber);
+        memset(feedback, 0xFF, static_cast<size_t>(bufferSize));
+
+        // [ cfarvin::NOTE ] Frames still in flight may read the residency buffer while it is
+        // written here. The worst case is one frame of feedback that is off by a level.
+        uint32_t* resident = static_cast<uint32_t*>(residency.mapped);
+        for (uint32_t ii = 0; ii < count; ii++)
+        {
+            resident[ii] = streamer.ResidentMip(ii);
+        }
+    }
+
+
+private:
+    struct MappedBuffer
+    {
+        VkBuffer       buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void*          mapped = nullptr;
+    };
+
+
+    void
+    CreateMappedBuffer(VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, MappedBuffer& mappedBuffer)
+    {
+        CreateBuffer(physicalDevice, device, bufferSize, usage,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     mappedBuffer.buffer, mappedBuffer.memory);
+        if (vkMapMemory(device, mappedBuffer.memory, 0, bufferSize, 0, &mappedBuffer.mapped) != VK_SUCCESS)
+        {
+            vkDestroyBuffer(device, mappedBuffer.buffer, nullptr);
+            vkFreeMemory(device, mappedBuffer.memory, nullptr);
+            mappedBuffer = MappedBuffer();
+            throw std::runtime_error("[ ERROR ] Failed to map texture streaming feedback buffer.");
+        }
+    }
+
+
+    void
+    DestroyMappedBuffer(MappedBuffer& mappedBuffer)
+    {
+        if (mappedBuffer.buffer == VK_NULL_HANDLE) return;
+        vkUnmapMemory(device, mappedBuffer.memory);
+        vkDestroyBuffer(device, mappedBuffer.buffer, nullptr);
+        vkFreeMemory(device, mappedBuffer.memory, nullptr);
+        mappedBuffer = MappedBuffer();
+    }
+
+    VkDevice                  device       = VK_NULL_HANDLE;
+    uint32_t                  textureCount = 0;
+    VkDeviceSize              bufferSize   = 0;
+    std::vector<MappedBuffer> frames;
+    MappedBuffer              residency;
+};
+
+
+// Streams single layer 2D textures out of a packed asset archive. Without sparse residency
+// a texture is reallocated on every residency change: the new image holds exactly the
+// resident levels, retained levels are copied GPU side and new levels are uploaded from
+// the mapped archive through a persistently mapped staging ring. Old images are retired
+// once the frames that may still sample them have completed.
+class VulkanTextureStreamingBackend : public TextureStreamingBackend
+{
+public:
+    void
+    Create(VkPhysicalDevice gpu,
+           VkDevice         logicalDevice,
+           VkDeviceSize     stagingBytesPerFrame,
+           uint32_t         framesInFlight)
+    {
+        physicalDevice = gpu;
+        device         = logicalDevice;
+        stagingSize    = stagingBytesPerFrame;
+        frameCount     = framesInFlight;
+
+        CreateBuffer(physicalDevice, device, stagingSize * frameCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagingBuffer, stagingMemory);
+        if (vkMapMemory(device, stagingMemory, 0, stagingSize * frameCount, 0, &stagingMapped) != VK_SUCCESS)
+        {
+            vkDestroyBuffer(device, stagingBuffer, nullptr);
+            vkFreeMemory(device, stagingMemory, nullptr);
+            stagingBuffer = VK_NULL_HANDLE;
+            stagingMemory = VK_NULL_HANDLE;
+            throw std::runtime_error("[ ERROR ] Failed to map texture streaming staging buffer.");
+        }
+    }
+
+
+    void
+    Destroy()
+    {
+        for (auto& texture : textures)
+        {
+            DestroyImage(texture.image);
+        }
+        for (auto& retired : retiredImages)
+        {
+            DestroyImage(retired.image);
+        }
+        textures.clear();
+        retiredImages.clear();
+
+        if (stagingBuffer != VK_NULL_HANDLE)
+        {
+            vkUnmapMemory(device, stagingMemory);
+            vkDestroyBuffer(device, stagingBuffer, nullptr);
+            vkFreeMemory(device, stagingMemory, nullptr);
+            stagingBuffer = VK_NULL_HANDLE;
+        }
+    }
+
+
+    // textureId must match the id returned by TextureStreamer::RegisterTexture for the
+    // same entry. The archive must outlive the backend. Nothing is resident until the
+    // caller uploads the tail with SetResidency(id, mipLevels, streamer.TailMip(id)).
+    uint32_t
+    AddTexture(const AssetArchive& archive, const AssetArchiveEntry& entry)
+    {
+        if (entry.type != ASSET_TYPE_TEXTURE || entry.info[4] != 1)
+        {
+            throw std::runtime_error("[ ERROR ] Only single layer 2D textures can be streamed.");
+        }
+
+        StreamedImage texture = {};
+        texture.archive = &archive;
+        texture.entry   = &entry;
+        textures.push_back(texture);
+        return static_cast<uint32_t>(textures.size() - 1);
+    }
+
+
+    static std::vector<uint64_t>
+    MipSizes(const AssetArchive& archive, const AssetArchiveEntry& entry)
+    {
+        std::vector<uint64_t> sizes(entry.info[3]);
+        const AssetArchiveRegion* regions = archive.Regions(entry);
+        for (uint32_t level = 0; level < sizes.size(); level++)
+        {
+            sizes[level] = regions[level].size;
+        }
+        return sizes;
+    }
+
+
+    // Begins recording streaming work for a frame. Everything recorded by SetResidency()
+    // goes into commandBuffer until the next BeginFrame().
+    void
+    BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint64_t completedFrameNumber, uint64_t frameNumber)
+    {
+        currentCommandBuffer = commandBuffer;
+        currentFrameIndex    = frameIndex;
+        currentFrameNumber   = frameNumber;
+        stagingUsed          = 0;
+
+        for (size_t ii = 0; ii < retiredImages.size();)
+        {
+            if (retiredImages[ii].retiredFrame <= completedFrameNumber)
+            {
+                DestroyImage(retiredImages[ii].image);
+                retiredImages[ii] = retiredImages.back();
+                retiredImages.pop_back();
+            }
+            else
+            {
+                ii++;
+            }
+        }
+    }
+
+
+    VkImageView
+    View(uint32_t textureId) const
+    {
+        return textures[textureId].image.view;
+    }
+
+
+    // Set when a texture's view changed; the owner must update any descriptors using it.
+    bool
+    ConsumeViewChanged(uint32_t textureId)
+    {
+        bool changed = textures[textureId].viewChanged;
+        textures[textureId].viewChanged = false;
+        return changed;
+    }
+
+
+    bool
+    SetResidency(uint32_t textureId, uint32_t oldResidentMip, uint32_t newResidentMip) override
+    {
+        assert(currentCommandBuffer != VK_NULL_HANDLE);
+
+        StreamedImage&            texture   = textures[textureId];
+        const AssetArchiveEntry&  entry     = *texture.entry;
+        const AssetArchiveRegion* regions   = texture.archive->Regions(entry);
+        const uint8_t*            payload   = texture.archive->Payload(entry);
+        VkFormat                  format    = static_cast<VkFormat>(entry.info[0]);
+        uint32_t                  mipLevels = entry.info[3];
+
+        // Newly resident levels must fit in this frame's staging slice.
+        VkDeviceSize              stagingCursor = stagingUsed;
+        std::vector<VkBufferImageCopy> uploads;
+        for (uint32_t level = newResidentMip; level < std::min(oldResidentMip, mipLevels); level++)
+        {
+            stagingCursor = (stagingCursor + 15) & ~VkDeviceSize(15);
+            if (stagingCursor + regions[level].size > stagingSize) return false;
+
+            VkDeviceSize frameOffset = stagingSize * currentFrameIndex + stagingCursor;
+            memcpy(static_cast<uint8_t*>(stagingMapped) + frameOffset,
+                   payload + regions[level].offset,
+                   static_cast<size_t>(regions[level].size));
+
+            VkBufferImageCopy copy = {};
+            copy.bufferOffset                = frameOffset;
+            copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copy.imageSubresource.mipLevel   = level - newResidentMip;
+            copy.imageSubresource.layerCount = 1;
+            copy.imageExtent                 = { std::max(entry.info[1] >> level, 1u),
+                                                 std::max(entry.info[2] >> level, 1u),
+                                                 1 };
+            uploads.push_back(copy);
+            stagingCursor += regions[level].size;
+        }
+
+        // First residency for this texture: everything, including the tail, comes from
+        // staging, so the caller must start from "nothing resident". Checked before any
+        // Vulkan object is created.
+        if (texture.image.image == VK_NULL_HANDLE && uploads.size() != mipLevels - newResidentMip)
+        {
+            throw std::runtime_error("[ ERROR ] Initial texture residency must upload every level.");
+        }
+        stagingUsed = stagingCursor;
+
+        GpuImage image = {};
+        image.levels   = mipLevels - newResidentMip;
+        CreateImage2D(physicalDevice, device, format,
+                      std::max(entry.info[1] >> newResidentMip, 1u),
+                      std::max(entry.info[2] >> newResidentMip, 1u),
+                      image.levels,
+                      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                      image.image, image.memory);
+        image.view = CreateImageView2D(device, image.image, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, image.levels);
+
+        VkCommandBuffer commandBuffer = currentCommandBuffer;
+        ImageBarrier(commandBuffer, image.image, VK_IMAGE_ASPECT_COLOR_BIT, 0, image.levels,
+                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                     0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        if (!uploads.empty())
+        {
+            vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(uploads.size()), uploads.data());
+        }
+
+        // Levels resident both before and after are copied from the old image.
+        GpuImage& oldImage = texture.image;
+        if (oldImage.image != VK_NULL_HANDLE)
+        {
+            uint32_t firstKept = std::max(oldResidentMip, newResidentMip);
+            ImageBarrier(commandBuffer, oldImage.image, VK_IMAGE_ASPECT_COLOR_BIT, 0, oldImage.levels,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            std::vector<VkImageCopy> copies;
+            for (uint32_t level = firstKept; level < mipLevels; level++)
+            {
+                VkImageCopy copy = {};
+                copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                copy.srcSubresource.mipLevel   = level - oldResidentMip;
+                copy.srcSubresource.layerCount = 1;
+                copy.dstSubresource            = copy.srcSubresource;
+                copy.dstSubresource.mipLevel   = level - newResidentMip;
+                copy.extent                    = { std::max(entry.info[1] >> level, 1u),
+                                                   std::max(entry.info[2] >> level, 1u),
+                                                   1 };
+                copies.push_back(copy);
+            }
+            vkCmdCopyImage(commandBuffer,
+                           oldImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(copies.size()), copies.data());
+
+            RetiredImage retired = {};
+            retired.image        = oldImage;
+            retired.retiredFrame = currentFrameNumber;
+            retiredImages.push_back(retired);
+        }
+
+        ImageBarrier(commandBuffer, image.image, VK_IMAGE_ASPECT_COLOR_BIT, 0, image.levels,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        texture.image       = image;
+        texture.viewChanged = true;
+        return true;
+    }
+
+
+private:
+    struct GpuImage
+    {
+        VkImage        image  = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView    view   = VK_NULL_HANDLE;
+        uint32_t       levels = 0;
+    };
+
+
+    struct StreamedImage
+    {
+        const AssetArchive*      archive;
+        const AssetArchiveEntry* entry;
+        GpuImage                 image;
+        bool                     viewChanged;
+    };
+
+
+    struct RetiredImage
+    {
+        GpuImage image;
+        uint64_t retiredFrame;
+    };
+
+
+    void
+    DestroyImage(GpuImage& image)
+    {
+        if (image.view != VK_NULL_HANDLE) vkDestroyImageView(device, image.view, nullptr);
+        if (image.image != VK_NULL_HANDLE) vkDestroyImage(device, image.image, nullptr);
+        if (image.memory != VK_NULL_HANDLE) vkFreeMemory(device, image.memory, nullptr);
+        image = GpuImage();
+    }
+
+    VkPhysicalDevice           physicalDevice       = VK_NULL_HANDLE;
+    VkDevice                   device               = VK_NULL_HANDLE;
+    VkBuffer                   stagingBuffer        = VK_NULL_HANDLE;
+    VkDeviceMemory             stagingMemory        = VK_NULL_HANDLE;
+    void*                      stagingMapped        = nullptr;
+    VkDeviceSize               stagingSize          = 0;
+    VkDeviceSize               stagingUsed          = 0;
+    uint32_t                   frameCount           = 0;
+    VkCommandBuffer            currentCommandBuffer = VK_NULL_HANDLE;
+    uint32_t                   currentFrameIndex    = 0;
+    uint64_t                   currentFrameNumber   = 0;
+    std::vector<StreamedImage> textures;
+    std::vector<RetiredImage>  retiredImages;
+};
+
+#endif // TEXTURE_STREAMING_H
@@ -0,0 +1,520 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+// CPU/GPU timeline tracing for a capture window, exported as Chrome trace JSON (load it in
+// chrome://tracing or ui.perfetto.dev).
+//
+// CPU scopes (TraceScope) cost one relaxed atomic load outside a capture. During a capture
+// they read the time stamp counter (rdtsc on x86, the host clock elsewhere) and append one
+// complete event to a buffer owned by the calling thread: fixed size chunks whose counts
+// are published with release stores, so neither writers nor the exporter take a lock.
+// Time stamp counter ticks are mapped to the host clock (QueryPerformanceCounter /
+// CLOCK_MONOTONIC) by sampling both at the start and end of the capture.
+//
+// GPU scopes come from GpuProfiler. GpuClockCalibration pairs device timestamps with the
+// host clock through VK_EXT_calibrated_timestamps, so both end up on one timeline; without
+// the extension only the CPU side is exported.
+//
+// GPU counters (PerformanceCounters.h) are exported as Chrome counter events on the GPU
+// process: one chart per counter with one series per pass.
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#include <vulkan/vulkan.h>
+
+#include "GpuProfiler.h"
+#include "VulkanUtilities.h"
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRACING_USE_RDTSC 1
+#else
+#define TRACING_USE_RDTSC 0
+#endif
+
+const uint32_t TRACE_CHUNK_EVENTS = 4096;
+
+
+// Host clock in the time domain Vulkan calibrates against: QueryPerformanceCounter ticks
+// on Windows, CLOCK_MONOTONIC nanoseconds elsewhere.
+inline uint64_t
+HostClockTicks()
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart);
+#else
+    timespec time = {};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ull + static_cast<uint64_t>(time.tv_nsec);
+#endif
+}
+
+
+inline double
+HostClockFrequency()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return static_cast<double>(frequency.QuadPart);
+#else
+    return 1e9;
+#endif
+}
+
+
+inline VkTimeDomainEXT
+HostTimeDomain()
+{
+#ifdef _WIN32
+    return VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+    return VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+}
+
+
+// Clock of CPU trace events; assumes an invariant TSC, as on every x86 CPU of the last
+// decade.
+inline uint64_t
+TraceTimestamp()
+{
+#if TRACING_USE_RDTSC
+    return __rdtsc();
+#else
+    return HostClockTicks();
+#endif
+}
+
+
+class Tracer
+{
+public:
+    static Tracer&
+    Instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+
+    // Drops the events of the previous capture; every thread rewinds its own buffer on
+    // its next event.
+    void
+    BeginCapture()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        gpuEvents.clear();
+        counterSamples.clear();
+        endTimestamp = 0;
+        endHost      = 0;
+        captureGeneration.fetch_add(1, std::memory_order_relaxed);
+        beginTimestamp = TraceTimestamp();
+        beginHost      = HostClockTicks();
+        capturing.store(true, std::memory_order_release);
+    }
+
+
+    void
+    EndCapture()
+    {
+        capturing.store(false, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mutex);
+        endTimestamp = TraceTimestamp();
+        endHost      = HostClockTicks();
+    }
+
+
+    bool
+    Capturing() const
+    {
+        return capturing.load(std::memory_order_relaxed);
+    }
+
+
+    // Shown as the thread's track name; call once from the thread itself.
+    void
+    SetThreadName(const std::string& name)
+    {
+        ThreadBuffer& buffer = LocalBuffer();
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer.name = name;
+    }
+
+
+    // begin and end are TraceTimestamp() values; name must be a string with static
+    // storage duration.
+    void
+    AddCpuEvent(const char* name, uint64_t begin, uint64_t end)
+    {
+        if (!Capturing()) return;
+
+        ThreadBuffer& buffer     = LocalBuffer();
+        uint32_t      generation = captureGeneration.load(std::memory_order_relaxed);
+        if (buffer.generation.load(std::memory_order_relaxed) != generation)
+        {
+            for (Chunk* chunk = buffer.head.get(); chunk; chunk = chunk->next.get())
+            {
+                chunk->count.store(0, std::memory_order_relaxed);
+            }
+            buffer.tail = buffer.head.get();
+            buffer.generation.store(generation, std::memory_order_release);
+        }
+
+        uint32_t count = buffer.tail->count.load(std::memory_order_relaxed);
+        if (count == TRACE_CHUNK_EVENTS)
+        {
+            if (!buffer.tail->next)
+            {
+                buffer.tail->next.reset(new Chunk());
+            }
+            buffer.tail = buffer.tail->next.get();
+            count       = 0;
+        }
+
+        Event& event = buffer.tail->events[count];
+        event.name  = name;
+        event.begin = begin;
+        event.end   = end;
+        buffer.tail->count.store(count + 1, std::memory_order_release);
+    }
+
+
+    // begin and end are HostClockTicks() values, e.g. from GpuClockCalibration. GPU results
+    // arrive frames late, so events inside the last capture window are still accepted
+    // after EndCapture().
+    void
+    AddGpuEvent(const char* name, uint64_t begin, uint64_t end)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (end <= beginHost) return;
+        if (!Capturing() && (endHost <= beginHost || begin >= endHost)) return;
+
+        Event event = { name, begin, end };
+        gpuEvents.push_back(event);
+    }
+
+
+    // value of counter for the series (e.g. a pass) at hostTicks, a HostClockTicks() value.
+    // Accepted like AddGpuEvent(); series must be a string with static storage duration.
+    void
+    AddGpuCounter(const std::string& counter, const char* series, uint64_t hostTicks, double value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hostTicks <= beginHost) return;
+        if (!Capturing() && (endHost <= beginHost || hostTicks >= endHost)) return;
+
+        CounterSample sample = { counter, series, hostTicks, value };
+        counterSamples.push_back(sample);
+    }
+
+
+    // Writes the last completed capture; call a few frames after EndCapture(), once the GPU
+    // profiler has read back the capture's last frames, and before the next BeginCapture().
+    void
+    WriteChromeTrace(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("[ ERROR ] Failed to open trace file " + path + ".");
+        }
+
+        // Time stamp counter to host ticks, fitted over the capture window.
+        double ticksPerTimestamp = endTimestamp > beginTimestamp ?
+            static_cast<double>(endHost - beginHost) / static_cast<double>(endTimestamp - beginTimestamp) : 1.0;
+        double microsecondsPerTick = 1e6 / HostClockFrequency();
+
+        // Microseconds with nanosecond resolution, however long the capture.
+        file << std::fixed;
+        file.precision(3);
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+        uint32_t eventCount = 0;
+        uint32_t generation = captureGeneration.load(std::memory_order_relaxed);
+        for (size_t thread = 0; thread < threads.size(); thread++)
+        {
+            const ThreadBuffer& buffer = *threads[thread];
+            std::string         name   = buffer.name.empty() ? "Thread " + std::to_string(thread) : buffer.name;
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+                 << ",\"args\":{\"name\":\"" << EscapeJson(name) << "\"}}";
+
+            if (buffer.generation.load(std::memory_order_acquire) != generation) continue;
+            for (const Chunk* chunk = buffer.head.get(); chunk; chunk = chunk->next.get())
+            {
+                uint32_t count = chunk->count.load(std::memory_order_acquire);
+                for (uint32_t ii = 0; ii < count; ii++)
+                {
+                    const Event& event = chunk->events[ii];
+                    double begin = (static_cast<double>(event.begin) - static_cast<double>(beginTimestamp)) *
+                                   ticksPerTimestamp * microsecondsPerTick;
+                    double duration = static_cast<double>(event.end - event.begin) * ticksPerTimestamp *
+                                      microsecondsPerTick;
+                    WriteEvent(file, event.name, 1, thread, begin, duration);
+                    eventCount++;
+                }
+                if (count < TRACE_CHUNK_EVENTS) break;
+            }
+        }
+
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"Queue\"}}";
+        for (const Event& event : gpuEvents)
+        {
+            double begin    = (static_cast<double>(event.begin) - static_cast<double>(beginHost)) * microsecondsPerTick;
+            double duration = static_cast<double>(event.end - event.begin) * microsecondsPerTick;
+            WriteEvent(file, event.name, 2, 0, begin, duration);
+            eventCount++;
+        }
+        for (const CounterSample& sample : counterSamples)
+        {
+            double time = (static_cast<double>(sample.time) - static_cast<double>(beginHost)) * microsecondsPerTick;
+            file << ",\n{\"name\":\"" << EscapeJson(sample.counter) << "\",\"ph\":\"C\",\"pid\":2,\"ts\":" << time
+                 << ",\"args\":{\"" << EscapeJson(sample.series) << "\":" << sample.value << "}}";
+            eventCount++;
+        }
+        file << "\n]}\n";
+
+        std::cout << "[ INFO ] Wrote " << eventCount << " trace events to " << path << "." << std::endl;
+    }
+
+
+private:
+    struct Event
+    {
+        const char* name;
+        uint64_t    begin;
+        uint64_t    end;
+    };
+
+
+    struct CounterSample
+    {
+        std::string counter;
+        const char* series;
+        uint64_t    time;
+        double      value;
+    };
+
+
+    struct Chunk
+    {
+        Event                  events[TRACE_CHUNK_EVENTS];
+        std::atomic<uint32_t>  count{ 0 };
+        std::unique_ptr<Chunk> next;
+    };
+
+
+    // Written only by its thread; the exporter reads published counts.
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Chunk> head{ new Chunk() };
+        Chunk*                 tail = head.get();
+        std::atomic<uint32_t>  generation{ 0 };
+        std::string            name;
+    };
+
+
+    Tracer() = default;
+
+
+    // Registered under the lock once per thread; buffers live as long as the tracer.
+    ThreadBuffer&
+    LocalBuffer()
+    {
+        static thread_local ThreadBuffer* local = nullptr;
+        if (!local)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.emplace_back(new ThreadBuffer());
+            local = threads.back().get();
+        }
+        return *local;
+    }
+
+
+    static void
+    WriteEvent(std::ofstream& file, const char* name, int process, size_t thread, double begin, double duration)
+    {
+        file << ",\n{\"name\":\"" << EscapeJson(name) << "\",\"ph\":\"X\",\"pid\":" << process << ",\"tid\":" << thread
+             << ",\"ts\":" << begin << ",\"dur\":" << duration << "}";
+    }
+
+    std::mutex                                 mutex;
+    std::atomic<bool>                          capturing{ false };
+    std::atomic<uint32_t>                      captureGeneration{ 0 };
+    uint64_t                                   beginTimestamp = 0;
+    uint64_t                                   endTimestamp   = 0;
+    uint64_t                                   beginHost      = 0;
+    uint64_t                                   endHost        = 0;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    std::vector<Event>                         gpuEvents;
+    std::vector<CounterSample>                 counterSamples;
+};
+
+
+// Traces the lifetime of the object on the calling thread's track:
+//   { TraceScope scope("Record frame"); ... }
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* scopeName)
+        : name(scopeName), active(Tracer::Instance().Capturing())
+    {
+        if (active) begin = TraceTimestamp();
+    }
+
+
+    ~TraceScope()
+    {
+        if (active) Tracer::Instance().AddCpuEvent(name, begin, TraceTimestamp());
+    }
+
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+
+private:
+    const char* name;
+    bool        active;
+    uint64_t    begin = 0;
+};
+
+
+// Maps device timestamps to HostClockTicks() through VK_EXT_calibrated_timestamps.
+class GpuClockCalibration
+{
+public:
+    // extensionEnabled: VK_EXT_calibrated_timestamps is enabled on the device.
+    void
+    Create(VkInstance instance, VkPhysicalDevice gpu, VkDevice logicalDevice, bool extensionEnabled)
+    {
+        device = logicalDevice;
+        if (!extensionEnabled) return;
+
+        auto getTimeDomains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+            vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+        getCalibratedTimestamps = LoadDeviceFunction<PFN_vkGetCalibratedTimestampsEXT>(
+            device, "vkGetCalibratedTimestampsEXT");
+        if (!getTimeDomains || !getCalibratedTimestamps) return;
+
+        uint32_t domainCount = 0;
+        getTimeDomains(gpu, &domainCount, nullptr);
+        std::vector<VkTimeDomainEXT> domains(domainCount);
+        getTimeDomains(gpu, &domainCount, domains.data());
+
+        bool deviceDomain = false;
+        bool hostDomain   = false;
+        for (VkTimeDomainEXT domain : domains)
+        {
+            deviceDomain = deviceDomain || domain == VK_TIME_DOMAIN_DEVICE_EXT;
+            hostDomain   = hostDomain || domain == HostTimeDomain();
+        }
+        if (!deviceDomain || !hostDomain)
+        {
+            std::cout << "[ INFO ] GPU clock calibration unavailable: missing time domain." << std::endl;
+            return;
+        }
+
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(gpu, &properties);
+        hostTicksPerDeviceTick = properties.limits.timestampPeriod * 1e-9 * HostClockFrequency();
+        available              = true;
+        Calibrate();
+    }
+
+
+    // Call once per frame; a fresh pair keeps drift between the clocks out of the trace.
+    void
+    Calibrate()
+    {
+        if (!available) return;
+
+        VkCalibratedTimestampInfoEXT infos[2] = {};
+        infos[0].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+        infos[1].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[1].timeDomain = HostTimeDomain();
+
+        uint64_t timestamps[2] = {};
+        uint64_t maxDeviation  = 0;
+        if (getCalibratedTimestamps(device, 2, infos, timestamps, &maxDeviation) == VK_SUCCESS)
+        {
+            deviceTimestamp = timestamps[0];
+            hostTimestamp   = timestamps[1];
+        }
+    }
+
+
+    bool
+    Available() const
+    {
+        return available;
+    }
+
+
+    uint64_t
+    ToHostTicks(uint64_t deviceTicks) const
+    {
+        double offset = static_cast<double>(static_cast<int64_t>(deviceTicks - deviceTimestamp)) * hostTicksPerDeviceTick;
+        return static_cast<uint64_t>(static_cast<double>(hostTimestamp) + offset);
+    }
+
+
+    // Routes the profiler's scopes into the tracer's GPU track.
+    void
+    ConnectProfiler(GpuProfiler& profiler) const
+    {
+        if (!available) return;
+
+        const GpuClockCalibration* calibration = this;
+        profiler.SetTimestampCallback([calibration](const char* name, uint64_t begin, uint64_t end)
+        {
+            Tracer::Instance().AddGpuEvent(name, calibration->ToHostTicks(begin), calibration->ToHostTicks(end));
+        });
+    }
+
+
+private:
+    VkDevice                         device                  = VK_NULL_HANDLE;
+    PFN_vkGetCalibratedTimestampsEXT getCalibratedTimestamps = nullptr;
+    bool                             available               = false;
+    double                           hostTicksPerDeviceTick  = 1.0;
+    uint64_t                         deviceTimestamp         = 0;
+    uint64_t                         hostTimestamp           = 0;
+};
+
+#endif // TRACING_H
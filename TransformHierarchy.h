@@ -0,0 +1,274 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+// Scene graph transforms stored as structure of arrays, sorted by depth.
+//
+// Every node lives at an index in depth order, so all parents of level N are finished
+// before level N is touched and each level is one parallel loop over contiguous arrays;
+// no pointers are chased. Callers hold stable handles, which Add() returns and which
+// survive the re-sort that follows topology changes.
+//
+// Setting a local transform flags the node; Update() propagates the flag to descendants
+// level by level and only recomposes flagged nodes, so static subtrees cost one byte
+// read per node. World matrices are multiplied with glm_mat4_mul (glm/simd/matrix.h)
+// when glm reports SSE2 (see FrustumCulling.h for the GLM_FORCE_* notes).
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include <glm/simd/matrix.h>
+#endif
+
+#include "JobSystem.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+const uint32_t TRANSFORM_NO_PARENT = 0xFFFFFFFF;
+
+
+class TransformHierarchy
+{
+public:
+    // parent is a handle returned earlier, or TRANSFORM_NO_PARENT for a root.
+    uint32_t
+    Add(uint32_t parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        if (parent != TRANSFORM_NO_PARENT && parent >= handleToIndex.size())
+        {
+            throw std::runtime_error("[ ERROR ] Transform parent handle is invalid.");
+        }
+
+        uint32_t handle = static_cast<uint32_t>(handleToIndex.size());
+        uint32_t index  = static_cast<uint32_t>(positions.size());
+        handleToIndex.push_back(index);
+        indexToHandle.push_back(handle);
+
+        positions.push_back(position);
+        rotations.push_back(rotation);
+        scales.push_back(scale);
+        parents.push_back(parent == TRANSFORM_NO_PARENT ? TRANSFORM_NO_PARENT : handleToIndex[parent]);
+        depths.push_back(parent == TRANSFORM_NO_PARENT ? 0 : depths[handleToIndex[parent]] + 1);
+        dirty.push_back(1);
+        worlds.push_back(glm::mat4(1.0f));
+
+        sorted = false;
+        return handle;
+    }
+
+
+    void
+    SetPosition(uint32_t handle, const glm::vec3& position)
+    {
+        uint32_t index = handleToIndex[handle];
+        positions[index] = position;
+        dirty[index]     = 1;
+    }
+
+
+    void
+    SetRotation(uint32_t handle, const glm::quat& rotation)
+    {
+        uint32_t index = handleToIndex[handle];
+        rotations[index] = rotation;
+        dirty[index]     = 1;
+    }
+
+
+    void
+    SetScale(uint32_t handle, const glm::vec3& scale)
+    {
+        uint32_t index = handleToIndex[handle];
+        scales[index] = scale;
+        dirty[index]  = 1;
+    }
+
+
+    // Recomputes the world matrices of every flagged node and its descendants. Returns the
+    // number of nodes recomputed.
+    uint32_t
+    Update(JobSystem& jobs)
+    {
+        if (!sorted) SortByDepth();
+
+        const size_t grainSize = 1024;
+
+        std::vector<uint32_t> levelUpdates(levelStarts.size(), 0);
+        for (size_t level = 0; level + 1 < levelStarts.size(); level++)
+        {
+            size_t begin = levelStarts[level];
+            size_t count = levelStarts[level + 1] - begin;
+            std::atomic<uint32_t> updated(0);
+            jobs.ParallelFor(count, grainSize, [&](size_t rangeBegin, size_t rangeEnd)
+            {
+                updated += UpdateRange(begin + rangeBegin, begin + rangeEnd);
+            });
+            levelUpdates[level] = updated;
+        }
+
+        // Flags are cleared only now: children read their parent's flag during the pass.
+        std::fill(dirty.begin(), dirty.end(), static_cast<uint8_t>(0));
+
+        uint32_t total = 0;
+        for (uint32_t count : levelUpdates) total += count;
+        return total;
+    }
+
+
+    const glm::mat4&
+    World(uint32_t handle) const
+    {
+        return worlds[handleToIndex[handle]];
+    }
+
+
+    // Depth sorted world matrices, e.g. for a bulk upload; see IndexOf().
+    const std::vector<glm::mat4>&
+    Worlds() const
+    {
+        return worlds;
+    }
+
+
+    uint32_t
+    IndexOf(uint32_t handle) const
+    {
+        return handleToIndex[handle];
+    }
+
+
+    size_t
+    Count() const
+    {
+        return positions.size();
+    }
+
+
+private:
+    static glm::mat4
+    ComposeLocal(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        glm::mat4 local = glm::mat4_cast(rotation);
+        local[0] *= scale.x;
+        local[1] *= scale.y;
+        local[2] *= scale.z;
+        local[3]  = glm::vec4(position, 1.0f);
+        return local;
+    }
+
+
+    static void
+    Multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& world)
+    {
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+        glm_vec4 left[4];
+        glm_vec4 right[4];
+        glm_vec4 result[4];
+        for (int column = 0; column < 4; column++)
+        {
+            left[column]  = _mm_loadu_ps(&parent[column][0]);
+            right[column] = _mm_loadu_ps(&local[column][0]);
+        }
+
+        glm_mat4_mul(left, right, result);
+        for (int column = 0; column < 4; column++)
+        {
+            _mm_storeu_ps(&world[column][0], result[column]);
+        }
+#else
+        world = parent * local;
+#endif
+    }
+
+
+    uint32_t
+    UpdateRange(size_t begin, size_t end)
+    {
+        uint32_t updated = 0;
+        for (size_t ii = begin; ii < end; ii++)
+        {
+            uint32_t parent = parents[ii];
+            if (parent != TRANSFORM_NO_PARENT && dirty[parent]) dirty[ii] = 1;
+            if (!dirty[ii]) continue;
+
+            glm::mat4 local = ComposeLocal(positions[ii], rotations[ii], scales[ii]);
+            if (parent == TRANSFORM_NO_PARENT) worlds[ii] = local;
+            else Multiply(worlds[parent], local, worlds[ii]);
+            updated++;
+        }
+        return updated;
+    }
+
+
+    // Stable counting sort by depth; within a level nodes keep their creation order.
+    void
+    SortByDepth()
+    {
+        const size_t count    = positions.size();
+        uint32_t     maxDepth = 0;
+        for (uint32_t depth : depths) maxDepth = std::max(maxDepth, depth);
+
+        levelStarts.assign(maxDepth + 2, 0);
+        for (uint32_t depth : depths) levelStarts[depth + 1]++;
+        for (size_t level = 1; level < levelStarts.size(); level++) levelStarts[level] += levelStarts[level - 1];
+
+        std::vector<uint32_t> newIndex(count);
+        std::vector<uint32_t> cursor(levelStarts.begin(), levelStarts.end() - 1);
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            newIndex[ii] = cursor[depths[ii]]++;
+        }
+
+        Permute(positions, newIndex);
+        Permute(rotations, newIndex);
+        Permute(scales, newIndex);
+        Permute(depths, newIndex);
+        Permute(dirty, newIndex);
+        Permute(worlds, newIndex);
+        Permute(indexToHandle, newIndex);
+        Permute(parents, newIndex);
+        for (auto& parent : parents)
+        {
+            if (parent != TRANSFORM_NO_PARENT) parent = newIndex[parent];
+        }
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            handleToIndex[indexToHandle[ii]] = static_cast<uint32_t>(ii);
+        }
+
+        sorted = true;
+    }
+
+
+    template<typename T>
+    static void
+    Permute(std::vector<T>& values, const std::vector<uint32_t>& newIndex)
+    {
+        std::vector<T> permuted(values.size());
+        for (size_t ii = 0; ii < values.size(); ii++)
+        {
+            permuted[newIndex[ii]] = values[ii];
+        }
+        values.swap(permuted);
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<uint32_t>  parents; // Indices, not handles
+    std::vector<uint32_t>  depths;
+    std::vector<uint8_t>   dirty;
+    std::vector<glm::mat4> worlds;
+    std::vector<uint32_t>  handleToIndex;
+    std::vector<uint32_t>  indexToHandle;
+    std::vector<size_t>    levelStarts;
+    bool                   sorted = true;
+};
+
+#endif // TRANSFORM_HIERARCHY_H
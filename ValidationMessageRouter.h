@@ -0,0 +1,413 @@
+#ifndef VALIDATION_MESSAGE_ROUTER_H
+#define VALIDATION_MESSAGE_ROUTER_H
+
+// Routes VK_EXT_debug_utils messages off the calling thread.
+//
+// The debug callback runs inside whatever Vulkan call produced the message, on any thread.
+// Route() therefore never blocks and never touches a stream: it looks the message's
+// messageIdNumber up in a fixed, lock-free table, drops it if the ID is muted or already
+// over its rate limit, and otherwise copies it into a bounded multi-producer queue (Dmitry
+// Vyukov's sequence-numbered ring). A logger thread drains the queue and writes whole
+// batches with a single flush.
+//
+// Rate limiting is per ID: up to burst messages pass per window, the rest are counted and
+// reported as one summary line when the window ends. Layers other than validation report
+// messageIdNumber 0 for everything, so those messages are limited per pMessageIdName
+// instead, and pass unlimited when they have no name either. IDs can be muted and unmuted
+// at any time from any thread. Messages that find the queue full are counted as dropped rather
+// than waited on.
+
+#include <vulkan/vulkan.h>
+
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+
+const uint32_t VALIDATION_ROUTER_QUEUE_SIZE   = 1024; // Power of two
+const uint32_t VALIDATION_ROUTER_MESSAGE_SIZE = 1024; // Longer messages are truncated
+const uint32_t VALIDATION_ROUTER_NAME_SIZE    = 96;
+const uint32_t VALIDATION_ROUTER_ID_SLOTS     = 4096; // Power of two; distinct IDs tracked
+
+
+class ValidationMessageRouter
+{
+public:
+    static ValidationMessageRouter&
+    Instance()
+    {
+        static ValidationMessageRouter router;
+        return router;
+    }
+
+
+    ValidationMessageRouter(const ValidationMessageRouter&) = delete;
+    ValidationMessageRouter& operator=(const ValidationMessageRouter&) = delete;
+
+
+    ~ValidationMessageRouter()
+    {
+        Stop();
+    }
+
+
+    // Messages routed before Start() wait in the queue until the logger picks them up.
+    void
+    Start(uint32_t burst = 5, uint32_t windowMs = 1000)
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        if (logger.joinable()) return;
+
+        burstLimit.store(burst, std::memory_order_relaxed);
+        windowTicks.store(static_cast<int64_t>(windowMs) * 1000000, std::memory_order_relaxed);
+        stopRequested.store(false, std::memory_order_relaxed);
+        logger = std::thread(&ValidationMessageRouter::LoggerLoop, this);
+    }
+
+
+    // Drains the queue, reports pending suppression counts and joins the logger.
+    void
+    Stop()
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        if (!logger.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> wakeLock(wakeMutex);
+            stopRequested.store(true, std::memory_order_relaxed);
+        }
+        wake.notify_one();
+        logger.join();
+    }
+
+
+    void
+    Mute(int32_t messageId)
+    {
+        IdSlot* slot = FindSlot(messageId, true);
+        if (slot) slot->muted.store(true, std::memory_order_relaxed);
+    }
+
+
+    void
+    Unmute(int32_t messageId)
+    {
+        IdSlot* slot = FindSlot(messageId, false);
+        if (slot) slot->muted.store(false, std::memory_order_relaxed);
+    }
+
+
+    bool
+    Muted(int32_t messageId)
+    {
+        IdSlot* slot = FindSlot(messageId, false);
+        return slot && slot->muted.load(std::memory_order_relaxed);
+    }
+
+
+    // Messages lost to a full queue so far.
+    uint64_t
+    DroppedCount() const
+    {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+
+    // Call from the debug utils callback; always returns VK_FALSE.
+    VkBool32
+    Route(VkDebugUtilsMessageSeverityFlagBitsEXT      severity,
+          const VkDebugUtilsMessengerCallbackDataEXT* callbackData)
+    {
+        int64_t key  = MessageKey(callbackData);
+        IdSlot* slot = key != ID_SLOT_EMPTY ? FindSlot(key, true) : nullptr;
+        if (slot && !Admit(*slot)) return VK_FALSE;
+
+        // Vyukov bounded queue: claim a cell whose sequence matches the position.
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Cell*  cell     = nullptr;
+        for (;;)
+        {
+            cell = &cells[position & (VALIDATION_ROUTER_QUEUE_SIZE - 1)];
+            size_t   sequence   = cell->sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (difference < 0)
+            {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return VK_FALSE;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->key       = key;
+        cell->severity  = severity;
+        CopyTruncated(cell->name, VALIDATION_ROUTER_NAME_SIZE, callbackData->pMessageIdName);
+        CopyTruncated(cell->text, VALIDATION_ROUTER_MESSAGE_SIZE, callbackData->pMessage);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return VK_FALSE;
+    }
+
+
+private:
+    struct IdSlot
+    {
+        std::atomic<int64_t>  key;          // ID_SLOT_EMPTY or MessageKey()
+        std::atomic<bool>     muted;
+        std::atomic<int64_t>  windowStart;  // Steady clock nanoseconds
+        std::atomic<uint32_t> windowCount;
+        std::atomic<uint32_t> suppressed;   // Since the last summary
+    };
+
+    struct Cell
+    {
+        std::atomic<size_t>                    sequence;
+        int64_t                                key       = 0;
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity  = VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+        char                                   name[VALIDATION_ROUTER_NAME_SIZE];
+        char                                   text[VALIDATION_ROUTER_MESSAGE_SIZE];
+    };
+
+    static const int64_t ID_SLOT_EMPTY = INT64_MIN;
+    static const int64_t NAME_KEY_BIT  = INT64_C(1) << 32; // Keys above int32_t: hashed names
+
+
+    ValidationMessageRouter()
+        : idSlots(new IdSlot[VALIDATION_ROUTER_ID_SLOTS]),
+          cells(new Cell[VALIDATION_ROUTER_QUEUE_SIZE])
+    {
+        for (uint32_t ii = 0; ii < VALIDATION_ROUTER_ID_SLOTS; ii++)
+        {
+            idSlots[ii].key.store(ID_SLOT_EMPTY, std::memory_order_relaxed);
+            idSlots[ii].muted.store(false, std::memory_order_relaxed);
+            idSlots[ii].windowStart.store(0, std::memory_order_relaxed);
+            idSlots[ii].windowCount.store(0, std::memory_order_relaxed);
+            idSlots[ii].suppressed.store(0, std::memory_order_relaxed);
+        }
+        for (uint32_t ii = 0; ii < VALIDATION_ROUTER_QUEUE_SIZE; ii++)
+        {
+            cells[ii].sequence.store(ii, std::memory_order_relaxed);
+        }
+    }
+
+
+    static int64_t
+    Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
+    static void
+    CopyTruncated(char* destination, size_t capacity, const char* source)
+    {
+        size_t length = source ? std::strlen(source) : 0;
+        if (length >= capacity)
+        {
+            length = capacity - 1;
+            std::memcpy(destination, source, length - 3);
+            std::memcpy(destination + length - 3, "...", 3);
+        }
+        else if (length)
+        {
+            std::memcpy(destination, source, length);
+        }
+        destination[length] = '\0';
+    }
+
+
+    // The message ID, or for ID 0 the FNV-1a hash of the ID name above the int32_t range.
+    // ID_SLOT_EMPTY when neither identifies the message.
+    static int64_t
+    MessageKey(const VkDebugUtilsMessengerCallbackDataEXT* callbackData)
+    {
+        if (callbackData->messageIdNumber != 0) return callbackData->messageIdNumber;
+
+        const char* name = callbackData->pMessageIdName;
+        if (!name || !*name) return ID_SLOT_EMPTY;
+
+        uint32_t hash = 2166136261u;
+        for (; *name; name++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+        }
+        return NAME_KEY_BIT | hash;
+    }
+
+
+    // Open addressing with linear probing; slots are claimed with a CAS and never freed.
+    // Returns nullptr when the table is full (such IDs are neither limited nor mutable).
+    IdSlot*
+    FindSlot(int64_t messageKey, bool insert)
+    {
+        uint32_t hash = static_cast<uint32_t>(messageKey ^ (messageKey >> 32)) * 2654435761u;
+        for (uint32_t probe = 0; probe < VALIDATION_ROUTER_ID_SLOTS; probe++)
+        {
+            IdSlot& slot = idSlots[(hash + probe) & (VALIDATION_ROUTER_ID_SLOTS - 1)];
+            int64_t key  = slot.key.load(std::memory_order_acquire);
+            if (key == messageKey) return &slot;
+            if (key != ID_SLOT_EMPTY) continue;
+            if (!insert) return nullptr;
+
+            int64_t expected = ID_SLOT_EMPTY;
+            if (slot.key.compare_exchange_strong(expected, messageKey, std::memory_order_acq_rel) ||
+                expected == messageKey)
+            {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+
+    // Per ID rate limit; racing threads may let a message or two beyond the burst through.
+    bool
+    Admit(IdSlot& slot)
+    {
+        if (slot.muted.load(std::memory_order_relaxed)) return false;
+
+        int64_t now         = Now();
+        int64_t windowStart = slot.windowStart.load(std::memory_order_relaxed);
+        if (now - windowStart >= windowTicks.load(std::memory_order_relaxed) &&
+            slot.windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+        {
+            slot.windowCount.store(0, std::memory_order_relaxed);
+        }
+
+        if (slot.windowCount.fetch_add(1, std::memory_order_relaxed) < burstLimit.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+        slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+
+    bool
+    Dequeue(std::ostringstream& info, std::ostringstream& errors)
+    {
+        Cell*  cell     = &cells[dequeuePosition & (VALIDATION_ROUTER_QUEUE_SIZE - 1)];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (sequence != dequeuePosition + 1) return false;
+
+        if (names.find(cell->key) == names.end())
+        {
+            names[cell->key] = cell->name;
+        }
+        if (cell->severity == VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+        {
+            info << "[ INFO ] Validation layer: " << cell->text << "\n";
+        }
+        else
+        {
+            errors << "[ ERROR ] Validation layer: " << cell->text << "\n";
+        }
+
+        cell->sequence.store(dequeuePosition + VALIDATION_ROUTER_QUEUE_SIZE, std::memory_order_release);
+        dequeuePosition++;
+        return true;
+    }
+
+
+    void
+    ReportSuppressed(std::ostringstream& info)
+    {
+        for (uint32_t ii = 0; ii < VALIDATION_ROUTER_ID_SLOTS; ii++)
+        {
+            int64_t key = idSlots[ii].key.load(std::memory_order_acquire);
+            if (key == ID_SLOT_EMPTY) continue;
+
+            uint32_t suppressed = idSlots[ii].suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed == 0) continue;
+
+            auto name = names.find(key);
+            info << "[ INFO ] Validation layer: suppressed " << suppressed << " repeats of "
+                 << (name != names.end() && !name->second.empty() ? name->second : "message");
+            if (key < NAME_KEY_BIT)
+            {
+                info << " (0x" << std::hex << static_cast<uint32_t>(key) << std::dec << ")";
+            }
+            info << "\n";
+        }
+    }
+
+
+    void
+    LoggerLoop()
+    {
+        int64_t lastReport = Now();
+        for (;;)
+        {
+            bool stopping = stopRequested.load(std::memory_order_relaxed);
+
+            std::ostringstream info;
+            std::ostringstream errors;
+            uint32_t           batch = 0;
+            while (batch < VALIDATION_ROUTER_QUEUE_SIZE && Dequeue(info, errors))
+            {
+                batch++;
+            }
+
+            int64_t now = Now();
+            if (stopping || now - lastReport >= windowTicks.load(std::memory_order_relaxed))
+            {
+                ReportSuppressed(info);
+                lastReport = now;
+            }
+
+            std::string infoText  = info.str();
+            std::string errorText = errors.str();
+            if (!infoText.empty())  std::cout << infoText << std::flush;
+            if (!errorText.empty()) std::cerr << errorText << std::flush;
+
+            if (stopping && batch == 0)
+            {
+                uint64_t dropped = droppedCount.load(std::memory_order_relaxed);
+                if (dropped)
+                {
+                    std::cerr << "[ ERROR ] Validation layer: " << dropped << " messages dropped, queue full." << std::endl;
+                }
+                return;
+            }
+            if (batch == 0)
+            {
+                // Producers never signal; polling keeps Route() free of syscalls.
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait_for(lock, std::chrono::milliseconds(5), [this]() { return stopRequested.load(); });
+            }
+        }
+    }
+
+
+    std::unique_ptr<IdSlot[]>                   idSlots;
+    std::unique_ptr<Cell[]>                     cells;
+    std::atomic<size_t>                         enqueuePosition { 0 };
+    size_t                                      dequeuePosition = 0; // Logger thread only
+    std::unordered_map<int64_t, std::string>    names;               // Logger thread only
+
+    std::atomic<uint32_t>                       burstLimit { 5 };
+    std::atomic<int64_t>                        windowTicks { 1000000000 };
+    std::atomic<uint64_t>                       droppedCount { 0 };
+
+    std::mutex                                  controlMutex;
+    std::mutex                                  wakeMutex;
+    std::condition_variable                     wake;
+    std::atomic<bool>                           stopRequested { false };
+    std::thread                                 logger;
+};
+
+#endif // VALIDATION_MESSAGE_ROUTER_H
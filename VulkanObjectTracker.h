@@ -0,0 +1,579 @@
+#ifndef VULKAN_OBJECT_TRACKER_H
+#define VULKAN_OBJECT_TRACKER_H
+
+// Debug build tracker for Vulkan object and device memory lifetimes.
+//
+// Include right after <vulkan/vulkan.h> (GLFW's include of it counts) and before any
+// header that creates Vulkan objects. With VULKAN_OBJECT_TRACKER enabled (the default
+// unless NDEBUG), the vkCreate*/vkDestroy*, vkAllocateMemory/vkFreeMemory and pipeline
+// creation calls below are redirected by function-like macros to wrappers. The wrappers
+// record the handle, its size for memory, and a raw creation callstack, then forward
+// through a device dispatch table loaded with vkGetDeviceProcAddr once Attach() is
+// called. Before that, and for other devices, they forward to the loader. Code that must
+// reach the real entry point can write (vkCreateBuffer)(...); the parentheses suppress
+// the macro.
+//
+// Capturing a callstack is a plain frame pointer walk (RtlCaptureStackBackTrace /
+// backtrace()); symbols are only resolved for the leak report, which Detach() prints
+// before the device is destroyed. Leaks are listed with the object's VK_EXT_debug_utils
+// name when it was set through SetObjectName().
+//
+// Descriptor sets and command buffers are owned by their pools and not tracked
+// individually. Windows symbolization uses DbgHelp, linked through #pragma comment
+// because build_vulkan.bat does not list dbghelp.lib.
+
+#ifndef VULKAN_OBJECT_TRACKER
+#ifdef NDEBUG
+#define VULKAN_OBJECT_TRACKER 0
+#else
+#define VULKAN_OBJECT_TRACKER 1
+#endif
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <dbghelp.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "dbghelp.lib")
+#endif
+#else
+#include <execinfo.h>
+#endif
+
+#include <vulkan/vulkan.h>
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+const uint32_t VULKAN_TRACKER_STACK_DEPTH = 16;
+
+
+// Objects whose create/destroy pair follows vkCreate<Name>(device, const Vk<Name>CreateInfo*,
+// allocator, Vk<Name>*) / vkDestroy<Name>(device, Vk<Name>, allocator).
+#define VULKAN_TRACKER_OBJECTS(X)                                      \
+    X(Buffer,              VK_OBJECT_TYPE_BUFFER)                      \
+    X(Image,               VK_OBJECT_TYPE_IMAGE)                       \
+    X(ImageView,           VK_OBJECT_TYPE_IMAGE_VIEW)                  \
+    X(Sampler,             VK_OBJECT_TYPE_SAMPLER)                     \
+    X(ShaderModule,        VK_OBJECT_TYPE_SHADER_MODULE)               \
+    X(PipelineLayout,      VK_OBJECT_TYPE_PIPELINE_LAYOUT)             \
+    X(PipelineCache,       VK_OBJECT_TYPE_PIPELINE_CACHE)              \
+    X(DescriptorSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT)       \
+    X(DescriptorPool,      VK_OBJECT_TYPE_DESCRIPTOR_POOL)             \
+    X(RenderPass,          VK_OBJECT_TYPE_RENDER_PASS)                 \
+    X(Framebuffer,         VK_OBJECT_TYPE_FRAMEBUFFER)                 \
+    X(CommandPool,         VK_OBJECT_TYPE_COMMAND_POOL)                \
+    X(Fence,               VK_OBJECT_TYPE_FENCE)                       \
+    X(Semaphore,           VK_OBJECT_TYPE_SEMAPHORE)                   \
+    X(Event,               VK_OBJECT_TYPE_EVENT)                       \
+    X(QueryPool,           VK_OBJECT_TYPE_QUERY_POOL)
+
+
+struct VulkanTrackerDispatch
+{
+#define VULKAN_TRACKER_DISPATCH_ENTRY(Name, ObjectType) \
+    PFN_vkCreate##Name  Create##Name  = nullptr;       \
+    PFN_vkDestroy##Name Destroy##Name = nullptr;
+    VULKAN_TRACKER_OBJECTS(VULKAN_TRACKER_DISPATCH_ENTRY)
+#undef VULKAN_TRACKER_DISPATCH_ENTRY
+
+    PFN_vkCreateGraphicsPipelines CreateGraphicsPipelines = nullptr;
+    PFN_vkCreateComputePipelines  CreateComputePipelines  = nullptr;
+    PFN_vkDestroyPipeline         DestroyPipeline         = nullptr;
+    PFN_vkAllocateMemory          AllocateMemory          = nullptr;
+    PFN_vkFreeMemory              FreeMemory              = nullptr;
+};
+
+
+template<typename Handle>
+inline uint64_t
+VulkanHandleValue(Handle handle)
+{
+    return (uint64_t)handle; // Pointer or uint64_t depending on the platform
+}
+
+
+inline const char*
+VulkanObjectTypeName(VkObjectType type)
+{
+    switch (type)
+    {
+#define VULKAN_TRACKER_TYPE_NAME(Name, ObjectType) case ObjectType: return "Vk" #Name;
+        VULKAN_TRACKER_OBJECTS(VULKAN_TRACKER_TYPE_NAME)
+#undef VULKAN_TRACKER_TYPE_NAME
+        case VK_OBJECT_TYPE_PIPELINE:      return "VkPipeline";
+        case VK_OBJECT_TYPE_DEVICE_MEMORY: return "VkDeviceMemory";
+        default:                           return "VkObject";
+    }
+}
+
+
+class VulkanObjectTracker
+{
+public:
+    static VulkanObjectTracker&
+    Instance()
+    {
+        static VulkanObjectTracker tracker;
+        return tracker;
+    }
+
+
+    VulkanObjectTracker(const VulkanObjectTracker&) = delete;
+    VulkanObjectTracker& operator=(const VulkanObjectTracker&) = delete;
+
+
+    // Call right after vkCreateDevice. Objects created earlier are tracked too, they
+    // just went through the loader.
+    void
+    Attach(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice logicalDevice)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        device   = logicalDevice;
+        dispatch = VulkanTrackerDispatch();
+
+#define VULKAN_TRACKER_LOAD(Name, ObjectType)                                                              \
+        dispatch.Create##Name  = (PFN_vkCreate##Name)vkGetDeviceProcAddr(device, "vkCreate" #Name);   \
+        dispatch.Destroy##Name = (PFN_vkDestroy##Name)vkGetDeviceProcAddr(device, "vkDestroy" #Name);
+        VULKAN_TRACKER_OBJECTS(VULKAN_TRACKER_LOAD)
+#undef VULKAN_TRACKER_LOAD
+
+        dispatch.CreateGraphicsPipelines = (PFN_vkCreateGraphicsPipelines)vkGetDeviceProcAddr(device, "vkCreateGraphicsPipelines");
+        dispatch.CreateComputePipelines  = (PFN_vkCreateComputePipelines)vkGetDeviceProcAddr(device, "vkCreateComputePipelines");
+        dispatch.DestroyPipeline         = (PFN_vkDestroyPipeline)vkGetDeviceProcAddr(device, "vkDestroyPipeline");
+        dispatch.AllocateMemory          = (PFN_vkAllocateMemory)vkGetDeviceProcAddr(device, "vkAllocateMemory");
+        dispatch.FreeMemory              = (PFN_vkFreeMemory)vkGetDeviceProcAddr(device, "vkFreeMemory");
+
+        // Only present when the instance enabled VK_EXT_debug_utils.
+        setObjectName = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT");
+
+        VkPhysicalDeviceMemoryProperties memoryProperties = {};
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        memoryTypeHeaps.assign(memoryProperties.memoryTypeCount, 0);
+        for (uint32_t ii = 0; ii < memoryProperties.memoryTypeCount; ii++)
+        {
+            memoryTypeHeaps[ii] = memoryProperties.memoryTypes[ii].heapIndex;
+        }
+        heapBytes.assign(memoryProperties.memoryHeapCount, 0);
+        for (const auto& entry : objects)
+        {
+            if (entry.second.type == VK_OBJECT_TYPE_DEVICE_MEMORY && entry.second.memoryType < memoryTypeHeaps.size())
+            {
+                heapBytes[memoryTypeHeaps[entry.second.memoryType]] += entry.second.bytes;
+            }
+        }
+    }
+
+
+    // Call right before vkDestroyDevice: reports everything still alive and drops the
+    // dispatch table. Returns the number of leaked objects.
+    size_t
+    Detach()
+    {
+        size_t leaks = ReportLeaks(std::cerr);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        device        = VK_NULL_HANDLE;
+        dispatch      = VulkanTrackerDispatch();
+        setObjectName = nullptr;
+        objects.clear();
+        return leaks;
+    }
+
+
+    // Records name for leak reports and forwards it to VK_EXT_debug_utils when enabled.
+    template<typename Handle>
+    void
+    SetObjectName(VkObjectType type, Handle handle, const std::string& name)
+    {
+        uint64_t value = VulkanHandleValue(handle);
+        PFN_vkSetDebugUtilsObjectNameEXT setName = nullptr;
+        VkDevice                         owner   = VK_NULL_HANDLE;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto object = objects.find(Key(type, value));
+            if (object != objects.end()) object->second.name = name;
+            setName = setObjectName;
+            owner   = device;
+        }
+
+        if (setName && owner != VK_NULL_HANDLE)
+        {
+            VkDebugUtilsObjectNameInfoEXT nameInfo = {};
+            nameInfo.sType        = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+            nameInfo.objectType   = type;
+            nameInfo.objectHandle = value;
+            nameInfo.pObjectName  = name.c_str();
+            setName(owner, &nameInfo);
+        }
+    }
+
+
+    void
+    PrintSummary() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unordered_map<std::string, size_t> counts;
+        for (const auto& entry : objects)
+        {
+            counts[VulkanObjectTypeName(entry.second.type)]++;
+        }
+
+        std::cout << "[ INFO ] Live Vulkan objects: " << objects.size() << "\n";
+        for (const auto& count : counts)
+        {
+            std::cout << "[ INFO ]     " << count.first << ": " << count.second << "\n";
+        }
+        for (size_t ii = 0; ii < heapBytes.size(); ii++)
+        {
+            std::cout << "[ INFO ]     heap " << ii << ": " << heapBytes[ii] / 1024 << " KB allocated\n";
+        }
+        std::cout.flush();
+    }
+
+
+    size_t
+    ReportLeaks(std::ostream& stream) const
+    {
+        std::vector<const Record*> leaks;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : objects)
+        {
+            leaks.push_back(&entry.second);
+        }
+        std::sort(leaks.begin(), leaks.end(), [](const Record* a, const Record* b) { return a->serial < b->serial; });
+
+        for (const Record* leak : leaks)
+        {
+            stream << "[ ERROR ] Leaked " << VulkanObjectTypeName(leak->type) << " 0x" << std::hex << leak->handle << std::dec;
+            if (!leak->name.empty())                        stream << " \"" << leak->name << "\"";
+            if (leak->type == VK_OBJECT_TYPE_DEVICE_MEMORY) stream << " (" << leak->bytes << " bytes)";
+            stream << ", created at:\n" << Symbolize(*leak);
+        }
+        if (!leaks.empty())
+        {
+            stream << "[ ERROR ] " << leaks.size() << " Vulkan objects leaked." << std::endl;
+        }
+        return leaks.size();
+    }
+
+
+    // Wrapper side; see the macros at the end of this file.
+    template<typename Handle>
+    void
+    OnCreate(VkObjectType type, Handle handle, VkDeviceSize bytes = 0, uint32_t memoryType = 0)
+    {
+        if (handle == VK_NULL_HANDLE) return;
+
+        Record record;
+        record.type       = type;
+        record.handle     = VulkanHandleValue(handle);
+        record.bytes      = bytes;
+        record.memoryType = memoryType;
+        record.frameCount = CaptureStack(record.frames);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        record.serial = nextSerial++;
+        if (type == VK_OBJECT_TYPE_DEVICE_MEMORY && memoryType < memoryTypeHeaps.size())
+        {
+            heapBytes[memoryTypeHeaps[memoryType]] += bytes;
+        }
+        objects[Key(type, record.handle)] = record;
+    }
+
+
+    template<typename Handle>
+    void
+    OnDestroy(VkObjectType type, Handle handle)
+    {
+        if (handle == VK_NULL_HANDLE) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto object = objects.find(Key(type, VulkanHandleValue(handle)));
+        if (object == objects.end()) return;
+
+        if (type == VK_OBJECT_TYPE_DEVICE_MEMORY && object->second.memoryType < memoryTypeHeaps.size())
+        {
+            heapBytes[memoryTypeHeaps[object->second.memoryType]] -= object->second.bytes;
+        }
+        objects.erase(object);
+    }
+
+
+    // Returns the device's dispatch table for device, nullptr for any other device (or
+    // before Attach()), in which case the wrapper calls the loader.
+    const VulkanTrackerDispatch*
+    Dispatch(VkDevice callingDevice) const
+    {
+        return callingDevice == device && device != VK_NULL_HANDLE ? &dispatch : nullptr;
+    }
+
+
+private:
+    struct Record
+    {
+        VkObjectType type       = VK_OBJECT_TYPE_UNKNOWN;
+        uint64_t     handle     = 0;
+        uint64_t     serial     = 0;
+        VkDeviceSize bytes      = 0;
+        uint32_t     memoryType = 0;
+        std::string  name;
+        void*        frames[VULKAN_TRACKER_STACK_DEPTH];
+        uint32_t     frameCount = 0;
+    };
+
+    struct KeyHash
+    {
+        size_t
+        operator()(const std::pair<uint32_t, uint64_t>& key) const
+        {
+            return std::hash<uint64_t>()(key.second * 0x9E3779B97F4A7C15ull + key.first);
+        }
+    };
+
+
+    VulkanObjectTracker() = default;
+
+
+    // Handles of different types may share values, so the type is part of the key.
+    static std::pair<uint32_t, uint64_t>
+    Key(VkObjectType type, uint64_t handle)
+    {
+        return std::make_pair(static_cast<uint32_t>(type), handle);
+    }
+
+
+    // Skips this function, OnCreate() and the wrapper.
+    static uint32_t
+    CaptureStack(void* frames[VULKAN_TRACKER_STACK_DEPTH])
+    {
+#ifdef _WIN32
+        return RtlCaptureStackBackTrace(3, VULKAN_TRACKER_STACK_DEPTH, frames, nullptr);
+#else
+        void* buffer[VULKAN_TRACKER_STACK_DEPTH + 3];
+        int   count = backtrace(buffer, VULKAN_TRACKER_STACK_DEPTH + 3);
+        int   kept  = std::max(count - 3, 0);
+        std::copy(buffer + std::min(count, 3), buffer + count, frames);
+        return static_cast<uint32_t>(kept);
+#endif
+    }
+
+
+    std::string
+    Symbolize(const Record& record) const
+    {
+        std::ostringstream text;
+#ifdef _WIN32
+        HANDLE process = GetCurrentProcess();
+        if (!symbolsInitialized)
+        {
+            SymSetOptions(SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
+            symbolsInitialized = SymInitialize(process, nullptr, TRUE) == TRUE;
+        }
+
+        char storage[sizeof(SYMBOL_INFO) + 256] = {};
+        SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(storage);
+        symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen   = 255;
+
+        for (uint32_t ii = 0; ii < record.frameCount; ii++)
+        {
+            DWORD64         address      = reinterpret_cast<DWORD64>(record.frames[ii]);
+            DWORD64         displacement = 0;
+            DWORD           lineOffset   = 0;
+            IMAGEHLP_LINE64 line         = {};
+            line.SizeOfStruct = sizeof(line);
+
+            text << "        ";
+            if (symbolsInitialized && SymFromAddr(process, address, &displacement, symbol)) text << symbol->Name;
+            else                                                                              text << record.frames[ii];
+            if (symbolsInitialized && SymGetLineFromAddr64(process, address, &lineOffset, &line))
+            {
+                text << " (" << line.FileName << ":" << line.LineNumber << ")";
+            }
+            text << "\n";
+        }
+#else
+        char** symbols = backtrace_symbols(record.frames, static_cast<int>(record.frameCount));
+        for (uint32_t ii = 0; ii < record.frameCount; ii++)
+        {
+            text << "        " << (symbols ? symbols[ii] : "?") << "\n";
+        }
+        std::free(symbols);
+#endif
+        return text.str();
+    }
+
+
+    mutable std::mutex                                                     mutex;
+    std::unordered_map<std::pair<uint32_t, uint64_t>, Record, KeyHash>     objects;
+    uint64_t                                                               nextSerial    = 0;
+    VkDevice                                                               device        = VK_NULL_HANDLE;
+    VulkanTrackerDispatch                                                  dispatch;
+    PFN_vkSetDebugUtilsObjectNameEXT                                       setObjectName = nullptr;
+    std::vector<uint32_t>                                                  memoryTypeHeaps;
+    std::vector<VkDeviceSize>                                              heapBytes;
+#ifdef _WIN32
+    mutable bool                                                           symbolsInitialized = false;
+#endif
+};
+
+
+// Wrappers with the exact signatures of the entry points they replace.
+#define VULKAN_TRACKER_WRAPPERS(Name, ObjectType)                                                            \
+    inline VkResult VKAPI_CALL                                                                               \
+    TrackedCreate##Name(VkDevice                      device,                                                \
+                        const Vk##Name##CreateInfo*   createInfo,                                            \
+                        const VkAllocationCallbacks*  allocator,                                             \
+                        Vk##Name*                     object)                                                \
+    {                                                                                                        \
+        const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);            \
+        VkResult result = dispatch ? dispatch->Create##Name(device, createInfo, allocator, object)           \
+                                   : (vkCreate##Name)(device, createInfo, allocator, object);                \
+        if (result == VK_SUCCESS) VulkanObjectTracker::Instance().OnCreate(ObjectType, *object);             \
+        return result;                                                                                       \
+    }                                                                                                        \
+                                                                                                             \
+    inline void VKAPI_CALL                                                                                   \
+    TrackedDestroy##Name(VkDevice device, Vk##Name object, const VkAllocationCallbacks* allocator)           \
+    {                                                                                                        \
+        VulkanObjectTracker::Instance().OnDestroy(ObjectType, object);                                       \
+        const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);            \
+        if (dispatch) dispatch->Destroy##Name(device, object, allocator);                                    \
+        else          (vkDestroy##Name)(device, object, allocator);                                          \
+    }
+VULKAN_TRACKER_OBJECTS(VULKAN_TRACKER_WRAPPERS)
+#undef VULKAN_TRACKER_WRAPPERS
+
+
+inline VkResult VKAPI_CALL
+TrackedCreateGraphicsPipelines(VkDevice                            device,
+                               VkPipelineCache                     pipelineCache,
+                               uint32_t                            createInfoCount,
+                               const VkGraphicsPipelineCreateInfo* createInfos,
+                               const VkAllocationCallbacks*        allocator,
+                               VkPipeline*                         pipelines)
+{
+    const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);
+    VkResult result = dispatch ? dispatch->CreateGraphicsPipelines(device, pipelineCache, createInfoCount, createInfos, allocator, pipelines)
+                               : (vkCreateGraphicsPipelines)(device, pipelineCache, createInfoCount, createInfos, allocator, pipelines);
+    for (uint32_t ii = 0; ii < createInfoCount; ii++)
+    {
+        VulkanObjectTracker::Instance().OnCreate(VK_OBJECT_TYPE_PIPELINE, pipelines[ii]);
+    }
+    return result;
+}
+
+
+inline VkResult VKAPI_CALL
+TrackedCreateComputePipelines(VkDevice                           device,
+                              VkPipelineCache                    pipelineCache,
+                              uint32_t                           createInfoCount,
+                              const VkComputePipelineCreateInfo* createInfos,
+                              const VkAllocationCallbacks*       allocator,
+                              VkPipeline*                        pipelines)
+{
+    const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);
+    VkResult result = dispatch ? dispatch->CreateComputePipelines(device, pipelineCache, createInfoCount, createInfos, allocator, pipelines)
+                               : (vkCreateComputePipelines)(device, pipelineCache, createInfoCount, createInfos, allocator, pipelines);
+    for (uint32_t ii = 0; ii < createInfoCount; ii++)
+    {
+        VulkanObjectTracker::Instance().OnCreate(VK_OBJECT_TYPE_PIPELINE, pipelines[ii]);
+    }
+    return result;
+}
+
+
+inline void VKAPI_CALL
+TrackedDestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks* allocator)
+{
+    VulkanObjectTracker::Instance().OnDestroy(VK_OBJECT_TYPE_PIPELINE, pipeline);
+    const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);
+    if (dispatch) dispatch->DestroyPipeline(device, pipeline, allocator);
+    else          (vkDestroyPipeline)(device, pipeline, allocator);
+}
+
+
+inline VkResult VKAPI_CALL
+TrackedAllocateMemory(VkDevice                     device,
+                      const VkMemoryAllocateInfo*  allocateInfo,
+                      const VkAllocationCallbacks* allocator,
+                      VkDeviceMemory*              memory)
+{
+    const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);
+    VkResult result = dispatch ? dispatch->AllocateMemory(device, allocateInfo, allocator, memory)
+                               : (vkAllocateMemory)(device, allocateInfo, allocator, memory);
+    if (result == VK_SUCCESS)
+    {
+        VulkanObjectTracker::Instance().OnCreate(VK_OBJECT_TYPE_DEVICE_MEMORY, *memory,
+                                                 allocateInfo->allocationSize, allocateInfo->memoryTypeIndex);
+    }
+    return result;
+}
+
+
+inline void VKAPI_CALL
+TrackedFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* allocator)
+{
+    VulkanObjectTracker::Instance().OnDestroy(VK_OBJECT_TYPE_DEVICE_MEMORY, memory);
+    const VulkanTrackerDispatch* dispatch = VulkanObjectTracker::Instance().Dispatch(device);
+    if (dispatch) dispatch->FreeMemory(device, memory, allocator);
+    else          (vkFreeMemory)(device, memory, allocator);
+}
+
+
+#if VULKAN_OBJECT_TRACKER
+#define vkCreateBuffer(...)              TrackedCreateBuffer(__VA_ARGS__)
+#define vkDestroyBuffer(...)             TrackedDestroyBuffer(__VA_ARGS__)
+#define vkCreateImage(...)               TrackedCreateImage(__VA_ARGS__)
+#define vkDestroyImage(...)              TrackedDestroyImage(__VA_ARGS__)
+#define vkCreateImageView(...)           TrackedCreateImageView(__VA_ARGS__)
+#define vkDestroyImageView(...)          TrackedDestroyImageView(__VA_ARGS__)
+#define vkCreateSampler(...)             TrackedCreateSampler(__VA_ARGS__)
+#define vkDestroySampler(...)            TrackedDestroySampler(__VA_ARGS__)
+#define vkCreateShaderModule(...)        TrackedCreateShaderModule(__VA_ARGS__)
+#define vkDestroyShaderModule(...)       TrackedDestroyShaderModule(__VA_ARGS__)
+#define vkCreatePipelineLayout(...)      TrackedCreatePipelineLayout(__VA_ARGS__)
+#define vkDestroyPipelineLayout(...)     TrackedDestroyPipelineLayout(__VA_ARGS__)
+#define vkCreatePipelineCache(...)       TrackedCreatePipelineCache(__VA_ARGS__)
+#define vkDestroyPipelineCache(...)      TrackedDestroyPipelineCache(__VA_ARGS__)
+#define vkCreateDescriptorSetLayout(...) TrackedCreateDescriptorSetLayout(__VA_ARGS__)
+#define vkDestroyDescriptorSetLayout(...) TrackedDestroyDescriptorSetLayout(__VA_ARGS__)
+#define vkCreateDescriptorPool(...)      TrackedCreateDescriptorPool(__VA_ARGS__)
+#define vkDestroyDescriptorPool(...)     TrackedDestroyDescriptorPool(__VA_ARGS__)
+#define vkCreateRenderPass(...)          TrackedCreateRenderPass(__VA_ARGS__)
+#define vkDestroyRenderPass(...)         TrackedDestroyRenderPass(__VA_ARGS__)
+#define vkCreateFramebuffer(...)         TrackedCreateFramebuffer(__VA_ARGS__)
+#define vkDestroyFramebuffer(...)        TrackedDestroyFramebuffer(__VA_ARGS__)
+#define vkCreateCommandPool(...)         TrackedCreateCommandPool(__VA_ARGS__)
+#define vkDestroyCommandPool(...)        TrackedDestroyCommandPool(__VA_ARGS__)
+#define vkCreateFence(...)               TrackedCreateFence(__VA_ARGS__)
+#define vkDestroyFence(...)              TrackedDestroyFence(__VA_ARGS__)
+#define vkCreateSemaphore(...)           TrackedCreateSemaphore(__VA_ARGS__)
+#define vkDestroySemaphore(...)          TrackedDestroySemaphore(__VA_ARGS__)
+#define vkCreateEvent(...)               TrackedCreateEvent(__VA_ARGS__)
+#define vkDestroyEvent(...)              TrackedDestroyEvent(__VA_ARGS__)
+#define vkCreateQueryPool(...)           TrackedCreateQueryPool(__VA_ARGS__)
+#define vkDestroyQueryPool(...)          TrackedDestroyQueryPool(__VA_ARGS__)
+#define vkCreateGraphicsPipelines(...)   TrackedCreateGraphicsPipelines(__VA_ARGS__)
+#define vkCreateComputePipelines(...)    TrackedCreateComputePipelines(__VA_ARGS__)
+#define vkDestroyPipeline(...)           TrackedDestroyPipeline(__VA_ARGS__)
+#define vkAllocateMemory(...)            TrackedAllocateMemory(__VA_ARGS__)
+#define vkFreeMemory(...)                TrackedFreeMemory(__VA_ARGS__)
+#endif
+
+#endif // VULKAN_OBJECT_TRACKER_H
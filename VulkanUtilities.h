@@ -0,0 +1,394 @@
+#ifndef VULKAN_UTILITIES_H
+#define VULKAN_UTILITIES_H
+
+// Small helpers shared by the rendering modules. Everything throws std::runtime_error on
+// failure, in the same way as HelloTriangleApplication.
+
+#include <vulkan/vulkan.h>
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+
+inline uint32_t
+FindMemoryType(VkPhysicalDevice      physicalDevice,
+               uint32_t              typeFilter,
+               VkMemoryPropertyFlags properties)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties = {};
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    for (uint32_t ii = 0; ii < memoryProperties.memoryTypeCount; ii++)
+    {
+        if ((typeFilter & (1u << ii)) &&
+            (memoryProperties.memoryTypes[ii].propertyFlags & properties) == properties)
+        {
+            return ii;
+        }
+    }
+
+    throw std::runtime_error("[ ERROR ] Failed to find a suitable memory type.");
+}
+
+
+inline void
+CreateBuffer(VkPhysicalDevice      physicalDevice,
+             VkDevice              device,
+             VkDeviceSize          size,
+             VkBufferUsageFlags    usage,
+             VkMemoryPropertyFlags properties,
+             VkBuffer&             buffer,
+             VkDeviceMemory&       memory)
+{
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size        = size;
+    bufferInfo.usage       = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to create buffer.");
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize  = requirements.size;
+    allocateInfo.memoryTypeIndex = FindMemoryType(physicalDevice, requirements.memoryTypeBits, properties);
+
+    if (vkAllocateMemory(device, &allocateInfo, nullptr, &memory) != VK_SUCCESS)
+    {
+        vkDestroyBuffer(device, buffer, nullptr);
+        throw std::runtime_error("[ ERROR ] Failed to allocate buffer memory.");
+    }
+
+    vkBindBufferMemory(device, buffer, memory, 0);
+}
+
+
+inline void
+CreateImage2D(VkPhysicalDevice  physicalDevice,
+              VkDevice          device,
+              VkFormat          format,
+              uint32_t          width,
+              uint32_t          height,
+              uint32_t          mipLevels,
+              VkImageUsageFlags usage,
+              VkImage&          image,
+              VkDeviceMemory&   memory)
+{
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+    imageInfo.format        = format;
+    imageInfo.extent        = { width, height, 1 };
+    imageInfo.mipLevels     = mipLevels;
+    imageInfo.arrayLayers   = 1;
+    imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage         = usage;
+    imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to create image.");
+    }
+
+    VkMemoryRequirements requirements = {};
+    vkGetImageMemoryRequirements(device, image, &requirements);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize  = requirements.size;
+    allocateInfo.memoryTypeIndex = FindMemoryType(physicalDevice,
+                                                  requirements.memoryTypeBits,
+                                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(device, &allocateInfo, nullptr, &memory) != VK_SUCCESS)
+    {
+        vkDestroyImage(device, image, nullptr);
+        throw std::runtime_error("[ ERROR ] Failed to allocate image memory.");
+    }
+
+    vkBindImageMemory(device, image, memory, 0);
+}
+
+
+inline VkImageView
+CreateImageView2D(VkDevice           device,
+                  VkImage            image,
+                  VkFormat           format,
+                  VkImageAspectFlags aspect,
+                  uint32_t           baseMipLevel,
+                  uint32_t           levelCount)
+{
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image                           = image;
+    viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format                          = format;
+    viewInfo.subresourceRange.aspectMask     = aspect;
+    viewInfo.subresourceRange.baseMipLevel   = baseMipLevel;
+    viewInfo.subresourceRange.levelCount     = levelCount;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount     = 1;
+
+    VkImageView view = VK_NULL_HANDLE;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to create image view.");
+    }
+    return view;
+}
+
+
+inline void
+ImageBarrier(VkCommandBuffer      commandBuffer,
+             VkImage              image,
+             VkImageAspectFlags   aspect,
+             uint32_t             baseMipLevel,
+             uint32_t             levelCount,
+             VkImageLayout        oldLayout,
+             VkImageLayout        newLayout,
+             VkAccessFlags        srcAccess,
+             VkAccessFlags        dstAccess,
+             VkPipelineStageFlags srcStage,
+             VkPipelineStageFlags dstStage)
+{
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask                   = srcAccess;
+    barrier.dstAccessMask                   = dstAccess;
+    barrier.oldLayout                       = oldLayout;
+    barrier.newLayout                       = newLayout;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = image;
+    barrier.subresourceRange.aspectMask     = aspect;
+    barrier.subresourceRange.baseMipLevel   = baseMipLevel;
+    barrier.subresourceRange.levelCount     = levelCount;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = 1;
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+
+inline bool
+DeviceExtensionSupported(VkPhysicalDevice physicalDevice, const char* extensionName)
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+    for (const auto& extension : extensions)
+    {
+        if (strcmp(extension.extensionName, extensionName) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+inline bool
+InstanceExtensionSupported(const char* extensionName)
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+
+    for (const auto& extension : extensions)
+    {
+        if (strcmp(extension.extensionName, extensionName) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Extension commands are not exported by the loader library and must be fetched per device.
+template <typename FunctionPointer>
+inline FunctionPointer
+LoadDeviceFunction(VkDevice device, const char* name)
+{
+    return reinterpret_cast<FunctionPointer>(vkGetDeviceProcAddr(device, name));
+}
+
+
+// Creates a pipeline cache seeded with the contents of path when that file exists and was
+// written for this device and driver (header fields of VkPipelineCacheHeaderVersionOne);
+// otherwise the cache starts empty. Not every driver survives foreign data, hence the check.
+inline VkPipelineCache
+CreatePipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path)
+{
+    std::vector<char> data;
+    if (!path.empty())
+    {
+        std::ifstream file(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if (!data.empty())
+    {
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        uint32_t header[4] = {};
+        if (data.size() >= headerSize)
+        {
+            memcpy(header, data.data(), sizeof(header));
+        }
+        if (data.size() < headerSize || header[0] < headerSize ||
+            header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+            header[2] != properties.vendorID || header[3] != properties.deviceID ||
+            memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            std::cout << "[ INFO ] Ignoring pipeline cache " << path << " from another device or driver." << std::endl;
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData    = data.empty() ? nullptr : data.data();
+
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to create pipeline cache.");
+    }
+    return cache;
+}
+
+
+// Writes the contents of cache to path for CreatePipelineCache() of the next run.
+inline void
+SavePipelineCache(VkDevice device, VkPipelineCache cache, const std::string& path)
+{
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to read pipeline cache data.");
+    }
+    std::vector<char> data(size);
+    if (size > 0 && vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to read pipeline cache data.");
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(data.data(), static_cast<std::streamsize>(size)))
+    {
+        throw std::runtime_error("[ ERROR ] Failed to write pipeline cache " + path + ".");
+    }
+}
+
+
+// Staging buffer of an upload recorded with RecordBufferUpload(). Destroy it once the
+// command buffer has completed.
+struct StagingBuffer
+{
+    VkBuffer       buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+
+
+    void
+    Destroy(VkDevice device)
+    {
+        if (buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, buffer, nullptr);
+        if (memory != VK_NULL_HANDLE) vkFreeMemory(device, memory, nullptr);
+        buffer = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
+    }
+};
+
+
+// Creates a device local buffer and records a copy of data into it. The buffer is usable
+// by any stage after a transfer -> consumer barrier, which the caller records.
+inline void
+RecordBufferUpload(VkPhysicalDevice   physicalDevice,
+                   VkDevice           device,
+                   VkCommandBuffer    commandBuffer,
+                   const void*        data,
+                   VkDeviceSize       size,
+                   VkBufferUsageFlags usage,
+                   VkBuffer&          buffer,
+                   VkDeviceMemory&    memory,
+                   StagingBuffer&     staging)
+{
+    CreateBuffer(physicalDevice, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 staging.buffer, staging.memory);
+
+    void* mapped = nullptr;
+    if (vkMapMemory(device, staging.memory, 0, size, 0, &mapped) != VK_SUCCESS)
+    {
+        throw std::runtime_error("[ ERROR ] Failed to map upload staging buffer.");
+    }
+    memcpy(mapped, data, static_cast<size_t>(size));
+    vkUnmapMemory(device, staging.memory);
+
+    CreateBuffer(physicalDevice, device, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+
+    VkBufferCopy region = {};
+    region.size = size;
+    vkCmdCopyBuffer(commandBuffer, staging.buffer, buffer, 1, &region);
+}
+
+
+inline void
+BufferBarrier(VkCommandBuffer      commandBuffer,
+              VkBuffer             buffer,
+              VkAccessFlags        srcAccess,
+              VkAccessFlags        dstAccess,
+              VkPipelineStageFlags srcStage,
+              VkPipelineStageFlags dstStage)
+{
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask       = srcAccess;
+    barrier.dstAccessMask       = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer              = buffer;
+    barrier.offset              = 0;
+    barrier.size                = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+
+// Contents of a JSON string literal for text: quotes and backslashes escaped, control
+// characters dropped. Shared by the trace and telemetry exports.
+inline std::string
+EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    for (char character : text)
+    {
+        if (character == '"' || character == '\\') escaped += '\\';
+        if (static_cast<unsigned char>(character) >= 0x20) escaped += character;
+    }
+    return escaped;
+}
+
+#endif // VULKAN_UTILITIES_H
@@ -37,6 +37,15 @@ IF %ERRORLEVEL% NEQ 0 call "C:\Program Files (x86)\Microsoft Visual Studio\2019\
 set file_name=%~n1
 set file_extension=%~x1
 
+:: shaderc_combined.lib ships with the Vulkan SDK. When it has been copied into libs\,
+:: runtime shader compilation is enabled (see ShaderCompiler.h).
+set shaderc_define=
+set shaderc_lib=
+IF EXIST %cd%\libs\shaderc_combined.lib (
+    set shaderc_define=/DHAVE_SHADERC
+    set shaderc_lib=shaderc_combined.lib
+)
+
 echo.
 echo [ STARTING COMPILATION ]
 
@@ -45,11 +54,11 @@ pushd msvc_landfill >nul
 
 cl %cd%\..\%file_name%%file_extension% /W4 /WX ^
 /I%cd%\.. ^
-/I%cd%\..\includes ^
+/I%cd%\..\includes %shaderc_define% ^
 /EHa /DEBUG:NONE /Z7 /GL /GS /MD /nologo ^
 /link /LIBPATH:%cd%/../libs /SUBSYSTEM:CONSOLE /NXCOMPAT /MACHINE:x64 /NODEFAULTLIB:MSVCRTD ^
 vulkan-1.lib ^
-glfw3.lib ^
+glfw3.lib %shaderc_lib% ^
 gdi32.lib ^
 user32.lib ^
 shell32.lib ^